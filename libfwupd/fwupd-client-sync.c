@@ -376,6 +376,98 @@ fwupd_client_get_upgrades (FwupdClient *self, const gchar *device_id,
 	return g_steal_pointer (&helper->array);
 }
 
+static void
+fwupd_client_get_releases_all_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientHelper *helper = (FwupdClientHelper *) user_data;
+	helper->hash = fwupd_client_get_releases_all_finish (FWUPD_CLIENT (source), res, &helper->error);
+	g_main_loop_quit (helper->loop);
+}
+
+/**
+ * fwupd_client_get_releases_all:
+ * @self: A #FwupdClient
+ * @cancellable: the #GCancellable, or %NULL
+ * @error: the #GError, or %NULL
+ *
+ * Gets all the releases for all devices in one call.
+ *
+ * Returns: (element-type utf8 GPtrArray) (transfer container): device ID to
+ * an array of #FwupdRelease
+ *
+ * Since: 1.5.2
+ **/
+GHashTable *
+fwupd_client_get_releases_all (FwupdClient *self, GCancellable *cancellable, GError **error)
+{
+	g_autoptr(FwupdClientHelper) helper = fwupd_client_helper_new ();
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* connect */
+	if (!fwupd_client_connect (self, cancellable, error))
+		return NULL;
+
+	/* call async version and run loop until complete */
+	fwupd_client_get_releases_all_async (self, cancellable,
+					     fwupd_client_get_releases_all_cb,
+					     helper);
+	g_main_loop_run (helper->loop);
+	if (helper->hash == NULL) {
+		g_propagate_error (error, g_steal_pointer (&helper->error));
+		return NULL;
+	}
+	return g_steal_pointer (&helper->hash);
+}
+
+static void
+fwupd_client_get_upgrades_all_cb (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	FwupdClientHelper *helper = (FwupdClientHelper *) user_data;
+	helper->hash = fwupd_client_get_upgrades_all_finish (FWUPD_CLIENT (source), res, &helper->error);
+	g_main_loop_quit (helper->loop);
+}
+
+/**
+ * fwupd_client_get_upgrades_all:
+ * @self: A #FwupdClient
+ * @cancellable: the #GCancellable, or %NULL
+ * @error: the #GError, or %NULL
+ *
+ * Gets all the upgrades for all devices in one call.
+ *
+ * Returns: (element-type utf8 GPtrArray) (transfer container): device ID to
+ * an array of #FwupdRelease
+ *
+ * Since: 1.5.2
+ **/
+GHashTable *
+fwupd_client_get_upgrades_all (FwupdClient *self, GCancellable *cancellable, GError **error)
+{
+	g_autoptr(FwupdClientHelper) helper = fwupd_client_helper_new ();
+
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* connect */
+	if (!fwupd_client_connect (self, cancellable, error))
+		return NULL;
+
+	/* call async version and run loop until complete */
+	fwupd_client_get_upgrades_all_async (self, cancellable,
+					     fwupd_client_get_upgrades_all_cb,
+					     helper);
+	g_main_loop_run (helper->loop);
+	if (helper->hash == NULL) {
+		g_propagate_error (error, g_steal_pointer (&helper->error));
+		return NULL;
+	}
+	return g_steal_pointer (&helper->hash);
+}
+
 static void
 fwupd_client_get_details_bytes_cb (GObject *source, GAsyncResult *res, gpointer user_data)
 {
@@ -32,6 +32,12 @@ GPtrArray	*fwupd_client_get_upgrades		(FwupdClient	*self,
 							 const gchar	*device_id,
 							 GCancellable	*cancellable,
 							 GError		**error);
+GHashTable	*fwupd_client_get_releases_all		(FwupdClient	*self,
+							 GCancellable	*cancellable,
+							 GError		**error);
+GHashTable	*fwupd_client_get_upgrades_all		(FwupdClient	*self,
+							 GCancellable	*cancellable,
+							 GError		**error);
 GPtrArray	*fwupd_client_get_details		(FwupdClient	*self,
 							 const gchar	*filename,
 							 GCancellable	*cancellable,
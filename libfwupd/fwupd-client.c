@@ -1340,6 +1340,205 @@ fwupd_client_get_upgrades_finish (FwupdClient *self, GAsyncResult *res, GError *
 	return g_task_propagate_pointer (G_TASK(res), error);
 }
 
+static GHashTable *
+fwupd_release_map_from_variant (GVariant *value)
+{
+	GHashTable *hash;
+	gsize sz;
+	g_autoptr(GVariant) untuple = NULL;
+
+	hash = g_hash_table_new_full (g_str_hash, g_str_equal,
+				      g_free, (GDestroyNotify) g_ptr_array_unref);
+	untuple = g_variant_get_child_value (value, 0);
+	sz = g_variant_n_children (untuple);
+	for (guint i = 0; i < sz; i++) {
+		GPtrArray *array;
+		const gchar *device_id = NULL;
+		gsize sz_rels;
+		g_autoptr(GVariant) data = NULL;
+		g_autoptr(GVariant) rels = NULL;
+
+		data = g_variant_get_child_value (untuple, i);
+		g_variant_get (data, "{&s@aa{sv}}", &device_id, &rels);
+		array = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+		sz_rels = g_variant_n_children (rels);
+		for (guint j = 0; j < sz_rels; j++) {
+			FwupdRelease *rel;
+			g_autoptr(GVariant) data_rel = g_variant_get_child_value (rels, j);
+			rel = fwupd_release_from_variant (data_rel);
+			if (rel == NULL)
+				continue;
+			g_ptr_array_add (array, rel);
+		}
+		g_hash_table_insert (hash, g_strdup (device_id), array);
+	}
+	return hash;
+}
+
+static void
+fwupd_client_get_releases_all_cb (GObject *source,
+				  GAsyncResult *res,
+				  gpointer user_data)
+{
+	g_autoptr(GTask) task = G_TASK (user_data);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GVariant) val = NULL;
+
+	val = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), res, &error);
+	if (val == NULL) {
+		fwupd_client_fixup_dbus_error (error);
+		g_task_return_error (task, g_steal_pointer (&error));
+		return;
+	}
+
+	/* success */
+	g_task_return_pointer (task,
+			       fwupd_release_map_from_variant (val),
+			       (GDestroyNotify) g_hash_table_unref);
+}
+
+/**
+ * fwupd_client_get_releases_all_async:
+ * @self: A #FwupdClient
+ * @cancellable: the #GCancellable, or %NULL
+ * @callback: the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Gets all the releases for all devices in one call, which is much faster
+ * than calling fwupd_client_get_releases_async() for each device.
+ *
+ * You must have called fwupd_client_connect_async() on @self before using
+ * this method.
+ *
+ * Since: 1.5.2
+ **/
+void
+fwupd_client_get_releases_all_async (FwupdClient *self,
+				     GCancellable *cancellable,
+				     GAsyncReadyCallback callback,
+				     gpointer callback_data)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	g_autoptr(GTask) task = NULL;
+
+	g_return_if_fail (FWUPD_IS_CLIENT (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (priv->proxy != NULL);
+
+	/* call into daemon */
+	task = g_task_new (self, cancellable, callback, callback_data);
+	g_dbus_proxy_call (priv->proxy, "GetReleasesAll",
+			   NULL,
+			   G_DBUS_CALL_FLAGS_NONE,
+			   -1, cancellable,
+			   fwupd_client_get_releases_all_cb,
+			   g_steal_pointer (&task));
+}
+
+/**
+ * fwupd_client_get_releases_all_finish:
+ * @self: A #FwupdClient
+ * @res: the #GAsyncResult
+ * @error: the #GError, or %NULL
+ *
+ * Gets the result of fwupd_client_get_releases_all_async().
+ *
+ * Returns: (element-type utf8 GPtrArray) (transfer container): device ID to
+ * an array of #FwupdRelease
+ *
+ * Since: 1.5.2
+ **/
+GHashTable *
+fwupd_client_get_releases_all_finish (FwupdClient *self, GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), NULL);
+	g_return_val_if_fail (g_task_is_valid (res, self), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	return g_task_propagate_pointer (G_TASK(res), error);
+}
+
+static void
+fwupd_client_get_upgrades_all_cb (GObject *source,
+				  GAsyncResult *res,
+				  gpointer user_data)
+{
+	g_autoptr(GTask) task = G_TASK (user_data);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GVariant) val = NULL;
+
+	val = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), res, &error);
+	if (val == NULL) {
+		fwupd_client_fixup_dbus_error (error);
+		g_task_return_error (task, g_steal_pointer (&error));
+		return;
+	}
+
+	/* success */
+	g_task_return_pointer (task,
+			       fwupd_release_map_from_variant (val),
+			       (GDestroyNotify) g_hash_table_unref);
+}
+
+/**
+ * fwupd_client_get_upgrades_all_async:
+ * @self: A #FwupdClient
+ * @cancellable: the #GCancellable, or %NULL
+ * @callback: the function to run on completion
+ * @callback_data: the data to pass to @callback
+ *
+ * Gets all the upgrades for all devices in one call, which is much faster
+ * than calling fwupd_client_get_upgrades_async() for each device.
+ *
+ * You must have called fwupd_client_connect_async() on @self before using
+ * this method.
+ *
+ * Since: 1.5.2
+ **/
+void
+fwupd_client_get_upgrades_all_async (FwupdClient *self,
+				     GCancellable *cancellable,
+				     GAsyncReadyCallback callback,
+				     gpointer callback_data)
+{
+	FwupdClientPrivate *priv = GET_PRIVATE (self);
+	g_autoptr(GTask) task = NULL;
+
+	g_return_if_fail (FWUPD_IS_CLIENT (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (priv->proxy != NULL);
+
+	/* call into daemon */
+	task = g_task_new (self, cancellable, callback, callback_data);
+	g_dbus_proxy_call (priv->proxy, "GetUpgradesAll",
+			   NULL,
+			   G_DBUS_CALL_FLAGS_NONE,
+			   -1, cancellable,
+			   fwupd_client_get_upgrades_all_cb,
+			   g_steal_pointer (&task));
+}
+
+/**
+ * fwupd_client_get_upgrades_all_finish:
+ * @self: A #FwupdClient
+ * @res: the #GAsyncResult
+ * @error: the #GError, or %NULL
+ *
+ * Gets the result of fwupd_client_get_upgrades_all_async().
+ *
+ * Returns: (element-type utf8 GPtrArray) (transfer container): device ID to
+ * an array of #FwupdRelease
+ *
+ * Since: 1.5.2
+ **/
+GHashTable *
+fwupd_client_get_upgrades_all_finish (FwupdClient *self, GAsyncResult *res, GError **error)
+{
+	g_return_val_if_fail (FWUPD_IS_CLIENT (self), NULL);
+	g_return_val_if_fail (g_task_is_valid (res, self), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	return g_task_propagate_pointer (G_TASK(res), error);
+}
+
 static void
 fwupd_client_modify_config_cb (GObject *source,
 			       GAsyncResult *res,
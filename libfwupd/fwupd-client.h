@@ -120,6 +120,20 @@ void		 fwupd_client_get_upgrades_async	(FwupdClient	*self,
 GPtrArray	*fwupd_client_get_upgrades_finish	(FwupdClient	*self,
 							 GAsyncResult	*res,
 							 GError		**error);
+void		 fwupd_client_get_releases_all_async	(FwupdClient	*self,
+							 GCancellable	*cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer	 callback_data);
+GHashTable	*fwupd_client_get_releases_all_finish	(FwupdClient	*self,
+							 GAsyncResult	*res,
+							 GError		**error);
+void		 fwupd_client_get_upgrades_all_async	(FwupdClient	*self,
+							 GCancellable	*cancellable,
+							 GAsyncReadyCallback callback,
+							 gpointer	 callback_data);
+GHashTable	*fwupd_client_get_upgrades_all_finish	(FwupdClient	*self,
+							 GAsyncResult	*res,
+							 GError		**error);
 void		 fwupd_client_get_details_bytes_async	(FwupdClient	*self,
 							 GBytes		*bytes,
 							 GCancellable	*cancellable,
@@ -1040,7 +1040,7 @@ fwupd_unix_input_stream_from_bytes (GBytes *bytes, GError **error)
 	gint fd;
 	gssize rc;
 
-	fd = memfd_create ("fwupd", MFD_CLOEXEC);
+	fd = memfd_create ("fwupd", MFD_CLOEXEC | MFD_ALLOW_SEALING);
 	if (fd < 0) {
 		g_set_error_literal (error,
 				     FWUPD_ERROR,
@@ -1063,6 +1063,13 @@ fwupd_unix_input_stream_from_bytes (GBytes *bytes, GError **error)
 			     "failed to seek: %s", g_strerror (errno));
 		return NULL;
 	}
+
+	/* the daemon can map a sealed memfd rather than reading it */
+#ifdef F_ADD_SEALS
+	if (fcntl (fd, F_ADD_SEALS,
+		   F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) < 0)
+		g_debug ("failed to seal memfd: %s", g_strerror (errno));
+#endif
 	return G_UNIX_INPUT_STREAM (g_unix_input_stream_new (fd, TRUE));
 }
 
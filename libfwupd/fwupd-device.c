@@ -64,6 +64,9 @@ typedef struct {
 	FwupdStatus			 status;
 	GPtrArray			*releases;
 	FwupdDevice			*parent;	/* noref */
+	GVariant			*variant;	/* (nullable) */
+	FwupdDeviceFlags		 variant_flags;
+	GRWLock				 mutex;		/* for the serialized fields */
 } FwupdDevicePrivate;
 
 enum {
@@ -79,6 +82,28 @@ enum {
 G_DEFINE_TYPE_WITH_PRIVATE (FwupdDevice, fwupd_device, G_TYPE_OBJECT)
 #define GET_PRIVATE(o) (fwupd_device_get_instance_private (o))
 
+/* the daemon serializes devices on the main thread while install worker
+ * threads modify them, so the fields included in the GVariant are only
+ * changed with the writer lock held, and this must be called with it held */
+static void
+fwupd_device_invalidate_variant (FwupdDevice *device)
+{
+	FwupdDevicePrivate *priv = GET_PRIVATE (device);
+	g_clear_pointer (&priv->variant, g_variant_unref);
+}
+
+static void
+fwupd_device_set_string (FwupdDevice *device, gchar **str, const gchar *value)
+{
+	FwupdDevicePrivate *priv = GET_PRIVATE (device);
+	g_autofree gchar *str_old = NULL;
+	g_rw_lock_writer_lock (&priv->mutex);
+	str_old = *str;
+	*str = g_strdup (value);
+	fwupd_device_invalidate_variant (device);
+	g_rw_lock_writer_unlock (&priv->mutex);
+}
+
 /**
  * fwupd_device_get_checksums:
  * @device: A #FwupdDevice
@@ -112,12 +137,17 @@ fwupd_device_add_checksum (FwupdDevice *device, const gchar *checksum)
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
 	g_return_if_fail (checksum != NULL);
+	g_rw_lock_writer_lock (&priv->mutex);
 	for (guint i = 0; i < priv->checksums->len; i++) {
 		const gchar *checksum_tmp = g_ptr_array_index (priv->checksums, i);
-		if (g_strcmp0 (checksum_tmp, checksum) == 0)
+		if (g_strcmp0 (checksum_tmp, checksum) == 0) {
+			g_rw_lock_writer_unlock (&priv->mutex);
 			return;
+		}
 	}
 	g_ptr_array_add (priv->checksums, g_strdup (checksum));
+	fwupd_device_invalidate_variant (device);
+	g_rw_lock_writer_unlock (&priv->mutex);
 }
 
 /**
@@ -170,8 +200,7 @@ fwupd_device_set_summary (FwupdDevice *device, const gchar *summary)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->summary);
-	priv->summary = g_strdup (summary);
+	fwupd_device_set_string (device, &priv->summary, summary);
 }
 
 /**
@@ -206,8 +235,7 @@ fwupd_device_set_branch (FwupdDevice *device, const gchar *branch)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->branch);
-	priv->branch = g_strdup (branch);
+	fwupd_device_set_string (device, &priv->branch, branch);
 }
 
 /**
@@ -242,8 +270,7 @@ fwupd_device_set_serial (FwupdDevice *device, const gchar *serial)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->serial);
-	priv->serial = g_strdup (serial);
+	fwupd_device_set_string (device, &priv->serial, serial);
 }
 
 /**
@@ -278,8 +305,7 @@ fwupd_device_set_id (FwupdDevice *device, const gchar *id)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->id);
-	priv->id = g_strdup (id);
+	fwupd_device_set_string (device, &priv->id, id);
 }
 
 /**
@@ -314,8 +340,7 @@ fwupd_device_set_parent_id (FwupdDevice *device, const gchar *parent_id)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->parent_id);
-	priv->parent_id = g_strdup (parent_id);
+	fwupd_device_set_string (device, &priv->parent_id, parent_id);
 }
 
 /**
@@ -443,9 +468,14 @@ fwupd_device_add_guid (FwupdDevice *device, const gchar *guid)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	if (fwupd_device_has_guid (device, guid))
+	g_rw_lock_writer_lock (&priv->mutex);
+	if (fwupd_device_has_guid (device, guid)) {
+		g_rw_lock_writer_unlock (&priv->mutex);
 		return;
+	}
 	g_ptr_array_add (priv->guids, g_strdup (guid));
+	fwupd_device_invalidate_variant (device);
+	g_rw_lock_writer_unlock (&priv->mutex);
 }
 
 /**
@@ -526,9 +556,14 @@ fwupd_device_add_instance_id (FwupdDevice *device, const gchar *instance_id)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	if (fwupd_device_has_instance_id (device, instance_id))
+	g_rw_lock_writer_lock (&priv->mutex);
+	if (fwupd_device_has_instance_id (device, instance_id)) {
+		g_rw_lock_writer_unlock (&priv->mutex);
 		return;
+	}
 	g_ptr_array_add (priv->instance_ids, g_strdup (instance_id));
+	fwupd_device_invalidate_variant (device);
+	g_rw_lock_writer_unlock (&priv->mutex);
 }
 
 /**
@@ -578,9 +613,14 @@ fwupd_device_add_icon (FwupdDevice *device, const gchar *icon)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	if (fwupd_device_has_icon (device, icon))
+	g_rw_lock_writer_lock (&priv->mutex);
+	if (fwupd_device_has_icon (device, icon)) {
+		g_rw_lock_writer_unlock (&priv->mutex);
 		return;
+	}
 	g_ptr_array_add (priv->icons, g_strdup (icon));
+	fwupd_device_invalidate_variant (device);
+	g_rw_lock_writer_unlock (&priv->mutex);
 }
 
 /**
@@ -615,8 +655,7 @@ fwupd_device_set_name (FwupdDevice *device, const gchar *name)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->name);
-	priv->name = g_strdup (name);
+	fwupd_device_set_string (device, &priv->name, name);
 }
 
 /**
@@ -651,8 +690,7 @@ fwupd_device_set_vendor (FwupdDevice *device, const gchar *vendor)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->vendor);
-	priv->vendor = g_strdup (vendor);
+	fwupd_device_set_string (device, &priv->vendor, vendor);
 }
 
 /**
@@ -687,8 +725,7 @@ fwupd_device_set_vendor_id (FwupdDevice *device, const gchar *vendor_id)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->vendor_id);
-	priv->vendor_id = g_strdup (vendor_id);
+	fwupd_device_set_string (device, &priv->vendor_id, vendor_id);
 }
 
 /**
@@ -723,8 +760,7 @@ fwupd_device_set_description (FwupdDevice *device, const gchar *description)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->description);
-	priv->description = g_strdup (description);
+	fwupd_device_set_string (device, &priv->description, description);
 }
 
 /**
@@ -759,8 +795,7 @@ fwupd_device_set_version (FwupdDevice *device, const gchar *version)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->version);
-	priv->version = g_strdup (version);
+	fwupd_device_set_string (device, &priv->version, version);
 }
 
 /**
@@ -795,8 +830,7 @@ fwupd_device_set_version_lowest (FwupdDevice *device, const gchar *version_lowes
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->version_lowest);
-	priv->version_lowest = g_strdup (version_lowest);
+	fwupd_device_set_string (device, &priv->version_lowest, version_lowest);
 }
 
 /**
@@ -831,7 +865,10 @@ fwupd_device_set_version_lowest_raw (FwupdDevice *device, guint64 version_lowest
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	g_rw_lock_writer_lock (&priv->mutex);
 	priv->version_lowest_raw = version_lowest_raw;
+	fwupd_device_invalidate_variant (device);
+	g_rw_lock_writer_unlock (&priv->mutex);
 }
 
 /**
@@ -866,8 +903,7 @@ fwupd_device_set_version_bootloader (FwupdDevice *device, const gchar *version_b
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->version_bootloader);
-	priv->version_bootloader = g_strdup (version_bootloader);
+	fwupd_device_set_string (device, &priv->version_bootloader, version_bootloader);
 }
 
 /**
@@ -902,7 +938,10 @@ fwupd_device_set_version_bootloader_raw (FwupdDevice *device, guint64 version_bo
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	g_rw_lock_writer_lock (&priv->mutex);
 	priv->version_bootloader_raw = version_bootloader_raw;
+	fwupd_device_invalidate_variant (device);
+	g_rw_lock_writer_unlock (&priv->mutex);
 }
 
 /**
@@ -937,7 +976,10 @@ fwupd_device_set_flashes_left (FwupdDevice *device, guint32 flashes_left)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	g_rw_lock_writer_lock (&priv->mutex);
 	priv->flashes_left = flashes_left;
+	fwupd_device_invalidate_variant (device);
+	g_rw_lock_writer_unlock (&priv->mutex);
 }
 
 /**
@@ -972,7 +1014,10 @@ fwupd_device_set_install_duration (FwupdDevice *device, guint32 duration)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	g_rw_lock_writer_lock (&priv->mutex);
 	priv->install_duration = duration;
+	fwupd_device_invalidate_variant (device);
+	g_rw_lock_writer_unlock (&priv->mutex);
 }
 
 /**
@@ -1007,8 +1052,7 @@ fwupd_device_set_plugin (FwupdDevice *device, const gchar *plugin)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->plugin);
-	priv->plugin = g_strdup (plugin);
+	fwupd_device_set_string (device, &priv->plugin, plugin);
 }
 
 /**
@@ -1043,8 +1087,7 @@ fwupd_device_set_protocol (FwupdDevice *device, const gchar *protocol)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->protocol);
-	priv->protocol = g_strdup (protocol);
+	fwupd_device_set_string (device, &priv->protocol, protocol);
 }
 
 /**
@@ -1079,9 +1122,14 @@ fwupd_device_set_flags (FwupdDevice *device, guint64 flags)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	if (priv->flags == flags)
+	g_rw_lock_writer_lock (&priv->mutex);
+	if (priv->flags == flags) {
+		g_rw_lock_writer_unlock (&priv->mutex);
 		return;
+	}
 	priv->flags = flags;
+	fwupd_device_invalidate_variant (device);
+	g_rw_lock_writer_unlock (&priv->mutex);
 	g_object_notify (G_OBJECT (device), "flags");
 }
 
@@ -1101,9 +1149,14 @@ fwupd_device_add_flag (FwupdDevice *device, FwupdDeviceFlags flag)
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
 	if (flag == 0)
 		return;
-	if ((priv->flags & flag) > 0)
+	g_rw_lock_writer_lock (&priv->mutex);
+	if ((priv->flags & flag) > 0) {
+		g_rw_lock_writer_unlock (&priv->mutex);
 		return;
+	}
 	priv->flags |= flag;
+	fwupd_device_invalidate_variant (device);
+	g_rw_lock_writer_unlock (&priv->mutex);
 	g_object_notify (G_OBJECT (device), "flags");
 }
 
@@ -1123,9 +1176,14 @@ fwupd_device_remove_flag (FwupdDevice *device, FwupdDeviceFlags flag)
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
 	if (flag == 0)
 		return;
-	if ((priv->flags & flag) == 0)
+	g_rw_lock_writer_lock (&priv->mutex);
+	if ((priv->flags & flag) == 0) {
+		g_rw_lock_writer_unlock (&priv->mutex);
 		return;
+	}
 	priv->flags &= ~flag;
+	fwupd_device_invalidate_variant (device);
+	g_rw_lock_writer_unlock (&priv->mutex);
 	g_object_notify (G_OBJECT (device), "flags");
 }
 
@@ -1180,7 +1238,10 @@ fwupd_device_set_created (FwupdDevice *device, guint64 created)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	g_rw_lock_writer_lock (&priv->mutex);
 	priv->created = created;
+	fwupd_device_invalidate_variant (device);
+	g_rw_lock_writer_unlock (&priv->mutex);
 }
 
 /**
@@ -1215,7 +1276,10 @@ fwupd_device_set_modified (FwupdDevice *device, guint64 modified)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	g_rw_lock_writer_lock (&priv->mutex);
 	priv->modified = modified;
+	fwupd_device_invalidate_variant (device);
+	g_rw_lock_writer_unlock (&priv->mutex);
 }
 
 /**
@@ -1309,26 +1373,13 @@ fwupd_device_incorporate (FwupdDevice *self, FwupdDevice *donor)
 	}
 }
 
-/**
- * fwupd_device_to_variant_full:
- * @device: A #FwupdDevice
- * @flags: #FwupdDeviceFlags for the call
- *
- * Creates a GVariant from the device data.
- * Optionally provides additional data based upon flags
- *
- * Returns: the GVariant, or %NULL for error
- *
- * Since: 1.1.2
- **/
-GVariant *
-fwupd_device_to_variant_full (FwupdDevice *device, FwupdDeviceFlags flags)
+/* must be called with the lock held */
+static GVariant *
+fwupd_device_to_variant_locked (FwupdDevice *device, FwupdDeviceFlags flags)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	GVariantBuilder builder;
 
-	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
-
 	/* create an array with all the metadata in */
 	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
 	if (priv->id != NULL) {
@@ -1522,6 +1573,64 @@ fwupd_device_to_variant_full (FwupdDevice *device, FwupdDeviceFlags flags)
 	return g_variant_new ("a{sv}", &builder);
 }
 
+/**
+ * fwupd_device_to_variant_full:
+ * @device: A #FwupdDevice
+ * @flags: #FwupdDeviceFlags for the call
+ *
+ * Creates a GVariant from the device data.
+ * Optionally provides additional data based upon flags
+ *
+ * Returns: the GVariant, or %NULL for error
+ *
+ * Since: 1.1.2
+ **/
+GVariant *
+fwupd_device_to_variant_full (FwupdDevice *device, FwupdDeviceFlags flags)
+{
+	FwupdDevicePrivate *priv = GET_PRIVATE (device);
+	g_autoptr(GRWLockReaderLocker) locker = NULL;
+
+	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+
+	locker = g_rw_lock_reader_locker_new (&priv->mutex);
+	return fwupd_device_to_variant_locked (device, flags);
+}
+
+/**
+ * fwupd_device_to_variant_cached:
+ * @device: A #FwupdDevice
+ * @flags: #FwupdDeviceFlags for the call
+ *
+ * Creates a GVariant from the device data, re-using the result of the
+ * previous call if the device has not been modified since.
+ *
+ * Returns: (transfer full): the GVariant, or %NULL for error
+ *
+ * Since: 1.5.2
+ **/
+GVariant *
+fwupd_device_to_variant_cached (FwupdDevice *device, FwupdDeviceFlags flags)
+{
+	FwupdDevicePrivate *priv = GET_PRIVATE (device);
+	g_autoptr(GRWLockWriterLocker) locker = NULL;
+
+	g_return_val_if_fail (FWUPD_IS_DEVICE (device), NULL);
+
+	locker = g_rw_lock_writer_locker_new (&priv->mutex);
+
+	/* the releases can be modified without the device knowing */
+	if (priv->releases->len > 0)
+		return g_variant_ref_sink (fwupd_device_to_variant_locked (device, flags));
+
+	if (priv->variant == NULL || priv->variant_flags != flags) {
+		g_clear_pointer (&priv->variant, g_variant_unref);
+		priv->variant = g_variant_ref_sink (fwupd_device_to_variant_locked (device, flags));
+		priv->variant_flags = flags;
+	}
+	return g_variant_ref (priv->variant);
+}
+
 /**
  * fwupd_device_to_variant:
  * @device: A #FwupdDevice
@@ -1538,10 +1647,109 @@ fwupd_device_to_variant (FwupdDevice *device)
 	return fwupd_device_to_variant_full (device, FWUPD_DEVICE_FLAG_NONE);
 }
 
+/* each object from the daemon has every key looked up, so build a hash
+ * once rather than comparing each key against every known value */
+typedef enum {
+	FWUPD_DEVICE_KEY_UNKNOWN,
+	FWUPD_DEVICE_KEY_RELEASE,
+	FWUPD_DEVICE_KEY_DEVICE_ID,
+	FWUPD_DEVICE_KEY_PARENT_DEVICE_ID,
+	FWUPD_DEVICE_KEY_FLAGS,
+	FWUPD_DEVICE_KEY_CREATED,
+	FWUPD_DEVICE_KEY_MODIFIED,
+	FWUPD_DEVICE_KEY_GUID,
+	FWUPD_DEVICE_KEY_INSTANCE_IDS,
+	FWUPD_DEVICE_KEY_ICON,
+	FWUPD_DEVICE_KEY_NAME,
+	FWUPD_DEVICE_KEY_VENDOR,
+	FWUPD_DEVICE_KEY_VENDOR_ID,
+	FWUPD_DEVICE_KEY_SERIAL,
+	FWUPD_DEVICE_KEY_SUMMARY,
+	FWUPD_DEVICE_KEY_BRANCH,
+	FWUPD_DEVICE_KEY_DESCRIPTION,
+	FWUPD_DEVICE_KEY_CHECKSUM,
+	FWUPD_DEVICE_KEY_PLUGIN,
+	FWUPD_DEVICE_KEY_PROTOCOL,
+	FWUPD_DEVICE_KEY_VERSION,
+	FWUPD_DEVICE_KEY_VERSION_LOWEST,
+	FWUPD_DEVICE_KEY_VERSION_BOOTLOADER,
+	FWUPD_DEVICE_KEY_FLASHES_LEFT,
+	FWUPD_DEVICE_KEY_INSTALL_DURATION,
+	FWUPD_DEVICE_KEY_UPDATE_ERROR,
+	FWUPD_DEVICE_KEY_UPDATE_MESSAGE,
+	FWUPD_DEVICE_KEY_UPDATE_IMAGE,
+	FWUPD_DEVICE_KEY_UPDATE_STATE,
+	FWUPD_DEVICE_KEY_STATUS,
+	FWUPD_DEVICE_KEY_VERSION_FORMAT,
+	FWUPD_DEVICE_KEY_VERSION_RAW,
+	FWUPD_DEVICE_KEY_VERSION_LOWEST_RAW,
+	FWUPD_DEVICE_KEY_VERSION_BOOTLOADER_RAW,
+	FWUPD_DEVICE_KEY_LAST
+} FwupdDeviceKey;
+
+static FwupdDeviceKey
+fwupd_device_key_from_string (const gchar *key)
+{
+	static gsize once = 0;
+	static GHashTable *hash = NULL;
+	if (key == NULL)
+		return FWUPD_DEVICE_KEY_UNKNOWN;
+	if (g_once_init_enter (&once)) {
+		const struct {
+			const gchar	*key;
+			FwupdDeviceKey	 id;
+		} map[] = {
+			{ FWUPD_RESULT_KEY_RELEASE, FWUPD_DEVICE_KEY_RELEASE },
+			{ FWUPD_RESULT_KEY_DEVICE_ID, FWUPD_DEVICE_KEY_DEVICE_ID },
+			{ FWUPD_RESULT_KEY_PARENT_DEVICE_ID, FWUPD_DEVICE_KEY_PARENT_DEVICE_ID },
+			{ FWUPD_RESULT_KEY_FLAGS, FWUPD_DEVICE_KEY_FLAGS },
+			{ FWUPD_RESULT_KEY_CREATED, FWUPD_DEVICE_KEY_CREATED },
+			{ FWUPD_RESULT_KEY_MODIFIED, FWUPD_DEVICE_KEY_MODIFIED },
+			{ FWUPD_RESULT_KEY_GUID, FWUPD_DEVICE_KEY_GUID },
+			{ FWUPD_RESULT_KEY_INSTANCE_IDS, FWUPD_DEVICE_KEY_INSTANCE_IDS },
+			{ FWUPD_RESULT_KEY_ICON, FWUPD_DEVICE_KEY_ICON },
+			{ FWUPD_RESULT_KEY_NAME, FWUPD_DEVICE_KEY_NAME },
+			{ FWUPD_RESULT_KEY_VENDOR, FWUPD_DEVICE_KEY_VENDOR },
+			{ FWUPD_RESULT_KEY_VENDOR_ID, FWUPD_DEVICE_KEY_VENDOR_ID },
+			{ FWUPD_RESULT_KEY_SERIAL, FWUPD_DEVICE_KEY_SERIAL },
+			{ FWUPD_RESULT_KEY_SUMMARY, FWUPD_DEVICE_KEY_SUMMARY },
+			{ FWUPD_RESULT_KEY_BRANCH, FWUPD_DEVICE_KEY_BRANCH },
+			{ FWUPD_RESULT_KEY_DESCRIPTION, FWUPD_DEVICE_KEY_DESCRIPTION },
+			{ FWUPD_RESULT_KEY_CHECKSUM, FWUPD_DEVICE_KEY_CHECKSUM },
+			{ FWUPD_RESULT_KEY_PLUGIN, FWUPD_DEVICE_KEY_PLUGIN },
+			{ FWUPD_RESULT_KEY_PROTOCOL, FWUPD_DEVICE_KEY_PROTOCOL },
+			{ FWUPD_RESULT_KEY_VERSION, FWUPD_DEVICE_KEY_VERSION },
+			{ FWUPD_RESULT_KEY_VERSION_LOWEST, FWUPD_DEVICE_KEY_VERSION_LOWEST },
+			{ FWUPD_RESULT_KEY_VERSION_BOOTLOADER, FWUPD_DEVICE_KEY_VERSION_BOOTLOADER },
+			{ FWUPD_RESULT_KEY_FLASHES_LEFT, FWUPD_DEVICE_KEY_FLASHES_LEFT },
+			{ FWUPD_RESULT_KEY_INSTALL_DURATION, FWUPD_DEVICE_KEY_INSTALL_DURATION },
+			{ FWUPD_RESULT_KEY_UPDATE_ERROR, FWUPD_DEVICE_KEY_UPDATE_ERROR },
+			{ FWUPD_RESULT_KEY_UPDATE_MESSAGE, FWUPD_DEVICE_KEY_UPDATE_MESSAGE },
+			{ FWUPD_RESULT_KEY_UPDATE_IMAGE, FWUPD_DEVICE_KEY_UPDATE_IMAGE },
+			{ FWUPD_RESULT_KEY_UPDATE_STATE, FWUPD_DEVICE_KEY_UPDATE_STATE },
+			{ FWUPD_RESULT_KEY_STATUS, FWUPD_DEVICE_KEY_STATUS },
+			{ FWUPD_RESULT_KEY_VERSION_FORMAT, FWUPD_DEVICE_KEY_VERSION_FORMAT },
+			{ FWUPD_RESULT_KEY_VERSION_RAW, FWUPD_DEVICE_KEY_VERSION_RAW },
+			{ FWUPD_RESULT_KEY_VERSION_LOWEST_RAW, FWUPD_DEVICE_KEY_VERSION_LOWEST_RAW },
+			{ FWUPD_RESULT_KEY_VERSION_BOOTLOADER_RAW, FWUPD_DEVICE_KEY_VERSION_BOOTLOADER_RAW },
+			{ NULL, FWUPD_DEVICE_KEY_UNKNOWN }
+		};
+		hash = g_hash_table_new (g_str_hash, g_str_equal);
+		for (guint i = 0; map[i].key != NULL; i++) {
+			g_hash_table_insert (hash, (gpointer) map[i].key,
+					     GUINT_TO_POINTER (map[i].id));
+		}
+		g_once_init_leave (&once, 1);
+	}
+	return GPOINTER_TO_UINT (g_hash_table_lookup (hash, key));
+}
+
 static void
 fwupd_device_from_key_value (FwupdDevice *device, const gchar *key, GVariant *value)
 {
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_RELEASE) == 0) {
+	FwupdDeviceKey key_id = fwupd_device_key_from_string (key);
+
+	if (key_id == FWUPD_DEVICE_KEY_RELEASE) {
 		GVariantIter iter;
 		GVariant *child;
 		g_variant_iter_init (&iter, value);
@@ -1553,73 +1761,73 @@ fwupd_device_from_key_value (FwupdDevice *device, const gchar *key, GVariant *va
 		}
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_DEVICE_ID) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_DEVICE_ID) {
 		fwupd_device_set_id (device, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_PARENT_DEVICE_ID) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_PARENT_DEVICE_ID) {
 		fwupd_device_set_parent_id (device, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_FLAGS) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_FLAGS) {
 		fwupd_device_set_flags (device, g_variant_get_uint64 (value));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_CREATED) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_CREATED) {
 		fwupd_device_set_created (device, g_variant_get_uint64 (value));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_MODIFIED) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_MODIFIED) {
 		fwupd_device_set_modified (device, g_variant_get_uint64 (value));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_GUID) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_GUID) {
 		g_autofree const gchar **guids = g_variant_get_strv (value, NULL);
 		for (guint i = 0; guids != NULL && guids[i] != NULL; i++)
 			fwupd_device_add_guid (device, guids[i]);
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_INSTANCE_IDS) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_INSTANCE_IDS) {
 		g_autofree const gchar **instance_ids = g_variant_get_strv (value, NULL);
 		for (guint i = 0; instance_ids != NULL && instance_ids[i] != NULL; i++)
 			fwupd_device_add_instance_id (device, instance_ids[i]);
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_ICON) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_ICON) {
 		g_autofree const gchar **icons = g_variant_get_strv (value, NULL);
 		for (guint i = 0; icons != NULL && icons[i] != NULL; i++)
 			fwupd_device_add_icon (device, icons[i]);
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_NAME) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_NAME) {
 		fwupd_device_set_name (device, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VENDOR) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_VENDOR) {
 		fwupd_device_set_vendor (device, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VENDOR_ID) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_VENDOR_ID) {
 		fwupd_device_set_vendor_id (device, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_SERIAL) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_SERIAL) {
 		fwupd_device_set_serial (device, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_SUMMARY) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_SUMMARY) {
 		fwupd_device_set_summary (device, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_BRANCH) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_BRANCH) {
 		fwupd_device_set_branch (device, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_DESCRIPTION) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_DESCRIPTION) {
 		fwupd_device_set_description (device, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_CHECKSUM) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_CHECKSUM) {
 		const gchar *checksums = g_variant_get_string (value, NULL);
 		if (checksums != NULL) {
 			g_auto(GStrv) split = g_strsplit (checksums, ",", -1);
@@ -1628,67 +1836,67 @@ fwupd_device_from_key_value (FwupdDevice *device, const gchar *key, GVariant *va
 		}
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_PLUGIN) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_PLUGIN) {
 		fwupd_device_set_plugin (device, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_PROTOCOL) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_PROTOCOL) {
 		fwupd_device_set_protocol (device, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VERSION) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_VERSION) {
 		fwupd_device_set_version (device, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VERSION_LOWEST) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_VERSION_LOWEST) {
 		fwupd_device_set_version_lowest (device, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VERSION_BOOTLOADER) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_VERSION_BOOTLOADER) {
 		fwupd_device_set_version_bootloader (device, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_FLASHES_LEFT) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_FLASHES_LEFT) {
 		fwupd_device_set_flashes_left (device, g_variant_get_uint32 (value));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_INSTALL_DURATION) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_INSTALL_DURATION) {
 		fwupd_device_set_install_duration (device, g_variant_get_uint32 (value));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_UPDATE_ERROR) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_UPDATE_ERROR) {
 		fwupd_device_set_update_error (device, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_UPDATE_MESSAGE) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_UPDATE_MESSAGE) {
 		fwupd_device_set_update_message (device, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_UPDATE_IMAGE) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_UPDATE_IMAGE) {
 		fwupd_device_set_update_image (device, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_UPDATE_STATE) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_UPDATE_STATE) {
 		fwupd_device_set_update_state (device, g_variant_get_uint32 (value));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_STATUS) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_STATUS) {
 		fwupd_device_set_status (device, g_variant_get_uint32 (value));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VERSION_FORMAT) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_VERSION_FORMAT) {
 		fwupd_device_set_version_format (device, g_variant_get_uint32 (value));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VERSION_RAW) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_VERSION_RAW) {
 		fwupd_device_set_version_raw (device, g_variant_get_uint64 (value));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VERSION_LOWEST_RAW) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_VERSION_LOWEST_RAW) {
 		fwupd_device_set_version_lowest_raw (device, g_variant_get_uint64 (value));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VERSION_BOOTLOADER_RAW) == 0) {
+	if (key_id == FWUPD_DEVICE_KEY_VERSION_BOOTLOADER_RAW) {
 		fwupd_device_set_version_bootloader_raw (device, g_variant_get_uint64 (value));
 		return;
 	}
@@ -1783,7 +1991,10 @@ fwupd_device_set_update_state (FwupdDevice *device, FwupdUpdateState update_stat
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	g_rw_lock_writer_lock (&priv->mutex);
 	priv->update_state = update_state;
+	fwupd_device_invalidate_variant (device);
+	g_rw_lock_writer_unlock (&priv->mutex);
 }
 
 /**
@@ -1818,7 +2029,10 @@ fwupd_device_set_version_format (FwupdDevice *device, FwupdVersionFormat version
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	g_rw_lock_writer_lock (&priv->mutex);
 	priv->version_format = version_format;
+	fwupd_device_invalidate_variant (device);
+	g_rw_lock_writer_unlock (&priv->mutex);
 }
 
 /**
@@ -1853,7 +2067,10 @@ fwupd_device_set_version_raw (FwupdDevice *device, guint64 version_raw)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	g_rw_lock_writer_lock (&priv->mutex);
 	priv->version_raw = version_raw;
+	fwupd_device_invalidate_variant (device);
+	g_rw_lock_writer_unlock (&priv->mutex);
 }
 
 /**
@@ -1888,8 +2105,7 @@ fwupd_device_set_update_message (FwupdDevice *device, const gchar *update_messag
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->update_message);
-	priv->update_message = g_strdup (update_message);
+	fwupd_device_set_string (device, &priv->update_message, update_message);
 }
 
 /**
@@ -1924,8 +2140,7 @@ fwupd_device_set_update_image (FwupdDevice *device, const gchar *update_image)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->update_image);
-	priv->update_image = g_strdup (update_image);
+	fwupd_device_set_string (device, &priv->update_image, update_image);
 }
 
 /**
@@ -1960,8 +2175,7 @@ fwupd_device_set_update_error (FwupdDevice *device, const gchar *update_error)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
-	g_free (priv->update_error);
-	priv->update_error = g_strdup (update_error);
+	fwupd_device_set_string (device, &priv->update_error, update_error);
 }
 
 /**
@@ -2016,8 +2230,12 @@ fwupd_device_add_release (FwupdDevice *device, FwupdRelease *release)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_if_fail (FWUPD_IS_DEVICE (device));
+	g_rw_lock_writer_lock (&priv->mutex);
 	g_ptr_array_add (priv->releases, g_object_ref (release));
+	fwupd_device_invalidate_variant (device);
+	g_rw_lock_writer_unlock (&priv->mutex);
 }
+
 /**
  * fwupd_device_get_status:
  * @self: A #FwupdDevice
@@ -2050,9 +2268,14 @@ fwupd_device_set_status (FwupdDevice *self, FwupdStatus status)
 {
 	FwupdDevicePrivate *priv = GET_PRIVATE (self);
 	g_return_if_fail (FWUPD_IS_DEVICE (self));
-	if (priv->status == status)
+	g_rw_lock_writer_lock (&priv->mutex);
+	if (priv->status == status) {
+		g_rw_lock_writer_unlock (&priv->mutex);
 		return;
+	}
 	priv->status = status;
+	fwupd_device_invalidate_variant (self);
+	g_rw_lock_writer_unlock (&priv->mutex);
 	g_object_notify (G_OBJECT (self), "status");
 }
 
@@ -2421,6 +2644,7 @@ fwupd_device_init (FwupdDevice *device)
 	priv->checksums = g_ptr_array_new_with_free_func (g_free);
 	priv->children = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
 	priv->releases = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_rw_lock_init (&priv->mutex);
 }
 
 static void
@@ -2454,6 +2678,9 @@ fwupd_device_finalize (GObject *object)
 	g_ptr_array_unref (priv->checksums);
 	g_ptr_array_unref (priv->children);
 	g_ptr_array_unref (priv->releases);
+	if (priv->variant != NULL)
+		g_variant_unref (priv->variant);
+	g_rw_lock_clear (&priv->mutex);
 
 	G_OBJECT_CLASS (fwupd_device_parent_class)->finalize (object);
 }
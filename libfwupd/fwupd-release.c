@@ -1482,130 +1482,221 @@ fwupd_release_to_variant (FwupdRelease *release)
 	return g_variant_new ("a{sv}", &builder);
 }
 
+/* each object from the daemon has every key looked up, so build a hash
+ * once rather than comparing each key against every known value */
+typedef enum {
+	FWUPD_RELEASE_KEY_UNKNOWN,
+	FWUPD_RELEASE_KEY_REMOTE_ID,
+	FWUPD_RELEASE_KEY_APPSTREAM_ID,
+	FWUPD_RELEASE_KEY_DETACH_CAPTION,
+	FWUPD_RELEASE_KEY_DETACH_IMAGE,
+	FWUPD_RELEASE_KEY_FILENAME,
+	FWUPD_RELEASE_KEY_PROTOCOL,
+	FWUPD_RELEASE_KEY_LICENSE,
+	FWUPD_RELEASE_KEY_NAME,
+	FWUPD_RELEASE_KEY_NAME_VARIANT_SUFFIX,
+	FWUPD_RELEASE_KEY_SIZE,
+	FWUPD_RELEASE_KEY_CREATED,
+	FWUPD_RELEASE_KEY_SUMMARY,
+	FWUPD_RELEASE_KEY_BRANCH,
+	FWUPD_RELEASE_KEY_DESCRIPTION,
+	FWUPD_RELEASE_KEY_CATEGORIES,
+	FWUPD_RELEASE_KEY_ISSUES,
+	FWUPD_RELEASE_KEY_CHECKSUM,
+	FWUPD_RELEASE_KEY_URI,
+	FWUPD_RELEASE_KEY_HOMEPAGE,
+	FWUPD_RELEASE_KEY_DETAILS_URL,
+	FWUPD_RELEASE_KEY_SOURCE_URL,
+	FWUPD_RELEASE_KEY_VERSION,
+	FWUPD_RELEASE_KEY_VENDOR,
+	FWUPD_RELEASE_KEY_TRUST_FLAGS,
+	FWUPD_RELEASE_KEY_URGENCY,
+	FWUPD_RELEASE_KEY_INSTALL_DURATION,
+	FWUPD_RELEASE_KEY_UPDATE_MESSAGE,
+	FWUPD_RELEASE_KEY_UPDATE_IMAGE,
+	FWUPD_RELEASE_KEY_METADATA,
+	FWUPD_RELEASE_KEY_LAST
+} FwupdReleaseKey;
+
+static FwupdReleaseKey
+fwupd_release_key_from_string (const gchar *key)
+{
+	static gsize once = 0;
+	static GHashTable *hash = NULL;
+	if (key == NULL)
+		return FWUPD_RELEASE_KEY_UNKNOWN;
+	if (g_once_init_enter (&once)) {
+		const struct {
+			const gchar	*key;
+			FwupdReleaseKey	 id;
+		} map[] = {
+			{ FWUPD_RESULT_KEY_REMOTE_ID, FWUPD_RELEASE_KEY_REMOTE_ID },
+			{ FWUPD_RESULT_KEY_APPSTREAM_ID, FWUPD_RELEASE_KEY_APPSTREAM_ID },
+			{ FWUPD_RESULT_KEY_DETACH_CAPTION, FWUPD_RELEASE_KEY_DETACH_CAPTION },
+			{ FWUPD_RESULT_KEY_DETACH_IMAGE, FWUPD_RELEASE_KEY_DETACH_IMAGE },
+			{ FWUPD_RESULT_KEY_FILENAME, FWUPD_RELEASE_KEY_FILENAME },
+			{ FWUPD_RESULT_KEY_PROTOCOL, FWUPD_RELEASE_KEY_PROTOCOL },
+			{ FWUPD_RESULT_KEY_LICENSE, FWUPD_RELEASE_KEY_LICENSE },
+			{ FWUPD_RESULT_KEY_NAME, FWUPD_RELEASE_KEY_NAME },
+			{ FWUPD_RESULT_KEY_NAME_VARIANT_SUFFIX, FWUPD_RELEASE_KEY_NAME_VARIANT_SUFFIX },
+			{ FWUPD_RESULT_KEY_SIZE, FWUPD_RELEASE_KEY_SIZE },
+			{ FWUPD_RESULT_KEY_CREATED, FWUPD_RELEASE_KEY_CREATED },
+			{ FWUPD_RESULT_KEY_SUMMARY, FWUPD_RELEASE_KEY_SUMMARY },
+			{ FWUPD_RESULT_KEY_BRANCH, FWUPD_RELEASE_KEY_BRANCH },
+			{ FWUPD_RESULT_KEY_DESCRIPTION, FWUPD_RELEASE_KEY_DESCRIPTION },
+			{ FWUPD_RESULT_KEY_CATEGORIES, FWUPD_RELEASE_KEY_CATEGORIES },
+			{ FWUPD_RESULT_KEY_ISSUES, FWUPD_RELEASE_KEY_ISSUES },
+			{ FWUPD_RESULT_KEY_CHECKSUM, FWUPD_RELEASE_KEY_CHECKSUM },
+			{ FWUPD_RESULT_KEY_URI, FWUPD_RELEASE_KEY_URI },
+			{ FWUPD_RESULT_KEY_HOMEPAGE, FWUPD_RELEASE_KEY_HOMEPAGE },
+			{ FWUPD_RESULT_KEY_DETAILS_URL, FWUPD_RELEASE_KEY_DETAILS_URL },
+			{ FWUPD_RESULT_KEY_SOURCE_URL, FWUPD_RELEASE_KEY_SOURCE_URL },
+			{ FWUPD_RESULT_KEY_VERSION, FWUPD_RELEASE_KEY_VERSION },
+			{ FWUPD_RESULT_KEY_VENDOR, FWUPD_RELEASE_KEY_VENDOR },
+			{ FWUPD_RESULT_KEY_TRUST_FLAGS, FWUPD_RELEASE_KEY_TRUST_FLAGS },
+			{ FWUPD_RESULT_KEY_URGENCY, FWUPD_RELEASE_KEY_URGENCY },
+			{ FWUPD_RESULT_KEY_INSTALL_DURATION, FWUPD_RELEASE_KEY_INSTALL_DURATION },
+			{ FWUPD_RESULT_KEY_UPDATE_MESSAGE, FWUPD_RELEASE_KEY_UPDATE_MESSAGE },
+			{ FWUPD_RESULT_KEY_UPDATE_IMAGE, FWUPD_RELEASE_KEY_UPDATE_IMAGE },
+			{ FWUPD_RESULT_KEY_METADATA, FWUPD_RELEASE_KEY_METADATA },
+			{ NULL, FWUPD_RELEASE_KEY_UNKNOWN }
+		};
+		hash = g_hash_table_new (g_str_hash, g_str_equal);
+		for (guint i = 0; map[i].key != NULL; i++) {
+			g_hash_table_insert (hash, (gpointer) map[i].key,
+					     GUINT_TO_POINTER (map[i].id));
+		}
+		g_once_init_leave (&once, 1);
+	}
+	return GPOINTER_TO_UINT (g_hash_table_lookup (hash, key));
+}
+
 static void
 fwupd_release_from_key_value (FwupdRelease *release, const gchar *key, GVariant *value)
 {
 	FwupdReleasePrivate *priv = GET_PRIVATE (release);
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_REMOTE_ID) == 0) {
+	FwupdReleaseKey key_id = fwupd_release_key_from_string (key);
+
+	if (key_id == FWUPD_RELEASE_KEY_REMOTE_ID) {
 		fwupd_release_set_remote_id (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_APPSTREAM_ID) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_APPSTREAM_ID) {
 		fwupd_release_set_appstream_id (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_DETACH_CAPTION) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_DETACH_CAPTION) {
 		fwupd_release_set_detach_caption (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_DETACH_IMAGE) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_DETACH_IMAGE) {
 		fwupd_release_set_detach_image (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_FILENAME) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_FILENAME) {
 		fwupd_release_set_filename (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_PROTOCOL) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_PROTOCOL) {
 		fwupd_release_set_protocol (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_LICENSE) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_LICENSE) {
 		fwupd_release_set_license (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_NAME) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_NAME) {
 		fwupd_release_set_name (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_NAME_VARIANT_SUFFIX) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_NAME_VARIANT_SUFFIX) {
 		fwupd_release_set_name_variant_suffix (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_SIZE) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_SIZE) {
 		fwupd_release_set_size (release, g_variant_get_uint64 (value));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_CREATED) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_CREATED) {
 		fwupd_release_set_created (release, g_variant_get_uint64 (value));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_SUMMARY) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_SUMMARY) {
 		fwupd_release_set_summary (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_BRANCH) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_BRANCH) {
 		fwupd_release_set_branch (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_DESCRIPTION) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_DESCRIPTION) {
 		fwupd_release_set_description (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_CATEGORIES) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_CATEGORIES) {
 		g_autofree const gchar **strv = g_variant_get_strv (value, NULL);
 		for (guint i = 0; strv[i] != NULL; i++)
 			fwupd_release_add_category (release, strv[i]);
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_ISSUES) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_ISSUES) {
 		g_autofree const gchar **strv = g_variant_get_strv (value, NULL);
 		for (guint i = 0; strv[i] != NULL; i++)
 			fwupd_release_add_issue (release, strv[i]);
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_CHECKSUM) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_CHECKSUM) {
 		const gchar *checksums = g_variant_get_string (value, NULL);
 		g_auto(GStrv) split = g_strsplit (checksums, ",", -1);
 		for (guint i = 0; split[i] != NULL; i++)
 			fwupd_release_add_checksum (release, split[i]);
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_URI) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_URI) {
 		fwupd_release_set_uri (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_HOMEPAGE) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_HOMEPAGE) {
 		fwupd_release_set_homepage (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_DETAILS_URL) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_DETAILS_URL) {
 		fwupd_release_set_details_url (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_SOURCE_URL) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_SOURCE_URL) {
 		fwupd_release_set_source_url (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VERSION) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_VERSION) {
 		fwupd_release_set_version (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_VENDOR) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_VENDOR) {
 		fwupd_release_set_vendor (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_TRUST_FLAGS) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_TRUST_FLAGS) {
 		fwupd_release_set_flags (release, g_variant_get_uint64 (value));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_URGENCY) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_URGENCY) {
 		fwupd_release_set_urgency (release, g_variant_get_uint32 (value));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_INSTALL_DURATION) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_INSTALL_DURATION) {
 		fwupd_release_set_install_duration (release, g_variant_get_uint32 (value));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_UPDATE_MESSAGE) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_UPDATE_MESSAGE) {
 		fwupd_release_set_update_message (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_UPDATE_IMAGE) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_UPDATE_IMAGE) {
 		fwupd_release_set_update_image (release, g_variant_get_string (value, NULL));
 		return;
 	}
-	if (g_strcmp0 (key, FWUPD_RESULT_KEY_METADATA) == 0) {
+	if (key_id == FWUPD_RELEASE_KEY_METADATA) {
 		g_hash_table_unref (priv->metadata);
 		priv->metadata = fwupd_variant_to_hash_kv (value);
 		return;
@@ -311,6 +311,94 @@ fwupd_release_func (void)
 	g_assert_cmpstr (fwupd_release_get_metadata_item (release2, "baz"), ==, "bam");
 }
 
+static void
+fwupd_device_variant_cache_func (void)
+{
+	g_autoptr(FwupdDevice) dev = fwupd_device_new ();
+	g_autoptr(GVariant) data1 = NULL;
+	g_autoptr(GVariant) data2 = NULL;
+	g_autoptr(GVariant) data3 = NULL;
+	g_autoptr(GVariant) data4 = NULL;
+	g_autoptr(FwupdDevice) dev2 = NULL;
+
+	fwupd_device_set_id (dev, "USB:foo");
+	fwupd_device_set_name (dev, "ColorHug2");
+	fwupd_device_set_serial (dev, "123456");
+
+	/* unchanged device re-uses the same data */
+	data1 = fwupd_device_to_variant_cached (dev, FWUPD_DEVICE_FLAG_NONE);
+	data2 = fwupd_device_to_variant_cached (dev, FWUPD_DEVICE_FLAG_NONE);
+	g_assert_true (data1 == data2);
+	g_assert_false (g_variant_is_floating (data1));
+
+	/* different flags include the serial number */
+	data3 = fwupd_device_to_variant_cached (dev, FWUPD_DEVICE_FLAG_TRUSTED);
+	g_assert_true (data3 != data1);
+	dev2 = fwupd_device_from_variant (data3);
+	g_assert_cmpstr (fwupd_device_get_serial (dev2), ==, "123456");
+	g_clear_object (&dev2);
+
+	/* modifying the device invalidates it */
+	fwupd_device_set_name (dev, "ColorHug3");
+	data4 = fwupd_device_to_variant_cached (dev, FWUPD_DEVICE_FLAG_TRUSTED);
+	g_assert_true (data4 != data3);
+	dev2 = fwupd_device_from_variant (data4);
+	g_assert_cmpstr (fwupd_device_get_name (dev2), ==, "ColorHug3");
+}
+
+static void
+fwupd_device_variant_performance_func (void)
+{
+	guint loops = g_test_perf () ? 100000 : 1000;
+	g_autoptr(FwupdDevice) dev = fwupd_device_new ();
+	g_autoptr(FwupdRelease) rel = fwupd_release_new ();
+	g_autoptr(GTimer) timer = g_timer_new ();
+	g_autoptr(GVariant) data = NULL;
+
+	/* populate most of the keys so each one is looked up */
+	fwupd_device_set_id (dev, "USB:foo");
+	fwupd_device_set_parent_id (dev, "USB:bar");
+	fwupd_device_set_name (dev, "ColorHug2");
+	fwupd_device_set_vendor (dev, "Hughski");
+	fwupd_device_set_vendor_id (dev, "USB:0x273F");
+	fwupd_device_set_summary (dev, "A colorimeter");
+	fwupd_device_set_plugin (dev, "colorhug");
+	fwupd_device_set_protocol (dev, "com.hughski.colorhug");
+	fwupd_device_set_version (dev, "1.2.3");
+	fwupd_device_set_version_lowest (dev, "1.0.0");
+	fwupd_device_set_version_bootloader (dev, "0.1.2");
+	fwupd_device_set_version_format (dev, FWUPD_VERSION_FORMAT_TRIPLET);
+	fwupd_device_set_flags (dev, FWUPD_DEVICE_FLAG_UPDATABLE);
+	fwupd_device_set_created (dev, 1);
+	fwupd_device_set_modified (dev, 60 * 60 * 24);
+	fwupd_device_set_install_duration (dev, 60);
+	fwupd_device_add_guid (dev, "2082b5e0-7a64-478a-b1b2-e3404fab6dad");
+	fwupd_device_add_icon (dev, "input-gaming");
+	fwupd_device_add_checksum (dev, "beefdead");
+	fwupd_release_set_version (rel, "1.2.4");
+	fwupd_release_set_name (rel, "ColorHug2 Firmware");
+	fwupd_release_set_summary (rel, "Firmware for the ColorHug2");
+	fwupd_release_set_description (rel, "<p>Fixes a bug</p>");
+	fwupd_release_set_vendor (rel, "Hughski");
+	fwupd_release_set_license (rel, "GPL-2.0+");
+	fwupd_release_set_size (rel, 1024);
+	fwupd_release_add_checksum (rel, "deadbeef");
+	fwupd_device_add_release (dev, rel);
+	data = fwupd_device_to_variant (dev);
+	g_variant_ref_sink (data);
+
+	g_timer_reset (timer);
+	for (guint i = 0; i < loops; i++) {
+		g_autoptr(FwupdDevice) dev2 = fwupd_device_from_variant (data);
+		FwupdRelease *rel2 = fwupd_device_get_release_default (dev2);
+		g_assert_cmpstr (fwupd_device_get_version_bootloader (dev2), ==, "0.1.2");
+		g_assert_nonnull (rel2);
+		g_assert_cmpint (fwupd_release_get_size (rel2), ==, 1024);
+	}
+	g_print ("from-variant=%.3fus ",
+		 g_timer_elapsed (timer, NULL) * 1000000.f / loops);
+}
+
 static void
 fwupd_device_func (void)
 {
@@ -672,6 +760,8 @@ main (int argc, char **argv)
 	g_test_add_func ("/fwupd/common{guid}", fwupd_common_guid_func);
 	g_test_add_func ("/fwupd/release", fwupd_release_func);
 	g_test_add_func ("/fwupd/device", fwupd_device_func);
+	g_test_add_func ("/fwupd/device{variant-cache}", fwupd_device_variant_cache_func);
+	g_test_add_func ("/fwupd/device{variant-performance}", fwupd_device_variant_performance_func);
 	g_test_add_func ("/fwupd/remote{download}", fwupd_remote_download_func);
 	g_test_add_func ("/fwupd/remote{base-uri}", fwupd_remote_baseuri_func);
 	g_test_add_func ("/fwupd/remote{no-path}", fwupd_remote_nopath_func);
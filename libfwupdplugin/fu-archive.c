@@ -22,17 +22,121 @@
 
 struct _FuArchive {
 	GObject			 parent_instance;
-	GHashTable		*entries;
+	GHashTable		*entries;		/* fn:FuArchiveEntry */
+	GPtrArray		*entries_idx;		/* (element-type FuArchiveEntry) (nullable) */
+	GBytes			*blob;			/* only set when lazy */
+	struct archive		*arch;			/* positioned at arch_idx */
+	guint			 arch_idx;
+	gboolean		 arch_rewound;
 };
 
+typedef struct {
+	guint			 idx;			/* position in the archive */
+	const gchar		*fn;			/* owned by the hash table */
+	gint64			 size;
+	GBytes			*bytes;			/* (nullable) */
+} FuArchiveEntry;
+
 G_DEFINE_TYPE (FuArchive, fu_archive, G_TYPE_OBJECT)
 
+/* workaround the struct types of libarchive */
+typedef struct archive _archive_read_ctx;
+
+static void
+_archive_read_ctx_free (_archive_read_ctx *arch)
+{
+	archive_read_close (arch);
+	archive_read_free (arch);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(_archive_read_ctx, _archive_read_ctx_free)
+
+#define FU_TYPE_ARCHIVE_STREAM (fu_archive_stream_get_type ())
+G_DECLARE_FINAL_TYPE (FuArchiveStream, fu_archive_stream, FU, ARCHIVE_STREAM, GInputStream)
+
+/* decompresses a single entry as it is read */
+struct _FuArchiveStream {
+	GInputStream		 parent_instance;
+	_archive_read_ctx	*arch;
+	GBytes			*blob;
+};
+
+G_DEFINE_TYPE (FuArchiveStream, fu_archive_stream, G_TYPE_INPUT_STREAM)
+
+static gssize
+fu_archive_stream_read (GInputStream *stream,
+			void *buffer,
+			gsize count,
+			GCancellable *cancellable,
+			GError **error)
+{
+	FuArchiveStream *self = FU_ARCHIVE_STREAM (stream);
+	gssize rc = archive_read_data (self->arch, buffer, count);
+	if (rc < 0) {
+		g_set_error (error,
+			     G_IO_ERROR,
+			     G_IO_ERROR_FAILED,
+			     "cannot read data: %s",
+			     archive_error_string (self->arch));
+		return -1;
+	}
+	return rc;
+}
+
+static gboolean
+fu_archive_stream_close (GInputStream *stream,
+			 GCancellable *cancellable,
+			 GError **error)
+{
+	FuArchiveStream *self = FU_ARCHIVE_STREAM (stream);
+	g_clear_pointer (&self->arch, _archive_read_ctx_free);
+	return TRUE;
+}
+
+static void
+fu_archive_stream_finalize (GObject *obj)
+{
+	FuArchiveStream *self = FU_ARCHIVE_STREAM (obj);
+	if (self->arch != NULL)
+		_archive_read_ctx_free (self->arch);
+	g_bytes_unref (self->blob);
+	G_OBJECT_CLASS (fu_archive_stream_parent_class)->finalize (obj);
+}
+
+static void
+fu_archive_stream_class_init (FuArchiveStreamClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	GInputStreamClass *stream_class = G_INPUT_STREAM_CLASS (klass);
+	stream_class->read_fn = fu_archive_stream_read;
+	stream_class->close_fn = fu_archive_stream_close;
+	object_class->finalize = fu_archive_stream_finalize;
+}
+
+static void
+fu_archive_stream_init (FuArchiveStream *self)
+{
+}
+
+static void
+fu_archive_entry_free (FuArchiveEntry *entry)
+{
+	if (entry->bytes != NULL)
+		g_bytes_unref (entry->bytes);
+	g_free (entry);
+}
+
 static void
 fu_archive_finalize (GObject *obj)
 {
 	FuArchive *self = FU_ARCHIVE (obj);
 
 	g_hash_table_unref (self->entries);
+	g_ptr_array_unref (self->entries_idx);
+	if (self->arch != NULL)
+		_archive_read_ctx_free (self->arch);
+	if (self->blob != NULL)
+		g_bytes_unref (self->blob);
 	G_OBJECT_CLASS (fu_archive_parent_class)->finalize (obj);
 }
 
@@ -47,7 +151,171 @@ static void
 fu_archive_init (FuArchive *self)
 {
 	self->entries = g_hash_table_new_full (g_str_hash, g_str_equal,
-					       g_free, (GDestroyNotify) g_bytes_unref);
+					       g_free, (GDestroyNotify) fu_archive_entry_free);
+	self->entries_idx = g_ptr_array_new ();
+}
+
+static _archive_read_ctx *
+fu_archive_open (GBytes *blob, GError **error)
+{
+	int r;
+	g_autoptr(_archive_read_ctx) arch = NULL;
+
+	arch = archive_read_new ();
+	if (arch == NULL) {
+		g_set_error_literal (error,
+				     G_IO_ERROR,
+				     G_IO_ERROR_NOT_SUPPORTED,
+				     "libarchive startup failed");
+		return NULL;
+	}
+	archive_read_support_format_all (arch);
+	archive_read_support_filter_all (arch);
+	r = archive_read_open_memory (arch,
+				      (void *) g_bytes_get_data (blob, NULL),
+				      (size_t) g_bytes_get_size (blob));
+	if (r != 0) {
+		g_set_error (error,
+			     G_IO_ERROR,
+			     G_IO_ERROR_NOT_SUPPORTED,
+			     "cannot open: %s",
+			     archive_error_string (arch));
+		return NULL;
+	}
+	return g_steal_pointer (&arch);
+}
+
+static gboolean
+fu_archive_read_next_header (_archive_read_ctx *arch,
+			     struct archive_entry **entry,
+			     gboolean *eof,
+			     GError **error)
+{
+	int r = archive_read_next_header (arch, entry);
+	if (r == ARCHIVE_EOF) {
+		*eof = TRUE;
+		return TRUE;
+	}
+	if (r != ARCHIVE_OK) {
+		g_set_error (error,
+			     G_IO_ERROR,
+			     G_IO_ERROR_FAILED,
+			     "cannot read header: %s",
+			     archive_error_string (arch));
+		return FALSE;
+	}
+	*eof = FALSE;
+	return TRUE;
+}
+
+/* returns an archive positioned at the start of the data for @entry; libarchive
+ * skips the data of any earlier entries without allocating */
+static _archive_read_ctx *
+fu_archive_open_entry (FuArchive *self, FuArchiveEntry *entry, GError **error)
+{
+	g_autoptr(_archive_read_ctx) arch = fu_archive_open (self->blob, error);
+	if (arch == NULL)
+		return NULL;
+	for (guint i = 0; i <= entry->idx; i++) {
+		gboolean eof = FALSE;
+		struct archive_entry *entry_tmp = NULL;
+		if (!fu_archive_read_next_header (arch, &entry_tmp, &eof, error))
+			return NULL;
+		if (eof) {
+			g_set_error_literal (error,
+					     G_IO_ERROR,
+					     G_IO_ERROR_FAILED,
+					     "archive truncated");
+			return NULL;
+		}
+	}
+	return g_steal_pointer (&arch);
+}
+
+static GBytes *
+fu_archive_read_data (_archive_read_ctx *arch, gint64 bufsz, GError **error)
+{
+	gssize rc;
+	g_autofree guint8 *buf = g_malloc (bufsz);
+
+	rc = archive_read_data (arch, buf, (gsize) bufsz);
+	if (rc < 0) {
+		g_set_error (error,
+			     G_IO_ERROR,
+			     G_IO_ERROR_FAILED,
+			     "cannot read data: %s",
+			     archive_error_string (arch));
+		return NULL;
+	}
+	if (rc != bufsz) {
+		g_set_error (error,
+			     G_IO_ERROR,
+			     G_IO_ERROR_FAILED,
+			     "read %" G_GSSIZE_FORMAT " of %" G_GINT64_FORMAT,
+			     rc, bufsz);
+		return NULL;
+	}
+	return g_bytes_new_take (g_steal_pointer (&buf), bufsz);
+}
+
+static gboolean
+fu_archive_seek_entry (FuArchive *self, FuArchiveEntry *entry, GError **error)
+{
+	/* the archive can only be read forwards, so start again at the top --
+	 * the caller is not reading in order so keep everything that gets
+	 * decompressed on the way to avoid reading the archive each time */
+	if (self->arch == NULL || entry->idx < self->arch_idx) {
+		if (self->arch != NULL) {
+			self->arch_rewound = TRUE;
+			g_clear_pointer (&self->arch, _archive_read_ctx_free);
+		}
+		self->arch = fu_archive_open (self->blob, error);
+		if (self->arch == NULL)
+			return FALSE;
+		self->arch_idx = 0;
+	}
+	while (self->arch_idx <= entry->idx) {
+		FuArchiveEntry *entry_tmp;
+		gboolean eof = FALSE;
+		struct archive_entry *entry_hdr = NULL;
+
+		if (!fu_archive_read_next_header (self->arch, &entry_hdr, &eof, error))
+			return FALSE;
+		if (eof) {
+			g_set_error_literal (error,
+					     G_IO_ERROR,
+					     G_IO_ERROR_FAILED,
+					     "archive truncated");
+			return FALSE;
+		}
+		entry_tmp = g_ptr_array_index (self->entries_idx, self->arch_idx++);
+		if (entry_tmp == entry)
+			break;
+		if (self->arch_rewound && entry_tmp != NULL && entry_tmp->bytes == NULL) {
+			entry_tmp->bytes = fu_archive_read_data (self->arch, entry_tmp->size, error);
+			if (entry_tmp->bytes == NULL)
+				return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+static GBytes *
+fu_archive_entry_ensure_bytes (FuArchive *self, FuArchiveEntry *entry, GError **error)
+{
+	/* already decompressed */
+	if (entry->bytes != NULL)
+		return entry->bytes;
+
+	/* reuse the archive from the last lookup if it has not gone past */
+	if (!fu_archive_seek_entry (self, entry, error)) {
+		g_clear_pointer (&self->arch, _archive_read_ctx_free);
+		return NULL;
+	}
+	entry->bytes = fu_archive_read_data (self->arch, entry->size, error);
+	if (entry->bytes == NULL)
+		g_clear_pointer (&self->arch, _archive_read_ctx_free);
+	return entry->bytes;
 }
 
 /**
@@ -58,6 +326,10 @@ fu_archive_init (FuArchive *self)
  *
  * Finds the blob referenced by filename
  *
+ * When using %FU_ARCHIVE_FLAG_LAZY the file is decompressed the first time it
+ * is looked up, and then kept until @self is destroyed. If files are looked
+ * up out of archive order then every file read on the way is also kept.
+ *
  * Returns: (transfer none): a #GBytes, or %NULL if the filename was not found
  *
  * Since: 1.2.2
@@ -65,20 +337,66 @@ fu_archive_init (FuArchive *self)
 GBytes *
 fu_archive_lookup_by_fn (FuArchive *self, const gchar *fn, GError **error)
 {
-	GBytes *fw;
+	FuArchiveEntry *entry;
 
 	g_return_val_if_fail (FU_IS_ARCHIVE (self), NULL);
 	g_return_val_if_fail (fn != NULL, NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	fw = g_hash_table_lookup (self->entries, fn);
-	if (fw == NULL) {
+	entry = g_hash_table_lookup (self->entries, fn);
+	if (entry == NULL) {
 		g_set_error (error,
 			     G_IO_ERROR,
 			     G_IO_ERROR_NOT_FOUND,
 			     "no blob for %s", fn);
+		return NULL;
 	}
-	return fw;
+	return fu_archive_entry_ensure_bytes (self, entry, error);
+}
+
+/**
+ * fu_archive_get_stream:
+ * @self: A #FuArchive
+ * @fn: A filename
+ * @error: A #GError, or %NULL
+ *
+ * Gets a stream that decompresses the file referenced by filename as it is
+ * read. When using %FU_ARCHIVE_FLAG_LAZY nothing is cached, which makes this
+ * suitable for large payloads.
+ *
+ * Returns: (transfer full): a #GInputStream, or %NULL if the filename was not found
+ *
+ * Since: 1.5.2
+ **/
+GInputStream *
+fu_archive_get_stream (FuArchive *self, const gchar *fn, GError **error)
+{
+	FuArchiveEntry *entry;
+	FuArchiveStream *stream;
+	_archive_read_ctx *arch;
+
+	g_return_val_if_fail (FU_IS_ARCHIVE (self), NULL);
+	g_return_val_if_fail (fn != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	entry = g_hash_table_lookup (self->entries, fn);
+	if (entry == NULL) {
+		g_set_error (error,
+			     G_IO_ERROR,
+			     G_IO_ERROR_NOT_FOUND,
+			     "no blob for %s", fn);
+		return NULL;
+	}
+	if (entry->bytes != NULL)
+		return g_memory_input_stream_new_from_bytes (entry->bytes);
+
+	arch = fu_archive_open_entry (self, entry, error);
+	if (arch == NULL)
+		return NULL;
+	stream = g_object_new (FU_TYPE_ARCHIVE_STREAM, NULL);
+	stream->arch = arch;
+	stream->blob = g_bytes_ref (self->blob);
+	return G_INPUT_STREAM (stream);
 }
 
 /**
@@ -103,83 +421,85 @@ fu_archive_iterate (FuArchive *self,
 {
 	GHashTableIter iter;
 	gpointer key, value;
+	g_autoptr(_archive_read_ctx) arch = NULL;
 
 	g_return_val_if_fail (FU_IS_ARCHIVE (self), FALSE);
 	g_return_val_if_fail (callback != NULL, FALSE);
 
-	g_hash_table_iter_init (&iter, self->entries);
-	while (g_hash_table_iter_next (&iter, &key, &value)) {
-		if (!callback (self, (const gchar *)key, (GBytes *)value, user_data, error))
-			return FALSE;
+	/* everything is already in memory */
+	if (self->blob == NULL) {
+		g_hash_table_iter_init (&iter, self->entries);
+		while (g_hash_table_iter_next (&iter, &key, &value)) {
+			FuArchiveEntry *entry = (FuArchiveEntry *) value;
+			if (!callback (self, (const gchar *)key, entry->bytes, user_data, error))
+				return FALSE;
+		}
+		return TRUE;
 	}
-	return TRUE;
-}
 
-/* workaround the struct types of libarchive */
-typedef struct archive _archive_read_ctx;
+	/* decompress each file in a single pass without keeping the data */
+	arch = fu_archive_open (self->blob, error);
+	if (arch == NULL)
+		return FALSE;
+	for (guint i = 0; i < self->entries_idx->len; i++) {
+		FuArchiveEntry *entry;
+		gboolean eof = FALSE;
+		struct archive_entry *entry_tmp = NULL;
+		g_autoptr(GBytes) bytes = NULL;
 
-static void
-_archive_read_ctx_free (_archive_read_ctx *arch)
-{
-	archive_read_close (arch);
-	archive_read_free (arch);
-}
+		if (!fu_archive_read_next_header (arch, &entry_tmp, &eof, error))
+			return FALSE;
+		if (eof)
+			break;
 
-G_DEFINE_AUTOPTR_CLEANUP_FUNC(_archive_read_ctx, _archive_read_ctx_free)
+		/* not valid, or replaced by a later file of the same name */
+		entry = g_ptr_array_index (self->entries_idx, i);
+		if (entry == NULL)
+			continue;
+		if (entry->bytes != NULL) {
+			bytes = g_bytes_ref (entry->bytes);
+		} else {
+			bytes = fu_archive_read_data (arch, entry->size, error);
+			if (bytes == NULL)
+				return FALSE;
+		}
+		if (!callback (self, entry->fn, bytes, user_data, error))
+			return FALSE;
+	}
+	return TRUE;
+}
 
 static gboolean
 fu_archive_load (FuArchive *self, GBytes *blob, FuArchiveFlags flags, GError **error)
 {
-	int r;
 	g_autoptr(_archive_read_ctx) arch = NULL;
 
 	/* decompress anything matching either glob */
-	arch = archive_read_new ();
-	if (arch == NULL) {
-		g_set_error_literal (error,
-				     G_IO_ERROR,
-				     G_IO_ERROR_NOT_SUPPORTED,
-				     "libarchive startup failed");
-		return FALSE;
-	}
-	archive_read_support_format_all (arch);
-	archive_read_support_filter_all (arch);
-	r = archive_read_open_memory (arch,
-				      (void *) g_bytes_get_data (blob, NULL),
-				      (size_t) g_bytes_get_size (blob));
-	if (r != 0) {
-		g_set_error (error,
-			     G_IO_ERROR,
-			     G_IO_ERROR_NOT_SUPPORTED,
-			     "cannot open: %s",
-			     archive_error_string (arch));
+	arch = fu_archive_open (blob, error);
+	if (arch == NULL)
 		return FALSE;
-	}
-	while (TRUE) {
+	if (flags & FU_ARCHIVE_FLAG_LAZY)
+		self->blob = g_bytes_ref (blob);
+	for (guint i = 0; ; i++) {
 		const gchar *fn;
+		gboolean eof = FALSE;
 		gint64 bufsz;
-		gssize rc;
-		struct archive_entry *entry;
+		struct archive_entry *entry_tmp = NULL;
 		g_autofree gchar *fn_key = NULL;
-		g_autofree guint8 *buf = NULL;
+		FuArchiveEntry *entry;
+		FuArchiveEntry *entry_old;
 
-		r = archive_read_next_header (arch, &entry);
-		if (r == ARCHIVE_EOF)
-			break;
-		if (r != ARCHIVE_OK) {
-			g_set_error (error,
-				     G_IO_ERROR,
-				     G_IO_ERROR_FAILED,
-				     "cannot read header: %s",
-				     archive_error_string (arch));
+		if (!fu_archive_read_next_header (arch, &entry_tmp, &eof, error))
 			return FALSE;
-		}
+		if (eof)
+			break;
+		g_ptr_array_add (self->entries_idx, NULL);
 
 		/* only extract if valid */
-		fn = archive_entry_pathname (entry);
+		fn = archive_entry_pathname (entry_tmp);
 		if (fn == NULL)
 			continue;
-		bufsz = archive_entry_size (entry);
+		bufsz = archive_entry_size (entry_tmp);
 		if (bufsz > 1024 * 1024 * 1024) {
 			g_set_error_literal (error,
 					     G_IO_ERROR,
@@ -187,23 +507,17 @@ fu_archive_load (FuArchive *self, GBytes *blob, FuArchiveFlags flags, GError **e
 					     "cannot read huge files");
 			return FALSE;
 		}
-		buf = g_malloc (bufsz);
-		rc = archive_read_data (arch, buf, (gsize) bufsz);
-		if (rc < 0) {
-			g_set_error (error,
-				     G_IO_ERROR,
-				     G_IO_ERROR_FAILED,
-				     "cannot read data: %s",
-				     archive_error_string (arch));
-			return FALSE;
-		}
-		if (rc != bufsz) {
-			g_set_error (error,
-				     G_IO_ERROR,
-				     G_IO_ERROR_FAILED,
-				     "read %" G_GSSIZE_FORMAT " of %" G_GINT64_FORMAT,
-				     rc, bufsz);
-			return FALSE;
+		entry = g_new0 (FuArchiveEntry, 1);
+		entry->idx = i;
+		entry->size = bufsz;
+
+		/* when lazy, only the header is read here */
+		if ((flags & FU_ARCHIVE_FLAG_LAZY) == 0) {
+			entry->bytes = fu_archive_read_data (arch, bufsz, error);
+			if (entry->bytes == NULL) {
+				fu_archive_entry_free (entry);
+				return FALSE;
+			}
 		}
 		if (flags & FU_ARCHIVE_FLAG_IGNORE_PATH) {
 			fn_key = g_path_get_basename (fn);
@@ -211,9 +525,12 @@ fu_archive_load (FuArchive *self, GBytes *blob, FuArchiveFlags flags, GError **e
 			fn_key = g_strdup (fn);
 		}
 		g_debug ("adding %s [%" G_GINT64_FORMAT "]", fn_key, bufsz);
-		g_hash_table_insert (self->entries,
-				     g_steal_pointer (&fn_key),
-				     g_bytes_new_take (g_steal_pointer (&buf), bufsz));
+		entry_old = g_hash_table_lookup (self->entries, fn_key);
+		if (entry_old != NULL)
+			g_ptr_array_index (self->entries_idx, entry_old->idx) = NULL;
+		g_ptr_array_index (self->entries_idx, i) = entry;
+		entry->fn = fn_key;
+		g_hash_table_replace (self->entries, g_steal_pointer (&fn_key), entry);
 	}
 
 	/* success */
@@ -228,6 +545,9 @@ fu_archive_load (FuArchive *self, GBytes *blob, FuArchiveFlags flags, GError **e
  *
  * Parses @data as an archive and decompresses all files to memory blobs.
  *
+ * If %FU_ARCHIVE_FLAG_LAZY is set then only the file headers are parsed, and
+ * each file is decompressed when it is looked up or iterated.
+ *
  * Returns: a #FuArchive, or %NULL if the archive was invalid in any way.
  *
  * Since: 1.2.2
@@ -6,7 +6,7 @@
 
 #pragma once
 
-#include <glib-object.h>
+#include <gio/gio.h>
 
 #define FU_TYPE_ARCHIVE (fu_archive_get_type ())
 
@@ -16,12 +16,14 @@ G_DECLARE_FINAL_TYPE (FuArchive, fu_archive, FU, ARCHIVE, GObject)
  * FuArchiveFlags:
  * @FU_ARCHIVE_FLAG_NONE:		No flags set
  * @FU_ARCHIVE_FLAG_IGNORE_PATH:	Ignore any path component
+ * @FU_ARCHIVE_FLAG_LAZY:		Only decompress files when required
  *
  * The flags to use when loading the archive.
  **/
 typedef enum {
 	FU_ARCHIVE_FLAG_NONE		= 0,
 	FU_ARCHIVE_FLAG_IGNORE_PATH	= 1 << 0,
+	FU_ARCHIVE_FLAG_LAZY		= 1 << 1,
 	/*< private >*/
 	FU_ARCHIVE_FLAG_LAST
 } FuArchiveFlags;
@@ -47,6 +49,9 @@ FuArchive	*fu_archive_new			(GBytes		*data,
 GBytes		*fu_archive_lookup_by_fn	(FuArchive	*self,
 						 const gchar	*fn,
 						 GError		**error);
+GInputStream	*fu_archive_get_stream		(FuArchive	*self,
+						 const gchar	*fn,
+						 GError		**error);
 gboolean	 fu_archive_iterate		(FuArchive		*self,
 						 FuArchiveIterateFunc	callback,
 						 gpointer		user_data,
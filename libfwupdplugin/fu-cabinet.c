@@ -14,6 +14,7 @@
 #include "fu-cabinet.h"
 #include "fu-common.h"
 
+#include "fwupd-common.h"
 #include "fwupd-enums.h"
 #include "fwupd-error.h"
 
@@ -203,8 +204,9 @@ fu_cabinet_parse_release (FuCabinet *self, XbNode *release, GError **error)
 
 	/* set if unspecified, but error out if specified and incorrect */
 	if (csum_tmp != NULL && xb_node_get_text (csum_tmp) != NULL) {
+		GChecksumType kind = fwupd_checksum_guess_kind (xb_node_get_text (csum_tmp));
 		g_autofree gchar *checksum = NULL;
-		checksum = g_compute_checksum_for_bytes (G_CHECKSUM_SHA1, blob);
+		checksum = g_compute_checksum_for_bytes (kind, blob);
 		if (g_strcmp0 (checksum, xb_node_get_text (csum_tmp)) != 0) {
 			g_set_error (error,
 				     FWUPD_ERROR,
@@ -332,7 +334,7 @@ fu_cabinet_set_container_checksum_cb (XbBuilderFixup *builder_fixup,
 
 	/* verify it exists */
 	csum = _xb_builder_node_get_child_by_element_attr (bn, "checksum",
-							   "type", "container");
+							   "target", "container");
 	if (csum == NULL) {
 		csum = xb_builder_node_insert (bn, "checksum",
 					       "target", "container",
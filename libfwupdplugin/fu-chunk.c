@@ -125,64 +125,21 @@ fu_chunk_array_new (const guint8 *data,
 		    guint32 page_sz,
 		    guint32 packet_sz)
 {
+	FuChunk chk;
+	FuChunkIter iter;
 	GPtrArray *segments = NULL;
-	guint32 page_old = G_MAXUINT32;
-	guint32 idx;
-	guint32 last_flush = 0;
 
 	g_return_val_if_fail (data_sz > 0, NULL);
 
 	segments = g_ptr_array_new_with_free_func (g_free);
-	for (idx = 1; idx < data_sz; idx++) {
-		guint32 page = 0;
-		if (page_sz > 0)
-			page = (addr_start + idx) / page_sz;
-		if (page_old == G_MAXUINT32) {
-			page_old = page;
-		} else if (page != page_old) {
-			const guint8 *data_offset = data != NULL ? data + last_flush : 0x0;
-			guint32 address_offset = addr_start + last_flush;
-			if (page_sz > 0)
-				address_offset %= page_sz;
-			g_ptr_array_add (segments,
-					 fu_chunk_new (segments->len,
-						       page_old,
-						       address_offset,
-						       data_offset,
-						       idx - last_flush));
-			last_flush = idx;
-			page_old = page;
-			continue;
-		}
-		if (packet_sz > 0 && idx - last_flush >= packet_sz) {
-			const guint8 *data_offset = data != NULL ? data + last_flush : 0x0;
-			guint32 address_offset = addr_start + last_flush;
-			if (page_sz > 0)
-				address_offset %= page_sz;
-			g_ptr_array_add (segments,
-					 fu_chunk_new (segments->len,
-						       page,
-						       address_offset,
-						       data_offset,
-						       idx - last_flush));
-			last_flush = idx;
-			continue;
-		}
-	}
-	if (last_flush != idx) {
-		const guint8 *data_offset = data != NULL ? data + last_flush : 0x0;
-		guint32 address_offset = addr_start + last_flush;
-		guint32 page = 0;
-		if (page_sz > 0) {
-			address_offset %= page_sz;
-			page = (addr_start + (idx - 1)) / page_sz;
-		}
+	fu_chunk_iter_init (&iter, data, data_sz, addr_start, page_sz, packet_sz);
+	while (fu_chunk_iter_next (&iter, &chk)) {
 		g_ptr_array_add (segments,
-				 fu_chunk_new (segments->len,
-					       page,
-					       address_offset,
-					       data_offset,
-					       data_sz - last_flush));
+				 fu_chunk_new (chk.idx,
+					       chk.page,
+					       chk.address,
+					       chk.data,
+					       chk.data_sz));
 	}
 	return segments;
 }
@@ -212,3 +169,156 @@ fu_chunk_array_new_from_bytes (GBytes *blob,
 	return fu_chunk_array_new (data, (guint32) sz,
 				   addr_start, page_sz, packet_sz);
 }
+
+/**
+ * fu_chunk_iter_init:
+ * @iter: an uninitialized #FuChunkIter, typically on the stack
+ * @data: (nullable): a linear blob of memory
+ * @data_sz: size of @data
+ * @addr_start: the hardware address offset, or 0
+ * @page_sz: the hardware page size, or 0
+ * @packet_sz: the transfer size, or 0
+ *
+ * Initializes an iterator that yields the same chunks as fu_chunk_array_new()
+ * without allocating any memory or copying @data, which must remain valid
+ * while the iterator is being used.
+ *
+ * Since: 1.5.2
+ **/
+void
+fu_chunk_iter_init (FuChunkIter *iter,
+		    const guint8 *data,
+		    guint32 data_sz,
+		    guint32 addr_start,
+		    guint32 page_sz,
+		    guint32 packet_sz)
+{
+	g_return_if_fail (iter != NULL);
+	iter->data = data;
+	iter->data_sz = data_sz;
+	iter->addr_start = addr_start;
+	iter->page_sz = page_sz;
+	iter->packet_sz = packet_sz;
+	iter->offset = 0;
+	iter->idx = 0;
+}
+
+/**
+ * fu_chunk_iter_init_from_bytes:
+ * @iter: an uninitialized #FuChunkIter, typically on the stack
+ * @blob: a #GBytes
+ * @addr_start: the hardware address offset, or 0
+ * @page_sz: the hardware page size, or 0
+ * @packet_sz: the transfer size, or 0
+ *
+ * Initializes an iterator over the contents of @blob, which must not be
+ * unreferenced while the iterator is being used.
+ *
+ * Since: 1.5.2
+ **/
+void
+fu_chunk_iter_init_from_bytes (FuChunkIter *iter,
+			       GBytes *blob,
+			       guint32 addr_start,
+			       guint32 page_sz,
+			       guint32 packet_sz)
+{
+	gsize sz;
+	const guint8 *data = g_bytes_get_data (blob, &sz);
+	fu_chunk_iter_init (iter, data, (guint32) sz, addr_start, page_sz, packet_sz);
+}
+
+static guint32
+fu_chunk_iter_get_page (FuChunkIter *iter, guint32 offset)
+{
+	if (iter->page_sz == 0)
+		return 0;
+	return (guint32) (((guint64) iter->addr_start + offset) / iter->page_sz);
+}
+
+/**
+ * fu_chunk_iter_next:
+ * @iter: a #FuChunkIter
+ * @chk: (out caller-allocates): a #FuChunk to fill in
+ *
+ * Gets the next chunk. The boundaries are calculated directly, so this is
+ * proportional to the number of chunks rather than the size of the data.
+ *
+ * Returns: %FALSE if there are no more chunks
+ *
+ * Since: 1.5.2
+ **/
+gboolean
+fu_chunk_iter_next (FuChunkIter *iter, FuChunk *chk)
+{
+	guint64 end = iter->data_sz;
+	guint32 page_offset;
+
+	g_return_val_if_fail (iter != NULL, FALSE);
+	g_return_val_if_fail (chk != NULL, FALSE);
+
+	/* finished */
+	if (iter->offset >= iter->data_sz)
+		return FALSE;
+
+	/* split at the next page boundary; like fu_chunk_array_new() the
+	 * boundary is only checked from the second byte onwards */
+	if (iter->page_sz > 0) {
+		guint64 rem = ((guint64) iter->addr_start + iter->offset + 1) % iter->page_sz;
+		guint64 tmp = (guint64) iter->offset + 1;
+		if (rem != 0)
+			tmp += iter->page_sz - rem;
+		if (tmp < 2)
+			tmp += iter->page_sz;
+		if (tmp < iter->data_sz)
+			end = tmp;
+	}
+
+	/* split at the packet size if sooner */
+	if (iter->packet_sz > 0) {
+		guint64 tmp = (guint64) iter->offset + iter->packet_sz;
+		if (tmp < iter->data_sz && tmp < end)
+			end = tmp;
+	}
+
+	/* the page of the last byte, but never the first byte of the data
+	 * unless this is the only chunk */
+	page_offset = (guint32) end - 1;
+	if (page_offset == 0 && end != iter->data_sz)
+		page_offset = 1;
+
+	chk->idx = iter->idx++;
+	chk->page = fu_chunk_iter_get_page (iter, page_offset);
+	chk->address = iter->addr_start + iter->offset;
+	if (iter->page_sz > 0)
+		chk->address %= iter->page_sz;
+	chk->data = iter->data != NULL ? iter->data + iter->offset : NULL;
+	chk->data_sz = (guint32) end - iter->offset;
+	iter->offset = (guint32) end;
+	return TRUE;
+}
+
+/**
+ * fu_chunk_iter_get_count:
+ * @iter: a #FuChunkIter
+ *
+ * Gets the total number of chunks the iterator yields, which is useful for
+ * reporting progress. The iterator position is not changed.
+ *
+ * Returns: integer
+ *
+ * Since: 1.5.2
+ **/
+guint
+fu_chunk_iter_get_count (FuChunkIter *iter)
+{
+	FuChunk chk;
+	FuChunkIter iter_tmp;
+
+	g_return_val_if_fail (iter != NULL, 0);
+
+	fu_chunk_iter_init (&iter_tmp, iter->data, iter->data_sz,
+			    iter->addr_start, iter->page_sz, iter->packet_sz);
+	while (fu_chunk_iter_next (&iter_tmp, &chk)) {}
+	return iter_tmp.idx;
+}
@@ -17,6 +17,17 @@ typedef struct {
 	guint32		 data_sz;
 } FuChunk;
 
+typedef struct {
+	/*< private >*/
+	const guint8	*data;
+	guint32		 data_sz;
+	guint32		 addr_start;
+	guint32		 page_sz;
+	guint32		 packet_sz;
+	guint32		 offset;
+	guint32		 idx;
+} FuChunkIter;
+
 FuChunk		*fu_chunk_new				(guint32	 idx,
 							 guint32	 page,
 							 guint32	 address,
@@ -34,3 +45,18 @@ GPtrArray	*fu_chunk_array_new_from_bytes		(GBytes		*blob,
 							 guint32	 addr_start,
 							 guint32	 page_sz,
 							 guint32	 packet_sz);
+
+void		 fu_chunk_iter_init			(FuChunkIter	*iter,
+							 const guint8	*data,
+							 guint32	 data_sz,
+							 guint32	 addr_start,
+							 guint32	 page_sz,
+							 guint32	 packet_sz);
+void		 fu_chunk_iter_init_from_bytes		(FuChunkIter	*iter,
+							 GBytes		*blob,
+							 guint32	 addr_start,
+							 guint32	 page_sz,
+							 guint32	 packet_sz);
+gboolean	 fu_chunk_iter_next			(FuChunkIter	*iter,
+							 FuChunk	*chk);
+guint		 fu_chunk_iter_get_count		(FuChunkIter	*iter);
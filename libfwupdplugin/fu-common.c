@@ -10,6 +10,9 @@
 
 #ifdef HAVE_GIO_UNIX
 #include <gio/gunixinputstream.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 #include <glib/gstdio.h>
 
@@ -23,6 +26,11 @@
 #include <cpuid.h>
 #endif
 
+#ifdef HAVE_ARM_CRC32
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#endif
+
 #include <archive_entry.h>
 #include <archive.h>
 #include <errno.h>
@@ -231,6 +239,42 @@ fu_common_get_contents_bytes (const gchar *filename, GError **error)
 	return g_bytes_new_take (data, len);
 }
 
+#ifdef HAVE_GIO_UNIX
+/* map a memfd that the sender has sealed against any further modification,
+ * so that the contents cannot change after being verified and cannot shrink
+ * to cause SIGBUS -- otherwise return %NULL to read the fd normally */
+static GBytes *
+fu_common_get_contents_fd_sealed (gint fd, gsize count)
+{
+#ifdef F_GET_SEALS
+	gint seals;
+	struct stat st;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GMappedFile) mapped_file = NULL;
+
+	seals = fcntl (fd, F_GET_SEALS);
+	if (seals < 0)
+		return NULL;
+	if ((seals & (F_SEAL_SHRINK | F_SEAL_WRITE)) != (F_SEAL_SHRINK | F_SEAL_WRITE))
+		return NULL;
+	if (fstat (fd, &st) < 0 || !S_ISREG (st.st_mode))
+		return NULL;
+	if (st.st_size == 0 || (guint64) st.st_size > count)
+		return NULL;
+	if (lseek (fd, 0, SEEK_CUR) != 0)
+		return NULL;
+	mapped_file = g_mapped_file_new_from_fd (fd, FALSE, &error_local);
+	if (mapped_file == NULL) {
+		g_debug ("failed to map sealed fd: %s", error_local->message);
+		return NULL;
+	}
+	return g_mapped_file_get_bytes (mapped_file);
+#else
+	return NULL;
+#endif
+}
+#endif
+
 /**
  * fu_common_get_contents_fd:
  * @fd: A file descriptor
@@ -239,6 +283,9 @@ fu_common_get_contents_bytes (const gchar *filename, GError **error)
  *
  * Reads a blob from a specific file descriptor.
  *
+ * If @fd is a memfd sealed with `F_SEAL_SHRINK` and `F_SEAL_WRITE` then the
+ * contents are mapped rather than copied into memory.
+ *
  * Note: this will close the fd when done
  *
  * Returns: (transfer full): a #GBytes, or %NULL
@@ -265,6 +312,15 @@ fu_common_get_contents_fd (gint fd, gsize count, GError **error)
 		return NULL;
 	}
 
+	/* use the pages of the sealed memfd directly */
+	blob = fu_common_get_contents_fd_sealed (fd, count);
+	if (blob != NULL) {
+		g_debug ("mapped sealed fd with %" G_GSIZE_FORMAT " bytes",
+			 g_bytes_get_size (blob));
+		close (fd);
+		return g_steal_pointer (&blob);
+	}
+
 	/* read the entire fd to a data blob */
 	stream = g_unix_input_stream_new (fd, TRUE);
 	blob = g_input_stream_read_bytes (stream, count, NULL, &error_local);
@@ -2463,6 +2519,138 @@ fu_common_get_esp_for_path (const gchar *esp_path, GError **error)
 	return NULL;
 }
 
+/* each table k has the CRC of byte i followed by k zero bytes, which allows
+ * processing eight bytes at a time ("slicing-by-8") */
+#define FU_COMMON_CRC_SLICES		8
+
+static guint8 fu_common_crc8_tbl[FU_COMMON_CRC_SLICES][256];
+static guint16 fu_common_crc16_tbl[FU_COMMON_CRC_SLICES][256];
+
+typedef struct {
+	guint32		 polynomial;
+	guint32		 tbl[FU_COMMON_CRC_SLICES][256];
+} FuCommonCrc32Table;
+
+/* tables are never freed, and there are only ever one or two polynomials */
+#define FU_COMMON_CRC32_TABLES_MAX	4
+static FuCommonCrc32Table *fu_common_crc32_tables[FU_COMMON_CRC32_TABLES_MAX] = { NULL };
+G_LOCK_DEFINE_STATIC (fu_common_crc32_tables);
+
+static void
+fu_common_crc8_ensure_tables (void)
+{
+	static gsize once = 0;
+	if (!g_once_init_enter (&once))
+		return;
+	for (guint32 i = 0; i < 256; i++) {
+		guint32 crc = i << 8;
+		for (guint32 j = 8; j; j--) {
+			if (crc & 0x8000)
+				crc ^= (0x1070 << 3);
+			crc <<= 1;
+		}
+		fu_common_crc8_tbl[0][i] = (guint8) (crc >> 8);
+	}
+	for (guint k = 1; k < FU_COMMON_CRC_SLICES; k++) {
+		for (guint32 i = 0; i < 256; i++) {
+			guint8 crc = fu_common_crc8_tbl[k - 1][i];
+			fu_common_crc8_tbl[k][i] = fu_common_crc8_tbl[0][crc];
+		}
+	}
+	g_once_init_leave (&once, 1);
+}
+
+static void
+fu_common_crc16_ensure_tables (void)
+{
+	static gsize once = 0;
+	if (!g_once_init_enter (&once))
+		return;
+	for (guint32 i = 0; i < 256; i++) {
+		guint16 crc = (guint16) i;
+		for (guint8 j = 0; j < 8; j++) {
+			if (crc & 0x1) {
+				crc = (crc >> 1) ^ 0xa001;
+			} else {
+				crc >>= 1;
+			}
+		}
+		fu_common_crc16_tbl[0][i] = crc;
+	}
+	for (guint k = 1; k < FU_COMMON_CRC_SLICES; k++) {
+		for (guint32 i = 0; i < 256; i++) {
+			guint16 crc = fu_common_crc16_tbl[k - 1][i];
+			fu_common_crc16_tbl[k][i] = (crc >> 8) ^ fu_common_crc16_tbl[0][crc & 0xff];
+		}
+	}
+	g_once_init_leave (&once, 1);
+}
+
+/* returns %NULL if there are too many different polynomials in use */
+static const FuCommonCrc32Table *
+fu_common_crc32_get_table (guint32 polynomial)
+{
+	FuCommonCrc32Table *table = NULL;
+
+	G_LOCK (fu_common_crc32_tables);
+	for (guint i = 0; i < FU_COMMON_CRC32_TABLES_MAX; i++) {
+		if (fu_common_crc32_tables[i] == NULL) {
+			table = g_new0 (FuCommonCrc32Table, 1);
+			table->polynomial = polynomial;
+			for (guint32 j = 0; j < 256; j++) {
+				guint32 crc = j;
+				for (guint32 bit = 0; bit < 8; bit++) {
+					guint32 mask = -(crc & 1);
+					crc = (crc >> 1) ^ (polynomial & mask);
+				}
+				table->tbl[0][j] = crc;
+			}
+			for (guint k = 1; k < FU_COMMON_CRC_SLICES; k++) {
+				for (guint32 j = 0; j < 256; j++) {
+					guint32 crc = table->tbl[k - 1][j];
+					table->tbl[k][j] = (crc >> 8) ^ table->tbl[0][crc & 0xff];
+				}
+			}
+			fu_common_crc32_tables[i] = table;
+			break;
+		}
+		if (fu_common_crc32_tables[i]->polynomial == polynomial) {
+			table = fu_common_crc32_tables[i];
+			break;
+		}
+	}
+	G_UNLOCK (fu_common_crc32_tables);
+	return table;
+}
+
+#ifdef HAVE_ARM_CRC32
+static gboolean
+fu_common_crc32_has_hw (void)
+{
+	static gsize has_hw = 0;
+	if (g_once_init_enter (&has_hw)) {
+		gboolean tmp = (getauxval (AT_HWCAP) & HWCAP_CRC32) > 0;
+		g_debug ("using ARMv8 CRC32 instructions: %i", tmp);
+		g_once_init_leave (&has_hw, tmp ? 2 : 1);
+	}
+	return has_hw == 2;
+}
+
+/* the CRC32 instructions use the 0xEDB88320 polynomial */
+__attribute__((target("+crc")))
+static guint32
+fu_common_crc32_hw (const guint8 *buf, gsize bufsz, guint32 crc)
+{
+	for (; bufsz > 0 && ((guintptr) buf & 0x7) != 0; bufsz--)
+		crc = __crc32b (crc, *buf++);
+	for (; bufsz >= 8; bufsz -= 8, buf += 8)
+		crc = __crc32d (crc, GUINT64_FROM_LE (*((const guint64 *) buf)));
+	for (; bufsz > 0; bufsz--)
+		crc = __crc32b (crc, *buf++);
+	return crc;
+}
+#endif
+
 /**
  * fu_common_crc8:
  * @buf: memory buffer
@@ -2477,16 +2665,22 @@ fu_common_get_esp_for_path (const gchar *esp_path, GError **error)
 guint8
 fu_common_crc8 (const guint8 *buf, gsize bufsz)
 {
-	guint32 crc = 0;
-	for (gsize j = bufsz; j > 0; j--) {
-		crc ^= (*(buf++) << 8);
-		for (guint32 i = 8; i; i--) {
-			if (crc & 0x8000)
-				crc ^= (0x1070 << 3);
-			crc <<= 1;
-		}
-	}
-	return ~((guint8) (crc >> 8));
+	guint8 crc = 0;
+	fu_common_crc8_ensure_tables ();
+	for (; bufsz >= FU_COMMON_CRC_SLICES; bufsz -= FU_COMMON_CRC_SLICES) {
+		crc = fu_common_crc8_tbl[7][crc ^ buf[0]] ^
+		      fu_common_crc8_tbl[6][buf[1]] ^
+		      fu_common_crc8_tbl[5][buf[2]] ^
+		      fu_common_crc8_tbl[4][buf[3]] ^
+		      fu_common_crc8_tbl[3][buf[4]] ^
+		      fu_common_crc8_tbl[2][buf[5]] ^
+		      fu_common_crc8_tbl[1][buf[6]] ^
+		      fu_common_crc8_tbl[0][buf[7]];
+		buf += FU_COMMON_CRC_SLICES;
+	}
+	for (; bufsz > 0; bufsz--)
+		crc = fu_common_crc8_tbl[0][crc ^ *buf++];
+	return ~crc;
 }
 
 /**
@@ -2504,16 +2698,20 @@ guint16
 fu_common_crc16 (const guint8 *buf, gsize bufsz)
 {
 	guint16 crc = 0xffff;
-	for (gsize len = bufsz; len > 0; len--) {
-		crc = (guint16) (crc ^ (*buf++));
-		for (guint8 i = 0; i < 8; i++) {
-			if (crc & 0x1) {
-				crc = (crc >> 1) ^ 0xa001;
-			} else {
-				crc >>= 1;
-			}
-		}
-	}
+	fu_common_crc16_ensure_tables ();
+	for (; bufsz >= FU_COMMON_CRC_SLICES; bufsz -= FU_COMMON_CRC_SLICES) {
+		crc = fu_common_crc16_tbl[7][(crc ^ buf[0]) & 0xff] ^
+		      fu_common_crc16_tbl[6][(crc >> 8) ^ buf[1]] ^
+		      fu_common_crc16_tbl[5][buf[2]] ^
+		      fu_common_crc16_tbl[4][buf[3]] ^
+		      fu_common_crc16_tbl[3][buf[4]] ^
+		      fu_common_crc16_tbl[2][buf[5]] ^
+		      fu_common_crc16_tbl[1][buf[6]] ^
+		      fu_common_crc16_tbl[0][buf[7]];
+		buf += FU_COMMON_CRC_SLICES;
+	}
+	for (; bufsz > 0; bufsz--)
+		crc = (crc >> 8) ^ fu_common_crc16_tbl[0][(crc ^ *buf++) & 0xff];
 	return ~crc;
 }
 
@@ -2533,14 +2731,44 @@ fu_common_crc16 (const guint8 *buf, gsize bufsz)
 guint32
 fu_common_crc32_full (const guint8 *buf, gsize bufsz, guint32 crc, guint32 polynomial)
 {
-	for (guint32 idx = 0; idx < bufsz; idx++) {
-		guint8 data = *buf++;
-		crc = crc ^ data;
-		for (guint32 bit = 0; bit < 8; bit++) {
-			guint32 mask = -(crc & 1);
-			crc = (crc >> 1) ^ (polynomial & mask);
+	const FuCommonCrc32Table *table;
+
+#ifdef HAVE_ARM_CRC32
+	if (polynomial == 0xEDB88320 && fu_common_crc32_has_hw ())
+		return ~fu_common_crc32_hw (buf, bufsz, crc);
+#endif
+
+	/* fall back to processing a bit at a time */
+	table = fu_common_crc32_get_table (polynomial);
+	if (table == NULL) {
+		for (gsize idx = 0; idx < bufsz; idx++) {
+			guint8 data = *buf++;
+			crc = crc ^ data;
+			for (guint32 bit = 0; bit < 8; bit++) {
+				guint32 mask = -(crc & 1);
+				crc = (crc >> 1) ^ (polynomial & mask);
+			}
 		}
-	}
+		return ~crc;
+	}
+
+	for (; bufsz >= FU_COMMON_CRC_SLICES; bufsz -= FU_COMMON_CRC_SLICES) {
+		guint32 one = crc ^ ((guint32) buf[0] |
+				     (guint32) buf[1] << 8 |
+				     (guint32) buf[2] << 16 |
+				     (guint32) buf[3] << 24);
+		crc = table->tbl[7][one & 0xff] ^
+		      table->tbl[6][(one >> 8) & 0xff] ^
+		      table->tbl[5][(one >> 16) & 0xff] ^
+		      table->tbl[4][one >> 24] ^
+		      table->tbl[3][buf[4]] ^
+		      table->tbl[2][buf[5]] ^
+		      table->tbl[1][buf[6]] ^
+		      table->tbl[0][buf[7]];
+		buf += FU_COMMON_CRC_SLICES;
+	}
+	for (; bufsz > 0; bufsz--)
+		crc = (crc >> 8) ^ table->tbl[0][(crc ^ *buf++) & 0xff];
 	return ~crc;
 }
 
@@ -0,0 +1,20 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#pragma once
+
+#include <json-glib/json-glib.h>
+
+#include "fu-device-event.h"
+
+FuDeviceEvent	*fu_device_event_new			(const gchar	*id);
+FuDeviceEvent	*fu_device_event_new_from_json		(JsonObject	*json_object,
+							 GError		**error);
+void		 fu_device_event_to_json		(FuDeviceEvent	*self,
+							 JsonBuilder	*builder);
+gboolean	 fu_device_event_get_consumed		(FuDeviceEvent	*self);
+void		 fu_device_event_set_consumed		(FuDeviceEvent	*self,
+							 gboolean	 consumed);
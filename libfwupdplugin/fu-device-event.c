@@ -0,0 +1,503 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#define G_LOG_DOMAIN				"FuDeviceEvent"
+
+#include "config.h"
+
+#include <string.h>
+
+#include "fu-device-event-private.h"
+
+#include "fwupd-error.h"
+
+/**
+ * SECTION:fu-device-event
+ * @short_description: a recorded device transaction
+ *
+ * An object that represents a single request sent to a device, and the
+ * response that was received, e.g. an ioctl or a HID report.
+ *
+ * Events are recorded when the device is in %FU_DEVICE_EMULATION_RECORD mode
+ * and are played back in %FU_DEVICE_EMULATION_REPLAY mode.
+ *
+ * See also: #FuDevice
+ */
+
+struct _FuDeviceEvent {
+	GObject			 parent_instance;
+	gchar			*id;
+	guint64			 duration;	/* us */
+	gboolean		 consumed;
+	GHashTable		*values;	/* key:value */
+};
+
+G_DEFINE_TYPE (FuDeviceEvent, fu_device_event, G_TYPE_OBJECT)
+
+/**
+ * fu_device_event_get_id:
+ * @self: A #FuDeviceEvent
+ *
+ * Gets the event ID, which encodes the request that was sent to the device.
+ *
+ * Returns: a string, or %NULL if unset
+ *
+ * Since: 1.5.2
+ **/
+const gchar *
+fu_device_event_get_id (FuDeviceEvent *self)
+{
+	g_return_val_if_fail (FU_IS_DEVICE_EVENT (self), NULL);
+	return self->id;
+}
+
+/**
+ * fu_device_event_get_duration:
+ * @self: A #FuDeviceEvent
+ *
+ * Gets how long the request took to complete on the real hardware.
+ *
+ * Returns: time in microseconds
+ *
+ * Since: 1.5.2
+ **/
+guint64
+fu_device_event_get_duration (FuDeviceEvent *self)
+{
+	g_return_val_if_fail (FU_IS_DEVICE_EVENT (self), 0);
+	return self->duration;
+}
+
+/**
+ * fu_device_event_set_duration:
+ * @self: A #FuDeviceEvent
+ * @duration: time in microseconds
+ *
+ * Sets how long the request took to complete on the real hardware.
+ *
+ * Since: 1.5.2
+ **/
+void
+fu_device_event_set_duration (FuDeviceEvent *self, guint64 duration)
+{
+	g_return_if_fail (FU_IS_DEVICE_EVENT (self));
+	self->duration = duration;
+}
+
+/**
+ * fu_device_event_get_consumed:
+ * @self: A #FuDeviceEvent
+ *
+ * Gets if the event has already been played back.
+ *
+ * Returns: %TRUE if the event has been used
+ *
+ * Since: 1.5.2
+ **/
+gboolean
+fu_device_event_get_consumed (FuDeviceEvent *self)
+{
+	g_return_val_if_fail (FU_IS_DEVICE_EVENT (self), FALSE);
+	return self->consumed;
+}
+
+/**
+ * fu_device_event_set_consumed:
+ * @self: A #FuDeviceEvent
+ * @consumed: boolean
+ *
+ * Sets if the event has already been played back.
+ *
+ * Since: 1.5.2
+ **/
+void
+fu_device_event_set_consumed (FuDeviceEvent *self, gboolean consumed)
+{
+	g_return_if_fail (FU_IS_DEVICE_EVENT (self));
+	self->consumed = consumed;
+}
+
+/**
+ * fu_device_event_set_str:
+ * @self: A #FuDeviceEvent
+ * @key: A unique key, e.g. `Data`
+ * @value: (nullable): A string
+ *
+ * Sets a string value on the event.
+ *
+ * Since: 1.5.2
+ **/
+void
+fu_device_event_set_str (FuDeviceEvent *self, const gchar *key, const gchar *value)
+{
+	g_return_if_fail (FU_IS_DEVICE_EVENT (self));
+	g_return_if_fail (key != NULL);
+	if (value == NULL) {
+		g_hash_table_remove (self->values, key);
+		return;
+	}
+	g_hash_table_insert (self->values, g_strdup (key), g_strdup (value));
+}
+
+/**
+ * fu_device_event_get_str:
+ * @self: A #FuDeviceEvent
+ * @key: A unique key, e.g. `Data`
+ * @error: A #GError, or %NULL
+ *
+ * Gets a string value from the event.
+ *
+ * Returns: a string, or %NULL if the key was not recorded
+ *
+ * Since: 1.5.2
+ **/
+const gchar *
+fu_device_event_get_str (FuDeviceEvent *self, const gchar *key, GError **error)
+{
+	const gchar *value;
+
+	g_return_val_if_fail (FU_IS_DEVICE_EVENT (self), NULL);
+	g_return_val_if_fail (key != NULL, NULL);
+
+	value = g_hash_table_lookup (self->values, key);
+	if (value == NULL) {
+		g_set_error (error,
+			     G_IO_ERROR,
+			     G_IO_ERROR_NOT_FOUND,
+			     "no %s in event %s",
+			     key, self->id);
+		return NULL;
+	}
+	return value;
+}
+
+/**
+ * fu_device_event_set_i64:
+ * @self: A #FuDeviceEvent
+ * @key: A unique key, e.g. `Rc`
+ * @value: An integer
+ *
+ * Sets an integer value on the event.
+ *
+ * Since: 1.5.2
+ **/
+void
+fu_device_event_set_i64 (FuDeviceEvent *self, const gchar *key, gint64 value)
+{
+	g_return_if_fail (FU_IS_DEVICE_EVENT (self));
+	g_return_if_fail (key != NULL);
+	g_hash_table_insert (self->values,
+			     g_strdup (key),
+			     g_strdup_printf ("%" G_GINT64_FORMAT, value));
+}
+
+/**
+ * fu_device_event_get_i64:
+ * @self: A #FuDeviceEvent
+ * @key: A unique key, e.g. `Rc`
+ * @value: (out): the integer value
+ * @error: A #GError, or %NULL
+ *
+ * Gets an integer value from the event.
+ *
+ * Returns: %TRUE if the key was recorded
+ *
+ * Since: 1.5.2
+ **/
+gboolean
+fu_device_event_get_i64 (FuDeviceEvent *self,
+			 const gchar *key,
+			 gint64 *value,
+			 GError **error)
+{
+	const gchar *tmp;
+
+	g_return_val_if_fail (FU_IS_DEVICE_EVENT (self), FALSE);
+	g_return_val_if_fail (key != NULL, FALSE);
+
+	tmp = fu_device_event_get_str (self, key, error);
+	if (tmp == NULL)
+		return FALSE;
+	if (value != NULL)
+		*value = g_ascii_strtoll (tmp, NULL, 10);
+	return TRUE;
+}
+
+/**
+ * fu_device_event_set_data:
+ * @self: A #FuDeviceEvent
+ * @key: A unique key, e.g. `Data`
+ * @buf: (nullable): A buffer
+ * @bufsz: Size of @buf
+ *
+ * Sets a blob of data on the event, which is stored base64 encoded.
+ *
+ * Since: 1.5.2
+ **/
+void
+fu_device_event_set_data (FuDeviceEvent *self,
+			  const gchar *key,
+			  const guint8 *buf,
+			  gsize bufsz)
+{
+	g_return_if_fail (FU_IS_DEVICE_EVENT (self));
+	g_return_if_fail (key != NULL);
+	g_hash_table_insert (self->values,
+			     g_strdup (key),
+			     g_base64_encode (buf, bufsz));
+}
+
+/**
+ * fu_device_event_copy_data:
+ * @self: A #FuDeviceEvent
+ * @key: A unique key, e.g. `Data`
+ * @buf: (nullable): A buffer
+ * @bufsz: Size of @buf
+ * @actual_length: (out) (allow-none): the number of bytes copied into @buf
+ * @error: A #GError, or %NULL
+ *
+ * Copies a blob of data from the event into a buffer.
+ *
+ * Returns: %TRUE if the data was recorded and was not larger than @buf
+ *
+ * Since: 1.5.2
+ **/
+gboolean
+fu_device_event_copy_data (FuDeviceEvent *self,
+			   const gchar *key,
+			   guint8 *buf,
+			   gsize bufsz,
+			   gsize *actual_length,
+			   GError **error)
+{
+	const gchar *tmp;
+	gsize datasz = 0;
+	g_autofree guchar *data = NULL;
+
+	g_return_val_if_fail (FU_IS_DEVICE_EVENT (self), FALSE);
+	g_return_val_if_fail (key != NULL, FALSE);
+
+	tmp = fu_device_event_get_str (self, key, error);
+	if (tmp == NULL)
+		return FALSE;
+	data = g_base64_decode (tmp, &datasz);
+	if (datasz > bufsz) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "%s in event %s was 0x%x bytes, buffer only 0x%x",
+			     key, self->id, (guint) datasz, (guint) bufsz);
+		return FALSE;
+	}
+	if (buf != NULL && datasz > 0)
+		memcpy (buf, data, datasz);
+	if (actual_length != NULL)
+		*actual_length = datasz;
+	return TRUE;
+}
+
+/**
+ * fu_device_event_set_error:
+ * @self: A #FuDeviceEvent
+ * @error: (nullable): A #GError
+ *
+ * Sets the error the request failed with, so that the same error can be
+ * returned when the event is played back.
+ *
+ * Since: 1.5.2
+ **/
+void
+fu_device_event_set_error (FuDeviceEvent *self, const GError *error)
+{
+	g_return_if_fail (FU_IS_DEVICE_EVENT (self));
+	if (error == NULL) {
+		g_hash_table_remove (self->values, "ErrorDomain");
+		g_hash_table_remove (self->values, "ErrorCode");
+		g_hash_table_remove (self->values, "Error");
+		return;
+	}
+	fu_device_event_set_str (self, "ErrorDomain", g_quark_to_string (error->domain));
+	fu_device_event_set_i64 (self, "ErrorCode", error->code);
+	fu_device_event_set_str (self, "Error", error->message);
+}
+
+/**
+ * fu_device_event_check_error:
+ * @self: A #FuDeviceEvent
+ * @error: A #GError, or %NULL
+ *
+ * Sets @error to the error that was recorded for the request, if any.
+ *
+ * Returns: %TRUE if the request succeeded when it was recorded
+ *
+ * Since: 1.5.2
+ **/
+gboolean
+fu_device_event_check_error (FuDeviceEvent *self, GError **error)
+{
+	const gchar *domain;
+	const gchar *message;
+	gint64 code = 0;
+
+	g_return_val_if_fail (FU_IS_DEVICE_EVENT (self), FALSE);
+
+	domain = g_hash_table_lookup (self->values, "ErrorDomain");
+	if (domain == NULL)
+		return TRUE;
+	if (!fu_device_event_get_i64 (self, "ErrorCode", &code, error))
+		return FALSE;
+	message = fu_device_event_get_str (self, "Error", error);
+	if (message == NULL)
+		return FALSE;
+	g_set_error_literal (error, g_quark_from_string (domain), (gint) code, message);
+	return FALSE;
+}
+
+/**
+ * fu_device_event_to_json:
+ * @self: A #FuDeviceEvent
+ * @builder: A #JsonBuilder
+ *
+ * Adds the event as a JSON object.
+ *
+ * Since: 1.5.2
+ **/
+void
+fu_device_event_to_json (FuDeviceEvent *self, JsonBuilder *builder)
+{
+	GHashTableIter iter;
+	gpointer key, value;
+	g_autoptr(GList) keys = NULL;
+
+	g_return_if_fail (FU_IS_DEVICE_EVENT (self));
+	g_return_if_fail (builder != NULL);
+
+	json_builder_begin_object (builder);
+	json_builder_set_member_name (builder, "Id");
+	json_builder_add_string_value (builder, self->id);
+	if (self->duration > 0) {
+		json_builder_set_member_name (builder, "Duration");
+		json_builder_add_int_value (builder, self->duration);
+	}
+
+	/* sort the keys so that the output is stable */
+	g_hash_table_iter_init (&iter, self->values);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+		keys = g_list_prepend (keys, key);
+	keys = g_list_sort (keys, (GCompareFunc) g_strcmp0);
+	for (GList *l = keys; l != NULL; l = l->next) {
+		const gchar *tmp = g_hash_table_lookup (self->values, l->data);
+		json_builder_set_member_name (builder, l->data);
+		json_builder_add_string_value (builder, tmp);
+	}
+	json_builder_end_object (builder);
+}
+
+/**
+ * fu_device_event_new_from_json:
+ * @json_object: A #JsonObject
+ * @error: A #GError, or %NULL
+ *
+ * Creates a new event from an object previously written with
+ * fu_device_event_to_json().
+ *
+ * Returns: (transfer full): a #FuDeviceEvent, or %NULL on error
+ *
+ * Since: 1.5.2
+ **/
+FuDeviceEvent *
+fu_device_event_new_from_json (JsonObject *json_object, GError **error)
+{
+	JsonNode *json_node;
+	g_autoptr(FuDeviceEvent) self = NULL;
+	g_autoptr(GList) members = NULL;
+
+	g_return_val_if_fail (json_object != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	json_node = json_object_get_member (json_object, "Id");
+	if (json_node == NULL ||
+	    !JSON_NODE_HOLDS_VALUE (json_node) ||
+	    json_node_get_value_type (json_node) != G_TYPE_STRING) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "event has no Id");
+		return NULL;
+	}
+	self = fu_device_event_new (json_node_get_string (json_node));
+	members = json_object_get_members (json_object);
+	for (GList *l = members; l != NULL; l = l->next) {
+		const gchar *key = l->data;
+		if (g_strcmp0 (key, "Id") == 0)
+			continue;
+		json_node = json_object_get_member (json_object, key);
+		if (g_strcmp0 (key, "Duration") == 0) {
+			if (!JSON_NODE_HOLDS_VALUE (json_node) ||
+			    json_node_get_value_type (json_node) != G_TYPE_INT64) {
+				g_set_error (error,
+					     FWUPD_ERROR,
+					     FWUPD_ERROR_INVALID_FILE,
+					     "event %s has invalid Duration",
+					     self->id);
+				return NULL;
+			}
+			self->duration = json_node_get_int (json_node);
+			continue;
+		}
+		if (!JSON_NODE_HOLDS_VALUE (json_node) ||
+		    json_node_get_value_type (json_node) != G_TYPE_STRING) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "event %s has invalid %s",
+				     self->id, key);
+			return NULL;
+		}
+		fu_device_event_set_str (self, key, json_node_get_string (json_node));
+	}
+	return g_steal_pointer (&self);
+}
+
+static void
+fu_device_event_finalize (GObject *object)
+{
+	FuDeviceEvent *self = FU_DEVICE_EVENT (object);
+	g_free (self->id);
+	g_hash_table_unref (self->values);
+	G_OBJECT_CLASS (fu_device_event_parent_class)->finalize (object);
+}
+
+static void
+fu_device_event_class_init (FuDeviceEventClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	object_class->finalize = fu_device_event_finalize;
+}
+
+static void
+fu_device_event_init (FuDeviceEvent *self)
+{
+	self->values = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+}
+
+/**
+ * fu_device_event_new:
+ * @id: the request, e.g. `Ioctl:Request=0x1234,Data=AAA=`
+ *
+ * Creates a new device event.
+ *
+ * Returns: (transfer full): a #FuDeviceEvent
+ *
+ * Since: 1.5.2
+ **/
+FuDeviceEvent *
+fu_device_event_new (const gchar *id)
+{
+	FuDeviceEvent *self = g_object_new (FU_TYPE_DEVICE_EVENT, NULL);
+	self->id = g_strdup (id);
+	return self;
+}
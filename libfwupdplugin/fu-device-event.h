@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+#define FU_TYPE_DEVICE_EVENT (fu_device_event_get_type ())
+
+G_DECLARE_FINAL_TYPE (FuDeviceEvent, fu_device_event, FU, DEVICE_EVENT, GObject)
+
+const gchar	*fu_device_event_get_id			(FuDeviceEvent	*self);
+guint64		 fu_device_event_get_duration		(FuDeviceEvent	*self);
+void		 fu_device_event_set_duration		(FuDeviceEvent	*self,
+							 guint64	 duration);
+void		 fu_device_event_set_str		(FuDeviceEvent	*self,
+							 const gchar	*key,
+							 const gchar	*value);
+const gchar	*fu_device_event_get_str		(FuDeviceEvent	*self,
+							 const gchar	*key,
+							 GError		**error);
+void		 fu_device_event_set_i64		(FuDeviceEvent	*self,
+							 const gchar	*key,
+							 gint64		 value);
+gboolean	 fu_device_event_get_i64		(FuDeviceEvent	*self,
+							 const gchar	*key,
+							 gint64		*value,
+							 GError		**error);
+void		 fu_device_event_set_data		(FuDeviceEvent	*self,
+							 const gchar	*key,
+							 const guint8	*buf,
+							 gsize		 bufsz);
+gboolean	 fu_device_event_copy_data		(FuDeviceEvent	*self,
+							 const gchar	*key,
+							 guint8		*buf,
+							 gsize		 bufsz,
+							 gsize		*actual_length,
+							 GError		**error);
+void		 fu_device_event_set_error		(FuDeviceEvent	*self,
+							 const GError	*error);
+gboolean	 fu_device_event_check_error		(FuDeviceEvent	*self,
+							 GError		**error);
@@ -9,6 +9,24 @@
 #include <fu-device.h>
 #include <xmlb.h>
 
+#include "fu-device-event.h"
+
+/**
+ * FuDeviceEmulation:
+ * @FU_DEVICE_EMULATION_NONE:		Requests are sent to the hardware
+ * @FU_DEVICE_EMULATION_RECORD:		Requests are sent to the hardware and recorded
+ * @FU_DEVICE_EMULATION_REPLAY:		Requests are satisfied from recorded events
+ *
+ * The emulation mode of the device.
+ **/
+typedef enum {
+	FU_DEVICE_EMULATION_NONE,
+	FU_DEVICE_EMULATION_RECORD,
+	FU_DEVICE_EMULATION_REPLAY,
+	/*< private >*/
+	FU_DEVICE_EMULATION_LAST
+} FuDeviceEmulation;
+
 #define fu_device_set_plugin(d,v)		fwupd_device_set_plugin(FWUPD_DEVICE(d),v)
 
 GPtrArray	*fu_device_get_parent_guids		(FuDevice	*self);
@@ -30,3 +48,17 @@ gchar		*fu_device_get_guids_as_str		(FuDevice	*self);
 GPtrArray	*fu_device_get_possible_plugins		(FuDevice	*self);
 void		 fu_device_add_possible_plugin		(FuDevice	*self,
 							 const gchar	*plugin);
+const gchar	*fu_device_emulation_to_string		(FuDeviceEmulation emulation);
+FuDeviceEmulation fu_device_get_emulation		(FuDevice	*self);
+void		 fu_device_set_emulation		(FuDevice	*self,
+							 FuDeviceEmulation emulation);
+void		 fu_device_set_emulation_latency	(FuDevice	*self,
+							 gboolean	 emulation_latency);
+GPtrArray	*fu_device_get_events			(FuDevice	*self);
+void		 fu_device_set_events			(FuDevice	*self,
+							 GPtrArray	*events);
+FuDeviceEvent	*fu_device_save_event			(FuDevice	*self,
+							 const gchar	*id);
+FuDeviceEvent	*fu_device_load_event			(FuDevice	*self,
+							 const gchar	*id,
+							 GError		**error);
@@ -14,6 +14,7 @@
 
 #include "fu-common.h"
 #include "fu-common-version.h"
+#include "fu-device-event-private.h"
 #include "fu-device-private.h"
 #include "fu-mutex.h"
 
@@ -36,6 +37,7 @@ typedef struct {
 	gchar				*equivalent_id;
 	gchar				*physical_id;
 	gchar				*logical_id;
+	gchar				*backend_id;
 	gchar				*proxy_guid;
 	FuDevice			*alternate;
 	FuDevice			*proxy;		/* noref */
@@ -59,6 +61,10 @@ typedef struct {
 	GPtrArray			*possible_plugins;
 	GPtrArray			*retry_recs;	/* of FuDeviceRetryRecovery */
 	guint				 retry_delay;
+	FuDeviceEmulation		 emulation;
+	gboolean			 emulation_latency;
+	GPtrArray			*events;	/* (nullable) of FuDeviceEvent */
+	guint				 events_idx;
 } FuDevicePrivate;
 
 typedef struct {
@@ -74,6 +80,9 @@ enum {
 	PROP_LOGICAL_ID,
 	PROP_QUIRKS,
 	PROP_PROXY,
+	PROP_DEVICE_ID,
+	PROP_EQUIVALENT_ID,
+	PROP_GUIDS,
 	PROP_LAST
 };
 
@@ -102,6 +111,15 @@ fu_device_get_property (GObject *object, guint prop_id,
 	case PROP_PROXY:
 		g_value_set_object (value, priv->proxy);
 		break;
+	case PROP_DEVICE_ID:
+		g_value_set_string (value, fu_device_get_id (self));
+		break;
+	case PROP_EQUIVALENT_ID:
+		g_value_set_string (value, priv->equivalent_id);
+		break;
+	case PROP_GUIDS:
+		g_value_set_boxed (value, fu_device_get_guids (self));
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -129,6 +147,9 @@ fu_device_set_property (GObject *object, guint prop_id,
 	case PROP_PROXY:
 		fu_device_set_proxy (self, g_value_get_object (value));
 		break;
+	case PROP_EQUIVALENT_ID:
+		fu_device_set_equivalent_id (self, g_value_get_string (value));
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -501,6 +522,7 @@ fu_device_set_equivalent_id (FuDevice *self, const gchar *equivalent_id)
 	g_return_if_fail (FU_IS_DEVICE (self));
 	g_free (priv->equivalent_id);
 	priv->equivalent_id = g_strdup (equivalent_id);
+	g_object_notify (G_OBJECT (self), "equivalent-id");
 }
 
 /**
@@ -1206,6 +1228,7 @@ fu_device_add_guid_safe (FuDevice *self, const gchar *guid)
 	/* add the device GUID before adding additional GUIDs from quirks
 	 * to ensure the bootloader GUID is listed after the runtime GUID */
 	fwupd_device_add_guid (FWUPD_DEVICE (self), guid);
+	g_object_notify (G_OBJECT (self), "guids");
 	fu_device_add_guid_quirks (self, guid);
 }
 
@@ -1333,11 +1356,10 @@ fu_device_add_counterpart_guid (FuDevice *self, const gchar *guid)
 	if (!fwupd_guid_is_valid (guid)) {
 		g_autofree gchar *tmp = fwupd_guid_hash_string (guid);
 		fwupd_device_add_guid (FWUPD_DEVICE (self), tmp);
-		return;
+	} else {
+		fwupd_device_add_guid (FWUPD_DEVICE (self), guid);
 	}
-
-	/* already valid */
-	fwupd_device_add_guid (FWUPD_DEVICE (self), guid);
+	g_object_notify (G_OBJECT (self), "guids");
 }
 
 /**
@@ -1620,6 +1642,7 @@ fu_device_set_id (FuDevice *self, const gchar *id)
 	}
 	fwupd_device_set_id (FWUPD_DEVICE (self), id_hash);
 	priv->device_id_valid = TRUE;
+	g_object_notify (G_OBJECT (self), "device-id");
 
 	/* ensure the parent ID is set */
 	children = fu_device_get_children (self);
@@ -1982,6 +2005,50 @@ fu_device_get_physical_id (FuDevice *self)
 	return priv->physical_id;
 }
 
+/**
+ * fu_device_set_backend_id:
+ * @self: A #FuDevice
+ * @backend_id: (nullable): a string that identifies the backend device
+ *
+ * Sets the ID used by the backend for the device, for instance the sysfs path
+ * for a udev device or the platform ID for a USB device. Unlike the physical
+ * ID this is not used to match devices, only to find the devices that were
+ * created for a backend device when it is removed.
+ *
+ * Since: 1.5.2
+ **/
+void
+fu_device_set_backend_id (FuDevice *self, const gchar *backend_id)
+{
+	FuDevicePrivate *priv = GET_PRIVATE (self);
+	g_return_if_fail (FU_IS_DEVICE (self));
+
+	/* not changed */
+	if (g_strcmp0 (priv->backend_id, backend_id) == 0)
+		return;
+
+	g_free (priv->backend_id);
+	priv->backend_id = g_strdup (backend_id);
+}
+
+/**
+ * fu_device_get_backend_id:
+ * @self: A #FuDevice
+ *
+ * Gets the ID used by the backend for the device.
+ *
+ * Returns: a string value, or %NULL if never set.
+ *
+ * Since: 1.5.2
+ **/
+const gchar *
+fu_device_get_backend_id (FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE (self);
+	g_return_val_if_fail (FU_IS_DEVICE (self), NULL);
+	return priv->backend_id;
+}
+
 /**
  * fu_device_add_flag:
  * @self: A #FuDevice
@@ -2254,11 +2321,16 @@ fu_device_set_progress_full (FuDevice *self, gsize progress_done, gsize progress
 void
 fu_device_sleep_with_progress (FuDevice *self, guint delay_secs)
 {
+	FuDevicePrivate *priv = GET_PRIVATE (self);
 	gulong delay_us_pc = (delay_secs * G_USEC_PER_SEC) / 100;
 
 	g_return_if_fail (FU_IS_DEVICE (self));
 	g_return_if_fail (delay_secs > 0);
 
+	/* nothing is going to change on an emulated device */
+	if (priv->emulation == FU_DEVICE_EMULATION_REPLAY && !priv->emulation_latency)
+		return;
+
 	fu_device_set_progress (self, 0);
 	for (guint i = 0; i < 100; i++) {
 		g_usleep (delay_us_pc);
@@ -2266,6 +2338,201 @@ fu_device_sleep_with_progress (FuDevice *self, guint delay_secs)
 	}
 }
 
+/**
+ * fu_device_emulation_to_string:
+ * @emulation: A #FuDeviceEmulation, e.g. %FU_DEVICE_EMULATION_RECORD
+ *
+ * Converts an emulation mode to a string.
+ *
+ * Returns: identifier string
+ *
+ * Since: 1.5.2
+ **/
+const gchar *
+fu_device_emulation_to_string (FuDeviceEmulation emulation)
+{
+	if (emulation == FU_DEVICE_EMULATION_NONE)
+		return "none";
+	if (emulation == FU_DEVICE_EMULATION_RECORD)
+		return "record";
+	if (emulation == FU_DEVICE_EMULATION_REPLAY)
+		return "replay";
+	return NULL;
+}
+
+/**
+ * fu_device_get_emulation:
+ * @self: A #FuDevice
+ *
+ * Gets if requests sent to the device are being recorded or played back.
+ *
+ * Returns: a #FuDeviceEmulation, e.g. %FU_DEVICE_EMULATION_NONE
+ *
+ * Since: 1.5.2
+ **/
+FuDeviceEmulation
+fu_device_get_emulation (FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE (self);
+	g_return_val_if_fail (FU_IS_DEVICE (self), FU_DEVICE_EMULATION_NONE);
+	return priv->emulation;
+}
+
+/**
+ * fu_device_set_emulation:
+ * @self: A #FuDevice
+ * @emulation: A #FuDeviceEmulation, e.g. %FU_DEVICE_EMULATION_REPLAY
+ *
+ * Sets if requests sent to the device should be recorded using
+ * fu_device_save_event() or played back using fu_device_load_event().
+ *
+ * Since: 1.5.2
+ **/
+void
+fu_device_set_emulation (FuDevice *self, FuDeviceEmulation emulation)
+{
+	FuDevicePrivate *priv = GET_PRIVATE (self);
+	g_return_if_fail (FU_IS_DEVICE (self));
+	priv->emulation = emulation;
+}
+
+/**
+ * fu_device_set_emulation_latency:
+ * @self: A #FuDevice
+ * @emulation_latency: %TRUE to sleep for the recorded duration
+ *
+ * Sets if events should be played back with the latency of the real hardware,
+ * or as quickly as possible.
+ *
+ * Since: 1.5.2
+ **/
+void
+fu_device_set_emulation_latency (FuDevice *self, gboolean emulation_latency)
+{
+	FuDevicePrivate *priv = GET_PRIVATE (self);
+	g_return_if_fail (FU_IS_DEVICE (self));
+	priv->emulation_latency = emulation_latency;
+}
+
+/**
+ * fu_device_get_events:
+ * @self: A #FuDevice
+ *
+ * Gets the events recorded for the device.
+ *
+ * Returns: (transfer none) (element-type FuDeviceEvent) (nullable): events
+ *
+ * Since: 1.5.2
+ **/
+GPtrArray *
+fu_device_get_events (FuDevice *self)
+{
+	FuDevicePrivate *priv = GET_PRIVATE (self);
+	g_return_val_if_fail (FU_IS_DEVICE (self), NULL);
+	return priv->events;
+}
+
+/**
+ * fu_device_set_events:
+ * @self: A #FuDevice
+ * @events: (element-type FuDeviceEvent): events
+ *
+ * Sets the array used for recording and playing back events. The array is
+ * shared rather than copied, so that devices re-created from the same
+ * hardware, e.g. after a replug, continue the same stream of events.
+ *
+ * Since: 1.5.2
+ **/
+void
+fu_device_set_events (FuDevice *self, GPtrArray *events)
+{
+	FuDevicePrivate *priv = GET_PRIVATE (self);
+	g_return_if_fail (FU_IS_DEVICE (self));
+	g_return_if_fail (events != NULL);
+	if (priv->events == events)
+		return;
+	if (priv->events != NULL)
+		g_ptr_array_unref (priv->events);
+	priv->events = g_ptr_array_ref (events);
+	priv->events_idx = 0;
+}
+
+/**
+ * fu_device_save_event:
+ * @self: A #FuDevice
+ * @id: the request, e.g. `Ioctl:Request=0x1234,Data=AAA=`
+ *
+ * Creates a new event for a request about to be sent to the device. The caller
+ * should add the response and the duration to the returned event.
+ *
+ * Returns: (transfer none): a #FuDeviceEvent
+ *
+ * Since: 1.5.2
+ **/
+FuDeviceEvent *
+fu_device_save_event (FuDevice *self, const gchar *id)
+{
+	FuDevicePrivate *priv = GET_PRIVATE (self);
+	FuDeviceEvent *event;
+
+	g_return_val_if_fail (FU_IS_DEVICE (self), NULL);
+	g_return_val_if_fail (id != NULL, NULL);
+
+	if (priv->events == NULL)
+		priv->events = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	event = fu_device_event_new (id);
+	g_ptr_array_add (priv->events, event);
+	return event;
+}
+
+/**
+ * fu_device_load_event:
+ * @self: A #FuDevice
+ * @id: the request, e.g. `Ioctl:Request=0x1234,Data=AAA=`
+ * @error: A #GError, or %NULL
+ *
+ * Finds the next recorded event that matches the request. Each event is only
+ * ever returned once, so repeated identical requests return the responses in
+ * the order they were recorded.
+ *
+ * If the device was set up using fu_device_set_emulation_latency() then this
+ * also blocks for the duration the request took on the real hardware.
+ *
+ * Returns: (transfer none): a #FuDeviceEvent, or %NULL if not found
+ *
+ * Since: 1.5.2
+ **/
+FuDeviceEvent *
+fu_device_load_event (FuDevice *self, const gchar *id, GError **error)
+{
+	FuDevicePrivate *priv = GET_PRIVATE (self);
+
+	g_return_val_if_fail (FU_IS_DEVICE (self), NULL);
+	g_return_val_if_fail (id != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* start from the last match as requests are normally replayed in order */
+	for (guint i = 0; priv->events != NULL && i < priv->events->len; i++) {
+		guint idx = (priv->events_idx + i) % priv->events->len;
+		FuDeviceEvent *event = g_ptr_array_index (priv->events, idx);
+		if (fu_device_event_get_consumed (event))
+			continue;
+		if (g_strcmp0 (fu_device_event_get_id (event), id) != 0)
+			continue;
+		fu_device_event_set_consumed (event, TRUE);
+		priv->events_idx = idx + 1;
+		if (priv->emulation_latency)
+			g_usleep (fu_device_event_get_duration (event));
+		return event;
+	}
+	g_set_error (error,
+		     FWUPD_ERROR,
+		     FWUPD_ERROR_NOT_FOUND,
+		     "no event recorded for %s",
+		     id);
+	return NULL;
+}
+
 static void
 fu_device_add_string (FuDevice *self, guint idt, GString *str)
 {
@@ -2291,6 +2558,8 @@ fu_device_add_string (FuDevice *self, guint idt, GString *str)
 		fu_common_string_append_kv (str, idt + 1, "PhysicalId", priv->physical_id);
 	if (priv->logical_id != NULL)
 		fu_common_string_append_kv (str, idt + 1, "LogicalId", priv->logical_id);
+	if (priv->backend_id != NULL)
+		fu_common_string_append_kv (str, idt + 1, "BackendId", priv->backend_id);
 	if (priv->proxy != NULL)
 		fu_common_string_append_kv (str, idt + 1, "ProxyId", fu_device_get_id (priv->proxy));
 	if (priv->proxy_guid != NULL)
@@ -2307,6 +2576,12 @@ fu_device_add_string (FuDevice *self, guint idt, GString *str)
 		fu_common_string_append_ku (str, idt + 1, "Order", priv->order);
 	if (priv->priority > 0)
 		fu_common_string_append_ku (str, idt + 1, "Priority", priv->priority);
+	if (priv->emulation != FU_DEVICE_EMULATION_NONE) {
+		fu_common_string_append_kv (str, idt + 1, "Emulation",
+					    fu_device_emulation_to_string (priv->emulation));
+	}
+	if (priv->events != NULL && priv->events->len > 0)
+		fu_common_string_append_ku (str, idt + 1, "Events", priv->events->len);
 	if (priv->metadata != NULL) {
 		g_autoptr(GList) keys = g_hash_table_get_keys (priv->metadata);
 		for (GList *l = keys; l != NULL; l = l->next) {
@@ -2951,6 +3226,8 @@ fu_device_convert_instance_ids (FuDevice *self)
 		g_autofree gchar *guid = fwupd_guid_hash_string (instance_id);
 		fwupd_device_add_guid (FWUPD_DEVICE (self), guid);
 	}
+	if (instance_ids->len > 0)
+		g_object_notify (G_OBJECT (self), "guids");
 
 	/* convert all children too */
 	children = fu_device_get_children (self);
@@ -3218,6 +3495,12 @@ fu_device_incorporate (FuDevice *self, FuDevice *donor)
 		fu_device_set_proxy_guid (self, priv_donor->proxy_guid);
 	if (priv->quirks == NULL)
 		fu_device_set_quirks (self, fu_device_get_quirks (donor));
+	if (priv->emulation == FU_DEVICE_EMULATION_NONE) {
+		priv->emulation = priv_donor->emulation;
+		priv->emulation_latency = priv_donor->emulation_latency;
+	}
+	if (priv->events == NULL && priv_donor->events != NULL)
+		fu_device_set_events (self, priv_donor->events);
 	g_rw_lock_reader_lock (&priv_donor->parent_guids_mutex);
 	for (guint i = 0; i < parent_guids->len; i++)
 		fu_device_add_parent_guid (self, g_ptr_array_index (parent_guids, i));
@@ -3241,6 +3524,8 @@ fu_device_incorporate (FuDevice *self, FuDevice *donor)
 	/* set by the superclass */
 	if (fu_device_get_id (self) != NULL)
 		priv->device_id_valid = TRUE;
+	g_object_notify (G_OBJECT (self), "device-id");
+	g_object_notify (G_OBJECT (self), "guids");
 
 	/* optional subclass */
 	if (klass->incorporate != NULL)
@@ -3336,6 +3621,22 @@ fu_device_class_init (FuDeviceClass *klass)
 				     G_PARAM_CONSTRUCT |
 				     G_PARAM_STATIC_NAME);
 	g_object_class_install_property (object_class, PROP_PROXY, pspec);
+
+	pspec = g_param_spec_string ("device-id", NULL, NULL, NULL,
+				     G_PARAM_READABLE |
+				     G_PARAM_STATIC_NAME);
+	g_object_class_install_property (object_class, PROP_DEVICE_ID, pspec);
+
+	pspec = g_param_spec_string ("equivalent-id", NULL, NULL, NULL,
+				     G_PARAM_READWRITE |
+				     G_PARAM_STATIC_NAME);
+	g_object_class_install_property (object_class, PROP_EQUIVALENT_ID, pspec);
+
+	pspec = g_param_spec_boxed ("guids", NULL, NULL,
+				    G_TYPE_PTR_ARRAY,
+				    G_PARAM_READABLE |
+				    G_PARAM_STATIC_NAME);
+	g_object_class_install_property (object_class, PROP_GUIDS, pspec);
 }
 
 static void
@@ -3369,6 +3670,8 @@ fu_device_finalize (GObject *object)
 		g_source_remove (priv->poll_id);
 	if (priv->metadata != NULL)
 		g_hash_table_unref (priv->metadata);
+	if (priv->events != NULL)
+		g_ptr_array_unref (priv->events);
 	g_ptr_array_unref (priv->parent_guids);
 	g_ptr_array_unref (priv->possible_plugins);
 	g_ptr_array_unref (priv->retry_recs);
@@ -3376,6 +3679,7 @@ fu_device_finalize (GObject *object)
 	g_free (priv->equivalent_id);
 	g_free (priv->physical_id);
 	g_free (priv->logical_id);
+	g_free (priv->backend_id);
 	g_free (priv->proxy_guid);
 
 	G_OBJECT_CLASS (fu_device_parent_class)->finalize (object);
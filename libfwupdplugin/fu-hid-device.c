@@ -8,6 +8,7 @@
 
 #include "config.h"
 
+#include "fu-device-private.h"
 #include "fu-hid-device.h"
 
 #define FU_HID_REPORT_GET				0x01
@@ -110,10 +111,11 @@ fu_hid_device_open (FuUsbDevice *device, GError **error)
 		g_debug ("autodetected HID interface of 0x%02x", priv->interface);
 	}
 
-	/* claim */
+	/* claim, unless all the requests are being played back */
 	if ((priv->flags & FU_HID_DEVICE_FLAG_NO_KERNEL_UNBIND) == 0)
 		flags |= G_USB_DEVICE_CLAIM_INTERFACE_BIND_KERNEL_DRIVER;
-	if (!g_usb_device_claim_interface (usb_device, priv->interface, flags, error)) {
+	if (fu_device_get_emulation (FU_DEVICE (self)) != FU_DEVICE_EMULATION_REPLAY &&
+	    !g_usb_device_claim_interface (usb_device, priv->interface, flags, error)) {
 		g_prefix_error (error, "failed to claim HID interface: ");
 		return FALSE;
 	}
@@ -144,6 +146,10 @@ fu_hid_device_close (FuUsbDevice *device, GError **error)
 			return FALSE;
 	}
 
+	/* nothing was claimed */
+	if (fu_device_get_emulation (FU_DEVICE (self)) == FU_DEVICE_EMULATION_REPLAY)
+		return TRUE;
+
 	/* release */
 	if ((priv->flags & FU_HID_DEVICE_FLAG_NO_KERNEL_REBIND) == 0)
 		flags |= G_USB_DEVICE_CLAIM_INTERFACE_BIND_KERNEL_DRIVER;
@@ -238,7 +244,6 @@ fu_hid_device_set_report_internal (FuHidDevice *self,
 				   GError **error)
 {
 	FuHidDevicePrivate *priv = GET_PRIVATE (self);
-	GUsbDevice *usb_device;
 	gsize actual_len = 0;
 	guint16 wvalue = (FU_HID_REPORT_TYPE_OUTPUT << 8) | helper->value;
 
@@ -253,17 +258,17 @@ fu_hid_device_set_report_internal (FuHidDevice *self,
 		fu_common_dump_raw (G_LOG_DOMAIN, title,
 				    helper->buf, helper->bufsz);
 	}
-	usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_CLASS,
-					    G_USB_DEVICE_RECIPIENT_INTERFACE,
-					    FU_HID_REPORT_SET,
-					    wvalue, priv->interface,
-					    helper->buf, helper->bufsz,
-					    &actual_len,
-					    helper->timeout,
-					    NULL, error)) {
+
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_INTERFACE,
+					     FU_HID_REPORT_SET,
+					     wvalue, priv->interface,
+					     helper->buf, helper->bufsz,
+					     &actual_len,
+					     helper->timeout,
+					     NULL, error)) {
 		g_prefix_error (error, "failed to SetReport: ");
 		return FALSE;
 	}
@@ -342,7 +347,6 @@ fu_hid_device_get_report_internal (FuHidDevice *self,
 				   GError **error)
 {
 	FuHidDevicePrivate *priv = GET_PRIVATE (self);
-	GUsbDevice *usb_device;
 	gsize actual_len = 0;
 	guint16 wvalue = (FU_HID_REPORT_TYPE_INPUT << 8) | helper->value;
 
@@ -357,17 +361,17 @@ fu_hid_device_get_report_internal (FuHidDevice *self,
 		fu_common_dump_raw (G_LOG_DOMAIN, title,
 				    helper->buf, actual_len);
 	}
-	usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					    G_USB_DEVICE_REQUEST_TYPE_CLASS,
-					    G_USB_DEVICE_RECIPIENT_INTERFACE,
-					    FU_HID_REPORT_GET,
-					    wvalue, priv->interface,
-					    helper->buf, helper->bufsz,
-					    &actual_len, /* actual length */
-					    helper->timeout,
-					    NULL, error)) {
+
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_INTERFACE,
+					     FU_HID_REPORT_GET,
+					     wvalue, priv->interface,
+					     helper->buf, helper->bufsz,
+					     &actual_len, /* actual length */
+					     helper->timeout,
+					     NULL, error)) {
 		g_prefix_error (error, "failed to GetReport: ");
 		return FALSE;
 	}
@@ -20,11 +20,13 @@
 
 #include "fwupd-error.h"
 #include "fu-common.h"
+#include "fu-device-private.h"
 #include "fu-io-channel.h"
 
 struct _FuIOChannel {
 	GObject			 parent_instance;
 	gint			 fd;
+	FuDevice		*device;	/* weak, for emulation */
 };
 
 G_DEFINE_TYPE (FuIOChannel, fu_io_channel, G_TYPE_OBJECT)
@@ -61,6 +63,8 @@ gboolean
 fu_io_channel_shutdown (FuIOChannel *self, GError **error)
 {
 	g_return_val_if_fail (FU_IS_IO_CHANNEL (self), FALSE);
+	if (self->fd == -1)
+		return TRUE;
 	if (!g_close (self->fd, error))
 		return FALSE;
 	self->fd = -1;
@@ -133,32 +137,23 @@ fu_io_channel_write_byte_array (FuIOChannel *self,
 	return fu_io_channel_write_raw (self, buf->data, buf->len, timeout_ms, flags, error);
 }
 
-/**
- * fu_io_channel_write_raw:
- * @self: a #FuIOChannel
- * @data: buffer to write
- * @datasz: size of @data
- * @timeout_ms: timeout in ms
- * @flags: some #FuIOChannelFlags, e.g. %FU_IO_CHANNEL_FLAG_SINGLE_SHOT
- * @error: a #GError, or %NULL
- *
- * Writes bytes to the TTY, that will fail if exceeding @timeout_ms.
- *
- * Returns: %TRUE if all the bytes was written
- *
- * Since: 1.2.2
- **/
-gboolean
-fu_io_channel_write_raw (FuIOChannel *self,
-			 const guint8 *data,
-			 gsize datasz,
-			 guint timeout_ms,
-			 FuIOChannelFlags flags,
-			 GError **error)
+static FuDeviceEmulation
+fu_io_channel_get_emulation (FuIOChannel *self)
 {
-	gsize idx = 0;
+	if (self->device == NULL)
+		return FU_DEVICE_EMULATION_NONE;
+	return fu_device_get_emulation (self->device);
+}
 
-	g_return_val_if_fail (FU_IS_IO_CHANNEL (self), FALSE);
+static gboolean
+fu_io_channel_write_raw_real (FuIOChannel *self,
+			      const guint8 *data,
+			      gsize datasz,
+			      guint timeout_ms,
+			      FuIOChannelFlags flags,
+			      GError **error)
+{
+	gsize idx = 0;
 
 	/* flush pending reads */
 	if (flags & FU_IO_CHANNEL_FLAG_FLUSH_INPUT) {
@@ -229,6 +224,65 @@ fu_io_channel_write_raw (FuIOChannel *self,
 	return TRUE;
 }
 
+/**
+ * fu_io_channel_write_raw:
+ * @self: a #FuIOChannel
+ * @data: buffer to write
+ * @datasz: size of @data
+ * @timeout_ms: timeout in ms
+ * @flags: some #FuIOChannelFlags, e.g. %FU_IO_CHANNEL_FLAG_SINGLE_SHOT
+ * @error: a #GError, or %NULL
+ *
+ * Writes bytes to the TTY, that will fail if exceeding @timeout_ms.
+ *
+ * Returns: %TRUE if all the bytes was written
+ *
+ * Since: 1.2.2
+ **/
+gboolean
+fu_io_channel_write_raw (FuIOChannel *self,
+			 const guint8 *data,
+			 gsize datasz,
+			 guint timeout_ms,
+			 FuIOChannelFlags flags,
+			 GError **error)
+{
+	FuDeviceEmulation emulation = fu_io_channel_get_emulation (self);
+	FuDeviceEvent *event = NULL;
+	gboolean ret;
+	gint64 start_time = 0;
+	g_autofree gchar *event_id = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	g_return_val_if_fail (FU_IS_IO_CHANNEL (self), FALSE);
+
+	/* recording or playing back */
+	if (emulation != FU_DEVICE_EMULATION_NONE) {
+		g_autofree gchar *data_base64 = g_base64_encode (data, datasz);
+		event_id = g_strdup_printf ("Write:Data=%s", data_base64);
+	}
+	if (emulation == FU_DEVICE_EMULATION_REPLAY) {
+		event = fu_device_load_event (self->device, event_id, error);
+		if (event == NULL)
+			return FALSE;
+		return fu_device_event_check_error (event, error);
+	}
+	if (emulation == FU_DEVICE_EMULATION_RECORD) {
+		event = fu_device_save_event (self->device, event_id);
+		start_time = g_get_monotonic_time ();
+	}
+	ret = fu_io_channel_write_raw_real (self, data, datasz, timeout_ms,
+					    flags, &error_local);
+	if (event != NULL) {
+		fu_device_event_set_duration (event, g_get_monotonic_time () - start_time);
+		fu_device_event_set_error (event, error_local);
+	}
+	if (!ret) {
+		g_propagate_error (error, g_steal_pointer (&error_local));
+		return FALSE;
+	}
+	return TRUE;
+}
 
 /**
  * fu_io_channel_read_bytes:
@@ -261,26 +315,12 @@ fu_io_channel_read_bytes (FuIOChannel *self,
 	return g_byte_array_free_to_bytes (buf);
 }
 
-/**
- * fu_io_channel_read_byte_array:
- * @self: a #FuIOChannel
- * @max_size: maximum size of the returned blob, or -1 for no limit
- * @timeout_ms: timeout in ms
- * @flags: some #FuIOChannelFlags, e.g. %FU_IO_CHANNEL_FLAG_SINGLE_SHOT
- * @error: a #GError, or %NULL
- *
- * Reads bytes from the TTY, that will fail if exceeding @timeout_ms.
- *
- * Returns: (transfer full): a #GByteArray, or %NULL for error
- *
- * Since: 1.3.2
- **/
-GByteArray *
-fu_io_channel_read_byte_array (FuIOChannel *self,
-			       gssize max_size,
-			       guint timeout_ms,
-			       FuIOChannelFlags flags,
-			       GError **error)
+static GByteArray *
+fu_io_channel_read_byte_array_real (FuIOChannel *self,
+				    gssize max_size,
+				    guint timeout_ms,
+				    FuIOChannelFlags flags,
+				    GError **error)
 {
 	GPollFD fds = {
 		.fd = self->fd,
@@ -288,8 +328,6 @@ fu_io_channel_read_byte_array (FuIOChannel *self,
 	};
 	g_autoptr(GByteArray) buf2 = g_byte_array_new ();
 
-	g_return_val_if_fail (FU_IS_IO_CHANNEL (self), NULL);
-
 	/* blocking IO */
 	if (flags & FU_IO_CHANNEL_FLAG_USE_BLOCKING_IO) {
 		guint8 buf[1024];
@@ -391,6 +429,77 @@ fu_io_channel_read_byte_array (FuIOChannel *self,
 	return g_steal_pointer (&buf2);
 }
 
+/**
+ * fu_io_channel_read_byte_array:
+ * @self: a #FuIOChannel
+ * @max_size: maximum size of the returned blob, or -1 for no limit
+ * @timeout_ms: timeout in ms
+ * @flags: some #FuIOChannelFlags, e.g. %FU_IO_CHANNEL_FLAG_SINGLE_SHOT
+ * @error: a #GError, or %NULL
+ *
+ * Reads bytes from the TTY, that will fail if exceeding @timeout_ms.
+ *
+ * Returns: (transfer full): a #GByteArray, or %NULL for error
+ *
+ * Since: 1.3.2
+ **/
+GByteArray *
+fu_io_channel_read_byte_array (FuIOChannel *self,
+			       gssize max_size,
+			       guint timeout_ms,
+			       FuIOChannelFlags flags,
+			       GError **error)
+{
+	FuDeviceEmulation emulation = fu_io_channel_get_emulation (self);
+	FuDeviceEvent *event = NULL;
+	gint64 start_time = 0;
+	g_autofree gchar *event_id = NULL;
+	g_autoptr(GByteArray) buf = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	g_return_val_if_fail (FU_IS_IO_CHANNEL (self), NULL);
+
+	/* recording or playing back */
+	if (emulation != FU_DEVICE_EMULATION_NONE) {
+		event_id = g_strdup_printf ("Read:MaxSize=%" G_GSSIZE_FORMAT ",Flags=0x%x",
+					    max_size, (guint) flags);
+	}
+	if (emulation == FU_DEVICE_EMULATION_REPLAY) {
+		const gchar *data_base64;
+		gsize datasz = 0;
+		g_autofree guchar *data = NULL;
+		event = fu_device_load_event (self->device, event_id, error);
+		if (event == NULL)
+			return NULL;
+		if (!fu_device_event_check_error (event, error))
+			return NULL;
+		data_base64 = fu_device_event_get_str (event, "Data", error);
+		if (data_base64 == NULL)
+			return NULL;
+		data = g_base64_decode (data_base64, &datasz);
+		buf = g_byte_array_new ();
+		g_byte_array_append (buf, data, datasz);
+		return g_steal_pointer (&buf);
+	}
+	if (emulation == FU_DEVICE_EMULATION_RECORD) {
+		event = fu_device_save_event (self->device, event_id);
+		start_time = g_get_monotonic_time ();
+	}
+	buf = fu_io_channel_read_byte_array_real (self, max_size, timeout_ms,
+						  flags, &error_local);
+	if (event != NULL) {
+		fu_device_event_set_duration (event, g_get_monotonic_time () - start_time);
+		fu_device_event_set_error (event, error_local);
+		if (buf != NULL)
+			fu_device_event_set_data (event, "Data", buf->data, buf->len);
+	}
+	if (buf == NULL) {
+		g_propagate_error (error, g_steal_pointer (&error_local));
+		return NULL;
+	}
+	return g_steal_pointer (&buf);
+}
+
 /**
  * fu_io_channel_read_raw:
  * @self: a #FuIOChannel
@@ -439,6 +548,8 @@ fu_io_channel_finalize (GObject *object)
 	FuIOChannel *self = FU_IO_CHANNEL (object);
 	if (self->fd != -1)
 		g_close (self->fd, NULL);
+	if (self->device != NULL)
+		g_object_remove_weak_pointer (G_OBJECT (self->device), (gpointer *) &self->device);
 	G_OBJECT_CLASS (fu_io_channel_parent_class)->finalize (object);
 }
 
@@ -506,3 +617,36 @@ fu_io_channel_new_file (const gchar *filename, GError **error)
 	return NULL;
 #endif
 }
+
+/**
+ * fu_io_channel_new_for_device:
+ * @device: a #FuDevice
+ * @filename: (nullable): device file
+ * @error: a #GError, or %NULL
+ *
+ * Creates a new object to write and read from, where the requests are recorded
+ * or played back when @device is being emulated. The file is not opened when
+ * the requests are being played back.
+ *
+ * Returns: a #FuIOChannel
+ *
+ * Since: 1.5.2
+ **/
+FuIOChannel *
+fu_io_channel_new_for_device (FuDevice *device, const gchar *filename, GError **error)
+{
+	FuIOChannel *self;
+
+	g_return_val_if_fail (FU_IS_DEVICE (device), NULL);
+
+	if (fu_device_get_emulation (device) == FU_DEVICE_EMULATION_REPLAY) {
+		self = fu_io_channel_unix_new (-1);
+	} else {
+		self = fu_io_channel_new_file (filename, error);
+		if (self == NULL)
+			return NULL;
+	}
+	self->device = device;
+	g_object_add_weak_pointer (G_OBJECT (device), (gpointer *) &self->device);
+	return self;
+}
@@ -8,6 +8,8 @@
 
 #include <glib-object.h>
 
+#include "fu-device.h"
+
 #define FU_TYPE_IO_CHANNEL (fu_io_channel_get_type ())
 
 G_DECLARE_FINAL_TYPE (FuIOChannel, fu_io_channel, FU, IO_CHANNEL, GObject)
@@ -33,6 +35,9 @@ typedef enum {
 FuIOChannel	*fu_io_channel_unix_new		(gint		 fd);
 FuIOChannel	*fu_io_channel_new_file		(const gchar	*filename,
 						 GError		**error);
+FuIOChannel	*fu_io_channel_new_for_device	(FuDevice	*device,
+						 const gchar	*filename,
+						 GError		**error);
 
 gint		 fu_io_channel_unix_get_fd	(FuIOChannel	*self);
 gboolean	 fu_io_channel_shutdown		(FuIOChannel	*self,
@@ -11,6 +11,38 @@
 #include "fu-security-attrs.h"
 #include "fu-smbios.h"
 
+typedef enum {
+	FU_PLUGIN_VFUNC_INIT,
+	FU_PLUGIN_VFUNC_DESTROY,
+	FU_PLUGIN_VFUNC_STARTUP,
+	FU_PLUGIN_VFUNC_COLDPLUG,
+	FU_PLUGIN_VFUNC_COLDPLUG_PREPARE,
+	FU_PLUGIN_VFUNC_COLDPLUG_CLEANUP,
+	FU_PLUGIN_VFUNC_RECOLDPLUG,
+	FU_PLUGIN_VFUNC_COMPOSITE_PREPARE,
+	FU_PLUGIN_VFUNC_COMPOSITE_CLEANUP,
+	FU_PLUGIN_VFUNC_UPDATE_PREPARE,
+	FU_PLUGIN_VFUNC_UPDATE_CLEANUP,
+	FU_PLUGIN_VFUNC_UPDATE_ATTACH,
+	FU_PLUGIN_VFUNC_UPDATE_DETACH,
+	FU_PLUGIN_VFUNC_UPDATE,
+	FU_PLUGIN_VFUNC_ACTIVATE,
+	FU_PLUGIN_VFUNC_UNLOCK,
+	FU_PLUGIN_VFUNC_VERIFY,
+	FU_PLUGIN_VFUNC_CLEAR_RESULTS,
+	FU_PLUGIN_VFUNC_GET_RESULTS,
+	FU_PLUGIN_VFUNC_ADD_SECURITY_ATTRS,
+	FU_PLUGIN_VFUNC_USB_DEVICE_ADDED,
+	FU_PLUGIN_VFUNC_UDEV_DEVICE_ADDED,
+	FU_PLUGIN_VFUNC_UDEV_DEVICE_CHANGED,
+	FU_PLUGIN_VFUNC_DEVICE_ADDED,
+	FU_PLUGIN_VFUNC_DEVICE_REMOVED,
+	FU_PLUGIN_VFUNC_DEVICE_REGISTERED,
+	FU_PLUGIN_VFUNC_DEVICE_CREATED,
+	/*< private >*/
+	FU_PLUGIN_VFUNC_LAST
+} FuPluginVfunc;
+
 FuPlugin	*fu_plugin_new				(void);
 gboolean	 fu_plugin_is_open			(FuPlugin	*self);
 void		 fu_plugin_set_usb_context		(FuPlugin	*self,
@@ -42,6 +74,10 @@ gboolean	 fu_plugin_has_rule			(FuPlugin	*self,
 							 FuPluginRule	 rule,
 							 const gchar	*name);
 GHashTable	*fu_plugin_get_report_metadata		(FuPlugin	*self);
+guint		 fu_plugin_get_runner_duration		(FuPlugin	*self,
+							 const gchar	*vfunc_name);
+gboolean	 fu_plugin_has_vfunc			(FuPlugin	*self,
+							 FuPluginVfunc	 vfunc);
 gboolean	 fu_plugin_open				(FuPlugin	*self,
 							 const gchar	*filename,
 							 GError		**error);
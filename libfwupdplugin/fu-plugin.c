@@ -36,6 +36,7 @@ static void fu_plugin_finalize			 (GObject *object);
 
 typedef struct {
 	GModule			*module;
+	gpointer		 vfuncs[FU_PLUGIN_VFUNC_LAST];	/* resolved in open */
 	GUsbContext		*usb_ctx;
 	guint			 order;
 	guint			 priority;
@@ -51,6 +52,9 @@ typedef struct {
 	GHashTable		*devices;		/* (nullable): platform_id:GObject */
 	GRWLock			 devices_mutex;
 	GHashTable		*report_metadata;	/* (nullable): key:value */
+	GHashTable		*runner_durations;	/* vfunc:us */
+	GMainContext		*main_ctx;
+	GThread			*main_thread;		/* (not owned) */
 	FuPluginData		*data;
 } FuPluginPrivate;
 
@@ -72,6 +76,37 @@ static guint signals[SIGNAL_LAST] = { 0 };
 G_DEFINE_TYPE_WITH_PRIVATE (FuPlugin, fu_plugin, FWUPD_TYPE_PLUGIN)
 #define GET_PRIVATE(o) (fu_plugin_get_instance_private (o))
 
+/* symbols looked up in the plugin module, indexed by #FuPluginVfunc */
+static const gchar *fu_plugin_vfunc_names[FU_PLUGIN_VFUNC_LAST] = {
+	[FU_PLUGIN_VFUNC_INIT] = "fu_plugin_init",
+	[FU_PLUGIN_VFUNC_DESTROY] = "fu_plugin_destroy",
+	[FU_PLUGIN_VFUNC_STARTUP] = "fu_plugin_startup",
+	[FU_PLUGIN_VFUNC_COLDPLUG] = "fu_plugin_coldplug",
+	[FU_PLUGIN_VFUNC_COLDPLUG_PREPARE] = "fu_plugin_coldplug_prepare",
+	[FU_PLUGIN_VFUNC_COLDPLUG_CLEANUP] = "fu_plugin_coldplug_cleanup",
+	[FU_PLUGIN_VFUNC_RECOLDPLUG] = "fu_plugin_recoldplug",
+	[FU_PLUGIN_VFUNC_COMPOSITE_PREPARE] = "fu_plugin_composite_prepare",
+	[FU_PLUGIN_VFUNC_COMPOSITE_CLEANUP] = "fu_plugin_composite_cleanup",
+	[FU_PLUGIN_VFUNC_UPDATE_PREPARE] = "fu_plugin_update_prepare",
+	[FU_PLUGIN_VFUNC_UPDATE_CLEANUP] = "fu_plugin_update_cleanup",
+	[FU_PLUGIN_VFUNC_UPDATE_ATTACH] = "fu_plugin_update_attach",
+	[FU_PLUGIN_VFUNC_UPDATE_DETACH] = "fu_plugin_update_detach",
+	[FU_PLUGIN_VFUNC_UPDATE] = "fu_plugin_update",
+	[FU_PLUGIN_VFUNC_ACTIVATE] = "fu_plugin_activate",
+	[FU_PLUGIN_VFUNC_UNLOCK] = "fu_plugin_unlock",
+	[FU_PLUGIN_VFUNC_VERIFY] = "fu_plugin_verify",
+	[FU_PLUGIN_VFUNC_CLEAR_RESULTS] = "fu_plugin_clear_results",
+	[FU_PLUGIN_VFUNC_GET_RESULTS] = "fu_plugin_get_results",
+	[FU_PLUGIN_VFUNC_ADD_SECURITY_ATTRS] = "fu_plugin_add_security_attrs",
+	[FU_PLUGIN_VFUNC_USB_DEVICE_ADDED] = "fu_plugin_usb_device_added",
+	[FU_PLUGIN_VFUNC_UDEV_DEVICE_ADDED] = "fu_plugin_udev_device_added",
+	[FU_PLUGIN_VFUNC_UDEV_DEVICE_CHANGED] = "fu_plugin_udev_device_changed",
+	[FU_PLUGIN_VFUNC_DEVICE_ADDED] = "fu_plugin_device_added",
+	[FU_PLUGIN_VFUNC_DEVICE_REMOVED] = "fu_plugin_device_removed",
+	[FU_PLUGIN_VFUNC_DEVICE_REGISTERED] = "fu_plugin_device_registered",
+	[FU_PLUGIN_VFUNC_DEVICE_CREATED] = "fu_plugin_device_created",
+};
+
 typedef const gchar	*(*FuPluginGetNameFunc)		(void);
 typedef void		 (*FuPluginInitFunc)		(FuPlugin	*self);
 typedef gboolean	 (*FuPluginStartupFunc)		(FuPlugin	*self,
@@ -106,6 +141,103 @@ typedef gboolean	 (*FuPluginUdevDeviceAddedFunc)	(FuPlugin	*self,
 typedef void		 (*FuPluginSecurityAttrsFunc)	(FuPlugin	*self,
 							 FuSecurityAttrs *attrs);
 
+typedef struct {
+	guint			 signal_id;
+	const GValue		*params;		/* instance and arguments */
+	GValue			*retval;		/* (nullable) */
+	gboolean		 done;
+	GMutex			 mutex;
+	GCond			 cond;
+} FuPluginEmitHelper;
+
+static void
+fu_plugin_emit_signal_direct (FuPluginEmitHelper *helper)
+{
+	g_signal_emitv (helper->params, helper->signal_id, 0, helper->retval);
+}
+
+static gboolean
+fu_plugin_emit_signal_idle_cb (gpointer user_data)
+{
+	FuPluginEmitHelper *helper = (FuPluginEmitHelper *) user_data;
+	fu_plugin_emit_signal_direct (helper);
+	g_mutex_lock (&helper->mutex);
+	helper->done = TRUE;
+	g_cond_signal (&helper->cond);
+	g_mutex_unlock (&helper->mutex);
+	return G_SOURCE_REMOVE;
+}
+
+/* the daemon is not thread safe, so when a plugin vfunc is being run from a
+ * worker thread proxy the signal to the thread that created the plugin and
+ * block until it has been handled */
+static void
+fu_plugin_emit_signalv (FuPlugin *self, guint signal_id, const GValue *params, GValue *retval)
+{
+	FuPluginPrivate *priv = GET_PRIVATE (self);
+	FuPluginEmitHelper helper = {
+		.signal_id = signal_id,
+		.params = params,
+		.retval = retval,
+	};
+	g_autoptr(GSource) source = NULL;
+
+	/* fast path */
+	if (g_thread_self () == priv->main_thread) {
+		fu_plugin_emit_signal_direct (&helper);
+		return;
+	}
+
+	/* do not use g_main_context_invoke() as that can run the callback in
+	 * this thread if the main context is not currently being iterated */
+	g_mutex_init (&helper.mutex);
+	g_cond_init (&helper.cond);
+	source = g_idle_source_new ();
+	g_source_set_callback (source, fu_plugin_emit_signal_idle_cb, &helper, NULL);
+	g_source_attach (source, priv->main_ctx);
+	g_mutex_lock (&helper.mutex);
+	while (!helper.done)
+		g_cond_wait (&helper.cond, &helper.mutex);
+	g_mutex_unlock (&helper.mutex);
+	g_mutex_clear (&helper.mutex);
+	g_cond_clear (&helper.cond);
+}
+
+/* for signals with no arguments, or one object or string argument */
+static gboolean
+fu_plugin_emit_signal (FuPlugin *self, guint signal_id, gpointer data)
+{
+	GSignalQuery query;
+	GValue params[2] = { G_VALUE_INIT, G_VALUE_INIT };
+	GValue retval = G_VALUE_INIT;
+	gboolean ret = FALSE;
+
+	g_signal_query (signal_id, &query);
+	g_value_init (&params[0], G_TYPE_FROM_INSTANCE (self));
+	g_value_set_object (&params[0], self);
+	if (query.n_params > 0) {
+		GType gtype = query.param_types[0] & ~G_SIGNAL_TYPE_STATIC_SCOPE;
+		g_value_init (&params[1], gtype);
+		if (gtype == G_TYPE_STRING)
+			g_value_set_string (&params[1], data);
+		else
+			g_value_set_object (&params[1], data);
+	}
+	if (query.return_type != G_TYPE_NONE)
+		g_value_init (&retval, query.return_type & ~G_SIGNAL_TYPE_STATIC_SCOPE);
+	fu_plugin_emit_signalv (self, signal_id, params,
+				G_IS_VALUE (&retval) ? &retval : NULL);
+	if (G_VALUE_HOLDS_BOOLEAN (&retval))
+		ret = g_value_get_boolean (&retval);
+	for (guint i = 0; i < G_N_ELEMENTS (params); i++) {
+		if (G_IS_VALUE (&params[i]))
+			g_value_unset (&params[i]);
+	}
+	if (G_IS_VALUE (&retval))
+		g_value_unset (&retval);
+	return ret;
+}
+
 /**
  * fu_plugin_is_open:
  * @self: A #FuPlugin
@@ -442,8 +574,15 @@ fu_plugin_open (FuPlugin *self, const gchar *filename, GError **error)
 		fu_plugin_set_name (self, str);
 	}
 
+	/* resolve all the vfuncs now rather than on each call */
+	for (guint i = 0; i < FU_PLUGIN_VFUNC_LAST; i++) {
+		g_module_symbol (priv->module,
+				 fu_plugin_vfunc_names[i],
+				 &priv->vfuncs[i]);
+	}
+
 	/* optional */
-	g_module_symbol (priv->module, "fu_plugin_init", (gpointer *) &func);
+	func = (FuPluginInitFunc) priv->vfuncs[FU_PLUGIN_VFUNC_INIT];
 	if (func != NULL) {
 		g_debug ("init(%s)", filename);
 		func (self);
@@ -523,7 +662,7 @@ fu_plugin_device_add (FuPlugin *self, FuDevice *device)
 		 fu_device_get_id (device));
 	fu_device_set_created (device, (guint64) g_get_real_time () / G_USEC_PER_SEC);
 	fu_device_set_plugin (device, fu_plugin_get_name (self));
-	g_signal_emit (self, signals[SIGNAL_DEVICE_ADDED], 0, device);
+	fu_plugin_emit_signal (self, signals[SIGNAL_DEVICE_ADDED], device);
 
 	/* add children if they have not already been added */
 	children = fu_device_get_children (device);
@@ -565,7 +704,7 @@ fu_plugin_device_register (FuPlugin *self, FuDevice *device)
 	g_debug ("emit device-register from %s: %s",
 		 fu_plugin_get_name (self),
 		 fu_device_get_id (device));
-	g_signal_emit (self, signals[SIGNAL_DEVICE_REGISTER], 0, device);
+	fu_plugin_emit_signal (self, signals[SIGNAL_DEVICE_REGISTER], device);
 }
 
 /**
@@ -586,7 +725,7 @@ fu_plugin_device_remove (FuPlugin *self, FuDevice *device)
 	g_debug ("emit removed from %s: %s",
 		 fu_plugin_get_name (self),
 		 fu_device_get_id (device));
-	g_signal_emit (self, signals[SIGNAL_DEVICE_REMOVED], 0, device);
+	fu_plugin_emit_signal (self, signals[SIGNAL_DEVICE_REMOVED], device);
 }
 
 /**
@@ -602,7 +741,7 @@ void
 fu_plugin_request_recoldplug (FuPlugin *self)
 {
 	g_return_if_fail (FU_IS_PLUGIN (self));
-	g_signal_emit (self, signals[SIGNAL_RECOLDPLUG], 0);
+	fu_plugin_emit_signal (self, signals[SIGNAL_RECOLDPLUG], NULL);
 }
 
 /**
@@ -617,7 +756,7 @@ void
 fu_plugin_security_changed (FuPlugin *self)
 {
 	g_return_if_fail (FU_IS_PLUGIN (self));
-	g_signal_emit (self, signals[SIGNAL_SECURITY_CHANGED], 0);
+	fu_plugin_emit_signal (self, signals[SIGNAL_SECURITY_CHANGED], NULL);
 }
 
 /**
@@ -740,9 +879,8 @@ fu_plugin_has_custom_flag (FuPlugin *self, const gchar *flag)
 static gboolean
 fu_plugin_check_supported (FuPlugin *self, const gchar *guid)
 {
-	gboolean retval = FALSE;
-	g_signal_emit (self, signals[SIGNAL_CHECK_SUPPORTED], 0, guid, &retval);
-	return retval;
+	return fu_plugin_emit_signal (self, signals[SIGNAL_CHECK_SUPPORTED],
+				      (gpointer) guid);
 }
 
 /**
@@ -1035,6 +1173,8 @@ fu_plugin_set_smbios (FuPlugin *self, FuSmbios *smbios)
 void
 fu_plugin_set_coldplug_delay (FuPlugin *self, guint duration)
 {
+	GValue params[2] = { G_VALUE_INIT, G_VALUE_INIT };
+
 	g_return_if_fail (FU_IS_PLUGIN (self));
 	g_return_if_fail (duration > 0);
 
@@ -1047,7 +1187,13 @@ fu_plugin_set_coldplug_delay (FuPlugin *self, guint duration)
 	}
 
 	/* emit */
-	g_signal_emit (self, signals[SIGNAL_SET_COLDPLUG_DELAY], 0, duration);
+	g_value_init (&params[0], G_TYPE_FROM_INSTANCE (self));
+	g_value_set_object (&params[0], self);
+	g_value_init (&params[1], G_TYPE_UINT);
+	g_value_set_uint (&params[1], duration);
+	fu_plugin_emit_signalv (self, signals[SIGNAL_SET_COLDPLUG_DELAY], params, NULL);
+	g_value_unset (&params[0]);
+	g_value_unset (&params[1]);
 }
 
 static gboolean
@@ -1157,6 +1303,71 @@ fu_plugin_device_read_firmware (FuPlugin *self, FuDevice *device, GError **error
 	return fu_device_attach (device, error);
 }
 
+/* record how long each phase took so that slow plugins can be identified;
+ * only the first run is kept so that a recoldplug does not hide the time
+ * taken at startup */
+static gboolean
+fu_plugin_runner_func_timed (FuPlugin *self,
+			     FuPluginStartupFunc func,
+			     const gchar *vfunc_name,
+			     GError **error)
+{
+	FuPluginPrivate *priv = GET_PRIVATE (self);
+	gboolean ret;
+	gint64 duration;
+	gint64 start = g_get_monotonic_time ();
+
+	ret = func (self, error);
+	if (g_hash_table_contains (priv->runner_durations, vfunc_name))
+		return ret;
+	duration = MAX (g_get_monotonic_time () - start, 1);
+	g_hash_table_insert (priv->runner_durations,
+			     g_strdup (vfunc_name),
+			     GUINT_TO_POINTER ((guint) duration));
+	return ret;
+}
+
+/**
+ * fu_plugin_get_runner_duration:
+ * @self: a #FuPlugin
+ * @vfunc_name: a vfunc name, e.g. `coldplug`
+ *
+ * Gets how long the vfunc took to run the first time it was called, which is
+ * normally when the daemon was starting.
+ *
+ * Returns: duration in microseconds, or 0 if never run
+ *
+ * Since: 1.5.2
+ **/
+guint
+fu_plugin_get_runner_duration (FuPlugin *self, const gchar *vfunc_name)
+{
+	FuPluginPrivate *priv = GET_PRIVATE (self);
+	g_return_val_if_fail (FU_IS_PLUGIN (self), 0);
+	g_return_val_if_fail (vfunc_name != NULL, 0);
+	return GPOINTER_TO_UINT (g_hash_table_lookup (priv->runner_durations, vfunc_name));
+}
+
+/**
+ * fu_plugin_has_vfunc:
+ * @self: a #FuPlugin
+ * @vfunc: a #FuPluginVfunc, e.g. %FU_PLUGIN_VFUNC_DEVICE_REGISTERED
+ *
+ * Finds out if the plugin module implements a specific vfunc.
+ *
+ * Returns: %TRUE if the vfunc is implemented
+ *
+ * Since: 1.5.2
+ **/
+gboolean
+fu_plugin_has_vfunc (FuPlugin *self, FuPluginVfunc vfunc)
+{
+	FuPluginPrivate *priv = GET_PRIVATE (self);
+	g_return_val_if_fail (FU_IS_PLUGIN (self), FALSE);
+	g_return_val_if_fail (vfunc < FU_PLUGIN_VFUNC_LAST, FALSE);
+	return priv->vfuncs[vfunc] != NULL;
+}
+
 /**
  * fu_plugin_runner_startup:
  * @self: a #FuPlugin
@@ -1184,11 +1395,11 @@ fu_plugin_runner_startup (FuPlugin *self, GError **error)
 		return TRUE;
 
 	/* optional */
-	g_module_symbol (priv->module, "fu_plugin_startup", (gpointer *) &func);
+	func = (FuPluginStartupFunc) priv->vfuncs[FU_PLUGIN_VFUNC_STARTUP];
 	if (func == NULL)
 		return TRUE;
 	g_debug ("startup(%s)", fu_plugin_get_name (self));
-	if (!func (self, &error_local)) {
+	if (!fu_plugin_runner_func_timed (self, func, "startup", &error_local)) {
 		if (error_local == NULL) {
 			g_critical ("unset plugin error in startup(%s)",
 				    fu_plugin_get_name (self));
@@ -1207,11 +1418,12 @@ fu_plugin_runner_startup (FuPlugin *self, GError **error)
 
 static gboolean
 fu_plugin_runner_device_generic (FuPlugin *self, FuDevice *device,
-				 const gchar *symbol_name,
+				 FuPluginVfunc vfunc,
 				 FuPluginDeviceFunc device_func,
 				 GError **error)
 {
 	FuPluginPrivate *priv = GET_PRIVATE (self);
+	const gchar *symbol_name = fu_plugin_vfunc_names[vfunc];
 	FuPluginDeviceFunc func = NULL;
 	g_autoptr(GError) error_local = NULL;
 
@@ -1224,7 +1436,7 @@ fu_plugin_runner_device_generic (FuPlugin *self, FuDevice *device,
 		return TRUE;
 
 	/* optional */
-	g_module_symbol (priv->module, symbol_name, (gpointer *) &func);
+	func = (FuPluginDeviceFunc) priv->vfuncs[vfunc];
 	if (func == NULL) {
 		if (device_func != NULL) {
 			g_debug ("running superclassed %s(%s)",
@@ -1254,9 +1466,10 @@ fu_plugin_runner_device_generic (FuPlugin *self, FuDevice *device,
 static gboolean
 fu_plugin_runner_flagged_device_generic (FuPlugin *self, FwupdInstallFlags flags,
 					 FuDevice *device,
-					 const gchar *symbol_name, GError **error)
+					 FuPluginVfunc vfunc, GError **error)
 {
 	FuPluginPrivate *priv = GET_PRIVATE (self);
+	const gchar *symbol_name = fu_plugin_vfunc_names[vfunc];
 	FuPluginFlaggedDeviceFunc func = NULL;
 	g_autoptr(GError) error_local = NULL;
 
@@ -1269,7 +1482,7 @@ fu_plugin_runner_flagged_device_generic (FuPlugin *self, FwupdInstallFlags flags
 		return TRUE;
 
 	/* optional */
-	g_module_symbol (priv->module, symbol_name, (gpointer *) &func);
+	func = (FuPluginFlaggedDeviceFunc) priv->vfuncs[vfunc];
 	if (func == NULL)
 		return TRUE;
 	g_debug ("%s(%s)", symbol_name + 10, fu_plugin_get_name (self));
@@ -1293,9 +1506,10 @@ fu_plugin_runner_flagged_device_generic (FuPlugin *self, FwupdInstallFlags flags
 
 static gboolean
 fu_plugin_runner_device_array_generic (FuPlugin *self, GPtrArray *devices,
-				       const gchar *symbol_name, GError **error)
+				       FuPluginVfunc vfunc, GError **error)
 {
 	FuPluginPrivate *priv = GET_PRIVATE (self);
+	const gchar *symbol_name = fu_plugin_vfunc_names[vfunc];
 	FuPluginDeviceArrayFunc func = NULL;
 	g_autoptr(GError) error_local = NULL;
 
@@ -1308,7 +1522,7 @@ fu_plugin_runner_device_array_generic (FuPlugin *self, GPtrArray *devices,
 		return TRUE;
 
 	/* optional */
-	g_module_symbol (priv->module, symbol_name, (gpointer *) &func);
+	func = (FuPluginDeviceArrayFunc) priv->vfuncs[vfunc];
 	if (func == NULL)
 		return TRUE;
 	g_debug ("%s(%s)", symbol_name + 10, fu_plugin_get_name (self));
@@ -1356,11 +1570,11 @@ fu_plugin_runner_coldplug (FuPlugin *self, GError **error)
 		return TRUE;
 
 	/* optional */
-	g_module_symbol (priv->module, "fu_plugin_coldplug", (gpointer *) &func);
+	func = (FuPluginStartupFunc) priv->vfuncs[FU_PLUGIN_VFUNC_COLDPLUG];
 	if (func == NULL)
 		return TRUE;
 	g_debug ("coldplug(%s)", fu_plugin_get_name (self));
-	if (!func (self, &error_local)) {
+	if (!fu_plugin_runner_func_timed (self, func, "coldplug", &error_local)) {
 		if (error_local == NULL) {
 			g_critical ("unset plugin error in coldplug(%s)",
 				    fu_plugin_get_name (self));
@@ -1403,7 +1617,7 @@ fu_plugin_runner_recoldplug (FuPlugin *self, GError **error)
 		return TRUE;
 
 	/* optional */
-	g_module_symbol (priv->module, "fu_plugin_recoldplug", (gpointer *) &func);
+	func = (FuPluginStartupFunc) priv->vfuncs[FU_PLUGIN_VFUNC_RECOLDPLUG];
 	if (func == NULL)
 		return TRUE;
 	g_debug ("recoldplug(%s)", fu_plugin_get_name (self));
@@ -1451,11 +1665,11 @@ fu_plugin_runner_coldplug_prepare (FuPlugin *self, GError **error)
 		return TRUE;
 
 	/* optional */
-	g_module_symbol (priv->module, "fu_plugin_coldplug_prepare", (gpointer *) &func);
+	func = (FuPluginStartupFunc) priv->vfuncs[FU_PLUGIN_VFUNC_COLDPLUG_PREPARE];
 	if (func == NULL)
 		return TRUE;
 	g_debug ("coldplug_prepare(%s)", fu_plugin_get_name (self));
-	if (!func (self, &error_local)) {
+	if (!fu_plugin_runner_func_timed (self, func, "coldplug_prepare", &error_local)) {
 		if (error_local == NULL) {
 			g_critical ("unset plugin error in coldplug_prepare(%s)",
 				    fu_plugin_get_name (self));
@@ -1499,11 +1713,11 @@ fu_plugin_runner_coldplug_cleanup (FuPlugin *self, GError **error)
 		return TRUE;
 
 	/* optional */
-	g_module_symbol (priv->module, "fu_plugin_coldplug_cleanup", (gpointer *) &func);
+	func = (FuPluginStartupFunc) priv->vfuncs[FU_PLUGIN_VFUNC_COLDPLUG_CLEANUP];
 	if (func == NULL)
 		return TRUE;
 	g_debug ("coldplug_cleanup(%s)", fu_plugin_get_name (self));
-	if (!func (self, &error_local)) {
+	if (!fu_plugin_runner_func_timed (self, func, "coldplug_cleanup", &error_local)) {
 		if (error_local == NULL) {
 			g_critical ("unset plugin error in coldplug_cleanup(%s)",
 				    fu_plugin_get_name (self));
@@ -1536,7 +1750,7 @@ gboolean
 fu_plugin_runner_composite_prepare (FuPlugin *self, GPtrArray *devices, GError **error)
 {
 	return fu_plugin_runner_device_array_generic (self, devices,
-						      "fu_plugin_composite_prepare",
+						      FU_PLUGIN_VFUNC_COMPOSITE_PREPARE,
 						      error);
 }
 
@@ -1556,7 +1770,7 @@ gboolean
 fu_plugin_runner_composite_cleanup (FuPlugin *self, GPtrArray *devices, GError **error)
 {
 	return fu_plugin_runner_device_array_generic (self, devices,
-						      "fu_plugin_composite_cleanup",
+						      FU_PLUGIN_VFUNC_COMPOSITE_CLEANUP,
 						      error);
 }
 
@@ -1576,7 +1790,7 @@ fu_plugin_runner_update_prepare (FuPlugin *self, FwupdInstallFlags flags, FuDevi
 				 GError **error)
 {
 	return fu_plugin_runner_flagged_device_generic (self, flags, device,
-							"fu_plugin_update_prepare",
+							FU_PLUGIN_VFUNC_UPDATE_PREPARE,
 							error);
 }
 
@@ -1596,7 +1810,7 @@ fu_plugin_runner_update_cleanup (FuPlugin *self, FwupdInstallFlags flags, FuDevi
 				 GError **error)
 {
 	return fu_plugin_runner_flagged_device_generic (self, flags, device,
-							"fu_plugin_update_cleanup",
+							FU_PLUGIN_VFUNC_UPDATE_CLEANUP,
 							error);
 }
 
@@ -1616,7 +1830,7 @@ gboolean
 fu_plugin_runner_update_attach (FuPlugin *self, FuDevice *device, GError **error)
 {
 	return fu_plugin_runner_device_generic (self, device,
-						"fu_plugin_update_attach",
+						FU_PLUGIN_VFUNC_UPDATE_ATTACH,
 						fu_plugin_device_attach,
 						error);
 }
@@ -1637,7 +1851,7 @@ gboolean
 fu_plugin_runner_update_detach (FuPlugin *self, FuDevice *device, GError **error)
 {
 	return fu_plugin_runner_device_generic (self, device,
-						"fu_plugin_update_detach",
+						FU_PLUGIN_VFUNC_UPDATE_DETACH,
 						fu_plugin_device_detach,
 						error);
 }
@@ -1683,14 +1897,14 @@ fu_plugin_runner_add_security_attrs (FuPlugin *self, FuSecurityAttrs *attrs)
 {
 	FuPluginPrivate *priv = GET_PRIVATE (self);
 	FuPluginSecurityAttrsFunc func = NULL;
-	const gchar *symbol_name = "fu_plugin_add_security_attrs";
+	const gchar *symbol_name = fu_plugin_vfunc_names[FU_PLUGIN_VFUNC_ADD_SECURITY_ATTRS];
 
 	/* no object loaded */
 	if (priv->module == NULL)
 		return;
 
 	/* optional, but gets called even for disabled plugins */
-	g_module_symbol (priv->module, symbol_name, (gpointer *) &func);
+	func = (FuPluginSecurityAttrsFunc) priv->vfuncs[FU_PLUGIN_VFUNC_ADD_SECURITY_ATTRS];
 	if (func == NULL)
 		return;
 	g_debug ("%s(%s)", symbol_name + 10, fu_plugin_get_name (self));
@@ -1759,7 +1973,17 @@ fu_plugin_set_device_gtype (FuPlugin *self, GType device_gtype)
 void
 fu_plugin_add_firmware_gtype (FuPlugin *self, const gchar *id, GType gtype)
 {
-	g_signal_emit (self, signals[SIGNAL_ADD_FIRMWARE_GTYPE], 0, id, gtype);
+	GValue params[3] = { G_VALUE_INIT, G_VALUE_INIT, G_VALUE_INIT };
+
+	g_value_init (&params[0], G_TYPE_FROM_INSTANCE (self));
+	g_value_set_object (&params[0], self);
+	g_value_init (&params[1], G_TYPE_STRING);
+	g_value_set_string (&params[1], id);
+	g_value_init (&params[2], G_TYPE_GTYPE);
+	g_value_set_gtype (&params[2], gtype);
+	fu_plugin_emit_signalv (self, signals[SIGNAL_ADD_FIRMWARE_GTYPE], params, NULL);
+	for (guint i = 0; i < G_N_ELEMENTS (params); i++)
+		g_value_unset (&params[i]);
 }
 
 static gboolean
@@ -1883,7 +2107,7 @@ fu_plugin_runner_usb_device_added (FuPlugin *self, FuUsbDevice *device, GError *
 		return TRUE;
 
 	/* optional */
-	g_module_symbol (priv->module, "fu_plugin_usb_device_added", (gpointer *) &func);
+	func = (FuPluginUsbDeviceAddedFunc) priv->vfuncs[FU_PLUGIN_VFUNC_USB_DEVICE_ADDED];
 	if (func == NULL) {
 		if (priv->device_gtype != G_TYPE_INVALID ||
 		    fu_device_get_specialized_gtype (FU_DEVICE (device)) != G_TYPE_INVALID) {
@@ -1938,7 +2162,7 @@ fu_plugin_runner_udev_device_added (FuPlugin *self, FuUdevDevice *device, GError
 		return TRUE;
 
 	/* optional */
-	g_module_symbol (priv->module, "fu_plugin_udev_device_added", (gpointer *) &func);
+	func = (FuPluginUdevDeviceAddedFunc) priv->vfuncs[FU_PLUGIN_VFUNC_UDEV_DEVICE_ADDED];
 	if (func == NULL) {
 		if (priv->device_gtype != G_TYPE_INVALID ||
 		    fu_device_get_specialized_gtype (FU_DEVICE (device)) != G_TYPE_INVALID) {
@@ -1993,7 +2217,7 @@ fu_plugin_runner_udev_device_changed (FuPlugin *self, FuUdevDevice *device, GErr
 		return TRUE;
 
 	/* optional */
-	g_module_symbol (priv->module, "fu_plugin_udev_device_changed", (gpointer *) &func);
+	func = (FuPluginUdevDeviceAddedFunc) priv->vfuncs[FU_PLUGIN_VFUNC_UDEV_DEVICE_CHANGED];
 	if (func == NULL)
 		return TRUE;
 	g_debug ("udev_device_changed(%s)", fu_plugin_get_name (self));
@@ -2036,7 +2260,7 @@ fu_plugin_runner_device_added (FuPlugin *self, FuDevice *device)
 		return;
 
 	/* optional */
-	g_module_symbol (priv->module, "fu_plugin_device_added", (gpointer *) &func);
+	func = (FuPluginDeviceRegisterFunc) priv->vfuncs[FU_PLUGIN_VFUNC_DEVICE_ADDED];
 	if (func == NULL)
 		return;
 	g_debug ("fu_plugin_device_added(%s)", fu_plugin_get_name (self));
@@ -2058,7 +2282,7 @@ fu_plugin_runner_device_removed (FuPlugin *self, FuDevice *device)
 	g_autoptr(GError) error_local= NULL;
 
 	if (!fu_plugin_runner_device_generic (self, device,
-					      "fu_plugin_device_removed",
+					      FU_PLUGIN_VFUNC_DEVICE_REMOVED,
 					      NULL,
 					      &error_local))
 		g_warning ("%s", error_local->message);
@@ -2090,7 +2314,7 @@ fu_plugin_runner_device_register (FuPlugin *self, FuDevice *device)
 		return;
 
 	/* optional */
-	g_module_symbol (priv->module, "fu_plugin_device_registered", (gpointer *) &func);
+	func = (FuPluginDeviceRegisterFunc) priv->vfuncs[FU_PLUGIN_VFUNC_DEVICE_REGISTERED];
 	if (func != NULL) {
 		g_debug ("fu_plugin_device_registered(%s)", fu_plugin_get_name (self));
 		func (self, device);
@@ -2122,7 +2346,7 @@ fu_plugin_runner_device_created (FuPlugin *self, FuDevice *device, GError **erro
 		return TRUE;
 
 	/* optional */
-	g_module_symbol (priv->module, "fu_plugin_device_created", (gpointer *) &func);
+	func = (FuPluginDeviceFunc) priv->vfuncs[FU_PLUGIN_VFUNC_DEVICE_CREATED];
 	if (func == NULL)
 		return TRUE;
 	g_debug ("fu_plugin_device_created(%s)", fu_plugin_get_name (self));
@@ -2162,7 +2386,7 @@ fu_plugin_runner_verify (FuPlugin *self,
 		return TRUE;
 
 	/* optional */
-	g_module_symbol (priv->module, "fu_plugin_verify", (gpointer *) &func);
+	func = (FuPluginVerifyFunc) priv->vfuncs[FU_PLUGIN_VFUNC_VERIFY];
 	if (func == NULL) {
 		return fu_plugin_device_read_firmware (self, device, error);
 	}
@@ -2173,7 +2397,7 @@ fu_plugin_runner_verify (FuPlugin *self,
 
 	/* run additional detach */
 	if (!fu_plugin_runner_device_generic (self, device,
-					      "fu_plugin_update_detach",
+					      FU_PLUGIN_VFUNC_UPDATE_DETACH,
 					      fu_plugin_device_detach,
 					      error))
 		return FALSE;
@@ -2195,7 +2419,7 @@ fu_plugin_runner_verify (FuPlugin *self,
 					    fu_plugin_get_name (self));
 		/* make the device "work" again, but don't prefix the error */
 		if (!fu_plugin_runner_device_generic (self, device,
-						      "fu_plugin_update_attach",
+						      FU_PLUGIN_VFUNC_UPDATE_ATTACH,
 						      fu_plugin_device_attach,
 						      &error_attach)) {
 			g_warning ("failed to attach whilst aborting verify(): %s",
@@ -2206,7 +2430,7 @@ fu_plugin_runner_verify (FuPlugin *self,
 
 	/* run optional attach */
 	if (!fu_plugin_runner_device_generic (self, device,
-					      "fu_plugin_update_attach",
+					      FU_PLUGIN_VFUNC_UPDATE_ATTACH,
 					      fu_plugin_device_attach,
 					      error))
 		return FALSE;
@@ -2245,7 +2469,7 @@ fu_plugin_runner_activate (FuPlugin *self, FuDevice *device, GError **error)
 
 	/* run vfunc */
 	if (!fu_plugin_runner_device_generic (self, device,
-					      "fu_plugin_activate",
+					      FU_PLUGIN_VFUNC_ACTIVATE,
 					      fu_plugin_device_activate,
 					      error))
 		return FALSE;
@@ -2286,7 +2510,7 @@ fu_plugin_runner_unlock (FuPlugin *self, FuDevice *device, GError **error)
 
 	/* run vfunc */
 	if (!fu_plugin_runner_device_generic (self, device,
-					      "fu_plugin_unlock",
+					      FU_PLUGIN_VFUNC_UNLOCK,
 					      NULL,
 					      error))
 		return FALSE;
@@ -2336,7 +2560,7 @@ fu_plugin_runner_update (FuPlugin *self,
 	}
 
 	/* optional */
-	g_module_symbol (priv->module, "fu_plugin_update", (gpointer *) &update_func);
+	update_func = (FuPluginUpdateFunc) priv->vfuncs[FU_PLUGIN_VFUNC_UPDATE];
 	if (update_func == NULL) {
 		g_debug ("superclassed write_firmware(%s)", fu_plugin_get_name (self));
 		return fu_plugin_device_write_firmware (self, device, blob_fw, flags, error);
@@ -2397,7 +2621,7 @@ fu_plugin_runner_clear_results (FuPlugin *self, FuDevice *device, GError **error
 		return TRUE;
 
 	/* optional */
-	g_module_symbol (priv->module, "fu_plugin_clear_results", (gpointer *) &func);
+	func = (FuPluginDeviceFunc) priv->vfuncs[FU_PLUGIN_VFUNC_CLEAR_RESULTS];
 	if (func == NULL)
 		return TRUE;
 	g_debug ("clear_result(%s)", fu_plugin_get_name (self));
@@ -2446,7 +2670,7 @@ fu_plugin_runner_get_results (FuPlugin *self, FuDevice *device, GError **error)
 		return TRUE;
 
 	/* optional */
-	g_module_symbol (priv->module, "fu_plugin_get_results", (gpointer *) &func);
+	func = (FuPluginDeviceFunc) priv->vfuncs[FU_PLUGIN_VFUNC_GET_RESULTS];
 	if (func == NULL)
 		return TRUE;
 	g_debug ("get_results(%s)", fu_plugin_get_name (self));
@@ -2557,7 +2781,7 @@ fu_plugin_add_rule (FuPlugin *self, FuPluginRule rule, const gchar *name)
 	if (priv->rules[rule] == NULL)
 		priv->rules[rule] = g_ptr_array_new_with_free_func (g_free);
 	g_ptr_array_add (priv->rules[rule], g_strdup (name));
-	g_signal_emit (self, signals[SIGNAL_RULES_CHANGED], 0);
+	fu_plugin_emit_signal (self, signals[SIGNAL_RULES_CHANGED], NULL);
 }
 
 /**
@@ -2806,6 +3030,9 @@ fu_plugin_init (FuPlugin *self)
 {
 	FuPluginPrivate *priv = GET_PRIVATE (self);
 	g_rw_lock_init (&priv->devices_mutex);
+	priv->runner_durations = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	priv->main_ctx = g_main_context_ref_thread_default ();
+	priv->main_thread = g_thread_self ();
 }
 
 static void
@@ -2819,7 +3046,7 @@ fu_plugin_finalize (GObject *object)
 
 	/* optional */
 	if (priv->module != NULL) {
-		g_module_symbol (priv->module, "fu_plugin_destroy", (gpointer *) &func);
+		func = (FuPluginInitFunc) priv->vfuncs[FU_PLUGIN_VFUNC_DESTROY];
 		if (func != NULL) {
 			g_debug ("destroy(%s)", fu_plugin_get_name (self));
 			func (self);
@@ -2848,6 +3075,8 @@ fu_plugin_finalize (GObject *object)
 		g_hash_table_unref (priv->report_metadata);
 	if (priv->devices != NULL)
 		g_hash_table_unref (priv->devices);
+	g_hash_table_unref (priv->runner_durations);
+	g_main_context_unref (priv->main_ctx);
 	g_free (priv->build_hash);
 	g_free (priv->data);
 	/* Must happen as the last step to avoid prematurely
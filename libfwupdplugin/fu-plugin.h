@@ -79,6 +79,7 @@ typedef enum {
  * @FU_PLUGIN_RULE_BETTER_THAN:		Is better than another plugin
  * @FU_PLUGIN_RULE_INHIBITS_IDLE:	The plugin inhibits the idle shutdown
  * @FU_PLUGIN_RULE_METADATA_SOURCE:	Uses another plugin as a source of report metadata
+ * @FU_PLUGIN_RULE_THREAD_SAFE:		The named vfunc can be run from a worker thread, e.g. `coldplug`, `update`, `usb_device_added` or `add_security_attrs`
  *
  * The rules used for ordering plugins.
  * Plugins are expected to add rules in fu_plugin_initialize().
@@ -90,6 +91,7 @@ typedef enum {
 	FU_PLUGIN_RULE_BETTER_THAN,
 	FU_PLUGIN_RULE_INHIBITS_IDLE,
 	FU_PLUGIN_RULE_METADATA_SOURCE,		/* Since: 1.3.6 */
+	FU_PLUGIN_RULE_THREAD_SAFE,		/* Since: 1.5.2 */
 	/*< private >*/
 	FU_PLUGIN_RULE_LAST
 } FuPluginRule;
@@ -53,8 +53,17 @@ struct _FuQuirks
 	GObject			 parent_instance;
 	FuQuirksLoadFlags	 load_flags;
 	XbSilo			*silo;
+	GRWLock			 silo_mutex;	/* protects the prepared queries */
+	XbQuery			*query_kv;
+	XbQuery			*query_vs;
+	GHashTable		*cache;		/* (element-type utf8 utf8) */
+	guint			 cache_hits;
+	guint			 cache_misses;
 };
 
+/* the cache is just dropped when full, as most lookups happen at coldplug */
+#define FU_QUIRKS_CACHE_SIZE_MAX		10000
+
 G_DEFINE_TYPE (FuQuirks, fu_quirks, G_TYPE_OBJECT)
 
 static gchar *
@@ -205,6 +214,7 @@ fu_quirks_check_silo (FuQuirks *self, GError **error)
 	g_autofree gchar *datadir = NULL;
 	g_autofree gchar *localstatedir = NULL;
 	g_autofree gchar *xmlbfn = NULL;
+	g_autoptr(GError) error_local = NULL;
 	g_autoptr(GFile) file = NULL;
 	g_autoptr(XbBuilder) builder = NULL;
 
@@ -234,8 +244,83 @@ fu_quirks_check_silo (FuQuirks *self, GError **error)
 	}
 	if (self->load_flags & FU_QUIRKS_LOAD_FLAG_READONLY_FS)
 		compile_flags |= XB_BUILDER_COMPILE_FLAG_IGNORE_GUID;
+	g_clear_object (&self->query_kv);
+	g_clear_object (&self->query_vs);
+	g_clear_object (&self->silo);
+	g_hash_table_remove_all (self->cache);
 	self->silo = xb_builder_ensure (builder, file, compile_flags, NULL, error);
-	return self->silo != NULL;
+	if (self->silo == NULL)
+		return FALSE;
+
+	/* create index */
+	if (!xb_silo_query_build_index (self->silo, "quirk/device", "id", error))
+		return FALSE;
+
+	/* build prepared queries, which are only invalidated with the silo */
+	self->query_kv = xb_query_new_full (self->silo,
+					    "quirk/device[@id=?]/value[@key=?]",
+					    XB_QUERY_FLAG_OPTIMIZE |
+					    XB_QUERY_FLAG_USE_INDEXES,
+					    &error_local);
+	if (self->query_kv == NULL) {
+		/* no quirk files installed */
+		if (g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
+		    g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT)) {
+			g_debug ("ignoring prepared query: %s", error_local->message);
+			return TRUE;
+		}
+		g_propagate_prefixed_error (error, g_steal_pointer (&error_local),
+					    "failed to prepare query: ");
+		return FALSE;
+	}
+	self->query_vs = xb_query_new_full (self->silo,
+					    "quirk/device[@id=?]/value",
+					    XB_QUERY_FLAG_OPTIMIZE |
+					    XB_QUERY_FLAG_USE_INDEXES,
+					    error);
+	if (self->query_vs == NULL) {
+		g_prefix_error (error, "failed to prepare query: ");
+		return FALSE;
+	}
+
+	/* success */
+	return TRUE;
+}
+
+static gchar *
+fu_quirks_build_cache_key (const gchar *group, const gchar *key)
+{
+	/* a NULL key is used for the group as a whole */
+	if (key == NULL)
+		return g_strdup (group);
+	return g_strdup_printf ("%s\x1f%s", group, key);
+}
+
+static gboolean
+fu_quirks_cache_lookup (FuQuirks *self,
+			const gchar *cache_key,
+			const gchar **value)
+{
+	gpointer tmp = NULL;
+	if (!g_hash_table_lookup_extended (self->cache, cache_key, NULL, &tmp)) {
+		self->cache_misses++;
+		return FALSE;
+	}
+	self->cache_hits++;
+	if (value != NULL)
+		*value = tmp;
+	return TRUE;
+}
+
+/* value is owned by the silo, and %NULL is used to record a miss */
+static void
+fu_quirks_cache_insert (FuQuirks *self, gchar *cache_key, const gchar *value)
+{
+	if (g_hash_table_size (self->cache) >= FU_QUIRKS_CACHE_SIZE_MAX) {
+		g_debug ("quirk cache full, clearing");
+		g_hash_table_remove_all (self->cache);
+	}
+	g_hash_table_insert (self->cache, cache_key, (gpointer) value);
 }
 
 /**
@@ -253,53 +338,58 @@ fu_quirks_check_silo (FuQuirks *self, GError **error)
 const gchar *
 fu_quirks_lookup_by_id (FuQuirks *self, const gchar *group, const gchar *key)
 {
+	const gchar *value = NULL;
+	g_autofree gchar *cache_key = NULL;
 	g_autofree gchar *group_key = NULL;
 	g_autoptr(GError) error = NULL;
+	g_autoptr(GRWLockWriterLocker) locker = NULL;
 	g_autoptr(XbNode) n = NULL;
-	g_autoptr(XbQuery) query = NULL;
 
 	g_return_val_if_fail (FU_IS_QUIRKS (self), NULL);
 	g_return_val_if_fail (group != NULL, NULL);
 	g_return_val_if_fail (key != NULL, NULL);
 
+	/* plugins may be running in worker threads */
+	locker = g_rw_lock_writer_locker_new (&self->silo_mutex);
+
 	/* ensure up to date */
 	if (!fu_quirks_check_silo (self, &error)) {
 		g_warning ("failed to build silo: %s", error->message);
 		return NULL;
 	}
 
+	/* no quirks loaded */
+	if (self->query_kv == NULL)
+		return NULL;
+
+	/* already looked up, perhaps unsuccessfully */
+	cache_key = fu_quirks_build_cache_key (group, key);
+	if (fu_quirks_cache_lookup (self, cache_key, &value))
+		return value;
+
 	/* query */
 	group_key = fu_quirks_build_group_key (group);
-	query = xb_query_new_full (self->silo,
-				   "quirk/device[@id=?]/value[@key=?]",
-				   XB_QUERY_FLAG_NONE,
-				   &error);
-	if (query == NULL) {
-		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
-			return NULL;
-		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT))
-			return NULL;
-		g_warning ("failed to build query: %s", error->message);
-		return NULL;
-	}
-	if (!xb_query_bind_str (query, 0, group_key, &error)) {
+	if (!xb_query_bind_str (self->query_kv, 0, group_key, &error)) {
 		g_warning ("failed to bind 0: %s", error->message);
 		return NULL;
 	}
-	if (!xb_query_bind_str (query, 1, key, &error)) {
+	if (!xb_query_bind_str (self->query_kv, 1, key, &error)) {
 		g_warning ("failed to bind 1: %s", error->message);
 		return NULL;
 	}
-	n = xb_silo_query_first_full (self->silo, query, &error);
+	n = xb_silo_query_first_full (self->silo, self->query_kv, &error);
 	if (n == NULL) {
-		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
-			return NULL;
-		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT))
+		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
+		    g_error_matches (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT)) {
+			fu_quirks_cache_insert (self, g_steal_pointer (&cache_key), NULL);
 			return NULL;
+		}
 		g_warning ("failed to query: %s", error->message);
 		return NULL;
 	}
-	return xb_node_get_text (n);
+	value = xb_node_get_text (n);
+	fu_quirks_cache_insert (self, g_steal_pointer (&cache_key), value);
+	return value;
 }
 
 /**
@@ -319,48 +409,53 @@ gboolean
 fu_quirks_lookup_by_id_iter (FuQuirks *self, const gchar *group,
 			     FuQuirksIter iter_cb, gpointer user_data)
 {
+	g_autofree gchar *cache_key = NULL;
 	g_autofree gchar *group_key = NULL;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GPtrArray) results = NULL;
-	g_autoptr(XbQuery) query = NULL;
+	g_autoptr(GRWLockWriterLocker) locker = NULL;
 
 	g_return_val_if_fail (FU_IS_QUIRKS (self), FALSE);
 	g_return_val_if_fail (group != NULL, FALSE);
 	g_return_val_if_fail (iter_cb != NULL, FALSE);
 
+	/* plugins may be running in worker threads */
+	locker = g_rw_lock_writer_locker_new (&self->silo_mutex);
+
 	/* ensure up to date */
 	if (!fu_quirks_check_silo (self, &error)) {
 		g_warning ("failed to build silo: %s", error->message);
 		return FALSE;
 	}
 
+	/* no quirks loaded */
+	if (self->query_vs == NULL)
+		return FALSE;
+
+	/* only misses are recorded for the group */
+	cache_key = fu_quirks_build_cache_key (group, NULL);
+	if (fu_quirks_cache_lookup (self, cache_key, NULL))
+		return FALSE;
+
 	/* query */
 	group_key = fu_quirks_build_group_key (group);
-	query = xb_query_new_full (self->silo,
-				   "quirk/device[@id=?]/value",
-				   XB_QUERY_FLAG_NONE,
-				   &error);
-	if (query == NULL) {
-		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
-			return FALSE;
-		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT))
-			return FALSE;
-		g_warning ("failed to build query: %s", error->message);
-		return FALSE;
-	}
-	if (!xb_query_bind_str (query, 0, group_key, &error)) {
+	if (!xb_query_bind_str (self->query_vs, 0, group_key, &error)) {
 		g_warning ("failed to bind 0: %s", error->message);
 		return FALSE;
 	}
-	results = xb_silo_query_full (self->silo, query, &error);
+	results = xb_silo_query_full (self->silo, self->query_vs, &error);
 	if (results == NULL) {
-		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
-			return FALSE;
-		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT))
+		if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
+		    g_error_matches (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT)) {
+			fu_quirks_cache_insert (self, g_steal_pointer (&cache_key), NULL);
 			return FALSE;
+		}
 		g_warning ("failed to query: %s", error->message);
 		return FALSE;
 	}
+
+	/* the callback may want to look up other quirks */
+	g_clear_pointer (&locker, g_rw_lock_writer_locker_free);
 	for (guint i = 0; i < results->len; i++) {
 		XbNode *n = g_ptr_array_index (results, i);
 		iter_cb (self,
@@ -386,11 +481,48 @@ fu_quirks_lookup_by_id_iter (FuQuirks *self, const gchar *group,
 gboolean
 fu_quirks_load (FuQuirks *self, FuQuirksLoadFlags load_flags, GError **error)
 {
+	g_autoptr(GRWLockWriterLocker) locker = NULL;
 	g_return_val_if_fail (FU_IS_QUIRKS (self), FALSE);
+	locker = g_rw_lock_writer_locker_new (&self->silo_mutex);
 	self->load_flags = load_flags;
 	return fu_quirks_check_silo (self, error);
 }
 
+/**
+ * fu_quirks_get_cache_hits:
+ * @self: A #FuQuirks
+ *
+ * Gets the number of lookups that were answered without querying the silo,
+ * including lookups that were remembered as not found.
+ *
+ * Returns: integer
+ *
+ * Since: 1.5.2
+ **/
+guint
+fu_quirks_get_cache_hits (FuQuirks *self)
+{
+	g_return_val_if_fail (FU_IS_QUIRKS (self), G_MAXUINT);
+	return self->cache_hits;
+}
+
+/**
+ * fu_quirks_get_cache_misses:
+ * @self: A #FuQuirks
+ *
+ * Gets the number of lookups that had to query the silo.
+ *
+ * Returns: integer
+ *
+ * Since: 1.5.2
+ **/
+guint
+fu_quirks_get_cache_misses (FuQuirks *self)
+{
+	g_return_val_if_fail (FU_IS_QUIRKS (self), G_MAXUINT);
+	return self->cache_misses;
+}
+
 static void
 fu_quirks_class_init (FuQuirksClass *klass)
 {
@@ -401,14 +533,22 @@ fu_quirks_class_init (FuQuirksClass *klass)
 static void
 fu_quirks_init (FuQuirks *self)
 {
+	g_rw_lock_init (&self->silo_mutex);
+	self->cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 }
 
 static void
 fu_quirks_finalize (GObject *obj)
 {
 	FuQuirks *self = FU_QUIRKS (obj);
+	if (self->query_kv != NULL)
+		g_object_unref (self->query_kv);
+	if (self->query_vs != NULL)
+		g_object_unref (self->query_vs);
 	if (self->silo != NULL)
 		g_object_unref (self->silo);
+	g_hash_table_unref (self->cache);
+	g_rw_lock_clear (&self->silo_mutex);
 	G_OBJECT_CLASS (fu_quirks_parent_class)->finalize (obj);
 }
 
@@ -42,6 +42,8 @@ gboolean	 fu_quirks_lookup_by_id_iter		(FuQuirks	*self,
 							 const gchar	*group,
 							 FuQuirksIter	 iter_cb,
 							 gpointer	 user_data);
+guint		 fu_quirks_get_cache_hits		(FuQuirks	*self);
+guint		 fu_quirks_get_cache_misses		(FuQuirks	*self);
 
 #define	FU_QUIRKS_PLUGIN			"Plugin"
 #define	FU_QUIRKS_FLAGS				"Flags"
@@ -273,16 +273,31 @@ void
 fu_security_attrs_depsolve (FuSecurityAttrs *self)
 {
 	g_autoptr(GHashTable) attrs_by_id = NULL;
+	g_autoptr(GHashTable) attrs_by_plugin = NULL;
 
 	g_return_if_fail (FU_IS_SECURITY_ATTRS (self));
 
-	/* make hash of ID -> object */
+	/* make hash of ID -> object and plugin -> objects, clearing any
+	 * previous result as the attrs may be re-used from a cache */
 	attrs_by_id = g_hash_table_new (g_str_hash, g_str_equal);
+	attrs_by_plugin = g_hash_table_new_full (g_str_hash, g_str_equal,
+						 NULL, (GDestroyNotify) g_ptr_array_unref);
 	for (guint i = 0; i < self->attrs->len; i++) {
 		FwupdSecurityAttr *attr = g_ptr_array_index (self->attrs, i);
+		const gchar *plugin = fwupd_security_attr_get_plugin (attr);
+		fwupd_security_attr_set_flags (attr, fwupd_security_attr_get_flags (attr) &
+						     ~FWUPD_SECURITY_ATTR_FLAG_OBSOLETED);
 		g_hash_table_insert (attrs_by_id,
 				     (gpointer) fwupd_security_attr_get_appstream_id (attr),
 				     (gpointer) attr);
+		if (plugin != NULL) {
+			GPtrArray *attrs_tmp = g_hash_table_lookup (attrs_by_plugin, plugin);
+			if (attrs_tmp == NULL) {
+				attrs_tmp = g_ptr_array_new ();
+				g_hash_table_insert (attrs_by_plugin, (gpointer) plugin, attrs_tmp);
+			}
+			g_ptr_array_add (attrs_tmp, attr);
+		}
 	}
 
 	/* set flat where required */
@@ -292,6 +307,7 @@ fu_security_attrs_depsolve (FuSecurityAttrs *self)
 		for (guint j = 0; j < obsoletes->len; j++) {
 			const gchar *obsolete = g_ptr_array_index (obsoletes, j);
 			FwupdSecurityAttr *attr_tmp = g_hash_table_lookup (attrs_by_id, obsolete);
+			GPtrArray *attrs_tmp = g_hash_table_lookup (attrs_by_plugin, obsolete);
 
 			/* by AppStream ID */
 			if (attr_tmp != NULL) {
@@ -302,14 +318,12 @@ fu_security_attrs_depsolve (FuSecurityAttrs *self)
 			}
 
 			/* by plugin name */
-			for (guint k = 0; k < self->attrs->len; k++) {
-				attr_tmp = g_ptr_array_index (self->attrs, k);
-				if (g_strcmp0 (obsolete, fwupd_security_attr_get_plugin (attr_tmp)) == 0) {
-					g_debug ("security attr %s obsoleted by %s", obsolete,
-						 fwupd_security_attr_get_appstream_id (attr_tmp));
-					fwupd_security_attr_add_flag (attr_tmp,
-								      FWUPD_SECURITY_ATTR_FLAG_OBSOLETED);
-				}
+			for (guint k = 0; attrs_tmp != NULL && k < attrs_tmp->len; k++) {
+				attr_tmp = g_ptr_array_index (attrs_tmp, k);
+				g_debug ("security attr %s obsoleted by %s", obsolete,
+					 fwupd_security_attr_get_appstream_id (attr_tmp));
+				fwupd_security_attr_add_flag (attr_tmp,
+							      FWUPD_SECURITY_ATTR_FLAG_OBSOLETED);
 			}
 		}
 	}
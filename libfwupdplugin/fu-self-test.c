@@ -11,7 +11,16 @@
 #include <fwupdplugin.h>
 #include <libgcab.h>
 #include <glib/gstdio.h>
+#ifdef HAVE_GIO_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#ifdef HAVE_IOCTL_H
+#include <sys/ioctl.h>
+#endif
 
+#include "fu-device-event-private.h"
 #include "fu-device-private.h"
 #include "fu-plugin-private.h"
 #include "fu-security-attrs-private.h"
@@ -107,6 +116,137 @@ fu_archive_cab_func (void)
 	g_assert_null (data_tmp);
 }
 
+static gboolean
+fu_archive_lazy_iterate_cb (FuArchive *self,
+			    const gchar *filename,
+			    GBytes *bytes,
+			    gpointer user_data,
+			    GError **error)
+{
+	guint *cnt = (guint *) user_data;
+	g_assert_nonnull (bytes);
+	(*cnt)++;
+	return TRUE;
+}
+
+static void
+fu_archive_lazy_func (void)
+{
+	gboolean ret;
+	gsize bufsz = 0;
+	gssize rc;
+	guint cnt = 0;
+	g_autofree gchar *checksum1 = NULL;
+	g_autofree gchar *checksum2 = NULL;
+	g_autofree gchar *checksum3 = NULL;
+	g_autofree gchar *checksum4 = NULL;
+	g_autofree gchar *filename = NULL;
+	g_autoptr(FuArchive) archive = NULL;
+	g_autoptr(GBytes) data = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GInputStream) stream = NULL;
+	g_autoptr(GInputStream) stream_missing = NULL;
+	g_autoptr(GOutputStream) ostream = g_memory_output_stream_new_resizable ();
+	GBytes *data_tmp;
+
+	filename = g_build_filename (TESTDATADIR_DST, "colorhug", "colorhug-als-3.0.2.cab", NULL);
+	data = fu_common_get_contents_bytes (filename, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (data);
+
+	archive = fu_archive_new (data, FU_ARCHIVE_FLAG_LAZY, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (archive);
+
+	/* decompressed on demand */
+	data_tmp = fu_archive_lookup_by_fn (archive, "firmware.bin", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (data_tmp);
+	checksum1 = g_compute_checksum_for_bytes (G_CHECKSUM_SHA1, data_tmp);
+	g_assert_cmpstr (checksum1, ==, "7c0ae84b191822bcadbdcbe2f74a011695d783c7");
+
+	/* streamed without being cached */
+	stream = fu_archive_get_stream (archive, "firmware.metainfo.xml", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (stream);
+	rc = g_output_stream_splice (ostream, stream,
+				     G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE |
+				     G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+				     NULL, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (rc, >, 0);
+	bufsz = g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (ostream));
+	checksum2 = g_compute_checksum_for_data (G_CHECKSUM_SHA1,
+						 g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (ostream)),
+						 bufsz);
+	g_assert_cmpstr (checksum2, ==, "8611114f51f7151f190de86a5c9259d79ff34216");
+
+	/* looked up in any order without reading the archive each time */
+	data_tmp = fu_archive_lookup_by_fn (archive, "firmware.metainfo.xml", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (data_tmp);
+	checksum3 = g_compute_checksum_for_bytes (G_CHECKSUM_SHA1, data_tmp);
+	g_assert_cmpstr (checksum3, ==, checksum2);
+	data_tmp = fu_archive_lookup_by_fn (archive, "firmware.bin", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (data_tmp);
+	checksum4 = g_compute_checksum_for_bytes (G_CHECKSUM_SHA1, data_tmp);
+	g_assert_cmpstr (checksum4, ==, checksum1);
+
+	/* all files are visited, cached or not */
+	ret = fu_archive_iterate (archive, fu_archive_lazy_iterate_cb, &cnt, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (cnt, >=, 2);
+
+	stream_missing = fu_archive_get_stream (archive, "NOTGOINGTOEXIST.xml", &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND);
+	g_assert_null (stream_missing);
+}
+
+#if defined(HAVE_GIO_UNIX) && defined(F_ADD_SEALS)
+static gint
+fu_common_get_contents_fd_create (gboolean sealed)
+{
+	const gchar buf[] = "hello world";
+	gint fd = memfd_create ("fwupd-self-test", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+	g_assert_cmpint (fd, >=, 0);
+	g_assert_cmpint (write (fd, buf, sizeof(buf)), ==, sizeof(buf));
+	g_assert_cmpint (lseek (fd, 0, SEEK_SET), ==, 0);
+	if (sealed) {
+		g_assert_cmpint (fcntl (fd, F_ADD_SEALS,
+					F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE), ==, 0);
+	}
+	return fd;
+}
+#endif
+
+static void
+fu_common_get_contents_fd_func (void)
+{
+#if defined(HAVE_GIO_UNIX) && defined(F_ADD_SEALS)
+	g_autoptr(GBytes) blob_mapped = NULL;
+	g_autoptr(GBytes) blob_read = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* sealed memfd is mapped */
+	blob_mapped = fu_common_get_contents_fd (fu_common_get_contents_fd_create (TRUE),
+						 1024, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob_mapped);
+	g_assert_cmpstr (g_bytes_get_data (blob_mapped, NULL), ==, "hello world");
+
+	/* unsealed memfd falls back to reading */
+	blob_read = fu_common_get_contents_fd (fu_common_get_contents_fd_create (FALSE),
+					       1024, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob_read);
+	g_assert_true (g_bytes_equal (blob_mapped, blob_read));
+#else
+	g_test_skip ("memfd sealing not supported");
+#endif
+}
+
 static void
 fu_common_byte_array_func (void)
 {
@@ -134,6 +274,104 @@ fu_common_crc_func (void)
 	g_assert_cmpint (fu_common_crc32 (buf, sizeof(buf)), ==, 0x40EFAB9E);
 }
 
+/* the original bit-at-a-time implementations */
+static guint8
+fu_common_crc8_bitwise (const guint8 *buf, gsize bufsz)
+{
+	guint32 crc = 0;
+	for (gsize j = bufsz; j > 0; j--) {
+		crc ^= (*(buf++) << 8);
+		for (guint32 i = 8; i; i--) {
+			if (crc & 0x8000)
+				crc ^= (0x1070 << 3);
+			crc <<= 1;
+		}
+	}
+	return ~((guint8) (crc >> 8));
+}
+
+static guint16
+fu_common_crc16_bitwise (const guint8 *buf, gsize bufsz)
+{
+	guint16 crc = 0xffff;
+	for (gsize len = bufsz; len > 0; len--) {
+		crc = (guint16) (crc ^ (*buf++));
+		for (guint8 i = 0; i < 8; i++) {
+			if (crc & 0x1) {
+				crc = (crc >> 1) ^ 0xa001;
+			} else {
+				crc >>= 1;
+			}
+		}
+	}
+	return ~crc;
+}
+
+static guint32
+fu_common_crc32_bitwise (const guint8 *buf, gsize bufsz, guint32 crc, guint32 polynomial)
+{
+	for (guint32 idx = 0; idx < bufsz; idx++) {
+		guint8 data = *buf++;
+		crc = crc ^ data;
+		for (guint32 bit = 0; bit < 8; bit++) {
+			guint32 mask = -(crc & 1);
+			crc = (crc >> 1) ^ (polynomial & mask);
+		}
+	}
+	return ~crc;
+}
+
+static void
+fu_common_crc_tables_func (void)
+{
+	guint8 buf[512];
+	const guint32 polynomials[] = { 0xEDB88320, 0x82F63B78, 0x04C11DB7 };
+
+	for (guint i = 0; i < sizeof(buf); i++)
+		buf[i] = (guint8) g_random_int ();
+
+	/* different alignments and lengths to cover the slicing tails */
+	for (gsize offset = 0; offset < 8; offset++) {
+		for (gsize len = 0; len < sizeof(buf) - offset; len += 13) {
+			const guint8 *ptr = buf + offset;
+			g_assert_cmpint (fu_common_crc8 (ptr, len), ==,
+					 fu_common_crc8_bitwise (ptr, len));
+			g_assert_cmpint (fu_common_crc16 (ptr, len), ==,
+					 fu_common_crc16_bitwise (ptr, len));
+			for (guint j = 0; j < G_N_ELEMENTS (polynomials); j++) {
+				g_assert_cmpint (fu_common_crc32_full (ptr, len, 0xFFFFFFFF, polynomials[j]), ==,
+						 fu_common_crc32_bitwise (ptr, len, 0xFFFFFFFF, polynomials[j]));
+			}
+		}
+	}
+}
+
+static void
+fu_common_crc_performance_func (void)
+{
+	gsize bufsz = 16 * 1024 * 1024;
+	guint32 crc;
+	g_autofree guint8 *buf = g_malloc (bufsz);
+	g_autoptr(GTimer) timer = g_timer_new ();
+
+	for (gsize i = 0; i < bufsz; i++)
+		buf[i] = (guint8) i;
+
+	g_timer_reset (timer);
+	crc = fu_common_crc32 (buf, bufsz);
+	g_print ("crc32=%.3fms ", g_timer_elapsed (timer, NULL) * 1000.f);
+	g_timer_reset (timer);
+	g_assert_cmpint (crc, ==, fu_common_crc32_bitwise (buf, bufsz, 0xFFFFFFFF, 0xEDB88320));
+	g_print ("crc32-bitwise=%.3fms ", g_timer_elapsed (timer, NULL) * 1000.f);
+
+	g_timer_reset (timer);
+	fu_common_crc16 (buf, bufsz);
+	g_print ("crc16=%.3fms ", g_timer_elapsed (timer, NULL) * 1000.f);
+	g_timer_reset (timer);
+	fu_common_crc8 (buf, bufsz);
+	g_print ("crc8=%.3fms ", g_timer_elapsed (timer, NULL) * 1000.f);
+}
+
 static void
 fu_common_string_append_kv_func (void)
 {
@@ -476,6 +714,56 @@ fu_plugin_quirks_performance_func (void)
 		}
 	}
 	g_print ("lookup=%.3fms ", g_timer_elapsed (timer, NULL) * 1000.f);
+
+	/* only the first lookup of each key hits the silo */
+	g_assert_cmpint (fu_quirks_get_cache_misses (quirks), ==, 3);
+	g_assert_cmpint (fu_quirks_get_cache_hits (quirks), ==, 2997);
+}
+
+static void
+fu_plugin_quirks_cache_iter_cb (FuQuirks *quirks,
+				const gchar *key,
+				const gchar *value,
+				gpointer user_data)
+{
+	g_assert_not_reached ();
+}
+
+static void
+fu_plugin_quirks_cache_func (void)
+{
+	const gchar *tmp;
+	gboolean ret;
+	g_autoptr(FuQuirks) quirks = fu_quirks_new ();
+	g_autoptr(GError) error = NULL;
+
+	ret = fu_quirks_load (quirks, FU_QUIRKS_LOAD_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
+
+	/* misses are remembered too */
+	tmp = fu_quirks_lookup_by_id (quirks, "DeviceInstanceId=USB\\VID_FFFF&PID_FFFF", "Name");
+	g_assert_cmpstr (tmp, ==, NULL);
+	tmp = fu_quirks_lookup_by_id (quirks, "DeviceInstanceId=USB\\VID_FFFF&PID_FFFF", "Name");
+	g_assert_cmpstr (tmp, ==, NULL);
+	g_assert_cmpint (fu_quirks_get_cache_misses (quirks), ==, 1);
+	g_assert_cmpint (fu_quirks_get_cache_hits (quirks), ==, 1);
+
+	/* cached values are the same as uncached */
+	tmp = fu_quirks_lookup_by_id (quirks, "USB\\VID_0A5C&PID_6412", "Flags");
+	g_assert_cmpstr (tmp, ==, "ignore-runtime");
+	tmp = fu_quirks_lookup_by_id (quirks, "USB\\VID_0A5C&PID_6412", "Flags");
+	g_assert_cmpstr (tmp, ==, "ignore-runtime");
+	g_assert_cmpint (fu_quirks_get_cache_misses (quirks), ==, 2);
+	g_assert_cmpint (fu_quirks_get_cache_hits (quirks), ==, 2);
+
+	/* the group is remembered when nothing was found */
+	ret = fu_quirks_lookup_by_id_iter (quirks, "unfound", fu_plugin_quirks_cache_iter_cb, NULL);
+	g_assert_false (ret);
+	ret = fu_quirks_lookup_by_id_iter (quirks, "unfound", fu_plugin_quirks_cache_iter_cb, NULL);
+	g_assert_false (ret);
+	g_assert_cmpint (fu_quirks_get_cache_misses (quirks), ==, 3);
+	g_assert_cmpint (fu_quirks_get_cache_hits (quirks), ==, 3);
 }
 
 static void
@@ -1213,6 +1501,40 @@ fu_chunk_func (void)
 					   "#05: page:02 addr:0004 len:02 ZZ\n");
 }
 
+static void
+fu_chunk_iter_func (void)
+{
+	gsize bufsz = 0;
+	const guint8 *buf;
+	FuChunk chk;
+	FuChunkIter iter;
+	g_autoptr(GBytes) blob = g_bytes_new_static ("0123456789abcdef", 16);
+	g_autoptr(GPtrArray) chunks = NULL;
+
+	/* same as the array, but without copying */
+	buf = g_bytes_get_data (blob, &bufsz);
+	chunks = fu_chunk_array_new (buf, bufsz, 0x3, 10, 4);
+	fu_chunk_iter_init_from_bytes (&iter, blob, 0x3, 10, 4);
+	g_assert_cmpint (fu_chunk_iter_get_count (&iter), ==, chunks->len);
+	for (guint i = 0; i < chunks->len; i++) {
+		FuChunk *chk_tmp = g_ptr_array_index (chunks, i);
+		g_assert_true (fu_chunk_iter_next (&iter, &chk));
+		g_assert_cmpint (chk.idx, ==, chk_tmp->idx);
+		g_assert_cmpint (chk.page, ==, chk_tmp->page);
+		g_assert_cmpint (chk.address, ==, chk_tmp->address);
+		g_assert_cmpint (chk.data_sz, ==, chk_tmp->data_sz);
+		g_assert_true (chk.data == chk_tmp->data);
+	}
+	g_assert_false (fu_chunk_iter_next (&iter, &chk));
+
+	/* no data, only addresses */
+	fu_chunk_iter_init (&iter, NULL, 0x10000000, 0x0, 0x0, 64);
+	g_assert_cmpint (fu_chunk_iter_get_count (&iter), ==, 0x10000000 / 64);
+	g_assert_true (fu_chunk_iter_next (&iter, &chk));
+	g_assert_null (chk.data);
+	g_assert_cmpint (chk.data_sz, ==, 64);
+}
+
 static void
 fu_common_strstrip_func (void)
 {
@@ -1992,6 +2314,395 @@ fu_device_retry_hardware_func (void)
 	g_assert_cmpint (helper.cnt_failed, ==, 2);
 }
 
+static void
+fu_device_emulation_func (void)
+{
+	FuDeviceEvent *event;
+	GPtrArray *events;
+	JsonArray *json_events;
+	gboolean ret;
+	gint64 rc = 0;
+	gsize actual_length = 0;
+	guint8 buf[2] = { 0x0 };
+	const guint8 data1[] = { 0x12, 0x34 };
+	const guint8 data2[] = { 0x56 };
+	g_autofree gchar *str = NULL;
+	g_autoptr(FuDevice) device1 = fu_device_new ();
+	g_autoptr(FuDevice) device2 = fu_device_new ();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GError) error_timeout = g_error_new_literal (G_IO_ERROR, G_IO_ERROR_TIMED_OUT, "timeout");
+	g_autoptr(GPtrArray) events_new = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_autoptr(JsonBuilder) builder = json_builder_new ();
+	g_autoptr(JsonGenerator) json_generator = json_generator_new ();
+	g_autoptr(JsonNode) json_root = NULL;
+	g_autoptr(JsonParser) json_parser = json_parser_new ();
+
+	/* record the same request twice with different responses */
+	fu_device_set_emulation (device1, FU_DEVICE_EMULATION_RECORD);
+	event = fu_device_save_event (device1, "Pread:Port=0x0,Length=0x2");
+	fu_device_event_set_data (event, "Data", data1, sizeof(data1));
+	fu_device_event_set_i64 (event, "Rc", -1);
+	fu_device_event_set_duration (event, 10);
+	event = fu_device_save_event (device1, "Pread:Port=0x0,Length=0x2");
+	fu_device_event_set_data (event, "Data", data2, sizeof(data2));
+	event = fu_device_save_event (device1, "Write:Data=AA==");
+	fu_device_event_set_error (event, error_timeout);
+	events = fu_device_get_events (device1);
+	g_assert_nonnull (events);
+	g_assert_cmpint (events->len, ==, 3);
+
+	/* export and import */
+	json_builder_begin_array (builder);
+	for (guint i = 0; i < events->len; i++)
+		fu_device_event_to_json (g_ptr_array_index (events, i), builder);
+	json_builder_end_array (builder);
+	json_root = json_builder_get_root (builder);
+	json_generator_set_root (json_generator, json_root);
+	str = json_generator_to_data (json_generator, NULL);
+	ret = json_parser_load_from_data (json_parser, str, -1, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	json_events = json_node_get_array (json_parser_get_root (json_parser));
+	for (guint i = 0; i < json_array_get_length (json_events); i++) {
+		JsonObject *json_event = json_array_get_object_element (json_events, i);
+		event = fu_device_event_new_from_json (json_event, &error);
+		g_assert_no_error (error);
+		g_assert_nonnull (event);
+		g_ptr_array_add (events_new, event);
+	}
+	g_assert_cmpint (events_new->len, ==, 3);
+
+	/* play back in the same order */
+	fu_device_set_emulation (device2, FU_DEVICE_EMULATION_REPLAY);
+	fu_device_set_events (device2, events_new);
+	event = fu_device_load_event (device2, "Pread:Port=0x0,Length=0x2", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (event);
+	g_assert_cmpint (fu_device_event_get_duration (event), ==, 10);
+	ret = fu_device_event_get_i64 (event, "Rc", &rc, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (rc, ==, -1);
+	ret = fu_device_event_check_error (event, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = fu_device_event_copy_data (event, "Data", buf, sizeof(buf), &actual_length, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (actual_length, ==, 2);
+	g_assert_cmpint (buf[0], ==, 0x12);
+	g_assert_cmpint (buf[1], ==, 0x34);
+	event = fu_device_load_event (device2, "Pread:Port=0x0,Length=0x2", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (event);
+	ret = fu_device_event_copy_data (event, "Data", buf, sizeof(buf), &actual_length, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (actual_length, ==, 1);
+	g_assert_cmpint (buf[0], ==, 0x56);
+	ret = fu_device_event_get_i64 (event, "Rc", &rc, &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND);
+	g_assert_false (ret);
+	g_clear_error (&error);
+
+	/* the recorded error is returned again */
+	event = fu_device_load_event (device2, "Write:Data=AA==", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (event);
+	ret = fu_device_event_check_error (event, &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT);
+	g_assert_cmpstr (error->message, ==, "timeout");
+	g_assert_false (ret);
+	g_clear_error (&error);
+
+	/* each event is only used once */
+	event = fu_device_load_event (device2, "Pread:Port=0x0,Length=0x2", &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null (event);
+}
+
+/* exports the recorded events as JSON and plays them back on another device */
+static void
+fu_device_emulation_copy_events (FuDevice *device_src, FuDevice *device_dst)
+{
+	GPtrArray *events = fu_device_get_events (device_src);
+	JsonArray *json_events;
+	gboolean ret;
+	g_autofree gchar *str = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) events_new = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_autoptr(JsonBuilder) builder = json_builder_new ();
+	g_autoptr(JsonGenerator) json_generator = json_generator_new ();
+	g_autoptr(JsonNode) json_root = NULL;
+	g_autoptr(JsonParser) json_parser = json_parser_new ();
+
+	g_assert_nonnull (events);
+	json_builder_begin_array (builder);
+	for (guint i = 0; i < events->len; i++)
+		fu_device_event_to_json (g_ptr_array_index (events, i), builder);
+	json_builder_end_array (builder);
+	json_root = json_builder_get_root (builder);
+	json_generator_set_root (json_generator, json_root);
+	str = json_generator_to_data (json_generator, NULL);
+	ret = json_parser_load_from_data (json_parser, str, -1, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	json_events = json_node_get_array (json_parser_get_root (json_parser));
+	for (guint i = 0; i < json_array_get_length (json_events); i++) {
+		JsonObject *json_event = json_array_get_object_element (json_events, i);
+		FuDeviceEvent *event = fu_device_event_new_from_json (json_event, &error);
+		g_assert_no_error (error);
+		g_assert_nonnull (event);
+		g_ptr_array_add (events_new, event);
+	}
+	fu_device_set_emulation (device_dst, FU_DEVICE_EMULATION_REPLAY);
+	fu_device_set_events (device_dst, events_new);
+}
+
+static void
+fu_udev_device_emulation_func (void)
+{
+#if defined(HAVE_GIO_UNIX) && defined(HAVE_IOCTL_H) && defined(HAVE_PWRITE)
+	const gulong request = _IOR ('X', 0x01, guint32);
+	gboolean ret;
+	gint fd;
+	gint rc = 0;
+	guint8 buf[4] = { 0x0 };
+	g_autofree gchar *error_msg = NULL;
+	g_autoptr(FuUdevDevice) device1 = fu_udev_device_new (NULL);
+	g_autoptr(FuUdevDevice) device2 = fu_udev_device_new (NULL);
+	g_autoptr(GError) error = NULL;
+
+	/* record a read that succeeds and an ioctl that fails */
+	g_assert_cmpint (g_mkdir_with_parents ("/tmp/fwupd-self-test", 0755), ==, 0);
+	ret = g_file_set_contents ("/tmp/fwupd-self-test/emulation-udev.bin",
+				   "\x01\x02\x03\x04", 4, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	fd = g_open ("/tmp/fwupd-self-test/emulation-udev.bin", O_RDONLY, 0);
+	g_assert_cmpint (fd, >, 0);
+	fu_udev_device_set_fd (device1, fd);
+	fu_device_set_emulation (FU_DEVICE (device1), FU_DEVICE_EMULATION_RECORD);
+	ret = fu_udev_device_pread_full (device1, 0x1, buf, 2, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (buf[0], ==, 0x02);
+	g_assert_cmpint (buf[1], ==, 0x03);
+	ret = fu_udev_device_ioctl (device1, request, buf, &rc, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL);
+	g_assert_false (ret);
+	g_assert_cmpint (rc, <, 0);
+	error_msg = g_strdup (error->message);
+	g_clear_error (&error);
+
+	/* play back without the file */
+	fu_device_emulation_copy_events (FU_DEVICE (device1), FU_DEVICE (device2));
+	memset (buf, 0x0, sizeof(buf));
+	ret = fu_udev_device_pread_full (device2, 0x1, buf, 2, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (buf[0], ==, 0x02);
+	g_assert_cmpint (buf[1], ==, 0x03);
+	rc = 0;
+	ret = fu_udev_device_ioctl (device2, request, buf, &rc, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL);
+	g_assert_cmpstr (error->message, ==, error_msg);
+	g_assert_false (ret);
+	g_assert_cmpint (rc, <, 0);
+	g_clear_error (&error);
+
+	/* the ioctl is keyed on the sequence number, so is not found again */
+	ret = fu_udev_device_ioctl (device2, request, buf, &rc, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_false (ret);
+#else
+	g_test_skip ("ioctl and pread are not supported");
+#endif
+}
+
+static void
+fu_usb_device_emulation_func (void)
+{
+	gboolean ret;
+	gsize actual_length = 0;
+	guint8 buf[2] = { 0x0 };
+	g_autofree gchar *error_msg = NULL;
+	g_autofree gchar *str = NULL;
+	g_autoptr(FuUsbDevice) device1 = NULL;
+	g_autoptr(FuUsbDevice) device2 = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) usb_devices = NULL;
+	g_autoptr(GUsbContext) usb_ctx = NULL;
+
+	/* any device will do as it is never opened */
+	usb_ctx = g_usb_context_new (NULL);
+	if (usb_ctx == NULL) {
+		g_test_skip ("no USB context");
+		return;
+	}
+	g_usb_context_enumerate (usb_ctx);
+	usb_devices = g_usb_context_get_devices (usb_ctx);
+	if (usb_devices->len == 0) {
+		g_test_skip ("no USB devices");
+		return;
+	}
+
+	/* record the requests, which fail as the device is not open */
+	device1 = fu_usb_device_new (g_ptr_array_index (usb_devices, 0));
+	fu_device_set_emulation (FU_DEVICE (device1), FU_DEVICE_EMULATION_RECORD);
+	ret = fu_usb_device_control_transfer (device1,
+					      G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					      G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					      G_USB_DEVICE_RECIPIENT_DEVICE,
+					      0x01, 0x0203, 0x0004,
+					      buf, sizeof(buf), &actual_length,
+					      500, NULL, &error);
+	g_assert_error (error, G_USB_DEVICE_ERROR, G_USB_DEVICE_ERROR_NOT_OPEN);
+	g_assert_false (ret);
+	error_msg = g_strdup (error->message);
+	g_clear_error (&error);
+	str = fu_usb_device_get_string_descriptor (device1, 0x01, &error);
+	g_assert_error (error, G_USB_DEVICE_ERROR, G_USB_DEVICE_ERROR_NOT_OPEN);
+	g_assert_null (str);
+	g_clear_error (&error);
+
+	/* the recorded errors are returned again */
+	device2 = fu_usb_device_new (g_ptr_array_index (usb_devices, 0));
+	fu_device_emulation_copy_events (FU_DEVICE (device1), FU_DEVICE (device2));
+	ret = fu_usb_device_control_transfer (device2,
+					      G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					      G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					      G_USB_DEVICE_RECIPIENT_DEVICE,
+					      0x01, 0x0203, 0x0004,
+					      buf, sizeof(buf), &actual_length,
+					      500, NULL, &error);
+	g_assert_error (error, G_USB_DEVICE_ERROR, G_USB_DEVICE_ERROR_NOT_OPEN);
+	g_assert_cmpstr (error->message, ==, error_msg);
+	g_assert_false (ret);
+	g_clear_error (&error);
+	str = fu_usb_device_get_string_descriptor (device2, 0x01, &error);
+	g_assert_error (error, G_USB_DEVICE_ERROR, G_USB_DEVICE_ERROR_NOT_OPEN);
+	g_assert_null (str);
+	g_clear_error (&error);
+
+	/* a request that was never recorded */
+	ret = fu_usb_device_control_transfer (device2,
+					      G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					      G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					      G_USB_DEVICE_RECIPIENT_DEVICE,
+					      0x01, 0x0203, 0x0005,
+					      buf, sizeof(buf), &actual_length,
+					      500, NULL, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_false (ret);
+}
+
+static void
+fu_io_channel_emulation_func (void)
+{
+#ifdef HAVE_POLL_H
+	gboolean ret;
+	g_autoptr(FuDevice) device1 = fu_device_new ();
+	g_autoptr(FuDevice) device2 = fu_device_new ();
+	g_autoptr(FuIOChannel) io_channel1 = NULL;
+	g_autoptr(FuIOChannel) io_channel2 = NULL;
+	g_autoptr(GBytes) blob1 = NULL;
+	g_autoptr(GBytes) blob2 = NULL;
+	g_autoptr(GBytes) blob3 = NULL;
+	g_autoptr(GBytes) blob4 = NULL;
+	g_autoptr(GBytes) blob_write = g_bytes_new_static ("world", 5);
+	g_autoptr(GError) error = NULL;
+
+	/* record a read, a write, and then a read that fails at the EOF */
+	g_assert_cmpint (g_mkdir_with_parents ("/tmp/fwupd-self-test", 0755), ==, 0);
+	ret = g_file_set_contents ("/tmp/fwupd-self-test/emulation-io-channel.bin",
+				   "hello", -1, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	fu_device_set_emulation (device1, FU_DEVICE_EMULATION_RECORD);
+	io_channel1 = fu_io_channel_new_for_device (device1,
+						    "/tmp/fwupd-self-test/emulation-io-channel.bin",
+						    &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (io_channel1);
+	blob1 = fu_io_channel_read_bytes (io_channel1, 5, 500,
+					  FU_IO_CHANNEL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob1);
+	g_assert_cmpint (g_bytes_get_size (blob1), ==, 5);
+	ret = fu_io_channel_write_bytes (io_channel1, blob_write, 500,
+					 FU_IO_CHANNEL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	blob2 = fu_io_channel_read_bytes (io_channel1, 5, 500,
+					  FU_IO_CHANNEL_FLAG_SINGLE_SHOT, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_READ);
+	g_assert_null (blob2);
+	g_clear_error (&error);
+
+	/* play back without opening the file */
+	fu_device_emulation_copy_events (device1, device2);
+	io_channel2 = fu_io_channel_new_for_device (device2, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (io_channel2);
+	blob3 = fu_io_channel_read_bytes (io_channel2, 5, 500,
+					  FU_IO_CHANNEL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob3);
+	g_assert_cmpint (g_bytes_compare (blob1, blob3), ==, 0);
+	ret = fu_io_channel_write_bytes (io_channel2, blob_write, 500,
+					 FU_IO_CHANNEL_FLAG_NONE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	blob4 = fu_io_channel_read_bytes (io_channel2, 5, 500,
+					  FU_IO_CHANNEL_FLAG_SINGLE_SHOT, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_READ);
+	g_assert_null (blob4);
+	g_clear_error (&error);
+
+	/* different data was never written */
+	ret = fu_io_channel_write_bytes (io_channel2, blob1, 500,
+					 FU_IO_CHANNEL_FLAG_NONE, &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_false (ret);
+#else
+	g_test_skip ("poll() is not supported");
+#endif
+}
+
+static void
+fu_security_attrs_depsolve_func (void)
+{
+	g_autoptr(FuSecurityAttrs) attrs = fu_security_attrs_new ();
+	g_autoptr(FuSecurityAttrs) attrs2 = fu_security_attrs_new ();
+	g_autoptr(FwupdSecurityAttr) attr1 = NULL;
+	g_autoptr(FwupdSecurityAttr) attr2 = NULL;
+	g_autoptr(FwupdSecurityAttr) attr3 = NULL;
+
+	/* obsoleted by plugin name */
+	attr1 = fwupd_security_attr_new (FWUPD_SECURITY_ATTR_ID_SPI_BIOSWE);
+	fwupd_security_attr_set_plugin (attr1, "old");
+	attr2 = fwupd_security_attr_new (FWUPD_SECURITY_ATTR_ID_SPI_BLE);
+	fwupd_security_attr_set_plugin (attr2, "old");
+	attr3 = fwupd_security_attr_new (FWUPD_SECURITY_ATTR_ID_SPI_SMM_BWP);
+	fwupd_security_attr_set_plugin (attr3, "new");
+	fwupd_security_attr_add_obsolete (attr3, "old");
+	fu_security_attrs_append (attrs, attr1);
+	fu_security_attrs_append (attrs, attr2);
+	fu_security_attrs_append (attrs, attr3);
+	fu_security_attrs_depsolve (attrs);
+	g_assert_true (fwupd_security_attr_has_flag (attr1, FWUPD_SECURITY_ATTR_FLAG_OBSOLETED));
+	g_assert_true (fwupd_security_attr_has_flag (attr2, FWUPD_SECURITY_ATTR_FLAG_OBSOLETED));
+	g_assert_false (fwupd_security_attr_has_flag (attr3, FWUPD_SECURITY_ATTR_FLAG_OBSOLETED));
+
+	/* re-using the same attrs without the obsoleting plugin clears the flag */
+	fu_security_attrs_append (attrs2, attr1);
+	fu_security_attrs_append (attrs2, attr2);
+	fu_security_attrs_depsolve (attrs2);
+	g_assert_false (fwupd_security_attr_has_flag (attr1, FWUPD_SECURITY_ATTR_FLAG_OBSOLETED));
+	g_assert_false (fwupd_security_attr_has_flag (attr2, FWUPD_SECURITY_ATTR_FLAG_OBSOLETED));
+}
+
 static void
 fu_security_attrs_hsi_func (void)
 {
@@ -2108,13 +2819,19 @@ main (int argc, char **argv)
 	g_setenv ("FWUPD_LOCALSTATEDIR", "/tmp/fwupd-self-test/var", TRUE);
 
 	g_test_add_func ("/fwupd/security-attrs{hsi}", fu_security_attrs_hsi_func);
+	g_test_add_func ("/fwupd/security-attrs{depsolve}", fu_security_attrs_depsolve_func);
 	g_test_add_func ("/fwupd/plugin{delay}", fu_plugin_delay_func);
 	g_test_add_func ("/fwupd/plugin{quirks}", fu_plugin_quirks_func);
 	g_test_add_func ("/fwupd/plugin{quirks-performance}", fu_plugin_quirks_performance_func);
+	g_test_add_func ("/fwupd/plugin{quirks-cache}", fu_plugin_quirks_cache_func);
 	g_test_add_func ("/fwupd/plugin{quirks-device}", fu_plugin_quirks_device_func);
 	g_test_add_func ("/fwupd/chunk", fu_chunk_func);
+	g_test_add_func ("/fwupd/chunk{iter}", fu_chunk_iter_func);
 	g_test_add_func ("/fwupd/common{byte-array}", fu_common_byte_array_func);
+	g_test_add_func ("/fwupd/common{get-contents-fd}", fu_common_get_contents_fd_func);
 	g_test_add_func ("/fwupd/common{crc}", fu_common_crc_func);
+	g_test_add_func ("/fwupd/common{crc-tables}", fu_common_crc_tables_func);
+	g_test_add_func ("/fwupd/common{crc-performance}", fu_common_crc_performance_func);
 	g_test_add_func ("/fwupd/common{string-append-kv}", fu_common_string_append_kv_func);
 	g_test_add_func ("/fwupd/common{version-guess-format}", fu_common_version_guess_format_func);
 	g_test_add_func ("/fwupd/common{version}", fu_common_version_func);
@@ -2149,6 +2866,7 @@ main (int argc, char **argv)
 	g_test_add_func ("/fwupd/firmware{dfu}", fu_firmware_dfu_func);
 	g_test_add_func ("/fwupd/archive{invalid}", fu_archive_invalid_func);
 	g_test_add_func ("/fwupd/archive{cab}", fu_archive_cab_func);
+	g_test_add_func ("/fwupd/archive{lazy}", fu_archive_lazy_func);
 	g_test_add_func ("/fwupd/device", fu_device_func);
 	g_test_add_func ("/fwupd/device{flags}", fu_device_flags_func);
 	g_test_add_func ("/fwupd/device{parent}", fu_device_parent_func);
@@ -2163,5 +2881,9 @@ main (int argc, char **argv)
 	g_test_add_func ("/fwupd/device{retry-success}", fu_device_retry_success_func);
 	g_test_add_func ("/fwupd/device{retry-failed}", fu_device_retry_failed_func);
 	g_test_add_func ("/fwupd/device{retry-hardware}", fu_device_retry_hardware_func);
+	g_test_add_func ("/fwupd/device{emulation}", fu_device_emulation_func);
+	g_test_add_func ("/fwupd/udev-device{emulation}", fu_udev_device_emulation_func);
+	g_test_add_func ("/fwupd/usb-device{emulation}", fu_usb_device_emulation_func);
+	g_test_add_func ("/fwupd/io-channel{emulation}", fu_io_channel_emulation_func);
 	return g_test_run ();
 }
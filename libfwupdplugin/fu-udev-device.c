@@ -22,6 +22,7 @@
 
 #include <glib/gstdio.h>
 
+#include "fu-device-event-private.h"
 #include "fu-device-private.h"
 #include "fu-udev-device-private.h"
 
@@ -45,6 +46,7 @@ typedef struct
 	gchar			*subsystem;
 	gchar			*device_file;
 	gint			 fd;
+	guint			 ioctl_seq;	/* for emulation */
 	FuUdevDeviceFlags	 flags;
 } FuUdevDevicePrivate;
 
@@ -489,6 +491,7 @@ fu_udev_device_set_dev (FuUdevDevice *self, GUdevDevice *udev_device)
 	if (priv->udev_device == NULL)
 		return;
 #ifdef HAVE_GUDEV
+	fu_device_set_backend_id (FU_DEVICE (self), g_udev_device_get_sysfs_path (priv->udev_device));
 	fu_udev_device_set_subsystem (self, g_udev_device_get_subsystem (priv->udev_device));
 	fu_udev_device_set_device_file (self, g_udev_device_get_device_file (priv->udev_device));
 
@@ -1098,8 +1101,13 @@ fu_udev_device_open (FuDevice *device, GError **error)
 	FuUdevDevicePrivate *priv = GET_PRIVATE (self);
 	FuUdevDeviceClass *klass = FU_UDEV_DEVICE_GET_CLASS (device);
 
-	/* open device */
-	if (priv->device_file != NULL && priv->flags != FU_UDEV_DEVICE_FLAG_NONE) {
+	/* ioctl events are matched in the order they are sent */
+	priv->ioctl_seq = 0;
+
+	/* open device, unless all the requests are being played back */
+	if (priv->device_file != NULL &&
+	    priv->flags != FU_UDEV_DEVICE_FLAG_NONE &&
+	    fu_device_get_emulation (device) != FU_DEVICE_EMULATION_REPLAY) {
 		gint flags;
 		if (priv->flags & FU_UDEV_DEVICE_FLAG_OPEN_READ &&
 		    priv->flags & FU_UDEV_DEVICE_FLAG_OPEN_WRITE) {
@@ -1159,6 +1167,48 @@ fu_udev_device_close (FuDevice *device, GError **error)
 	return TRUE;
 }
 
+#ifdef HAVE_IOCTL_H
+/* only requests where the whole buffer is encoded in the request and which do
+ * not point to other memory can be recorded and played back */
+static gboolean
+fu_udev_device_ioctl_check_emulation (gulong request, gsize *bufsz, GError **error)
+{
+#ifdef _IOC_SIZE
+	/* e.g. SG_IO */
+	if (_IOC_SIZE (request) == 0) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_SUPPORTED,
+			     "ioctl 0x%04x cannot be emulated as the size is not "
+			     "encoded in the request",
+			     (guint) request);
+		return FALSE;
+	}
+
+	/* MMC_IOC_CMD and MMC_IOC_MULTI_CMD, and the NVMe passthru commands */
+	if (_IOC_TYPE (request) == 179 ||
+	    (_IOC_TYPE (request) == 'N' && _IOC_NR (request) >= 0x40)) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_SUPPORTED,
+			     "ioctl 0x%04x cannot be emulated as the request "
+			     "contains pointers",
+			     (guint) request);
+		return FALSE;
+	}
+	*bufsz = _IOC_SIZE (request);
+	return TRUE;
+#else
+	g_set_error (error,
+		     FWUPD_ERROR,
+		     FWUPD_ERROR_NOT_SUPPORTED,
+		     "ioctl 0x%04x cannot be emulated as the size is unknown",
+		     (guint) request);
+	return FALSE;
+#endif
+}
+#endif
+
 /**
  * fu_udev_device_ioctl:
  * @self: A #FuUdevDevice
@@ -1182,14 +1232,59 @@ fu_udev_device_ioctl (FuUdevDevice *self,
 {
 #ifdef HAVE_IOCTL_H
 	FuUdevDevicePrivate *priv = GET_PRIVATE (self);
+	FuDeviceEmulation emulation = fu_device_get_emulation (FU_DEVICE (self));
+	FuDeviceEvent *event = NULL;
+	gint errno_tmp = 0;
 	gint rc_tmp;
+	gint64 start_time = 0;
+	gsize bufsz = 0;
+	g_autofree gchar *event_id = NULL;
 
 	g_return_val_if_fail (FU_IS_UDEV_DEVICE (self), FALSE);
 	g_return_val_if_fail (request != 0x0, FALSE);
 	g_return_val_if_fail (buf != NULL, FALSE);
-	g_return_val_if_fail (priv->fd > 0, FALSE);
+	g_return_val_if_fail (priv->fd > 0 || emulation == FU_DEVICE_EMULATION_REPLAY, FALSE);
 
-	rc_tmp = ioctl (priv->fd, request, buf);
+	/* recording or playing back; the input buffer may contain pointers
+	 * which differ for each run, so the event is keyed on the position of
+	 * the request rather than the data sent to the device */
+	if (emulation != FU_DEVICE_EMULATION_NONE) {
+		if (!fu_udev_device_ioctl_check_emulation (request, &bufsz, error))
+			return FALSE;
+		event_id = g_strdup_printf ("Ioctl:Request=0x%04x,Seq=%u",
+					    (guint) request, priv->ioctl_seq++);
+	}
+	if (emulation == FU_DEVICE_EMULATION_REPLAY) {
+		gint64 rc_event = 0;
+		gint64 errno_event = 0;
+		event = fu_device_load_event (FU_DEVICE (self), event_id, error);
+		if (event == NULL)
+			return FALSE;
+		if (!fu_device_event_get_i64 (event, "Rc", &rc_event, error))
+			return FALSE;
+		if (!fu_device_event_copy_data (event, "Data", buf, bufsz, NULL, error))
+			return FALSE;
+		if (rc_event < 0) {
+			if (!fu_device_event_get_i64 (event, "Errno", &errno_event, error))
+				return FALSE;
+			errno_tmp = errno_event;
+		}
+		rc_tmp = rc_event;
+	} else {
+		if (emulation == FU_DEVICE_EMULATION_RECORD) {
+			event = fu_device_save_event (FU_DEVICE (self), event_id);
+			start_time = g_get_monotonic_time ();
+		}
+		rc_tmp = ioctl (priv->fd, request, buf);
+		errno_tmp = errno;
+		if (event != NULL) {
+			fu_device_event_set_duration (event, g_get_monotonic_time () - start_time);
+			fu_device_event_set_i64 (event, "Rc", rc_tmp);
+			if (rc_tmp < 0)
+				fu_device_event_set_i64 (event, "Errno", errno_tmp);
+			fu_device_event_set_data (event, "Data", buf, bufsz);
+		}
+	}
 	if (rc != NULL)
 		*rc = rc_tmp;
 	if (rc_tmp < 0) {
@@ -1204,7 +1299,9 @@ fu_udev_device_ioctl (FuUdevDevice *self,
 			     FWUPD_ERROR,
 			     FWUPD_ERROR_INTERNAL,
 			     "ioctl not supported: %s",
-			     strerror (errno));
+			     strerror (errno_tmp));
+		/* callers may check errno, including when playing back */
+		errno = errno_tmp;
 		return FALSE;
 	}
 	return TRUE;
@@ -1237,19 +1334,61 @@ fu_udev_device_pread_full (FuUdevDevice *self, goffset port,
 			   GError **error)
 {
 	FuUdevDevicePrivate *priv = GET_PRIVATE (self);
+	FuDeviceEmulation emulation = fu_device_get_emulation (FU_DEVICE (self));
+	FuDeviceEvent *event = NULL;
+#ifdef HAVE_PWRITE
+	gint errno_tmp;
+	gint64 start_time = 0;
+	gssize rc;
+#endif
+	g_autofree gchar *event_id = NULL;
 
 	g_return_val_if_fail (FU_IS_UDEV_DEVICE (self), FALSE);
 	g_return_val_if_fail (buf != NULL, FALSE);
-	g_return_val_if_fail (priv->fd > 0, FALSE);
+	g_return_val_if_fail (priv->fd > 0 || emulation == FU_DEVICE_EMULATION_REPLAY, FALSE);
+
+	/* recording or playing back */
+	if (emulation != FU_DEVICE_EMULATION_NONE) {
+		event_id = g_strdup_printf ("Pread:Port=0x%x,Length=0x%x",
+					    (guint) port, (guint) bufsz);
+	}
+	if (emulation == FU_DEVICE_EMULATION_REPLAY) {
+		gsize actual_length = 0;
+		event = fu_device_load_event (FU_DEVICE (self), event_id, error);
+		if (event == NULL)
+			return FALSE;
+		if (!fu_device_event_copy_data (event, "Data", buf, bufsz, &actual_length, error))
+			return FALSE;
+		if (actual_length != bufsz) {
+			g_set_error (error,
+				     G_IO_ERROR,
+				     G_IO_ERROR_FAILED,
+				     "failed to read from port 0x%04x",
+				     (guint) port);
+			return FALSE;
+		}
+		return TRUE;
+	}
 
 #ifdef HAVE_PWRITE
-	if (pread (priv->fd, buf, bufsz, port) != (gssize) bufsz) {
+	if (emulation == FU_DEVICE_EMULATION_RECORD) {
+		event = fu_device_save_event (FU_DEVICE (self), event_id);
+		start_time = g_get_monotonic_time ();
+	}
+	rc = pread (priv->fd, buf, bufsz, port);
+	errno_tmp = errno;
+	if (event != NULL) {
+		fu_device_event_set_duration (event, g_get_monotonic_time () - start_time);
+		if (rc > 0)
+			fu_device_event_set_data (event, "Data", buf, rc);
+	}
+	if (rc != (gssize) bufsz) {
 		g_set_error (error,
 			     G_IO_ERROR,
 			     G_IO_ERROR_FAILED,
 			     "failed to read from port 0x%04x: %s",
 			     (guint) port,
-			     strerror (errno));
+			     strerror (errno_tmp));
 		return FALSE;
 	}
 	return TRUE;
@@ -1282,12 +1421,37 @@ fu_udev_device_pwrite_full (FuUdevDevice *self, goffset port,
 			    GError **error)
 {
 	FuUdevDevicePrivate *priv = GET_PRIVATE (self);
+	FuDeviceEmulation emulation = fu_device_get_emulation (FU_DEVICE (self));
+	FuDeviceEvent *event = NULL;
+#ifdef HAVE_PWRITE
+	gint64 start_time = 0;
+	gssize rc;
+#endif
+	g_autofree gchar *event_id = NULL;
 
 	g_return_val_if_fail (FU_IS_UDEV_DEVICE (self), FALSE);
-	g_return_val_if_fail (priv->fd > 0, FALSE);
+	g_return_val_if_fail (priv->fd > 0 || emulation == FU_DEVICE_EMULATION_REPLAY, FALSE);
+
+	/* recording or playing back */
+	if (emulation != FU_DEVICE_EMULATION_NONE) {
+		g_autofree gchar *data = g_base64_encode (buf, bufsz);
+		event_id = g_strdup_printf ("Pwrite:Port=0x%x,Data=%s",
+					    (guint) port, data);
+	}
+	if (emulation == FU_DEVICE_EMULATION_REPLAY) {
+		event = fu_device_load_event (FU_DEVICE (self), event_id, error);
+		return event != NULL;
+	}
 
 #ifdef HAVE_PWRITE
-	if (pwrite (priv->fd, buf, bufsz, port) != (gssize) bufsz) {
+	if (emulation == FU_DEVICE_EMULATION_RECORD) {
+		event = fu_device_save_event (FU_DEVICE (self), event_id);
+		start_time = g_get_monotonic_time ();
+	}
+	rc = pwrite (priv->fd, buf, bufsz, port);
+	if (event != NULL)
+		fu_device_event_set_duration (event, g_get_monotonic_time () - start_time);
+	if (rc != (gssize) bufsz) {
 		g_set_error (error,
 			     G_IO_ERROR,
 			     G_IO_ERROR_FAILED,
@@ -1369,11 +1533,26 @@ fu_udev_device_get_sysfs_attr (FuUdevDevice *self, const gchar *attr,
 {
 #ifdef HAVE_GUDEV
 	FuUdevDevicePrivate *priv = GET_PRIVATE (self);
+	FuDeviceEmulation emulation = fu_device_get_emulation (FU_DEVICE (self));
+	FuDeviceEvent *event = NULL;
 	const gchar *result;
+	g_autofree gchar *event_id = NULL;
 
 	g_return_val_if_fail (FU_IS_UDEV_DEVICE (self), NULL);
 	g_return_val_if_fail (attr != NULL, NULL);
 
+	/* recording or playing back */
+	if (emulation != FU_DEVICE_EMULATION_NONE)
+		event_id = g_strdup_printf ("GetSysfsAttr:Attr=%s", attr);
+	if (emulation == FU_DEVICE_EMULATION_REPLAY) {
+		event = fu_device_load_event (FU_DEVICE (self), event_id, error);
+		if (event == NULL)
+			return NULL;
+		return fu_device_event_get_str (event, "Data", error);
+	}
+	if (emulation == FU_DEVICE_EMULATION_RECORD)
+		event = fu_device_save_event (FU_DEVICE (self), event_id);
+
 	/* nothing to do */
 	if (priv->udev_device == NULL) {
 		g_set_error_literal (error,
@@ -1383,6 +1562,8 @@ fu_udev_device_get_sysfs_attr (FuUdevDevice *self, const gchar *attr,
 		return NULL;
 	}
 	result = g_udev_device_get_sysfs_attr (priv->udev_device, attr);
+	if (event != NULL)
+		fu_device_event_set_str (event, "Data", result);
 	if (result == NULL) {
 		g_set_error (error,
 			     G_IO_ERROR,
@@ -24,6 +24,7 @@ typedef struct
 {
 	GUsbDevice		*usb_device;
 	FuDeviceLocker		*usb_device_locker;
+	gboolean		 replay_open;	/* no locker when playing back */
 } FuUsbDevicePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (FuUsbDevice, fu_usb_device, FU_TYPE_DEVICE)
@@ -108,7 +109,7 @@ fu_usb_device_is_open (FuUsbDevice *device)
 {
 	FuUsbDevicePrivate *priv = GET_PRIVATE (device);
 	g_return_val_if_fail (FU_IS_USB_DEVICE (device), FALSE);
-	return priv->usb_device_locker != NULL;
+	return priv->usb_device_locker != NULL || priv->replay_open;
 }
 
 static gboolean
@@ -123,14 +124,14 @@ fu_usb_device_query_hub (FuUsbDevice *self, GError **error)
 	/* longer descriptor for SuperSpeed */
 	if (fu_usb_device_get_spec (self) >= 0x0300)
 		value = 0x2a;
-	if (!g_usb_device_control_transfer (priv->usb_device,
-					    G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					    G_USB_DEVICE_REQUEST_TYPE_CLASS,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0x06, /* LIBUSB_REQUEST_GET_DESCRIPTOR */
-					    value << 8, 0x00,
-					    data, sizeof(data), &sz,
-					    1000, NULL, error)) {
+	if (!fu_usb_device_control_transfer (self,
+					     G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0x06, /* LIBUSB_REQUEST_GET_DESCRIPTOR */
+					     value << 8, 0x00,
+					     data, sizeof(data), &sz,
+					     1000, NULL, error)) {
 		g_prefix_error (error, "failed to get USB descriptor: ");
 		return FALSE;
 	}
@@ -167,13 +168,15 @@ fu_usb_device_open (FuDevice *device, GError **error)
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
 	/* already open */
-	if (priv->usb_device_locker != NULL)
+	if (fu_usb_device_is_open (self))
 		return TRUE;
 
-	/* open */
-	locker = fu_device_locker_new (priv->usb_device, error);
-	if (locker == NULL)
-		return FALSE;
+	/* open, unless all the requests are being played back */
+	if (fu_device_get_emulation (device) != FU_DEVICE_EMULATION_REPLAY) {
+		locker = fu_device_locker_new (priv->usb_device, error);
+		if (locker == NULL)
+			return FALSE;
+	}
 
 	/* get vendor */
 	if (fu_device_get_vendor (device) == NULL) {
@@ -181,8 +184,8 @@ fu_usb_device_open (FuDevice *device, GError **error)
 		if (idx != 0x00) {
 			g_autofree gchar *tmp = NULL;
 			g_autoptr(GError) error_local = NULL;
-			tmp = g_usb_device_get_string_descriptor (priv->usb_device,
-								  idx, &error_local);
+			tmp = fu_usb_device_get_string_descriptor (self, idx,
+								   &error_local);
 			if (tmp != NULL)
 				fu_device_set_vendor (device, g_strchomp (tmp));
 			else
@@ -199,8 +202,8 @@ fu_usb_device_open (FuDevice *device, GError **error)
 		if (idx != 0x00) {
 			g_autofree gchar *tmp = NULL;
 			g_autoptr(GError) error_local = NULL;
-			tmp = g_usb_device_get_string_descriptor (priv->usb_device,
-								  idx, &error_local);
+			tmp = fu_usb_device_get_string_descriptor (self, idx,
+								   &error_local);
 			if (tmp != NULL)
 				fu_device_set_name (device, g_strchomp (tmp));
 			else
@@ -217,8 +220,8 @@ fu_usb_device_open (FuDevice *device, GError **error)
 		if (idx != 0x00) {
 			g_autofree gchar *tmp = NULL;
 			g_autoptr(GError) error_local = NULL;
-			tmp = g_usb_device_get_string_descriptor (priv->usb_device,
-								  idx, &error_local);
+			tmp = fu_usb_device_get_string_descriptor (self, idx,
+								   &error_local);
 			if (tmp != NULL)
 				fu_device_set_serial (device, g_strchomp (tmp));
 			else
@@ -235,7 +238,7 @@ fu_usb_device_open (FuDevice *device, GError **error)
 					     'F', 'W', NULL);
 	if (idx != 0x00) {
 		g_autofree gchar *tmp = NULL;
-		tmp = g_usb_device_get_string_descriptor (priv->usb_device, idx, NULL);
+		tmp = fu_usb_device_get_string_descriptor (self, idx, NULL);
 		/* although guessing is a route to insanity, if the device has
 		 * provided the extra data it's because the BCD type was not
 		 * suitable -- and INTEL_ME is not relevant here */
@@ -249,7 +252,7 @@ fu_usb_device_open (FuDevice *device, GError **error)
 					     'G', 'U', NULL);
 	if (idx != 0x00) {
 		g_autofree gchar *tmp = NULL;
-		tmp = g_usb_device_get_string_descriptor (priv->usb_device, idx, NULL);
+		tmp = fu_usb_device_get_string_descriptor (self, idx, NULL);
 		fu_device_add_guid (device, tmp);
 	}
 
@@ -267,6 +270,7 @@ fu_usb_device_open (FuDevice *device, GError **error)
 
 	/* success */
 	priv->usb_device_locker = g_steal_pointer (&locker);
+	priv->replay_open = fu_device_get_emulation (device) == FU_DEVICE_EMULATION_REPLAY;
 	return TRUE;
 }
 
@@ -280,8 +284,8 @@ fu_usb_device_close (FuDevice *device, GError **error)
 	g_return_val_if_fail (FU_IS_USB_DEVICE (self), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	/* already open */
-	if (priv->usb_device_locker == NULL)
+	/* already closed */
+	if (!fu_usb_device_is_open (self))
 		return TRUE;
 
 	/* subclassed */
@@ -291,6 +295,7 @@ fu_usb_device_close (FuDevice *device, GError **error)
 	}
 
 	g_clear_object (&priv->usb_device_locker);
+	priv->replay_open = FALSE;
 	return TRUE;
 }
 
@@ -485,6 +490,8 @@ fu_usb_device_set_dev (FuUsbDevice *device, GUsbDevice *usb_device)
 	/* set device ID automatically */
 	fu_device_set_physical_id (FU_DEVICE (device),
 				   g_usb_device_get_platform_id (usb_device));
+	fu_device_set_backend_id (FU_DEVICE (device),
+				  g_usb_device_get_platform_id (usb_device));
 }
 
 /**
@@ -561,6 +568,468 @@ fu_usb_device_get_dev (FuUsbDevice *device)
 	return priv->usb_device;
 }
 
+/* the data sent to the device is part of the request, and the data received
+ * is stored in the event */
+static gchar *
+fu_usb_device_event_data_to_string (gboolean device_to_host, const guint8 *data, gsize length)
+{
+	g_autofree gchar *data_base64 = NULL;
+	if (device_to_host)
+		return g_strdup_printf ("Length=0x%x", (guint) length);
+	data_base64 = g_base64_encode (data, length);
+	return g_strdup_printf ("Data=%s", data_base64);
+}
+
+static gboolean
+fu_usb_device_load_transfer_event (FuUsbDevice *self,
+				   const gchar *event_id,
+				   gboolean device_to_host,
+				   guint8 *data,
+				   gsize length,
+				   gsize *actual_length,
+				   GError **error)
+{
+	FuDeviceEvent *event;
+	gsize actual_length_tmp = 0;
+
+	event = fu_device_load_event (FU_DEVICE (self), event_id, error);
+	if (event == NULL)
+		return FALSE;
+	if (!fu_device_event_check_error (event, error))
+		return FALSE;
+	if (device_to_host) {
+		if (!fu_device_event_copy_data (event, "Data", data, length,
+						&actual_length_tmp, error))
+			return FALSE;
+	} else {
+		gint64 actual_length_event = 0;
+		if (!fu_device_event_get_i64 (event, "ActualLength",
+					      &actual_length_event, error))
+			return FALSE;
+		actual_length_tmp = actual_length_event;
+	}
+	if (actual_length != NULL)
+		*actual_length = actual_length_tmp;
+	return TRUE;
+}
+
+static void
+fu_usb_device_save_transfer_event (FuDeviceEvent *event,
+				   gint64 start_time,
+				   gboolean device_to_host,
+				   const guint8 *data,
+				   gsize actual_length,
+				   const GError *error)
+{
+	fu_device_event_set_duration (event, g_get_monotonic_time () - start_time);
+	fu_device_event_set_error (event, error);
+	if (error != NULL)
+		return;
+	if (device_to_host)
+		fu_device_event_set_data (event, "Data", data, actual_length);
+	else
+		fu_device_event_set_i64 (event, "ActualLength", actual_length);
+}
+
+/**
+ * fu_usb_device_control_transfer:
+ * @self: A #FuUsbDevice
+ * @direction: the #GUsbDeviceDirection
+ * @request_type: the #GUsbDeviceRequestType
+ * @recipient: the #GUsbDeviceRecipient
+ * @request: the request field for the setup packet
+ * @value: the value field for the setup packet
+ * @idx: the index field for the setup packet
+ * @data: (array length=length): a suitably-sized data buffer
+ * @length: the length field for the setup packet
+ * @actual_length: (out) (optional): the actual number of bytes sent, or %NULL
+ * @timeout: timeout timeout (in millseconds) that this function should wait
+ * before giving up due to no response being received, or 0 for unlimited
+ * @cancellable: a #GCancellable, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Performs a USB control transfer, in the same way as
+ * g_usb_device_control_transfer(), but also records or plays back the
+ * request when the device is being emulated.
+ *
+ * Returns: %TRUE on success
+ *
+ * Since: 1.5.2
+ **/
+gboolean
+fu_usb_device_control_transfer (FuUsbDevice *self,
+				GUsbDeviceDirection direction,
+				GUsbDeviceRequestType request_type,
+				GUsbDeviceRecipient recipient,
+				guint8 request,
+				guint16 value,
+				guint16 idx,
+				guint8 *data,
+				gsize length,
+				gsize *actual_length,
+				guint timeout,
+				GCancellable *cancellable,
+				GError **error)
+{
+	FuUsbDevicePrivate *priv = GET_PRIVATE (self);
+	FuDeviceEmulation emulation = fu_device_get_emulation (FU_DEVICE (self));
+	FuDeviceEvent *event = NULL;
+	gboolean device_to_host = direction == G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST;
+	gboolean ret;
+	gint64 start_time = 0;
+	gsize actual_length_tmp = 0;
+	g_autofree gchar *event_id = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	g_return_val_if_fail (FU_IS_USB_DEVICE (self), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* recording or playing back */
+	if (emulation != FU_DEVICE_EMULATION_NONE) {
+		g_autofree gchar *data_str = NULL;
+		data_str = fu_usb_device_event_data_to_string (device_to_host, data, length);
+		event_id = g_strdup_printf ("ControlTransfer:Direction=0x%02x,"
+					    "RequestType=0x%02x,Recipient=0x%02x,"
+					    "Request=0x%02x,Value=0x%04x,Idx=0x%04x,%s",
+					    (guint) direction,
+					    (guint) request_type,
+					    (guint) recipient,
+					    request, value, idx, data_str);
+	}
+	if (emulation == FU_DEVICE_EMULATION_REPLAY) {
+		return fu_usb_device_load_transfer_event (self, event_id, device_to_host,
+							  data, length, actual_length,
+							  error);
+	}
+	if (emulation == FU_DEVICE_EMULATION_RECORD) {
+		event = fu_device_save_event (FU_DEVICE (self), event_id);
+		start_time = g_get_monotonic_time ();
+	}
+	ret = g_usb_device_control_transfer (priv->usb_device,
+					     direction, request_type, recipient,
+					     request, value, idx,
+					     data, length,
+					     &actual_length_tmp,
+					     timeout, cancellable,
+					     &error_local);
+	if (event != NULL) {
+		fu_usb_device_save_transfer_event (event, start_time, device_to_host,
+						   data, actual_length_tmp, error_local);
+	}
+	if (!ret) {
+		g_propagate_error (error, g_steal_pointer (&error_local));
+		return FALSE;
+	}
+	if (actual_length != NULL)
+		*actual_length = actual_length_tmp;
+	return TRUE;
+}
+
+static gboolean
+fu_usb_device_endpoint_transfer (FuUsbDevice *self,
+				 gboolean is_interrupt,
+				 guint8 endpoint,
+				 guint8 *data,
+				 gsize length,
+				 gsize *actual_length,
+				 guint timeout,
+				 GCancellable *cancellable,
+				 GError **error)
+{
+	FuUsbDevicePrivate *priv = GET_PRIVATE (self);
+	FuDeviceEmulation emulation = fu_device_get_emulation (FU_DEVICE (self));
+	FuDeviceEvent *event = NULL;
+	gboolean device_to_host = (endpoint & 0x80) > 0;
+	gboolean ret;
+	gint64 start_time = 0;
+	gsize actual_length_tmp = 0;
+	g_autofree gchar *event_id = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	g_return_val_if_fail (FU_IS_USB_DEVICE (self), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* recording or playing back */
+	if (emulation != FU_DEVICE_EMULATION_NONE) {
+		g_autofree gchar *data_str = NULL;
+		data_str = fu_usb_device_event_data_to_string (device_to_host, data, length);
+		event_id = g_strdup_printf ("%s:Endpoint=0x%02x,%s",
+					    is_interrupt ? "InterruptTransfer" : "BulkTransfer",
+					    endpoint, data_str);
+	}
+	if (emulation == FU_DEVICE_EMULATION_REPLAY) {
+		return fu_usb_device_load_transfer_event (self, event_id, device_to_host,
+							  data, length, actual_length,
+							  error);
+	}
+	if (emulation == FU_DEVICE_EMULATION_RECORD) {
+		event = fu_device_save_event (FU_DEVICE (self), event_id);
+		start_time = g_get_monotonic_time ();
+	}
+	if (is_interrupt) {
+		ret = g_usb_device_interrupt_transfer (priv->usb_device, endpoint,
+						       data, length,
+						       &actual_length_tmp,
+						       timeout, cancellable,
+						       &error_local);
+	} else {
+		ret = g_usb_device_bulk_transfer (priv->usb_device, endpoint,
+						  data, length,
+						  &actual_length_tmp,
+						  timeout, cancellable,
+						  &error_local);
+	}
+	if (event != NULL) {
+		fu_usb_device_save_transfer_event (event, start_time, device_to_host,
+						   data, actual_length_tmp, error_local);
+	}
+	if (!ret) {
+		g_propagate_error (error, g_steal_pointer (&error_local));
+		return FALSE;
+	}
+	if (actual_length != NULL)
+		*actual_length = actual_length_tmp;
+	return TRUE;
+}
+
+/**
+ * fu_usb_device_bulk_transfer:
+ * @self: A #FuUsbDevice
+ * @endpoint: the address of a valid endpoint to communicate with
+ * @data: (array length=length): a suitably-sized data buffer
+ * @length: the size of @data
+ * @actual_length: (out) (optional): the actual number of bytes sent, or %NULL
+ * @timeout: timeout timeout (in millseconds) that this function should wait
+ * before giving up due to no response being received, or 0 for unlimited
+ * @cancellable: a #GCancellable, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Performs a USB bulk transfer, in the same way as
+ * g_usb_device_bulk_transfer(), but also records or plays back the request
+ * when the device is being emulated.
+ *
+ * Returns: %TRUE on success
+ *
+ * Since: 1.5.2
+ **/
+gboolean
+fu_usb_device_bulk_transfer (FuUsbDevice *self,
+			     guint8 endpoint,
+			     guint8 *data,
+			     gsize length,
+			     gsize *actual_length,
+			     guint timeout,
+			     GCancellable *cancellable,
+			     GError **error)
+{
+	return fu_usb_device_endpoint_transfer (self, FALSE, endpoint,
+						data, length, actual_length,
+						timeout, cancellable, error);
+}
+
+/**
+ * fu_usb_device_interrupt_transfer:
+ * @self: A #FuUsbDevice
+ * @endpoint: the address of a valid endpoint to communicate with
+ * @data: (array length=length): a suitably-sized data buffer
+ * @length: the size of @data
+ * @actual_length: (out) (optional): the actual number of bytes sent, or %NULL
+ * @timeout: timeout timeout (in millseconds) that this function should wait
+ * before giving up due to no response being received, or 0 for unlimited
+ * @cancellable: a #GCancellable, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Performs a USB interrupt transfer, in the same way as
+ * g_usb_device_interrupt_transfer(), but also records or plays back the
+ * request when the device is being emulated.
+ *
+ * Returns: %TRUE on success
+ *
+ * Since: 1.5.2
+ **/
+gboolean
+fu_usb_device_interrupt_transfer (FuUsbDevice *self,
+				  guint8 endpoint,
+				  guint8 *data,
+				  gsize length,
+				  gsize *actual_length,
+				  guint timeout,
+				  GCancellable *cancellable,
+				  GError **error)
+{
+	return fu_usb_device_endpoint_transfer (self, TRUE, endpoint,
+						data, length, actual_length,
+						timeout, cancellable, error);
+}
+
+/**
+ * fu_usb_device_claim_interface:
+ * @self: A #FuUsbDevice
+ * @iface: bInterfaceNumber of the interface you wish to claim
+ * @flags: #GUsbDeviceClaimInterfaceFlags
+ * @error: a #GError, or %NULL
+ *
+ * Claims an interface, in the same way as g_usb_device_claim_interface().
+ * Nothing is claimed when the requests are being played back.
+ *
+ * Returns: %TRUE on success
+ *
+ * Since: 1.5.2
+ **/
+gboolean
+fu_usb_device_claim_interface (FuUsbDevice *self,
+			       guint8 iface,
+			       GUsbDeviceClaimInterfaceFlags flags,
+			       GError **error)
+{
+	FuUsbDevicePrivate *priv = GET_PRIVATE (self);
+	g_return_val_if_fail (FU_IS_USB_DEVICE (self), FALSE);
+	if (fu_device_get_emulation (FU_DEVICE (self)) == FU_DEVICE_EMULATION_REPLAY)
+		return TRUE;
+	return g_usb_device_claim_interface (priv->usb_device, iface, flags, error);
+}
+
+/**
+ * fu_usb_device_release_interface:
+ * @self: A #FuUsbDevice
+ * @iface: bInterfaceNumber of the interface you wish to release
+ * @flags: #GUsbDeviceClaimInterfaceFlags
+ * @error: a #GError, or %NULL
+ *
+ * Releases an interface, in the same way as g_usb_device_release_interface().
+ * Nothing is released when the requests are being played back.
+ *
+ * Returns: %TRUE on success
+ *
+ * Since: 1.5.2
+ **/
+gboolean
+fu_usb_device_release_interface (FuUsbDevice *self,
+				 guint8 iface,
+				 GUsbDeviceClaimInterfaceFlags flags,
+				 GError **error)
+{
+	FuUsbDevicePrivate *priv = GET_PRIVATE (self);
+	g_return_val_if_fail (FU_IS_USB_DEVICE (self), FALSE);
+	if (fu_device_get_emulation (FU_DEVICE (self)) == FU_DEVICE_EMULATION_REPLAY)
+		return TRUE;
+	return g_usb_device_release_interface (priv->usb_device, iface, flags, error);
+}
+
+/**
+ * fu_usb_device_set_interface_alt:
+ * @self: A #FuUsbDevice
+ * @iface: bInterfaceNumber of the interface
+ * @alt: the alternate setting number
+ * @error: a #GError, or %NULL
+ *
+ * Sets an alternate setting on an interface, in the same way as
+ * g_usb_device_set_interface_alt(). Nothing is changed when the requests are
+ * being played back.
+ *
+ * Returns: %TRUE on success
+ *
+ * Since: 1.5.2
+ **/
+gboolean
+fu_usb_device_set_interface_alt (FuUsbDevice *self,
+				 guint8 iface,
+				 guint8 alt,
+				 GError **error)
+{
+	FuUsbDevicePrivate *priv = GET_PRIVATE (self);
+	g_return_val_if_fail (FU_IS_USB_DEVICE (self), FALSE);
+	if (fu_device_get_emulation (FU_DEVICE (self)) == FU_DEVICE_EMULATION_REPLAY)
+		return TRUE;
+	return g_usb_device_set_interface_alt (priv->usb_device, iface, alt, error);
+}
+
+/**
+ * fu_usb_device_reset:
+ * @self: A #FuUsbDevice
+ * @error: a #GError, or %NULL
+ *
+ * Resets the device, in the same way as g_usb_device_reset(). The device is
+ * not reset when the requests are being played back.
+ *
+ * Returns: %TRUE on success
+ *
+ * Since: 1.5.2
+ **/
+gboolean
+fu_usb_device_reset (FuUsbDevice *self, GError **error)
+{
+	FuUsbDevicePrivate *priv = GET_PRIVATE (self);
+	g_return_val_if_fail (FU_IS_USB_DEVICE (self), FALSE);
+	if (fu_device_get_emulation (FU_DEVICE (self)) == FU_DEVICE_EMULATION_REPLAY)
+		return TRUE;
+	return g_usb_device_reset (priv->usb_device, error);
+}
+
+/**
+ * fu_usb_device_get_string_descriptor:
+ * @self: A #FuUsbDevice
+ * @desc_index: the index for the string descriptor to retrieve
+ * @error: a #GError, or %NULL
+ *
+ * Gets a string descriptor, in the same way as
+ * g_usb_device_get_string_descriptor(), but also records or plays back the
+ * request when the device is being emulated.
+ *
+ * Returns: a newly-allocated string holding the descriptor, or %NULL on error
+ *
+ * Since: 1.5.2
+ **/
+gchar *
+fu_usb_device_get_string_descriptor (FuUsbDevice *self,
+				     guint8 desc_index,
+				     GError **error)
+{
+	FuUsbDevicePrivate *priv = GET_PRIVATE (self);
+	FuDeviceEmulation emulation = fu_device_get_emulation (FU_DEVICE (self));
+	FuDeviceEvent *event = NULL;
+	gchar *str;
+	gint64 start_time = 0;
+	g_autofree gchar *event_id = NULL;
+	g_autoptr(GError) error_local = NULL;
+
+	g_return_val_if_fail (FU_IS_USB_DEVICE (self), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* recording or playing back */
+	if (emulation != FU_DEVICE_EMULATION_NONE) {
+		event_id = g_strdup_printf ("GetStringDescriptor:DescIndex=0x%02x",
+					    desc_index);
+	}
+	if (emulation == FU_DEVICE_EMULATION_REPLAY) {
+		const gchar *tmp;
+		event = fu_device_load_event (FU_DEVICE (self), event_id, error);
+		if (event == NULL)
+			return NULL;
+		if (!fu_device_event_check_error (event, error))
+			return NULL;
+		tmp = fu_device_event_get_str (event, "Data", error);
+		if (tmp == NULL)
+			return NULL;
+		return g_strdup (tmp);
+	}
+	if (emulation == FU_DEVICE_EMULATION_RECORD) {
+		event = fu_device_save_event (FU_DEVICE (self), event_id);
+		start_time = g_get_monotonic_time ();
+	}
+	str = g_usb_device_get_string_descriptor (priv->usb_device, desc_index, &error_local);
+	if (event != NULL) {
+		fu_device_event_set_duration (event, g_get_monotonic_time () - start_time);
+		fu_device_event_set_error (event, error_local);
+		fu_device_event_set_str (event, "Data", str);
+	}
+	if (str == NULL) {
+		g_propagate_error (error, g_steal_pointer (&error_local));
+		return NULL;
+	}
+	return str;
+}
+
 static void
 fu_usb_device_incorporate (FuDevice *self, FuDevice *donor)
 {
@@ -37,3 +37,49 @@ void		 fu_usb_device_set_dev			(FuUsbDevice	*device,
 gboolean	 fu_usb_device_is_open			(FuUsbDevice	*device);
 GUdevDevice	*fu_usb_device_find_udev_device		(FuUsbDevice	*device,
 							 GError		**error);
+gboolean	 fu_usb_device_control_transfer		(FuUsbDevice	*self,
+							 GUsbDeviceDirection direction,
+							 GUsbDeviceRequestType request_type,
+							 GUsbDeviceRecipient recipient,
+							 guint8		 request,
+							 guint16	 value,
+							 guint16	 idx,
+							 guint8		*data,
+							 gsize		 length,
+							 gsize		*actual_length,
+							 guint		 timeout,
+							 GCancellable	*cancellable,
+							 GError		**error);
+gboolean	 fu_usb_device_bulk_transfer		(FuUsbDevice	*self,
+							 guint8		 endpoint,
+							 guint8		*data,
+							 gsize		 length,
+							 gsize		*actual_length,
+							 guint		 timeout,
+							 GCancellable	*cancellable,
+							 GError		**error);
+gboolean	 fu_usb_device_interrupt_transfer	(FuUsbDevice	*self,
+							 guint8		 endpoint,
+							 guint8		*data,
+							 gsize		 length,
+							 gsize		*actual_length,
+							 guint		 timeout,
+							 GCancellable	*cancellable,
+							 GError		**error);
+gboolean	 fu_usb_device_claim_interface		(FuUsbDevice	*self,
+							 guint8		 iface,
+							 GUsbDeviceClaimInterfaceFlags flags,
+							 GError		**error);
+gboolean	 fu_usb_device_release_interface	(FuUsbDevice	*self,
+							 guint8		 iface,
+							 GUsbDeviceClaimInterfaceFlags flags,
+							 GError		**error);
+gboolean	 fu_usb_device_set_interface_alt	(FuUsbDevice	*self,
+							 guint8		 iface,
+							 guint8		 alt,
+							 GError		**error);
+gboolean	 fu_usb_device_reset			(FuUsbDevice	*self,
+							 GError		**error);
+gchar		*fu_usb_device_get_string_descriptor	(FuUsbDevice	*self,
+							 guint8		 desc_index,
+							 GError		**error);
@@ -20,6 +20,7 @@
 #include <libfwupdplugin/fu-common-guid.h>
 #include <libfwupdplugin/fu-common-version.h>
 #include <libfwupdplugin/fu-device.h>
+#include <libfwupdplugin/fu-device-event.h>
 #include <libfwupdplugin/fu-device-locker.h>
 #include <libfwupdplugin/fu-device-metadata.h>
 #include <libfwupdplugin/fu-dfu-firmware.h>
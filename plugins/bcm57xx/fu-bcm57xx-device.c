@@ -336,17 +336,19 @@ fu_bcm57xx_device_dump_firmware (FuDevice *device, GError **error)
 	FuBcm57xxDevice *self = FU_BCM57XX_DEVICE (device);
 	const gsize bufsz = fu_device_get_firmware_size_max (FU_DEVICE (self));
 	g_autofree guint8 *buf = g_malloc0 (bufsz);
-	g_autoptr(GPtrArray) chunks = NULL;
+	guint chunks_cnt;
+	FuChunk chk;
+	FuChunkIter iter;
 
 	fu_device_set_status (device, FWUPD_STATUS_DEVICE_READ);
-	chunks = fu_chunk_array_new (buf, bufsz, 0x0, 0x0, FU_BCM57XX_BLOCK_SZ);
-	for (guint i = 0; i < chunks->len; i++) {
-		FuChunk *chk = g_ptr_array_index (chunks, i);
-		if (!fu_bcm57xx_device_nvram_read (self, chk->address,
-						   (guint8 *) chk->data, chk->data_sz,
+	fu_chunk_iter_init (&iter, buf, bufsz, 0x0, 0x0, FU_BCM57XX_BLOCK_SZ);
+	chunks_cnt = fu_chunk_iter_get_count (&iter);
+	while (fu_chunk_iter_next (&iter, &chk)) {
+		if (!fu_bcm57xx_device_nvram_read (self, chk.address,
+						   (guint8 *) chk.data, chk.data_sz,
 						   error))
 			return NULL;
-		fu_device_set_progress_full (device, i, chunks->len - 1);
+		fu_device_set_progress_full (device, chk.idx, chunks_cnt - 1);
 	}
 
 	/* read from hardware */
@@ -466,8 +468,10 @@ fu_bcm57xx_device_write_firmware (FuDevice *device,
 {
 	FuBcm57xxDevice *self = FU_BCM57XX_DEVICE (device);
 	g_autoptr(GBytes) blob = NULL;
+	guint chunks_cnt;
+	FuChunk chk;
+	FuChunkIter iter;
 	g_autoptr(GBytes) blob_verify = NULL;
-	g_autoptr(GPtrArray) chunks = NULL;
 
 	/* build the images into one linear blob of the correct size */
 	fu_device_set_status (device, FWUPD_STATUS_DECOMPRESSING);
@@ -477,14 +481,14 @@ fu_bcm57xx_device_write_firmware (FuDevice *device,
 
 	/* hit hardware */
 	fu_device_set_status (device, FWUPD_STATUS_DEVICE_WRITE);
-	chunks = fu_chunk_array_new_from_bytes (blob, 0x0, 0x0, FU_BCM57XX_BLOCK_SZ);
-	for (guint i = 0; i < chunks->len; i++) {
-		FuChunk *chk = g_ptr_array_index (chunks, i);
-		if (!fu_bcm57xx_device_nvram_write (self, chk->address,
-						    chk->data, chk->data_sz,
+	fu_chunk_iter_init_from_bytes (&iter, blob, 0x0, 0x0, FU_BCM57XX_BLOCK_SZ);
+	chunks_cnt = fu_chunk_iter_get_count (&iter);
+	while (fu_chunk_iter_next (&iter, &chk)) {
+		if (!fu_bcm57xx_device_nvram_write (self, chk.address,
+						    chk.data, chk.data_sz,
 						    error))
 			return FALSE;
-		fu_device_set_progress_full (device, i, chunks->len - 1);
+		fu_device_set_progress_full (device, chk.idx, chunks_cnt - 1);
 	}
 
 	/* verify */
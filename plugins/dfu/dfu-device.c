@@ -768,7 +768,6 @@ gboolean
 dfu_device_ensure_interface (DfuDevice *device, GError **error)
 {
 	DfuDevicePrivate *priv = GET_PRIVATE (device);
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (device));
 	g_autoptr(GError) error_local = NULL;
 
 	/* already done */
@@ -780,10 +779,10 @@ dfu_device_ensure_interface (DfuDevice *device, GError **error)
 		return TRUE;
 
 	/* claim, without detaching kernel driver */
-	if (!g_usb_device_claim_interface (usb_device,
-					   (gint) priv->iface_number,
-					   G_USB_DEVICE_CLAIM_INTERFACE_BIND_KERNEL_DRIVER,
-					   &error_local)) {
+	if (!fu_usb_device_claim_interface (FU_USB_DEVICE (device),
+					    (gint) priv->iface_number,
+					    G_USB_DEVICE_CLAIM_INTERFACE_BIND_KERNEL_DRIVER,
+					    &error_local)) {
 		g_set_error (error,
 			     FWUPD_ERROR,
 			     FWUPD_ERROR_NOT_SUPPORTED,
@@ -881,17 +880,17 @@ dfu_device_refresh (DfuDevice *device, GError **error)
 	    !(priv->attributes & DFU_DEVICE_ATTRIBUTE_MANIFEST_TOL))
 		return TRUE;
 
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					    G_USB_DEVICE_REQUEST_TYPE_CLASS,
-					    G_USB_DEVICE_RECIPIENT_INTERFACE,
-					    DFU_REQUEST_GETSTATUS,
-					    0,
-					    priv->iface_number,
-					    buf, sizeof(buf), &actual_length,
-					    priv->timeout_ms,
-					    NULL, /* cancellable */
-					    &error_local)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (device),
+					     G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_INTERFACE,
+					     DFU_REQUEST_GETSTATUS,
+					     0,
+					     priv->iface_number,
+					     buf, sizeof(buf), &actual_length,
+					     priv->timeout_ms,
+					     NULL, /* cancellable */
+					     &error_local)) {
 		g_set_error (error,
 			     FWUPD_ERROR,
 			     FWUPD_ERROR_NOT_SUPPORTED,
@@ -937,21 +936,20 @@ static gboolean
 dfu_device_request_detach (DfuDevice *self, GError **error)
 {
 	DfuDevicePrivate *priv = GET_PRIVATE (self);
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
 	const guint16 timeout_reset_ms = 1000;
 	g_autoptr(GError) error_local = NULL;
 
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_CLASS,
-					    G_USB_DEVICE_RECIPIENT_INTERFACE,
-					    DFU_REQUEST_DETACH,
-					    timeout_reset_ms,
-					    priv->iface_number,
-					    NULL, 0, NULL,
-					    priv->timeout_ms,
-					    NULL, /* cancellable */
-					    &error_local)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_INTERFACE,
+					     DFU_REQUEST_DETACH,
+					     timeout_reset_ms,
+					     priv->iface_number,
+					     NULL, 0, NULL,
+					     priv->timeout_ms,
+					     NULL, /* cancellable */
+					     &error_local)) {
 		/* some devices just reboot and stall the endpoint :/ */
 		if (g_error_matches (error_local,
 				     G_USB_DEVICE_ERROR,
@@ -1078,17 +1076,17 @@ dfu_device_abort (DfuDevice *device, GError **error)
 	if (!dfu_device_ensure_interface (device, error))
 		return FALSE;
 
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_CLASS,
-					    G_USB_DEVICE_RECIPIENT_INTERFACE,
-					    DFU_REQUEST_ABORT,
-					    0,
-					    priv->iface_number,
-					    NULL, 0, NULL,
-					    priv->timeout_ms,
-					    NULL, /* cancellable */
-					    &error_local)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (device),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_INTERFACE,
+					     DFU_REQUEST_ABORT,
+					     0,
+					     priv->iface_number,
+					     NULL, 0, NULL,
+					     priv->timeout_ms,
+					     NULL, /* cancellable */
+					     &error_local)) {
 		/* refresh the error code */
 		dfu_device_error_fixup (device, &error_local);
 		g_set_error (error,
@@ -1145,17 +1143,17 @@ dfu_device_clear_status (DfuDevice *device, GError **error)
 	if (!dfu_device_ensure_interface (device, error))
 		return FALSE;
 
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_CLASS,
-					    G_USB_DEVICE_RECIPIENT_INTERFACE,
-					    DFU_REQUEST_CLRSTATUS,
-					    0,
-					    priv->iface_number,
-					    NULL, 0, NULL,
-					    priv->timeout_ms,
-					    NULL, /* cancellable */
-					    &error_local)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (device),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_INTERFACE,
+					     DFU_REQUEST_CLRSTATUS,
+					     0,
+					     priv->iface_number,
+					     NULL, 0, NULL,
+					     priv->timeout_ms,
+					     NULL, /* cancellable */
+					     &error_local)) {
 		/* refresh the error code */
 		dfu_device_error_fixup (device, &error_local);
 		g_set_error (error,
@@ -1233,13 +1231,12 @@ dfu_device_close (FuUsbDevice *device, GError **error)
 {
 	DfuDevice *self = DFU_DEVICE (device);
 	DfuDevicePrivate *priv = GET_PRIVATE (self);
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (device));
 
 	/* release interface */
 	if (priv->claimed_interface) {
-		g_usb_device_release_interface (usb_device,
-						(gint) priv->iface_number,
-						0, NULL);
+		fu_usb_device_release_interface (FU_USB_DEVICE (device),
+						 (gint) priv->iface_number,
+						 0, NULL);
 		priv->claimed_interface = FALSE;
 	}
 
@@ -1305,7 +1302,7 @@ dfu_device_reset (DfuDevice *device, GError **error)
 		return FALSE;
 	}
 
-	if (!g_usb_device_reset (usb_device, &error_local)) {
+	if (!fu_usb_device_reset (FU_USB_DEVICE (device), &error_local)) {
 		g_set_error (error,
 			     FWUPD_ERROR,
 			     FWUPD_ERROR_NOT_SUPPORTED,
@@ -578,7 +578,6 @@ static gboolean
 dfu_target_use_alt_setting (DfuTarget *target, GError **error)
 {
 	DfuTargetPrivate *priv = GET_PRIVATE (target);
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (priv->device));
 	g_autoptr(GError) error_local = NULL;
 
 	g_return_val_if_fail (DFU_IS_TARGET (target), FALSE);
@@ -590,10 +589,10 @@ dfu_target_use_alt_setting (DfuTarget *target, GError **error)
 
 	/* use the correct setting */
 	if (fu_device_has_flag (FU_DEVICE (priv->device), FWUPD_DEVICE_FLAG_IS_BOOTLOADER)) {
-		if (!g_usb_device_set_interface_alt (usb_device,
-						     (gint) dfu_device_get_interface (priv->device),
-						     (gint) priv->alt_setting,
-						     &error_local)) {
+		if (!fu_usb_device_set_interface_alt (FU_USB_DEVICE (priv->device),
+						      (gint) dfu_device_get_interface (priv->device),
+						      (gint) priv->alt_setting,
+						      &error_local)) {
 			g_set_error (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_NOT_SUPPORTED,
@@ -657,11 +656,10 @@ dfu_target_setup (DfuTarget *target, GError **error)
 
 	/* get string */
 	if (priv->alt_idx != 0x00 && priv->alt_name == NULL) {
-		GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (priv->device));
 		priv->alt_name =
-			g_usb_device_get_string_descriptor (usb_device,
-							    priv->alt_idx,
-							    NULL);
+			fu_usb_device_get_string_descriptor (FU_USB_DEVICE (priv->device),
+							     priv->alt_idx,
+							     NULL);
 	}
 
 	/* parse the DfuSe format according to UM0424 */
@@ -719,7 +717,6 @@ gboolean
 dfu_target_download_chunk (DfuTarget *target, guint16 index, GBytes *bytes, GError **error)
 {
 	DfuTargetPrivate *priv = GET_PRIVATE (target);
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (priv->device));
 	g_autoptr(GError) error_local = NULL;
 	gsize actual_length;
 
@@ -731,19 +728,19 @@ dfu_target_download_chunk (DfuTarget *target, guint16 index, GBytes *bytes, GErr
 			g_print ("Message: m[%" G_GSIZE_FORMAT "] = 0x%02x\n", i, (guint) data[i]);
 	}
 
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_CLASS,
-					    G_USB_DEVICE_RECIPIENT_INTERFACE,
-					    DFU_REQUEST_DNLOAD,
-					    index,
-					    dfu_device_get_interface (priv->device),
-					    (guint8 *) g_bytes_get_data (bytes, NULL),
-					    g_bytes_get_size (bytes),
-					    &actual_length,
-					    dfu_device_get_timeout (priv->device),
-					    NULL,
-					    &error_local)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (priv->device),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_INTERFACE,
+					     DFU_REQUEST_DNLOAD,
+					     index,
+					     dfu_device_get_interface (priv->device),
+					     (guint8 *) g_bytes_get_data (bytes, NULL),
+					     g_bytes_get_size (bytes),
+					     &actual_length,
+					     dfu_device_get_timeout (priv->device),
+					     NULL,
+					     &error_local)) {
 		/* refresh the error code */
 		dfu_device_error_fixup (priv->device, &error_local);
 		g_set_error (error,
@@ -784,7 +781,6 @@ GBytes *
 dfu_target_upload_chunk (DfuTarget *target, guint16 index, gsize buf_sz, GError **error)
 {
 	DfuTargetPrivate *priv = GET_PRIVATE (target);
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (priv->device));
 	g_autoptr(GError) error_local = NULL;
 	guint8 *buf;
 	gsize actual_length;
@@ -794,18 +790,18 @@ dfu_target_upload_chunk (DfuTarget *target, guint16 index, gsize buf_sz, GError
 		buf_sz = (gsize) dfu_device_get_transfer_size (priv->device);
 
 	buf = g_new0 (guint8, buf_sz);
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					    G_USB_DEVICE_REQUEST_TYPE_CLASS,
-					    G_USB_DEVICE_RECIPIENT_INTERFACE,
-					    DFU_REQUEST_UPLOAD,
-					    index,
-					    dfu_device_get_interface (priv->device),
-					    buf, buf_sz,
-					    &actual_length,
-					    dfu_device_get_timeout (priv->device),
-					    NULL,
-					    &error_local)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (priv->device),
+					     G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					     G_USB_DEVICE_REQUEST_TYPE_CLASS,
+					     G_USB_DEVICE_RECIPIENT_INTERFACE,
+					     DFU_REQUEST_UPLOAD,
+					     index,
+					     dfu_device_get_interface (priv->device),
+					     buf, buf_sz,
+					     &actual_length,
+					     dfu_device_get_timeout (priv->device),
+					     NULL,
+					     &error_local)) {
 		/* refresh the error code */
 		dfu_device_error_fixup (priv->device, &error_local);
 		g_set_error (error,
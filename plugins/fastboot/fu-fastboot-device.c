@@ -608,8 +608,8 @@ fu_fastboot_device_write_firmware (FuDevice *device,
 	if (fw == NULL)
 		return FALSE;
 
-	/* decompress entire archive ahead of time */
-	archive = fu_archive_new (fw, FU_ARCHIVE_FLAG_IGNORE_PATH, error);
+	/* only decompress the images referenced by the manifest */
+	archive = fu_archive_new (fw, FU_ARCHIVE_FLAG_IGNORE_PATH | FU_ARCHIVE_FLAG_LAZY, error);
 	if (archive == NULL)
 		return FALSE;
 
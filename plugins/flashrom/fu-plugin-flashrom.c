@@ -29,8 +29,14 @@
 
 #define SELFCHECK_TRUE 1
 
+/* smallest erase block on any supported SPI flash */
+#define FU_PLUGIN_FLASHROM_BLOCK_SIZE	0x1000
+
+#define FU_PLUGIN_FLASHROM_IFD_SIGNATURE	0x0FF0A55A
+
 struct FuPluginData {
 	gsize				 flash_size;
+	GBytes				*refbuf;	/* current flash contents */
 	struct flashrom_flashctx	*flashctx;
 	struct flashrom_layout		*layout;
 	struct flashrom_programmer	*flashprog;
@@ -47,6 +53,8 @@ void
 fu_plugin_destroy (FuPlugin *plugin)
 {
 	FuPluginData *data = fu_plugin_get_data (plugin);
+	if (data->refbuf != NULL)
+		g_bytes_unref (data->refbuf);
 	flashrom_layout_release (data->layout);
 	flashrom_programmer_shutdown (data->flashprog);
 	flashrom_flash_release (data->flashctx);
@@ -173,37 +181,115 @@ fu_plugin_update_prepare (FuPlugin *plugin,
 	FuPluginData *data = fu_plugin_get_data (plugin);
 	g_autofree gchar *firmware_orig = NULL;
 	g_autofree gchar *basename = NULL;
+	g_autofree guint8 *newcontents = NULL;
 
 	/* not us */
 	if (fu_plugin_cache_lookup (plugin, fu_device_get_id (device)) == NULL)
 		return TRUE;
 
-	/* if the original firmware doesn't exist, grab it now */
+	/* read the current contents, which are used as the reference when
+	 * writing so that flashrom can skip the erase blocks that match */
+	fu_device_set_status (device, FWUPD_STATUS_DEVICE_READ);
+	newcontents = g_malloc0 (data->flash_size);
+	if (flashrom_image_read (data->flashctx, newcontents, data->flash_size)) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_READ,
+				     "failed to read current firmware");
+		return FALSE;
+	}
+	if (data->refbuf != NULL)
+		g_bytes_unref (data->refbuf);
+	data->refbuf = g_bytes_new_take (g_steal_pointer (&newcontents), data->flash_size);
+
+	/* if the original firmware doesn't exist, save it now -- an existing
+	 * backup may be from before a previous update so is not reused */
 	basename = g_strdup_printf ("flashrom-%s.bin", fu_device_get_id (device));
 	firmware_orig = g_build_filename (FWUPD_LOCALSTATEDIR, "lib", "fwupd",
 					  "builder", basename, NULL);
 	if (!fu_common_mkdir_parent (firmware_orig, error))
 		return FALSE;
 	if (!g_file_test (firmware_orig, G_FILE_TEST_EXISTS)) {
-		g_autofree guint8 *newcontents = g_malloc0 (data->flash_size);
-		g_autoptr(GBytes) buf = NULL;
-
-		fu_device_set_status (device, FWUPD_STATUS_DEVICE_READ);
-		if (flashrom_image_read (data->flashctx, newcontents, data->flash_size)) {
-			g_set_error_literal (error,
-					     FWUPD_ERROR,
-					     FWUPD_ERROR_READ,
-					     "failed to back up original firmware");
+		if (!fu_common_set_contents_bytes (firmware_orig, data->refbuf, error))
 			return FALSE;
-		}
-		buf = g_bytes_new_static (newcontents, data->flash_size);
-		if (!fu_common_set_contents_bytes (firmware_orig, buf, error))
+	}
+
+	return TRUE;
+}
+
+/* finds the BIOS region in the Intel flash descriptor, which is the same
+ * region flashrom_layout_read_from_ifd() reads from the flash */
+static gboolean
+fu_plugin_flashrom_get_bios_region (const guint8 *buf,
+				    gsize bufsz,
+				    gsize *offset,
+				    gsize *size,
+				    GError **error)
+{
+	guint32 flmap0 = 0;
+	guint32 flreg1 = 0;
+	guint32 sig = 0;
+	gsize base;
+	gsize frba;
+	gsize limit;
+	gsize sig_offset = 0x10;
+
+	/* older chipsets have the signature at the very start */
+	if (!fu_common_read_uint32_safe (buf, bufsz, sig_offset, &sig,
+					 G_LITTLE_ENDIAN, error))
+		return FALSE;
+	if (sig != FU_PLUGIN_FLASHROM_IFD_SIGNATURE) {
+		sig_offset = 0x0;
+		if (!fu_common_read_uint32_safe (buf, bufsz, sig_offset, &sig,
+						 G_LITTLE_ENDIAN, error))
 			return FALSE;
 	}
+	if (sig != FU_PLUGIN_FLASHROM_IFD_SIGNATURE) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "no Intel flash descriptor signature");
+		return FALSE;
+	}
 
+	/* FLREG1 is the BIOS region, in units of 4kB */
+	if (!fu_common_read_uint32_safe (buf, bufsz, sig_offset + 0x4, &flmap0,
+					 G_LITTLE_ENDIAN, error))
+		return FALSE;
+	frba = ((flmap0 >> 16) & 0xff) << 4;
+	if (!fu_common_read_uint32_safe (buf, bufsz, frba + 0x4, &flreg1,
+					 G_LITTLE_ENDIAN, error))
+		return FALSE;
+	base = (gsize) (flreg1 & 0x7fff) << 12;
+	limit = ((gsize) ((flreg1 >> 16) & 0x7fff) << 12) | 0xfff;
+	if (base > limit || limit >= bufsz) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "invalid BIOS region 0x%x:0x%x",
+			     (guint) base, (guint) limit);
+		return FALSE;
+	}
+	*offset = base;
+	*size = limit - base + 1;
 	return TRUE;
 }
 
+/* returns the number of erase blocks that differ from the reference */
+static guint
+fu_plugin_flashrom_count_changed_blocks (const guint8 *buf,
+					 const guint8 *refbuf,
+					 gsize bufsz)
+{
+	guint cnt = 0;
+	for (gsize i = 0; i < bufsz; i += FU_PLUGIN_FLASHROM_BLOCK_SIZE) {
+		gsize chunksz = MIN (bufsz - i, FU_PLUGIN_FLASHROM_BLOCK_SIZE);
+		if (memcmp (buf + i, refbuf + i, chunksz) != 0)
+			cnt++;
+	}
+	return cnt;
+}
+
 gboolean
 fu_plugin_update (FuPlugin *plugin,
 		  FuDevice *device,
@@ -214,7 +300,9 @@ fu_plugin_update (FuPlugin *plugin,
 	FuPluginData *data = fu_plugin_get_data (plugin);
 	gsize sz = 0;
 	gint rc;
+	guint8 *refbuf = NULL;
 	const guint8 *buf = g_bytes_get_data (blob_fw, &sz);
+	g_autoptr(GBytes) refblob = g_steal_pointer (&data->refbuf);
 
 	if (flashrom_layout_read_from_ifd (&data->layout, data->flashctx, NULL, 0)) {
 		g_set_error_literal (error,
@@ -244,8 +332,45 @@ fu_plugin_update (FuPlugin *plugin,
 		return FALSE;
 	}
 
+	/* only the changed erase blocks need to be erased and programmed, and
+	 * flashrom only writes the included region */
+	if (refblob != NULL && g_bytes_get_size (refblob) == sz)
+		refbuf = (guint8 *) g_bytes_get_data (refblob, NULL);
+	if (refbuf != NULL) {
+		gsize region_offset = 0;
+		gsize region_size = 0;
+		g_autoptr(GError) error_local = NULL;
+		if (!fu_plugin_flashrom_get_bios_region (refbuf, sz,
+							 &region_offset,
+							 &region_size,
+							 &error_local)) {
+			g_debug ("not counting changed blocks: %s",
+				 error_local->message);
+		} else {
+			guint blocks_total = (region_size + FU_PLUGIN_FLASHROM_BLOCK_SIZE - 1) /
+					     FU_PLUGIN_FLASHROM_BLOCK_SIZE;
+			guint blocks_changed;
+			blocks_changed = fu_plugin_flashrom_count_changed_blocks (buf + region_offset,
+										  refbuf + region_offset,
+										  region_size);
+			g_debug ("%u of %u blocks changed in region 0x%x:0x%x, "
+				 "skipping 0x%x bytes",
+				 blocks_changed, blocks_total,
+				 (guint) region_offset, (guint) region_size,
+				 (guint) (blocks_total - blocks_changed) * FU_PLUGIN_FLASHROM_BLOCK_SIZE);
+			if (blocks_changed == 0) {
+				g_debug ("flash contents already match, skipping write");
+				return TRUE;
+			}
+		}
+	}
+
+	/* flashrom verifies what it wrote, which is skipped when no erase
+	 * blocks differ from the reference */
+	flashrom_flag_set (data->flashctx, FLASHROM_FLAG_VERIFY_AFTER_WRITE, TRUE);
+	flashrom_flag_set (data->flashctx, FLASHROM_FLAG_VERIFY_WHOLE_CHIP, FALSE);
 	fu_device_set_status (device, FWUPD_STATUS_DEVICE_WRITE);
-	rc = flashrom_image_write (data->flashctx, (void *) buf, sz, NULL /* refbuffer */);
+	rc = flashrom_image_write (data->flashctx, (void *) buf, sz, refbuf);
 	if (rc != 0) {
 		g_set_error (error,
 			     FWUPD_ERROR,
@@ -254,15 +379,6 @@ fu_plugin_update (FuPlugin *plugin,
 		return FALSE;
 	}
 
-	fu_device_set_status (device, FWUPD_STATUS_DEVICE_VERIFY);
-	if (flashrom_image_verify (data->flashctx, (void *) buf, sz)) {
-		g_set_error (error,
-			     FWUPD_ERROR,
-			     FWUPD_ERROR_WRITE,
-			     "image verify failed");
-		return FALSE;
-	}
-
 	/* success */
 	return TRUE;
 }
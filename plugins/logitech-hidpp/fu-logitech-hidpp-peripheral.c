@@ -236,11 +236,10 @@ static gboolean
 fu_logitech_hidpp_peripheral_open (FuDevice *device, GError **error)
 {
 	FuLogitechHidPpPeripheral *self = FU_UNIFYING_PERIPHERAL (device);
-	GUdevDevice *udev_device = fu_udev_device_get_dev (FU_UDEV_DEVICE (device));
-	const gchar *devpath = g_udev_device_get_device_file (udev_device);
+	const gchar *devpath = fu_udev_device_get_device_file (FU_UDEV_DEVICE (device));
 
 	/* open */
-	self->io_channel = fu_io_channel_new_file (devpath, error);
+	self->io_channel = fu_io_channel_new_for_device (device, devpath, error);
 	if (self->io_channel == NULL)
 		return FALSE;
 
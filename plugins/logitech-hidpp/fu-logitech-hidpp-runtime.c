@@ -112,11 +112,10 @@ static gboolean
 fu_logitech_hidpp_runtime_open (FuDevice *device, GError **error)
 {
 	FuLogitechHidPpRuntime *self = FU_UNIFYING_RUNTIME (device);
-	GUdevDevice *udev_device = fu_udev_device_get_dev (FU_UDEV_DEVICE (device));
-	const gchar *devpath = g_udev_device_get_device_file (udev_device);
+	const gchar *devpath = fu_udev_device_get_device_file (FU_UDEV_DEVICE (device));
 
 	/* open, but don't block */
-	self->io_channel = fu_io_channel_new_file (devpath, error);
+	self->io_channel = fu_io_channel_new_for_device (device, devpath, error);
 	if (self->io_channel == NULL)
 		return FALSE;
 
@@ -566,8 +566,8 @@ fu_mm_device_write_firmware_qmi_pdc (FuDevice *device, GBytes *fw, GArray **acti
 		.total_bytes = 0,
 	};
 
-	/* decompress entire archive ahead of time */
-	archive = fu_archive_new (fw, FU_ARCHIVE_FLAG_IGNORE_PATH, error);
+	/* only the MCFG files are kept when iterating */
+	archive = fu_archive_new (fw, FU_ARCHIVE_FLAG_IGNORE_PATH | FU_ARCHIVE_FLAG_LAZY, error);
 	if (archive == NULL)
 		return FALSE;
 
@@ -17,4 +17,7 @@ fu_plugin_init (FuPlugin *plugin)
 	fu_plugin_set_build_hash (plugin, FU_BUILD_HASH);
 	fu_plugin_add_udev_subsystem (plugin, "nvme");
 	fu_plugin_set_device_gtype (plugin, FU_TYPE_NVME_DEVICE);
+
+	/* each drive is written using its own fd and never replugs */
+	fu_plugin_add_rule (plugin, FU_PLUGIN_RULE_THREAD_SAFE, "update");
 }
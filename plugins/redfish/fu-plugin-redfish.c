@@ -118,6 +118,9 @@ fu_plugin_init (FuPlugin *plugin)
 	FuPluginData *data = fu_plugin_alloc_data (plugin, sizeof (FuPluginData));
 	data->client = fu_redfish_client_new ();
 	fu_plugin_set_build_hash (plugin, FU_BUILD_HASH);
+
+	/* the BMC can be slow to respond, and the client has no shared state */
+	fu_plugin_add_rule (plugin, FU_PLUGIN_RULE_THREAD_SAFE, "coldplug");
 }
 
 void
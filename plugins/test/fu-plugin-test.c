@@ -11,6 +11,8 @@
 
 struct FuPluginData {
 	GMutex			 mutex;
+	guint			 security_attrs_cnt;
+	gint			 probe_active;	/* atomic */
 };
 
 void
@@ -150,7 +152,9 @@ fu_plugin_update (FuPlugin *plugin,
 {
 	const gchar *test = g_getenv ("FWUPD_PLUGIN_TEST");
 	gboolean requires_activation = g_strcmp0 (test, "requires-activation") == 0;
-	if (g_strcmp0 (test, "fail") == 0) {
+	if (g_strcmp0 (test, "fail") == 0 ||
+	    (g_strcmp0 (test, "fail-logical-id") == 0 &&
+	     g_strcmp0 (fu_device_get_logical_id (device), "fail") == 0)) {
 		g_set_error_literal (error,
 				     FWUPD_ERROR,
 				     FWUPD_ERROR_NOT_SUPPORTED,
@@ -215,6 +219,51 @@ fu_plugin_update (FuPlugin *plugin,
 	return TRUE;
 }
 
+void
+fu_plugin_add_security_attrs (FuPlugin *plugin, FuSecurityAttrs *attrs)
+{
+	FuPluginData *data = fu_plugin_get_data (plugin);
+	g_autofree gchar *cnt = NULL;
+	g_autoptr(FwupdSecurityAttr) attr = NULL;
+
+	if (g_strcmp0 (g_getenv ("FWUPD_PLUGIN_TEST"), "security-attrs") != 0)
+		return;
+
+	/* for the self tests only */
+	cnt = g_strdup_printf ("%u", ++data->security_attrs_cnt);
+	attr = fwupd_security_attr_new ("org.fwupd.hsi.Test");
+	fwupd_security_attr_set_plugin (attr, fu_plugin_get_name (plugin));
+	fwupd_security_attr_set_name (attr, "Test");
+	fwupd_security_attr_add_metadata (attr, "nr-queries", cnt);
+	fu_security_attrs_append (attrs, attr);
+}
+
+gboolean
+fu_plugin_udev_device_added (FuPlugin *plugin, FuUdevDevice *device, GError **error)
+{
+	FuPluginData *data = fu_plugin_get_data (plugin);
+	g_autofree gchar *key = NULL;
+
+	if (g_strcmp0 (g_getenv ("FWUPD_PLUGIN_TEST"), "probe-thread") != 0) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_NOT_SUPPORTED,
+				     "not supported");
+		return FALSE;
+	}
+
+	/* for the self tests only, where events for the same device have to be
+	 * processed one at a time */
+	if (g_atomic_int_add (&data->probe_active, 1) != 0)
+		fu_device_set_metadata_boolean (FU_DEVICE (device), "ProbeOverlap", TRUE);
+	g_usleep (G_USEC_PER_SEC / 50);
+	key = g_strdup_printf ("nr-added-%s", fu_plugin_get_name (plugin));
+	fu_device_set_metadata_integer (FU_DEVICE (device), key,
+					fu_device_get_metadata_integer (FU_DEVICE (device), key) + 1);
+	g_atomic_int_add (&data->probe_active, -1);
+	return TRUE;
+}
+
 gboolean
 fu_plugin_activate (FuPlugin *plugin, FuDevice *device, GError **error)
 {
@@ -25,15 +25,15 @@ static gboolean
 fu_vli_pd_device_read_regs (FuVliPdDevice *self, guint16 addr,
 			    guint8 *buf, gsize bufsz, GError **error)
 {
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0xe0,
-					    ((addr & 0xff) << 8) | 0x01,
-					    addr >> 8,
-					    buf, bufsz, NULL,
-					    1000, NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0xe0,
+					     ((addr & 0xff) << 8) | 0x01,
+					     addr >> 8,
+					     buf, bufsz, NULL,
+					     1000, NULL, error)) {
 		g_prefix_error (error, "failed to write register @0x%x: ", addr);
 		return FALSE;
 	}
@@ -57,15 +57,15 @@ fu_vli_pd_device_write_reg (FuVliPdDevice *self, guint16 addr, guint8 value, GEr
 		g_autofree gchar *title = g_strdup_printf ("WriteReg@0x%x", addr);
 		fu_common_dump_raw (G_LOG_DOMAIN, title, &value, sizeof(value));
 	}
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0xe0,
-					    ((addr & 0xff) << 8) | 0x02,
-					    addr >> 8,
-					    &value, sizeof(value), NULL,
-					    1000, NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0xe0,
+					     ((addr & 0xff) << 8) | 0x02,
+					     addr >> 8,
+					     &value, sizeof(value), NULL,
+					     1000, NULL, error)) {
 		g_prefix_error (error, "failed to write register @0x%x: ", addr);
 		return FALSE;
 	}
@@ -79,14 +79,14 @@ fu_vli_pd_device_spi_read_status (FuVliDevice *self, guint8 *status, GError **er
 	if (!fu_vli_device_get_spi_cmd (self, FU_VLI_DEVICE_SPI_REQ_READ_STATUS,
 					&spi_cmd, error))
 		return FALSE;
-	return g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					      G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					      G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					      G_USB_DEVICE_RECIPIENT_DEVICE,
-					      0xc5, spi_cmd, 0x0000,
-					      status, 0x1, NULL,
-					      FU_VLI_DEVICE_TIMEOUT,
-					      NULL, error);
+	return fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					       G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					       G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					       G_USB_DEVICE_RECIPIENT_DEVICE,
+					       0xc5, spi_cmd, 0x0000,
+					       status, 0x1, NULL,
+					       FU_VLI_DEVICE_TIMEOUT,
+					       NULL, error);
 }
 
 static gboolean
@@ -100,14 +100,14 @@ fu_vli_pd_device_spi_read_data (FuVliDevice *self, guint32 addr, guint8 *buf, gs
 		return FALSE;
 	value = ((addr << 8) & 0xff00) | spi_cmd;
 	index = addr >> 8;
-	return g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					      G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					      G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					      G_USB_DEVICE_RECIPIENT_DEVICE,
-					      0xc4, value, index,
-					      buf, bufsz, NULL,
-					      FU_VLI_DEVICE_TIMEOUT,
-					      NULL, error);
+	return fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					       G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					       G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					       G_USB_DEVICE_RECIPIENT_DEVICE,
+					       0xc4, value, index,
+					       buf, bufsz, NULL,
+					       FU_VLI_DEVICE_TIMEOUT,
+					       NULL, error);
 }
 
 static gboolean
@@ -119,14 +119,14 @@ fu_vli_pd_device_spi_write_status (FuVliDevice *self, guint8 status, GError **er
 					&spi_cmd, error))
 		return FALSE;
 	value = ((guint16) status << 8) | spi_cmd;
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0xd8, value, 0x0,
-					    NULL, 0, NULL,
-					    FU_VLI_DEVICE_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0xd8, value, 0x0,
+					     NULL, 0, NULL,
+					     FU_VLI_DEVICE_TIMEOUT,
+					     NULL, error)) {
 		return FALSE;
 	}
 
@@ -142,14 +142,14 @@ fu_vli_pd_device_spi_write_enable (FuVliDevice *self, GError **error)
 	if (!fu_vli_device_get_spi_cmd (self, FU_VLI_DEVICE_SPI_REQ_WRITE_EN,
 					&spi_cmd, error))
 		return FALSE;
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0xd4, spi_cmd, 0x0000,
-					    NULL, 0x0, NULL,
-					    FU_VLI_DEVICE_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0xd4, spi_cmd, 0x0000,
+					     NULL, 0x0, NULL,
+					     FU_VLI_DEVICE_TIMEOUT,
+					     NULL, error)) {
 		g_prefix_error (error, "failed to write enable SPI: ");
 		return FALSE;
 	}
@@ -163,14 +163,14 @@ fu_vli_pd_device_spi_chip_erase (FuVliDevice *self, GError **error)
 	if (!fu_vli_device_get_spi_cmd (self, FU_VLI_DEVICE_SPI_REQ_CHIP_ERASE,
 					&spi_cmd, error))
 		return FALSE;
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0xd1, spi_cmd, 0x0000,
-					    NULL, 0x0, NULL,
-					    FU_VLI_DEVICE_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0xd1, spi_cmd, 0x0000,
+					     NULL, 0x0, NULL,
+					     FU_VLI_DEVICE_TIMEOUT,
+					     NULL, error)) {
 		return FALSE;
 	}
 	return TRUE;
@@ -187,14 +187,14 @@ fu_vli_pd_device_spi_sector_erase (FuVliDevice *self, guint32 addr, GError **err
 		return FALSE;
 	value = ((addr << 8) & 0xff00) | spi_cmd;
 	index = addr >> 8;
-	return g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					      G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					      G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					      G_USB_DEVICE_RECIPIENT_DEVICE,
-					      0xd2, value, index,
-					      NULL, 0x0, NULL,
-					      FU_VLI_DEVICE_TIMEOUT,
-					      NULL, error);
+	return fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					       G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					       G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					       G_USB_DEVICE_RECIPIENT_DEVICE,
+					       0xd2, value, index,
+					       NULL, 0x0, NULL,
+					       FU_VLI_DEVICE_TIMEOUT,
+					       NULL, error);
 }
 
 static gboolean
@@ -212,14 +212,14 @@ fu_vli_pd_device_spi_write_data (FuVliDevice *self,
 		return FALSE;
 	value = ((addr << 8) & 0xff00) | spi_cmd;
 	index = addr >> 8;
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0xdc, value, index,
-					    (guint8 *) buf, bufsz, NULL,
-					    FU_VLI_DEVICE_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0xdc, value, index,
+					     (guint8 *) buf, bufsz, NULL,
+					     FU_VLI_DEVICE_TIMEOUT,
+					     NULL, error)) {
 		return FALSE;
 	}
 	return TRUE;
@@ -262,13 +262,13 @@ fu_vli_pd_device_setup (FuVliDevice *device, GError **error)
 	g_autofree gchar *version_str = NULL;
 
 	/* get version */
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (self)),
-					    G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0xe2, 0x0001, 0x0000,
-					    verbuf, sizeof(verbuf), NULL,
-					    1000, NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0xe2, 0x0001, 0x0000,
+					     verbuf, sizeof(verbuf), NULL,
+					     1000, NULL, error)) {
 		g_prefix_error (error, "failed to get version: ");
 		return FALSE;
 	}
@@ -524,14 +524,14 @@ fu_vli_pd_device_detach (FuDevice *device, GError **error)
 	/* VL103 set ROM sig does not work, so use alternate function */
 	if (fu_vli_device_get_kind (FU_VLI_DEVICE (device)) == FU_VLI_DEVICE_KIND_VL103) {
 		fu_device_set_status (device, FWUPD_STATUS_DEVICE_RESTART);
-		if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (device)),
-						    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-						    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-						    G_USB_DEVICE_RECIPIENT_DEVICE,
-						    0xc0, 0x0000, 0x0000,
-						    NULL, 0x0, NULL,
-						    FU_VLI_DEVICE_TIMEOUT,
-						    NULL, &error_local)) {
+		if (!fu_usb_device_control_transfer (FU_USB_DEVICE (device),
+						     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+						     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+						     G_USB_DEVICE_RECIPIENT_DEVICE,
+						     0xc0, 0x0000, 0x0000,
+						     NULL, 0x0, NULL,
+						     FU_VLI_DEVICE_TIMEOUT,
+						     NULL, &error_local)) {
 			if (g_error_matches (error_local,
 					     G_USB_DEVICE_ERROR,
 					     G_USB_DEVICE_ERROR_FAILED)) {
@@ -566,27 +566,27 @@ fu_vli_pd_device_detach (FuDevice *device, GError **error)
 	}
 
 	/* set ROM sig */
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (device)),
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0xa0,
-					    0x0000, 0x0000,
-					    NULL, 0x0, NULL,
-					    FU_VLI_DEVICE_TIMEOUT,
-					    NULL, error))
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (device),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0xa0,
+					     0x0000, 0x0000,
+					     NULL, 0x0, NULL,
+					     FU_VLI_DEVICE_TIMEOUT,
+					     NULL, error))
 		return FALSE;
 
 	/* reset from SPI_Code into ROM_Code */
 	fu_device_set_status (device, FWUPD_STATUS_DEVICE_RESTART);
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (device)),
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0xb0, 0x0000, 0x0000,
-					    NULL, 0x0, NULL,
-					    FU_VLI_DEVICE_TIMEOUT,
-					    NULL, &error_local)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (device),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0xb0, 0x0000, 0x0000,
+					     NULL, 0x0, NULL,
+					     FU_VLI_DEVICE_TIMEOUT,
+					     NULL, &error_local)) {
 		if (g_error_matches (error_local,
 				     G_USB_DEVICE_ERROR,
 				     G_USB_DEVICE_ERROR_FAILED)) {
@@ -630,15 +630,15 @@ fu_vli_pd_device_attach (FuDevice *device, GError **error)
 	}
 
 	/* chip reset command works only for non-VL103 */
-	if (!g_usb_device_control_transfer (fu_usb_device_get_dev (FU_USB_DEVICE (device)),
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    0xb0,
-					    0x0000, 0x0000,
-					    NULL, 0x0, NULL,
-					    FU_VLI_DEVICE_TIMEOUT,
-					    NULL, &error_local)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (device),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     0xb0,
+					     0x0000, 0x0000,
+					     NULL, 0x0, NULL,
+					     FU_VLI_DEVICE_TIMEOUT,
+					     NULL, &error_local)) {
 		if (g_error_matches (error_local,
 				     G_USB_DEVICE_ERROR,
 				     G_USB_DEVICE_ERROR_NO_DEVICE) ||
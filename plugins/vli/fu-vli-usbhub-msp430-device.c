@@ -39,17 +39,16 @@ fu_vli_usbhub_device_i2c_read (FuVliUsbhubDevice *self,
 			       guint8 cmd, guint8 *buf, gsize bufsz,
 			       GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
 	guint16 value = ((guint16) I2C_ADDR_WRITE << 8) | cmd;
 	guint16 index = (guint16) I2C_ADDR_READ << 8;
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    I2C_R_VDR, value, index,
-					    buf, bufsz, NULL,
-					    FU_VLI_DEVICE_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_DEVICE_TO_HOST,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     I2C_R_VDR, value, index,
+					     buf, bufsz, NULL,
+					     FU_VLI_DEVICE_TIMEOUT,
+					     NULL, error)) {
 		g_prefix_error (error, "failed to read I2C: ");
 		return FALSE;
 	}
@@ -82,18 +81,17 @@ fu_vli_usbhub_device_i2c_write_data (FuVliUsbhubDevice *self,
 				     gsize bufsz,
 				     GError **error)
 {
-	GUsbDevice *usb_device = fu_usb_device_get_dev (FU_USB_DEVICE (self));
 	guint16 value = (((guint16) disable_start_bit) << 8) | disable_end_bit;
 	if (g_getenv ("FWUPD_VLI_USBHUB_VERBOSE") != NULL)
 		fu_common_dump_raw (G_LOG_DOMAIN, "I2cWriteData", buf, bufsz);
-	if (!g_usb_device_control_transfer (usb_device,
-					    G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
-					    G_USB_DEVICE_REQUEST_TYPE_VENDOR,
-					    G_USB_DEVICE_RECIPIENT_DEVICE,
-					    I2C_W_VDR, value, 0x0,
-					    (guint8 *) buf, bufsz, NULL,
-					    FU_VLI_DEVICE_TIMEOUT,
-					    NULL, error)) {
+	if (!fu_usb_device_control_transfer (FU_USB_DEVICE (self),
+					     G_USB_DEVICE_DIRECTION_HOST_TO_DEVICE,
+					     G_USB_DEVICE_REQUEST_TYPE_VENDOR,
+					     G_USB_DEVICE_RECIPIENT_DEVICE,
+					     I2C_W_VDR, value, 0x0,
+					     (guint8 *) buf, bufsz, NULL,
+					     FU_VLI_DEVICE_TIMEOUT,
+					     NULL, error)) {
 		g_prefix_error (error, "failed to write I2C @0x%x: ", value);
 		return FALSE;
 	}
@@ -38,12 +38,19 @@ struct _FuDeviceList
 	GObject			 parent_instance;
 	GPtrArray		*devices;	/* of FuDeviceItem */
 	GRWLock			 devices_mutex;
+	GHashTable		*index_id;	/* device-id:GPtrArray of FuDeviceItem */
+	GHashTable		*index_guid;	/* guid:GPtrArray of FuDeviceItem */
+	GHashTable		*index_connection; /* physical-id[\tlogical-id]:GPtrArray of FuDeviceItem */
+	guint64			 item_seq;
+	gint			 index_dirty;	/* atomic, set if any item is dirty */
+	GPtrArray		*replug_helpers; /* of FuDeviceListReplugHelper, no ref */
 };
 
 enum {
 	SIGNAL_ADDED,
 	SIGNAL_REMOVED,
 	SIGNAL_CHANGED,
+	SIGNAL_REPLACED,
 	SIGNAL_LAST
 };
 
@@ -54,10 +61,249 @@ typedef struct {
 	FuDevice		*device_old;
 	FuDeviceList		*self;		/* no ref */
 	guint			 remove_id;
+	guint64			 seq;		/* order added to the list */
+	gint			 index_dirty;	/* atomic */
+	GPtrArray		*index_keys;	/* of FuDeviceIndexKey */
 } FuDeviceItem;
 
+typedef struct {
+	GHashTable		*index;		/* no ref */
+	gchar			*key;
+} FuDeviceIndexKey;
+
+typedef struct {
+	FuDevice		*device;
+	GMainLoop		*loop;
+	guint			 wait_removed_old;
+} FuDeviceListReplugHelper;
+
+typedef gboolean (*FuDeviceListMatchFunc)	(FuDevice	*device,
+						 gconstpointer	 user_data);
+
 G_DEFINE_TYPE (FuDeviceList, fu_device_list, G_TYPE_OBJECT)
 
+static void
+fu_device_index_key_free (FuDeviceIndexKey *index_key)
+{
+	g_free (index_key->key);
+	g_free (index_key);
+}
+
+/* the index functions have to be called with the writer lock held */
+static void
+fu_device_list_index_add (FuDeviceItem *item, GHashTable *index, const gchar *key)
+{
+	FuDeviceIndexKey *index_key;
+	GPtrArray *items;
+
+	if (key == NULL)
+		return;
+	items = g_hash_table_lookup (index, key);
+	if (items == NULL) {
+		items = g_ptr_array_new ();
+		g_hash_table_insert (index, g_strdup (key), items);
+	}
+	for (guint i = 0; i < items->len; i++) {
+		if (g_ptr_array_index (items, i) == item)
+			return;
+	}
+	g_ptr_array_add (items, item);
+	index_key = g_new0 (FuDeviceIndexKey, 1);
+	index_key->index = index;
+	index_key->key = g_strdup (key);
+	g_ptr_array_add (item->index_keys, index_key);
+}
+
+static void
+fu_device_list_item_unindex (FuDeviceItem *item)
+{
+	for (guint i = 0; i < item->index_keys->len; i++) {
+		FuDeviceIndexKey *index_key = g_ptr_array_index (item->index_keys, i);
+		GPtrArray *items = g_hash_table_lookup (index_key->index, index_key->key);
+		if (items == NULL)
+			continue;
+		g_ptr_array_remove (items, item);
+		if (items->len == 0)
+			g_hash_table_remove (index_key->index, index_key->key);
+	}
+	g_ptr_array_set_size (item->index_keys, 0);
+}
+
+static gchar *
+fu_device_list_build_connection_key (const gchar *physical_id, const gchar *logical_id)
+{
+	if (physical_id == NULL)
+		return NULL;
+	if (logical_id == NULL)
+		return g_strdup (physical_id);
+	return g_strdup_printf ("%s\t%s", physical_id, logical_id);
+}
+
+static void
+fu_device_list_item_index_device (FuDeviceItem *item, FuDevice *device)
+{
+	FuDeviceList *self = item->self;
+	GPtrArray *guids = fu_device_get_guids (device);
+	const gchar *ids[] = {
+		fu_device_get_id (device),
+		fu_device_get_equivalent_id (device) };
+	g_autofree gchar *connection_key = NULL;
+
+	for (guint i = 0; i < G_N_ELEMENTS (ids); i++)
+		fu_device_list_index_add (item, self->index_id, ids[i]);
+	for (guint i = 0; i < guids->len; i++) {
+		const gchar *guid = g_ptr_array_index (guids, i);
+		fu_device_list_index_add (item, self->index_guid, guid);
+	}
+	connection_key = fu_device_list_build_connection_key (fu_device_get_physical_id (device),
+							      fu_device_get_logical_id (device));
+	fu_device_list_index_add (item, self->index_connection, connection_key);
+}
+
+static void
+fu_device_list_item_reindex (FuDeviceItem *item)
+{
+	g_atomic_int_set (&item->index_dirty, FALSE);
+	fu_device_list_item_unindex (item);
+	if (item->device != NULL)
+		fu_device_list_item_index_device (item, item->device);
+	if (item->device_old != NULL)
+		fu_device_list_item_index_device (item, item->device_old);
+}
+
+static void
+fu_device_list_item_set_index_dirty (FuDeviceItem *item)
+{
+	g_atomic_int_set (&item->index_dirty, TRUE);
+	g_atomic_int_set (&item->self->index_dirty, TRUE);
+}
+
+/* only the items that changed since the last lookup are reindexed */
+static void
+fu_device_list_ensure_index (FuDeviceList *self)
+{
+	/* fast path */
+	if (!g_atomic_int_get (&self->index_dirty))
+		return;
+
+	/* clear the flag first so that any change made while reindexing is
+	 * picked up the next time */
+	g_rw_lock_writer_lock (&self->devices_mutex);
+	g_atomic_int_set (&self->index_dirty, FALSE);
+	for (guint i = 0; i < self->devices->len; i++) {
+		FuDeviceItem *item = g_ptr_array_index (self->devices, i);
+		if (g_atomic_int_get (&item->index_dirty))
+			fu_device_list_item_reindex (item);
+	}
+	g_rw_lock_writer_unlock (&self->devices_mutex);
+}
+
+/* this may be called with the devices lock already held */
+static void
+fu_device_list_device_notify_cb (FuDevice *device, GParamSpec *pspec, gpointer user_data)
+{
+	FuDeviceItem *item = (FuDeviceItem *) user_data;
+	fu_device_list_item_set_index_dirty (item);
+}
+
+/* all the properties that are used as index keys */
+static void
+fu_device_list_item_watch_device (FuDeviceItem *item, FuDevice *device)
+{
+	const gchar *signal_names[] = { "notify::device-id",
+					"notify::equivalent-id",
+					"notify::guids",
+					"notify::physical-id",
+					"notify::logical-id",
+					NULL };
+	for (guint i = 0; signal_names[i] != NULL; i++) {
+		g_signal_connect (device, signal_names[i],
+				  G_CALLBACK (fu_device_list_device_notify_cb), item);
+	}
+}
+
+/* returns the matching item added to the list first, which is the same item
+ * a linear search would have returned */
+static FuDeviceItem *
+fu_device_list_index_lookup (GHashTable *index,
+			     const gchar *key,
+			     gboolean use_old,
+			     gboolean removed_only,
+			     FuDeviceListMatchFunc match_func,
+			     gconstpointer user_data,
+			     FuDeviceItem *item_best)
+{
+	GPtrArray *items = g_hash_table_lookup (index, key);
+	if (items == NULL)
+		return item_best;
+	for (guint i = 0; i < items->len; i++) {
+		FuDeviceItem *item_tmp = g_ptr_array_index (items, i);
+		FuDevice *device = use_old ? item_tmp->device_old : item_tmp->device;
+		if (device == NULL)
+			continue;
+		if (removed_only && item_tmp->remove_id == 0)
+			continue;
+		if (item_best != NULL && item_tmp->seq > item_best->seq)
+			continue;
+		if (!match_func (device, user_data))
+			continue;
+		item_best = item_tmp;
+	}
+	return item_best;
+}
+
+static gboolean
+fu_device_list_match_guid (FuDevice *device, gconstpointer user_data)
+{
+	const gchar *guid = (const gchar *) user_data;
+	return fu_device_has_guid (device, guid);
+}
+
+/* the index only contains GUIDs, so convert any instance ID first */
+static FuDeviceItem *
+fu_device_list_index_lookup_guid (FuDeviceList *self,
+				  const gchar *guid,
+				  gboolean use_old,
+				  gboolean removed_only,
+				  FuDeviceItem *item_best)
+{
+	g_autofree gchar *guid_tmp = NULL;
+	if (!fwupd_guid_is_valid (guid)) {
+		guid_tmp = fwupd_guid_hash_string (guid);
+		return fu_device_list_index_lookup (self->index_guid, guid_tmp,
+						    use_old, removed_only,
+						    fu_device_list_match_guid, guid,
+						    item_best);
+	}
+	return fu_device_list_index_lookup (self->index_guid, guid,
+					    use_old, removed_only,
+					    fu_device_list_match_guid, guid,
+					    item_best);
+}
+
+typedef struct {
+	const gchar		*physical_id;
+	const gchar		*logical_id;
+} FuDeviceListConnection;
+
+static gboolean
+fu_device_list_match_connection (FuDevice *device, gconstpointer user_data)
+{
+	const FuDeviceListConnection *conn = (const FuDeviceListConnection *) user_data;
+	return g_strcmp0 (fu_device_get_physical_id (device), conn->physical_id) == 0 &&
+	       g_strcmp0 (fu_device_get_logical_id (device), conn->logical_id) == 0;
+}
+
+/* the item is freed by the array, so must not be used after this */
+static void
+fu_device_list_remove_item (FuDeviceList *self, FuDeviceItem *item)
+{
+	g_rw_lock_writer_lock (&self->devices_mutex);
+	fu_device_list_item_unindex (item);
+	g_ptr_array_remove (self->devices, item);
+	g_rw_lock_writer_unlock (&self->devices_mutex);
+}
+
 static void
 fu_device_list_emit_device_added (FuDeviceList *self, FuDevice *device)
 {
@@ -79,6 +325,13 @@ fu_device_list_emit_device_changed (FuDeviceList *self, FuDevice *device)
 	g_signal_emit (self, signals[SIGNAL_CHANGED], 0, device);
 }
 
+static void
+fu_device_list_emit_device_replaced (FuDeviceList *self, FuDevice *device_old, FuDevice *device)
+{
+	g_debug ("::replaced %s", fu_device_get_id (device));
+	g_signal_emit (self, signals[SIGNAL_REPLACED], 0, device_old, device);
+}
+
 /* we cannot use fu_device_get_children() as this will not find "parent-only"
  * logical relationships added using fu_device_add_parent_guid() */
 static GPtrArray *
@@ -215,21 +468,16 @@ fu_device_list_find_by_device (FuDeviceList *self, FuDevice *device)
 static FuDeviceItem *
 fu_device_list_find_by_guid (FuDeviceList *self, const gchar *guid)
 {
-	g_autoptr(GRWLockReaderLocker) locker = g_rw_lock_reader_locker_new (&self->devices_mutex);
+	FuDeviceItem *item;
+	g_autoptr(GRWLockReaderLocker) locker = NULL;
+
+	fu_device_list_ensure_index (self);
+	locker = g_rw_lock_reader_locker_new (&self->devices_mutex);
 	g_return_val_if_fail (locker != NULL, NULL);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index (self->devices, i);
-		if (fu_device_has_guid (item->device, guid))
-			return item;
-	}
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index (self->devices, i);
-		if (item->device_old == NULL)
-			continue;
-		if (fu_device_has_guid (item->device_old, guid))
-			return item;
-	}
-	return NULL;
+	item = fu_device_list_index_lookup_guid (self, guid, FALSE, FALSE, NULL);
+	if (item != NULL)
+		return item;
+	return fu_device_list_index_lookup_guid (self, guid, TRUE, FALSE, NULL);
 }
 
 static FuDeviceItem *
@@ -237,28 +485,57 @@ fu_device_list_find_by_connection (FuDeviceList *self,
 				   const gchar *physical_id,
 				   const gchar *logical_id)
 {
+	FuDeviceItem *item;
+	FuDeviceListConnection conn = {
+		.physical_id = physical_id,
+		.logical_id = logical_id,
+	};
+	g_autofree gchar *key = NULL;
 	g_autoptr(GRWLockReaderLocker) locker = NULL;
+
 	if (physical_id == NULL)
 		return NULL;
+	fu_device_list_ensure_index (self);
+	key = fu_device_list_build_connection_key (physical_id, logical_id);
 	locker = g_rw_lock_reader_locker_new (&self->devices_mutex);
 	g_return_val_if_fail (locker != NULL, NULL);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item_tmp = g_ptr_array_index (self->devices, i);
-		FuDevice *device = item_tmp->device;
-		if (device != NULL &&
-		    g_strcmp0 (fu_device_get_physical_id (device), physical_id) == 0 &&
-		    g_strcmp0 (fu_device_get_logical_id (device), logical_id) == 0)
-			return item_tmp;
-	}
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item_tmp = g_ptr_array_index (self->devices, i);
-		FuDevice *device = item_tmp->device_old;
-		if (device != NULL &&
-		    g_strcmp0 (fu_device_get_physical_id (device), physical_id) == 0 &&
-		    g_strcmp0 (fu_device_get_logical_id (device), logical_id) == 0)
-			return item_tmp;
+	item = fu_device_list_index_lookup (self->index_connection, key, FALSE, FALSE,
+					    fu_device_list_match_connection, &conn, NULL);
+	if (item != NULL)
+		return item;
+	return fu_device_list_index_lookup (self->index_connection, key, TRUE, FALSE,
+					    fu_device_list_match_connection, &conn, NULL);
+}
+
+/* the last matching item wins, as with the linear search */
+static FuDeviceItem *
+fu_device_list_find_by_id_index (FuDeviceList *self,
+				 const gchar *device_id,
+				 gboolean use_old,
+				 gboolean *multiple_matches)
+{
+	FuDeviceItem *item = NULL;
+	GPtrArray *items;
+	g_autoptr(GRWLockReaderLocker) locker = g_rw_lock_reader_locker_new (&self->devices_mutex);
+
+	g_return_val_if_fail (locker != NULL, NULL);
+	items = g_hash_table_lookup (self->index_id, device_id);
+	if (items == NULL)
+		return NULL;
+	for (guint i = 0; i < items->len; i++) {
+		FuDeviceItem *item_tmp = g_ptr_array_index (items, i);
+		FuDevice *device = use_old ? item_tmp->device_old : item_tmp->device;
+		if (device == NULL)
+			continue;
+		if (g_strcmp0 (fu_device_get_id (device), device_id) != 0 &&
+		    g_strcmp0 (fu_device_get_equivalent_id (device), device_id) != 0)
+			continue;
+		if (item != NULL && multiple_matches != NULL)
+			*multiple_matches = TRUE;
+		if (item == NULL || item_tmp->seq > item->seq)
+			item = item_tmp;
 	}
-	return NULL;
+	return item;
 }
 
 static FuDeviceItem *
@@ -275,6 +552,19 @@ fu_device_list_find_by_id (FuDeviceList *self,
 		return NULL;
 	}
 
+	/* use the index for complete hashes */
+	if (fwupd_device_id_is_valid (device_id)) {
+		fu_device_list_ensure_index (self);
+		item = fu_device_list_find_by_id_index (self, device_id, FALSE,
+							multiple_matches);
+		if (item != NULL)
+			return item;
+
+		/* only search old devices if we didn't find the active device */
+		return fu_device_list_find_by_id_index (self, device_id, TRUE,
+							multiple_matches);
+	}
+
 	/* support abbreviated hashes */
 	device_id_len = strlen (device_id);
 	g_rw_lock_reader_lock (&self->devices_mutex);
@@ -340,59 +630,101 @@ fu_device_list_get_old (FuDeviceList *self, FuDevice *device)
 }
 
 static FuDeviceItem *
-fu_device_list_get_by_guids (FuDeviceList *self, GPtrArray *guids)
+fu_device_list_get_by_guids_full (FuDeviceList *self, GPtrArray *guids, gboolean removed_only)
 {
-	g_autoptr(GRWLockReaderLocker) locker = g_rw_lock_reader_locker_new (&self->devices_mutex);
+	FuDeviceItem *item = NULL;
+	g_autoptr(GRWLockReaderLocker) locker = NULL;
+
+	fu_device_list_ensure_index (self);
+	locker = g_rw_lock_reader_locker_new (&self->devices_mutex);
 	g_return_val_if_fail (locker != NULL, NULL);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index (self->devices, i);
-		for (guint j = 0; j < guids->len; j++) {
-			const gchar *guid = g_ptr_array_index (guids, j);
-			if (fu_device_has_guid (item->device, guid))
-				return item;
-		}
+	for (guint j = 0; j < guids->len; j++) {
+		const gchar *guid = g_ptr_array_index (guids, j);
+		item = fu_device_list_index_lookup_guid (self, guid, FALSE, removed_only, item);
 	}
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index (self->devices, i);
-		if (item->device_old == NULL)
-			continue;
-		for (guint j = 0; j < guids->len; j++) {
-			const gchar *guid = g_ptr_array_index (guids, j);
-			if (fu_device_has_guid (item->device_old, guid))
-				return item;
-		}
+	if (item != NULL)
+		return item;
+	for (guint j = 0; j < guids->len; j++) {
+		const gchar *guid = g_ptr_array_index (guids, j);
+		item = fu_device_list_index_lookup_guid (self, guid, TRUE, removed_only, item);
 	}
-	return NULL;
+	return item;
+}
+
+static FuDeviceItem *
+fu_device_list_get_by_guids (FuDeviceList *self, GPtrArray *guids)
+{
+	return fu_device_list_get_by_guids_full (self, guids, FALSE);
 }
 
 static FuDeviceItem *
 fu_device_list_get_by_guids_removed (FuDeviceList *self, GPtrArray *guids)
 {
-	g_autoptr(GRWLockReaderLocker) locker = g_rw_lock_reader_locker_new (&self->devices_mutex);
-	g_return_val_if_fail (locker != NULL, NULL);
+	return fu_device_list_get_by_guids_full (self, guids, TRUE);
+}
+
+/* count devices that are disconnected and are waiting to be replugged */
+static guint
+fu_device_list_devices_wait_removed (FuDeviceList *self)
+{
+	guint cnt = 0;
+	g_rw_lock_reader_lock (&self->devices_mutex);
 	for (guint i = 0; i < self->devices->len; i++) {
 		FuDeviceItem *item = g_ptr_array_index (self->devices, i);
-		if (item->remove_id == 0)
-			continue;
-		for (guint j = 0; j < guids->len; j++) {
-			const gchar *guid = g_ptr_array_index (guids, j);
-			if (fu_device_has_guid (item->device, guid))
-				return item;
-		}
+		if (item->remove_id != 0)
+			cnt++;
 	}
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index (self->devices, i);
-		if (item->device_old == NULL)
-			continue;
-		if (item->remove_id == 0)
-			continue;
-		for (guint j = 0; j < guids->len; j++) {
-			const gchar *guid = g_ptr_array_index (guids, j);
-			if (fu_device_has_guid (item->device_old, guid))
-				return item;
-		}
+	g_rw_lock_reader_unlock (&self->devices_mutex);
+	return cnt;
+}
+
+static gboolean
+fu_device_list_replug_helper_done (FuDeviceList *self, FuDeviceListReplugHelper *helper)
+{
+	FuDeviceItem *item;
+	guint wait_removed;
+
+	/* count how many devices are in the remove waiting state */
+	wait_removed = fu_device_list_devices_wait_removed (self);
+	if (wait_removed != helper->wait_removed_old) {
+		g_debug ("devices in wait_removed: %u -> %u",
+			 helper->wait_removed_old, wait_removed);
+		helper->wait_removed_old = wait_removed;
 	}
-	return NULL;
+	if (wait_removed != 0)
+		return FALSE;
+
+	/* the item may have been removed from the list while waiting */
+	item = fu_device_list_find_by_device (self, helper->device);
+	if (item != NULL)
+		return !fu_device_has_flag (item->device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG);
+	return !fu_device_has_flag (helper->device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG);
+}
+
+/* called when anything in the list changed that could finish a replug */
+static void
+fu_device_list_replug_check (FuDeviceList *self)
+{
+	for (guint i = 0; i < self->replug_helpers->len; i++) {
+		FuDeviceListReplugHelper *helper = g_ptr_array_index (self->replug_helpers, i);
+		if (fu_device_list_replug_helper_done (self, helper))
+			g_main_loop_quit (helper->loop);
+	}
+}
+
+static void
+fu_device_list_replug_flags_notify_cb (FuDevice *device, GParamSpec *pspec, gpointer user_data)
+{
+	FuDeviceList *self = FU_DEVICE_LIST (user_data);
+	fu_device_list_replug_check (self);
+}
+
+static gboolean
+fu_device_list_replug_timeout_cb (gpointer user_data)
+{
+	FuDeviceListReplugHelper *helper = (FuDeviceListReplugHelper *) user_data;
+	g_main_loop_quit (helper->loop);
+	return G_SOURCE_REMOVE;
 }
 
 static gboolean
@@ -417,17 +749,14 @@ fu_device_list_device_delayed_remove_cb (gpointer user_data)
 			continue;
 		}
 		fu_device_list_emit_device_removed (self, child);
-		g_rw_lock_writer_lock (&self->devices_mutex);
-		g_ptr_array_remove (self->devices, child_item);
-		g_rw_lock_writer_unlock (&self->devices_mutex);
+		fu_device_list_remove_item (self, child_item);
 	}
 
 	/* just remove now */
 	g_debug ("doing delayed removal");
 	fu_device_list_emit_device_removed (self, item->device);
-	g_rw_lock_writer_lock (&self->devices_mutex);
-	g_ptr_array_remove (self->devices, item);
-	g_rw_lock_writer_unlock (&self->devices_mutex);
+	fu_device_list_remove_item (self, item);
+	fu_device_list_replug_check (self);
 	return G_SOURCE_REMOVE;
 }
 
@@ -445,6 +774,7 @@ fu_device_list_remove_with_delay (FuDeviceItem *item)
 	item->remove_id = g_timeout_add (fu_device_get_remove_delay (item->device),
 					 fu_device_list_device_delayed_remove_cb,
 					 item);
+	fu_device_list_replug_check (item->self);
 }
 
 /**
@@ -503,16 +833,13 @@ fu_device_list_remove (FuDeviceList *self, FuDevice *device)
 			continue;
 		}
 		fu_device_list_emit_device_removed (self, child);
-		g_rw_lock_writer_lock (&self->devices_mutex);
-		g_ptr_array_remove (self->devices, child_item);
-		g_rw_lock_writer_unlock (&self->devices_mutex);
+		fu_device_list_remove_item (self, child_item);
 	}
 
 	/* remove right now */
 	fu_device_list_emit_device_removed (self, item->device);
-	g_rw_lock_writer_lock (&self->devices_mutex);
-	g_ptr_array_remove (self->devices, item);
-	g_rw_lock_writer_unlock (&self->devices_mutex);
+	fu_device_list_remove_item (self, item);
+	fu_device_list_replug_check (self);
 }
 
 static void
@@ -543,9 +870,7 @@ fu_device_list_item_finalized_cb (gpointer data, GObject *where_the_object_was)
 	g_critical ("FuDevice %p was finalized without being removed from "
 		    "FuDeviceList, removing item!",
 		    where_the_object_was);
-	g_rw_lock_writer_lock (&self->devices_mutex);
-	g_ptr_array_remove (self->devices, item);
-	g_rw_lock_writer_unlock (&self->devices_mutex);
+	fu_device_list_remove_item (self, item);
 }
 
 /* this should never be required, and yet here we are */
@@ -556,13 +881,17 @@ fu_device_list_item_set_device (FuDeviceItem *item, FuDevice *device)
 		g_object_weak_unref (G_OBJECT (item->device),
 				     fu_device_list_item_finalized_cb,
 				     item);
+		g_signal_handlers_disconnect_by_data (item->device, item);
 	}
 	if (device != NULL) {
 		g_object_weak_ref (G_OBJECT (device),
 				   fu_device_list_item_finalized_cb,
 				   item);
+		fu_device_list_item_watch_device (item, device);
 	}
 	g_set_object (&item->device, device);
+	if (device != NULL)
+		fu_device_list_item_set_index_dirty (item);
 }
 
 static void
@@ -635,8 +964,12 @@ fu_device_list_replace (FuDeviceList *self, FuDeviceItem *item, FuDevice *device
 	}
 
 	/* assign the new device */
+	if (item->device_old != NULL)
+		g_signal_handlers_disconnect_by_data (item->device_old, item);
 	g_set_object (&item->device_old, item->device);
 	fu_device_list_item_set_device (item, device);
+	fu_device_list_item_watch_device (item, item->device_old);
+	fu_device_list_emit_device_replaced (self, item->device_old, device);
 	fu_device_list_emit_device_changed (self, device);
 
 	/* we were waiting for this... */
@@ -644,6 +977,7 @@ fu_device_list_replace (FuDeviceList *self, FuDeviceItem *item, FuDevice *device
 		g_debug ("device came back, clearing flag");
 		fu_device_remove_flag (item->device_old, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG);
 	}
+	fu_device_list_replug_check (self);
 }
 
 /**
@@ -761,11 +1095,15 @@ fu_device_list_add (FuDeviceList *self, FuDevice *device)
 	/* add helper */
 	item = g_new0 (FuDeviceItem, 1);
 	item->self = self; /* no ref */
+	item->index_keys = g_ptr_array_new_with_free_func ((GDestroyNotify) fu_device_index_key_free);
 	fu_device_list_item_set_device (item, device);
 	g_rw_lock_writer_lock (&self->devices_mutex);
+	item->seq = self->item_seq++;
+	fu_device_list_item_reindex (item);
 	g_ptr_array_add (self->devices, item);
 	g_rw_lock_writer_unlock (&self->devices_mutex);
 	fu_device_list_emit_device_added (self, device);
+	fu_device_list_replug_check (self);
 }
 
 /**
@@ -798,21 +1136,6 @@ fu_device_list_get_by_guid (FuDeviceList *self, const gchar *guid, GError **erro
 	return NULL;
 }
 
-/* count devices that are disconnected and are waiting to be replugged */
-static guint
-fu_device_list_devices_wait_removed (FuDeviceList *self)
-{
-	guint cnt = 0;
-	g_rw_lock_reader_lock (&self->devices_mutex);
-	for (guint i = 0; i < self->devices->len; i++) {
-		FuDeviceItem *item = g_ptr_array_index (self->devices, i);
-		if (item->remove_id != 0)
-			cnt++;
-	}
-	g_rw_lock_reader_unlock (&self->devices_mutex);
-	return cnt;
-}
-
 /**
  * fu_device_list_wait_for_replug:
  * @self: A #FuDeviceList
@@ -832,10 +1155,11 @@ gboolean
 fu_device_list_wait_for_replug (FuDeviceList *self, FuDevice *device, GError **error)
 {
 	FuDeviceItem *item;
+	FuDeviceListReplugHelper helper = { NULL };
 	guint remove_delay;
-	guint wait_removed;
-	guint wait_removed_old = 0;
-	g_autoptr(GTimer) timer = g_timer_new ();
+	gulong notify_id;
+	g_autoptr(GMainLoop) loop = NULL;
+	g_autoptr(GSource) source = NULL;
 
 	g_return_val_if_fail (FU_IS_DEVICE_LIST (self), FALSE);
 	g_return_val_if_fail (FU_IS_DEVICE (device), FALSE);
@@ -877,23 +1201,35 @@ fu_device_list_wait_for_replug (FuDeviceList *self, FuDevice *device, GError **e
 		g_debug ("waiting %ums for replug", remove_delay);
 	}
 
-	/* time to unplug and then re-plug */
-	do {
-		/* count how many devices are in the remove waiting state */
-		wait_removed = fu_device_list_devices_wait_removed (self);
-		if (wait_removed != wait_removed_old) {
-			g_debug ("devices in wait_removed: %u -> %u",
-				 wait_removed_old, wait_removed);
-			wait_removed_old = wait_removed;
-		}
-		g_usleep (1000);
-		g_main_context_iteration (NULL, FALSE);
-		if (!fu_device_has_flag (item->device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG) &&
-		    wait_removed == 0)
-			break;
-	} while (g_timer_elapsed (timer, NULL) * 1000.f < remove_delay);
+	/* time to unplug and then re-plug, woken up by the device list changing
+	 * or the flag being cleared rather than polling */
+	loop = g_main_loop_new (NULL, FALSE);
+	helper.device = device;
+	helper.loop = loop;
+	source = g_timeout_source_new (remove_delay);
+	g_source_set_callback (source, fu_device_list_replug_timeout_cb, &helper, NULL);
+	g_source_attach (source, NULL);
+	notify_id = g_signal_connect (device, "notify::flags",
+				      G_CALLBACK (fu_device_list_replug_flags_notify_cb),
+				      self);
+	g_ptr_array_add (self->replug_helpers, &helper);
+	if (!fu_device_list_replug_helper_done (self, &helper))
+		g_main_loop_run (loop);
+	g_ptr_array_remove (self->replug_helpers, &helper);
+	g_signal_handler_disconnect (device, notify_id);
+	g_source_destroy (source);
 
 	/* device was not added back to the device list */
+	item = fu_device_list_find_by_device (self, device);
+	if (item == NULL) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_FOUND,
+			     "device %s did not come back",
+			     fu_device_get_id (device));
+		fu_device_remove_flag (device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG);
+		return FALSE;
+	}
 	if (fu_device_has_flag (item->device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG)) {
 		g_set_error (error,
 			     FWUPD_ERROR,
@@ -972,9 +1308,12 @@ fu_device_list_item_free (FuDeviceItem *item)
 {
 	if (item->remove_id != 0)
 		g_source_remove (item->remove_id);
-	if (item->device_old != NULL)
+	if (item->device_old != NULL) {
+		g_signal_handlers_disconnect_by_data (item->device_old, item);
 		g_object_unref (item->device_old);
+	}
 	fu_device_list_item_set_device (item, NULL);
+	g_ptr_array_unref (item->index_keys);
 	g_free (item);
 }
 
@@ -999,12 +1338,24 @@ fu_device_list_class_init (FuDeviceListClass *klass)
 			      G_TYPE_FROM_CLASS (object_class), G_SIGNAL_RUN_LAST,
 			      0, NULL, NULL, g_cclosure_marshal_VOID__OBJECT,
 			      G_TYPE_NONE, 1, FU_TYPE_DEVICE);
+	signals[SIGNAL_REPLACED] =
+		g_signal_new ("replaced",
+			      G_TYPE_FROM_CLASS (object_class), G_SIGNAL_RUN_LAST,
+			      0, NULL, NULL, g_cclosure_marshal_generic,
+			      G_TYPE_NONE, 2, FU_TYPE_DEVICE, FU_TYPE_DEVICE);
 }
 
 static void
 fu_device_list_init (FuDeviceList *self)
 {
 	self->devices = g_ptr_array_new_with_free_func ((GDestroyNotify) fu_device_list_item_free);
+	self->index_id = g_hash_table_new_full (g_str_hash, g_str_equal,
+						g_free, (GDestroyNotify) g_ptr_array_unref);
+	self->index_guid = g_hash_table_new_full (g_str_hash, g_str_equal,
+						  g_free, (GDestroyNotify) g_ptr_array_unref);
+	self->index_connection = g_hash_table_new_full (g_str_hash, g_str_equal,
+							g_free, (GDestroyNotify) g_ptr_array_unref);
+	self->replug_helpers = g_ptr_array_new ();
 	g_rw_lock_init (&self->devices_mutex);
 }
 
@@ -1015,6 +1366,10 @@ fu_device_list_finalize (GObject *obj)
 
 	g_rw_lock_clear (&self->devices_mutex);
 	g_ptr_array_unref (self->devices);
+	g_hash_table_unref (self->index_id);
+	g_hash_table_unref (self->index_guid);
+	g_hash_table_unref (self->index_connection);
+	g_ptr_array_unref (self->replug_helpers);
 
 	G_OBJECT_CLASS (fu_device_list_parent_class)->finalize (obj);
 }
@@ -21,6 +21,7 @@
 #include <sys/utsname.h>
 #endif
 #include <errno.h>
+#include <glib/gstdio.h>
 
 #include "fwupd-common-private.h"
 #include "fwupd-enums-private.h"
@@ -34,6 +35,7 @@
 #include "fu-common.h"
 #include "fu-config.h"
 #include "fu-debug.h"
+#include "fu-device-event-private.h"
 #include "fu-device-list.h"
 #include "fu-device-private.h"
 #include "fu-engine.h"
@@ -54,6 +56,7 @@
 #include "fu-security-attrs-private.h"
 #include "fu-smbios-private.h"
 #include "fu-udev-device-private.h"
+#include "fu-uevent-batch.h"
 #include "fu-usb-device-private.h"
 
 #include "fu-dfu-firmware.h"
@@ -70,6 +73,26 @@
 
 static void fu_engine_finalize	 (GObject *obj);
 static void fu_engine_ensure_security_attrs	(FuEngine *self);
+static void fu_engine_security_attrs_invalidate	(FuEngine *self,
+						 const gchar *plugin_name);
+
+/* maximum number of plugins to coldplug at the same time */
+#define FU_ENGINE_COLDPLUG_THREADS_MAX		8
+
+/* maximum number of devices to update at the same time */
+#define FU_ENGINE_INSTALL_THREADS_MAX		8
+
+/* maximum number of hotplugged devices to probe and set up at the same time */
+#define FU_ENGINE_PROBE_THREADS_MAX		4
+
+/* how long to collect udev events for before processing them, in ms */
+#define FU_ENGINE_UEVENT_COALESCE_DELAY		50
+
+/* maximum number of plugins to query for security attributes at the same time */
+#define FU_ENGINE_SECURITY_ATTRS_THREADS_MAX	4
+
+/* plugins are re-queried after this long even if nothing signalled a change */
+#define FU_ENGINE_SECURITY_ATTRS_MAX_AGE	(15 * 60 * G_USEC_PER_SEC)
 
 struct _FuEngine
 {
@@ -87,15 +110,28 @@ struct _FuEngine
 	guint			 percentage;
 	FuHistory		*history;
 	FuIdle			*idle;
-	XbSilo			*silo;
+	GPtrArray		*silos;			/* of XbSilo, one per remote */
+	GHashTable		*silo_shards;		/* remote-id:XbSilo */
+	GHashTable		*silo_shard_stamps;	/* remote-id:utf-8 */
+	GHashTable		*component_index;	/* (nullable) guid:GPtrArray of XbNode */
 	gboolean		 coldplug_running;
+	guint			 coldplug_pending;	/* plugins in worker threads */
 	guint			 coldplug_id;
 	guint			 coldplug_delay;
+	guint			 install_pending;	/* tasks in worker threads */
+	guint			 install_threads_max;
+	GThreadPool		*probe_pool;		/* (nullable) */
+	GHashTable		*probe_queues;		/* backend-id:GQueue of FuEngineProbeHelper */
+	GHashTable		*backend_devices;	/* backend-id:GPtrArray of FuDevice */
+	GMainContext		*main_ctx;
+	GThread			*main_thread;		/* (not owned) */
 	FuPluginList		*plugin_list;
 	GPtrArray		*plugin_filter;
 	GPtrArray		*udev_subsystems;
 #ifdef HAVE_GUDEV
 	GHashTable		*udev_changed_ids;	/* sysfs:FuEngineUdevChangedHelper */
+	FuUeventBatch		*uevents;
+	guint			 uevents_id;
 #endif
 	FuSmbios		*smbios;
 	FuHwids			*hwids;
@@ -110,8 +146,36 @@ struct _FuEngine
 	gboolean		 loaded;
 	gchar			*host_security_id;
 	FuSecurityAttrs		*host_security_attrs;
+	GHashTable		*security_attrs_cache;	/* plugin-name:FuEngineSecurityAttrsItem */
+	GPtrArray		*startup_profile;	/* of FuEngineProfileItem */
+	GHashTable		*releases_cache;	/* key:FuEngineReleasesCacheItem */
+	FuDeviceEmulation	 emulation;
+	gboolean		 emulation_latency;
+	GHashTable		*emulation_events;	/* backend-id:GPtrArray */
 };
 
+typedef struct {
+	gchar			*id;
+	guint64			 duration;		/* us */
+} FuEngineProfileItem;
+
+typedef struct {
+	FuDevice		*device;		/* no-ref, only compared */
+	gchar			*version;
+	gchar			*version_lowest;
+	gchar			*branch;
+	guint64			 flags;
+	guint			 guids_len;
+	GPtrArray		*releases;		/* (nullable) */
+	GError			*error;			/* (nullable) */
+} FuEngineReleasesCacheItem;
+
+typedef struct {
+	FuPlugin		*plugin;
+	FuSecurityAttrs		*attrs;
+	gint64			 ctime;			/* us, monotonic */
+} FuEngineSecurityAttrsItem;
+
 enum {
 	SIGNAL_CHANGED,
 	SIGNAL_DEVICE_ADDED,
@@ -126,9 +190,75 @@ static guint signals[SIGNAL_LAST] = { 0 };
 
 G_DEFINE_TYPE (FuEngine, fu_engine, G_TYPE_OBJECT)
 
+typedef struct {
+	FuEngine		*self;
+	guint			 signal_id;
+	FuDevice		*device;		/* (nullable) */
+	guint			 value;
+} FuEngineEmitHelper;
+
+static void fu_engine_emit_changed		(FuEngine	*self);
+static void fu_engine_emit_device_changed	(FuEngine	*self,
+						 FuDevice	*device);
+static void fu_engine_set_status		(FuEngine	*self,
+						 FwupdStatus	 status);
+static void fu_engine_set_percentage		(FuEngine	*self,
+						 guint		 percentage);
+
+static void
+fu_engine_emit_helper_free (FuEngineEmitHelper *helper)
+{
+	g_object_unref (helper->self);
+	if (helper->device != NULL)
+		g_object_unref (helper->device);
+	g_free (helper);
+}
+
+static gboolean
+fu_engine_emit_idle_cb (gpointer user_data)
+{
+	FuEngineEmitHelper *helper = (FuEngineEmitHelper *) user_data;
+	if (helper->signal_id == SIGNAL_CHANGED)
+		fu_engine_emit_changed (helper->self);
+	else if (helper->signal_id == SIGNAL_DEVICE_CHANGED)
+		fu_engine_emit_device_changed (helper->self, helper->device);
+	else if (helper->signal_id == SIGNAL_STATUS_CHANGED)
+		fu_engine_set_status (helper->self, helper->value);
+	else if (helper->signal_id == SIGNAL_PERCENTAGE_CHANGED)
+		fu_engine_set_percentage (helper->self, helper->value);
+	return G_SOURCE_REMOVE;
+}
+
+/* devices being updated from a worker thread change state there, so defer
+ * anything that modifies the engine or emits a signal to the main thread;
+ * returns %TRUE if the caller should do nothing more */
+static gboolean
+fu_engine_emit_proxy (FuEngine *self, guint signal_id, FuDevice *device, guint value)
+{
+	FuEngineEmitHelper *helper;
+	g_autoptr(GSource) source = NULL;
+
+	/* fast path */
+	if (g_thread_self () == self->main_thread)
+		return FALSE;
+
+	helper = g_new0 (FuEngineEmitHelper, 1);
+	helper->self = g_object_ref (self);
+	helper->signal_id = signal_id;
+	helper->device = device != NULL ? g_object_ref (device) : NULL;
+	helper->value = value;
+	source = g_idle_source_new ();
+	g_source_set_callback (source, fu_engine_emit_idle_cb, helper,
+			       (GDestroyNotify) fu_engine_emit_helper_free);
+	g_source_attach (source, self->main_ctx);
+	return TRUE;
+}
+
 static void
 fu_engine_emit_changed (FuEngine *self)
 {
+	if (fu_engine_emit_proxy (self, SIGNAL_CHANGED, NULL, 0))
+		return;
 	g_signal_emit (self, signals[SIGNAL_CHANGED], 0);
 	fu_engine_idle_reset (self);
 
@@ -142,11 +272,27 @@ fu_engine_emit_changed (FuEngine *self)
 	}
 }
 
+static void
+fu_engine_releases_cache_invalidate (FuEngine *self)
+{
+	if (g_hash_table_size (self->releases_cache) == 0)
+		return;
+	g_debug ("invalidating %u cached release lookups",
+		 g_hash_table_size (self->releases_cache));
+	g_hash_table_remove_all (self->releases_cache);
+}
+
 static void
 fu_engine_emit_device_changed (FuEngine *self, FuDevice *device)
 {
-	/* invalidate host security attributes */
-	g_clear_pointer (&self->host_security_id, g_free);
+	if (fu_engine_emit_proxy (self, SIGNAL_DEVICE_CHANGED, device, 0))
+		return;
+
+	/* invalidate host security attributes from the device plugin */
+	fu_engine_security_attrs_invalidate (self, fu_device_get_plugin (device));
+
+	/* requirements can depend on the state of other devices */
+	fu_engine_releases_cache_invalidate (self);
 	g_signal_emit (self, signals[SIGNAL_DEVICE_CHANGED], 0, device);
 }
 
@@ -201,6 +347,8 @@ fu_engine_get_status (FuEngine *self)
 static void
 fu_engine_set_status (FuEngine *self, FwupdStatus status)
 {
+	if (fu_engine_emit_proxy (self, SIGNAL_STATUS_CHANGED, NULL, status))
+		return;
 	if (self->status == status)
 		return;
 	self->status = status;
@@ -214,6 +362,8 @@ fu_engine_set_status (FuEngine *self, FwupdStatus status)
 static void
 fu_engine_set_percentage (FuEngine *self, guint percentage)
 {
+	if (fu_engine_emit_proxy (self, SIGNAL_PERCENTAGE_CHANGED, NULL, percentage))
+		return;
 	if (self->percentage == percentage)
 		return;
 	self->percentage = percentage;
@@ -256,9 +406,44 @@ fu_engine_watch_device (FuEngine *self, FuDevice *device)
 			  G_CALLBACK (fu_engine_status_notify_cb), self);
 }
 
+static void
+fu_engine_backend_devices_add (FuEngine *self, FuDevice *device)
+{
+	GPtrArray *devices;
+	const gchar *backend_id = fu_device_get_backend_id (device);
+
+	if (backend_id == NULL)
+		return;
+	devices = g_hash_table_lookup (self->backend_devices, backend_id);
+	if (devices == NULL) {
+		devices = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+		g_hash_table_insert (self->backend_devices, g_strdup (backend_id), devices);
+	}
+	if (!g_ptr_array_find (devices, device, NULL))
+		g_ptr_array_add (devices, g_object_ref (device));
+}
+
+static void
+fu_engine_backend_devices_remove (FuEngine *self, FuDevice *device)
+{
+	GPtrArray *devices;
+	const gchar *backend_id = fu_device_get_backend_id (device);
+
+	if (backend_id == NULL)
+		return;
+	devices = g_hash_table_lookup (self->backend_devices, backend_id);
+	if (devices == NULL)
+		return;
+	g_ptr_array_remove (devices, device);
+	if (devices->len == 0)
+		g_hash_table_remove (self->backend_devices, backend_id);
+}
+
 static void
 fu_engine_device_added_cb (FuDeviceList *device_list, FuDevice *device, FuEngine *self)
 {
+	fu_engine_releases_cache_invalidate (self);
+	fu_engine_backend_devices_add (self, device);
 	fu_engine_watch_device (self, device);
 	g_signal_emit (self, signals[SIGNAL_DEVICE_ADDED], 0, device);
 }
@@ -266,7 +451,8 @@ fu_engine_device_added_cb (FuDeviceList *device_list, FuDevice *device, FuEngine
 static void
 fu_engine_device_runner_device_removed (FuEngine *self, FuDevice *device)
 {
-	GPtrArray *plugins = fu_plugin_list_get_all (self->plugin_list);
+	GPtrArray *plugins = fu_plugin_list_get_all_by_vfunc (self->plugin_list,
+							      FU_PLUGIN_VFUNC_DEVICE_REMOVED);
 	for (guint j = 0; j < plugins->len; j++) {
 		FuPlugin *plugin_tmp = g_ptr_array_index (plugins, j);
 		fu_plugin_runner_device_removed (plugin_tmp, device);
@@ -276,11 +462,24 @@ fu_engine_device_runner_device_removed (FuEngine *self, FuDevice *device)
 static void
 fu_engine_device_removed_cb (FuDeviceList *device_list, FuDevice *device, FuEngine *self)
 {
+	fu_engine_releases_cache_invalidate (self);
+	fu_engine_backend_devices_remove (self, device);
 	fu_engine_device_runner_device_removed (self, device);
 	g_signal_handlers_disconnect_by_data (device, self);
 	g_signal_emit (self, signals[SIGNAL_DEVICE_REMOVED], 0, device);
 }
 
+static void
+fu_engine_device_replaced_cb (FuDeviceList *device_list,
+			      FuDevice *device_old,
+			      FuDevice *device,
+			      FuEngine *self)
+{
+	/* the item is now using a new device after a replug */
+	fu_engine_backend_devices_remove (self, device_old);
+	fu_engine_backend_devices_add (self, device);
+}
+
 static void
 fu_engine_device_changed_cb (FuDeviceList *device_list, FuDevice *device, FuEngine *self)
 {
@@ -468,6 +667,142 @@ fu_engine_set_release_from_appstream (FuEngine *self,
 	return TRUE;
 }
 
+/* queries each remote shard in turn, in the same order as the remotes; a shard
+ * that does not have the element or attribute in its string table returns
+ * INVALID_ARGUMENT, which is the same as no results */
+static GPtrArray *
+fu_engine_silo_query (FuEngine *self, const gchar *xpath, guint limit, GError **error)
+{
+	g_autoptr(GPtrArray) results = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	for (guint i = 0; i < self->silos->len; i++) {
+		XbSilo *silo = g_ptr_array_index (self->silos, i);
+		g_autoptr(GError) error_local = NULL;
+		g_autoptr(GPtrArray) results_tmp = NULL;
+
+		results_tmp = xb_silo_query (silo, xpath,
+					     limit > 0 ? limit - results->len : 0,
+					     &error_local);
+		if (results_tmp == NULL) {
+			if (g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
+			    g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT))
+				continue;
+			g_propagate_error (error, g_steal_pointer (&error_local));
+			return NULL;
+		}
+		for (guint j = 0; j < results_tmp->len; j++) {
+			XbNode *n = g_ptr_array_index (results_tmp, j);
+			g_ptr_array_add (results, g_object_ref (n));
+		}
+		if (limit > 0 && results->len >= limit)
+			break;
+	}
+	if (results->len == 0) {
+		g_set_error (error,
+			     G_IO_ERROR,
+			     G_IO_ERROR_NOT_FOUND,
+			     "no results for XPath query '%s'",
+			     xpath);
+		return NULL;
+	}
+	return g_steal_pointer (&results);
+}
+
+static XbNode *
+fu_engine_silo_query_first (FuEngine *self, const gchar *xpath, GError **error)
+{
+	g_autoptr(GPtrArray) results = fu_engine_silo_query (self, xpath, 1, error);
+	if (results == NULL)
+		return NULL;
+	return g_object_ref (g_ptr_array_index (results, 0));
+}
+
+static void
+fu_engine_component_index_add (FuEngine *self, XbNode *component)
+{
+	g_autoptr(XbNode) provides = xb_node_get_child (component);
+
+	/* walk the children rather than compiling an XPath per component */
+	while (provides != NULL) {
+		XbNode *tmp;
+		if (g_strcmp0 (xb_node_get_element (provides), "provides") == 0) {
+			g_autoptr(XbNode) firmware = xb_node_get_child (provides);
+			while (firmware != NULL) {
+				const gchar *guid = xb_node_get_text (firmware);
+				if (guid != NULL &&
+				    g_strcmp0 (xb_node_get_element (firmware), "firmware") == 0 &&
+				    g_strcmp0 (xb_node_get_attr (firmware, "type"), "flashed") == 0) {
+					GPtrArray *components = g_hash_table_lookup (self->component_index, guid);
+					if (components == NULL) {
+						components = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+						g_hash_table_insert (self->component_index,
+								     g_strdup (guid),
+								     components);
+					}
+					if (!g_ptr_array_find (components, component, NULL))
+						g_ptr_array_add (components, g_object_ref (component));
+				}
+				tmp = xb_node_get_next (firmware);
+				g_object_unref (firmware);
+				firmware = tmp;
+			}
+		}
+		tmp = xb_node_get_next (provides);
+		g_object_unref (provides);
+		provides = tmp;
+	}
+}
+
+/* builds a GUID to component table once per set of silos */
+static void
+fu_engine_ensure_component_index (FuEngine *self)
+{
+	if (self->component_index != NULL)
+		return;
+	self->component_index = g_hash_table_new_full (g_str_hash, g_str_equal,
+						       g_free, (GDestroyNotify) g_ptr_array_unref);
+	for (guint i = 0; i < self->silos->len; i++) {
+		XbSilo *silo = g_ptr_array_index (self->silos, i);
+		g_autoptr(GPtrArray) components = NULL;
+		components = xb_silo_query (silo, "components/component", 0, NULL);
+		if (components == NULL)
+			continue;
+		for (guint j = 0; j < components->len; j++) {
+			XbNode *component = g_ptr_array_index (components, j);
+			fu_engine_component_index_add (self, component);
+		}
+	}
+	g_debug ("indexed %u GUIDs", g_hash_table_size (self->component_index));
+}
+
+static void
+fu_engine_component_index_invalidate (FuEngine *self)
+{
+	g_clear_pointer (&self->component_index, g_hash_table_unref);
+}
+
+/* returns the components for each device GUID in order, without duplicates */
+static GPtrArray *
+fu_engine_get_components_for_device (FuEngine *self, FuDevice *device)
+{
+	GPtrArray *guids = fu_device_get_guids (device);
+	GPtrArray *components = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+
+	fu_engine_ensure_component_index (self);
+	for (guint i = 0; i < guids->len; i++) {
+		const gchar *guid = g_ptr_array_index (guids, i);
+		GPtrArray *components_tmp = g_hash_table_lookup (self->component_index, guid);
+		if (components_tmp == NULL)
+			continue;
+		for (guint j = 0; j < components_tmp->len; j++) {
+			XbNode *component = g_ptr_array_index (components_tmp, j);
+			if (g_ptr_array_find (components, component, NULL))
+				continue;
+			g_ptr_array_add (components, g_object_ref (component));
+		}
+	}
+	return components;
+}
+
 /* finds the remote-id for the first firmware in the silo that matches this
  * container checksum */
 static const gchar *
@@ -478,7 +813,7 @@ fu_engine_get_remote_id_for_checksum (FuEngine *self, const gchar *csum)
 	xpath = g_strdup_printf ("components/component/releases/release/"
 				 "checksum[@target='container'][text()='%s']/../../"
 				 "../../custom/value[@key='fwupd::RemoteId']", csum);
-	key = xb_silo_query_first (self->silo, xpath, NULL);
+	key = fu_engine_silo_query_first (self, xpath, NULL);
 	if (key == NULL)
 		return NULL;
 	return xb_node_get_text (key);
@@ -558,6 +893,30 @@ fu_engine_modify_config (FuEngine *self, const gchar *key, const gchar *value, G
 	return fu_config_set_key_value (self->config, key, value, error);
 }
 
+/**
+ * fu_engine_check_not_installing:
+ * @self: A #FuEngine
+ * @error: A #GError, or %NULL
+ *
+ * Checks no devices are being updated from worker threads. The main context
+ * is iterated while they are, and the install uses the silo and history
+ * database from the main thread.
+ *
+ * Returns: %TRUE if nothing is being installed
+ **/
+gboolean
+fu_engine_check_not_installing (FuEngine *self, GError **error)
+{
+	g_return_val_if_fail (FU_IS_ENGINE (self), FALSE);
+	if (self->install_pending == 0)
+		return TRUE;
+	g_set_error_literal (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NOT_SUPPORTED,
+			     "Cannot change this while devices are being updated");
+	return FALSE;
+}
+
 /**
  * fu_engine_modify_remote:
  * @self: A #FuEngine
@@ -589,6 +948,10 @@ fu_engine_modify_remote (FuEngine *self,
 		NULL,
 	};
 
+	/* the silo is in use by the install */
+	if (!fu_engine_check_not_installing (self, error))
+		return FALSE;
+
 	/* check keys are valid */
 	if (!g_strv_contains (keys, key)) {
 		g_set_error (error,
@@ -783,18 +1146,13 @@ XbNode *
 fu_engine_get_component_by_guids (FuEngine *self, FuDevice *device)
 {
 	GPtrArray *guids = fu_device_get_guids (device);
-	g_autoptr(GString) xpath = g_string_new (NULL);
-	g_autoptr(XbNode) component = NULL;
+	fu_engine_ensure_component_index (self);
 	for (guint i = 0; i < guids->len; i++) {
 		const gchar *guid = g_ptr_array_index (guids, i);
-		xb_string_append_union (xpath,
-					"components/component/"
-					"provides/firmware[@type='flashed'][text()='%s']/"
-					"../..", guid);
+		GPtrArray *components = g_hash_table_lookup (self->component_index, guid);
+		if (components != NULL)
+			return g_object_ref (g_ptr_array_index (components, 0));
 	}
-	component = xb_silo_query_first (self->silo, xpath->str, NULL);
-	if (component != NULL)
-		return g_steal_pointer (&component);
 	return NULL;
 }
 
@@ -855,47 +1213,63 @@ fu_engine_verify_from_system_metadata (FuEngine *self,
 {
 	FwupdVersionFormat fmt = fu_device_get_version_format (device);
 	GPtrArray *guids = fu_device_get_guids (device);
-	g_autoptr(XbQuery) query = NULL;
-
-	/* prepare query with bound GUID parameter */
-	query = xb_query_new_full (self->silo,
-				   "components/component/"
-				   "provides/firmware[@type='flashed'][text()=?]/"
-				   "../../releases/release",
-				   XB_QUERY_FLAG_OPTIMIZE |
-				   XB_QUERY_FLAG_USE_INDEXES,
-				   error);
-	if (query == NULL)
-		return NULL;
+	g_autoptr(GPtrArray) queries = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_autoptr(GPtrArray) silos = g_ptr_array_new ();
 
-	/* use prepared query for each GUID */
-	for (guint i = 0; i < guids->len; i++) {
-		const gchar *guid = g_ptr_array_index (guids, i);
+	/* prepare query with bound GUID parameter for each shard */
+	for (guint i = 0; i < self->silos->len; i++) {
+		XbSilo *silo = g_ptr_array_index (self->silos, i);
 		g_autoptr(GError) error_local = NULL;
-		g_autoptr(GPtrArray) releases = NULL;
-
-		/* bind GUID and then query */
-		if (!xb_query_bind_str (query, 0, guid, error)) {
-			g_prefix_error (error, "failed to bind string: ");
-			return NULL;
-		}
-		releases = xb_silo_query_full (self->silo, query, &error_local);
-		if (releases == NULL) {
+		XbQuery *query = xb_query_new_full (silo,
+						    "components/component/"
+						    "provides/firmware[@type='flashed'][text()=?]/"
+						    "../../releases/release",
+						    XB_QUERY_FLAG_OPTIMIZE |
+						    XB_QUERY_FLAG_USE_INDEXES,
+						    &error_local);
+		if (query == NULL) {
 			if (g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
-			    g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT)) {
-				g_debug ("could not find %s: %s",
-					 guid, error_local->message);
+			    g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT))
 				continue;
-			}
 			g_propagate_error (error, g_steal_pointer (&error_local));
 			return NULL;
 		}
-		for (guint j = 0; j < releases->len; j++) {
-			XbNode *rel = g_ptr_array_index (releases, j);
-			const gchar *rel_ver = xb_node_get_attr (rel, "version");
-			g_autofree gchar *tmp_ver = fu_common_version_parse_from_format (rel_ver, fmt);
-			if (fu_common_vercmp_full (tmp_ver, fu_device_get_version (device), fmt) == 0)
-				return g_object_ref (rel);
+		g_ptr_array_add (queries, query);
+		g_ptr_array_add (silos, silo);
+	}
+
+	/* use prepared query for each GUID */
+	for (guint i = 0; i < guids->len; i++) {
+		const gchar *guid = g_ptr_array_index (guids, i);
+		for (guint k = 0; k < queries->len; k++) {
+			XbQuery *query = g_ptr_array_index (queries, k);
+			XbSilo *silo = g_ptr_array_index (silos, k);
+			g_autoptr(GError) error_local = NULL;
+			g_autoptr(GPtrArray) releases = NULL;
+
+			/* bind GUID and then query */
+			if (!xb_query_bind_str (query, 0, guid, error)) {
+				g_prefix_error (error, "failed to bind string: ");
+				return NULL;
+			}
+			releases = xb_silo_query_full (silo, query, &error_local);
+			if (releases == NULL) {
+				if (g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
+				    g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT)) {
+					g_debug ("could not find %s: %s",
+						 guid, error_local->message);
+					continue;
+				}
+				g_propagate_error (error, g_steal_pointer (&error_local));
+				return NULL;
+			}
+			for (guint j = 0; j < releases->len; j++) {
+				XbNode *rel = g_ptr_array_index (releases, j);
+				const gchar *rel_ver = xb_node_get_attr (rel, "version");
+				g_autofree gchar *tmp_ver = fu_common_version_parse_from_format (rel_ver, fmt);
+				if (fu_common_vercmp_full (tmp_ver, fu_device_get_version (device), fmt) == 0)
+					return g_object_ref (rel);
+			}
 		}
 	}
 
@@ -1722,7 +2096,8 @@ fu_engine_get_report_metadata (FuEngine *self, GError **error)
 gboolean
 fu_engine_composite_prepare (FuEngine *self, GPtrArray *devices, GError **error)
 {
-	GPtrArray *plugins = fu_plugin_list_get_all (self->plugin_list);
+	GPtrArray *plugins = fu_plugin_list_get_all_by_vfunc (self->plugin_list,
+							      FU_PLUGIN_VFUNC_COMPOSITE_PREPARE);
 	for (guint j = 0; j < plugins->len; j++) {
 		FuPlugin *plugin_tmp = g_ptr_array_index (plugins, j);
 		if (!fu_plugin_runner_composite_prepare (plugin_tmp, devices, error))
@@ -1744,7 +2119,8 @@ fu_engine_composite_prepare (FuEngine *self, GPtrArray *devices, GError **error)
 gboolean
 fu_engine_composite_cleanup (FuEngine *self, GPtrArray *devices, GError **error)
 {
-	GPtrArray *plugins = fu_plugin_list_get_all (self->plugin_list);
+	GPtrArray *plugins = fu_plugin_list_get_all_by_vfunc (self->plugin_list,
+							      FU_PLUGIN_VFUNC_COMPOSITE_CLEANUP);
 	for (guint j = 0; j < plugins->len; j++) {
 		FuPlugin *plugin_tmp = g_ptr_array_index (plugins, j);
 		if (!fu_plugin_runner_composite_cleanup (plugin_tmp, devices, error))
@@ -1753,83 +2129,400 @@ fu_engine_composite_cleanup (FuEngine *self, GPtrArray *devices, GError **error)
 	return TRUE;
 }
 
-/**
- * fu_engine_install_tasks:
- * @self: A #FuEngine
- * @request: A #FuEngineRequest
- * @install_tasks: (element-type FuInstallTask): A #FuDevice
- * @blob_cab: The #GBytes of the .cab file
- * @flags: The #FwupdInstallFlags, e.g. %FWUPD_DEVICE_FLAG_UPDATABLE
- * @error: A #GError, or %NULL
- *
- * Installs a specific firmware file on one or more install tasks.
- *
- * By this point all the requirements and tests should have been done in
- * fu_engine_check_requirements() so this should not fail before running
- * the plugin loader.
- *
- * Returns: %TRUE for success
- **/
-gboolean
-fu_engine_install_tasks (FuEngine *self,
-			 FuEngineRequest *request,
-			 GPtrArray *install_tasks,
-			 GBytes *blob_cab,
-			 FwupdInstallFlags flags,
-			 GError **error)
+typedef enum {
+	FU_ENGINE_INSTALL_STEP_PREPARE,
+	FU_ENGINE_INSTALL_STEP_DETACH,
+	FU_ENGINE_INSTALL_STEP_UPDATE,
+	FU_ENGINE_INSTALL_STEP_ATTACH,
+	FU_ENGINE_INSTALL_STEP_LAST
+} FuEngineInstallStep;
+
+typedef struct {
+	FuEngine		*self;
+	FuDevice		*device;
+	GBytes			*blob_fw;
+	gchar			*version_orig;
+	gchar			*version_rel;
+	FwupdInstallFlags	 flags;
+	FuEngineInstallStep	 step;
+	GTimer			*timer;
+	gboolean		 done;
+	GError			*error;
+} FuEngineInstallHelper;
+
+static void
+fu_engine_install_helper_free (FuEngineInstallHelper *helper)
+{
+	g_object_unref (helper->device);
+	if (helper->blob_fw != NULL)
+		g_bytes_unref (helper->blob_fw);
+	g_free (helper->version_orig);
+	g_free (helper->version_rel);
+	g_timer_destroy (helper->timer);
+	if (helper->error != NULL)
+		g_error_free (helper->error);
+	g_free (helper);
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wunused-function"
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuEngineInstallHelper, fu_engine_install_helper_free)
+#pragma clang diagnostic pop
+
+static FuEngineInstallHelper *fu_engine_install_task_start	(FuEngine		*self,
+								 FuInstallTask		*task,
+								 FwupdInstallFlags	 flags,
+								 GError			**error);
+static gboolean fu_engine_install_task_finish			(FuEngineInstallHelper	*helper,
+								 GError			**error);
+static gboolean fu_engine_install_blob_step			(FuEngine		*self,
+								 const gchar		*device_id,
+								 GBytes			*blob_fw,
+								 FwupdInstallFlags	 flags,
+								 FuEngineInstallStep	 step,
+								 GError			**error);
+static gboolean fu_engine_install_blob_start			(FuEngine		*self,
+								 FuDevice		*device,
+								 GBytes			*blob_fw,
+								 GError			**error);
+static gboolean fu_engine_install_blob_resume			(FuEngine		*self,
+								 const gchar		*device_id,
+								 GBytes			*blob_fw,
+								 FwupdInstallFlags	 flags,
+								 FuEngineInstallStep	 step,
+								 GError			**error);
+static void fu_engine_install_blob_failed			(FuEngine		*self,
+								 const gchar		*device_id,
+								 FwupdInstallFlags	 flags,
+								 FuEngineInstallStep	 step);
+
+static gboolean
+fu_engine_install_done_cb (gpointer user_data)
 {
-	g_autoptr(FuIdleLocker) locker = NULL;
-	g_autoptr(GPtrArray) devices = NULL;
-	g_autoptr(GPtrArray) devices_new = NULL;
+	FuEngineInstallHelper *helper = (FuEngineInstallHelper *) user_data;
+	helper->done = TRUE;
+	helper->self->install_pending--;
+	return G_SOURCE_REMOVE;
+}
 
-	/* do not allow auto-shutdown during this time */
-	locker = fu_idle_locker_new (self->idle, "update");
-	g_assert (locker != NULL);
+/* the device list can only wait for a replug from the main thread */
+static gboolean
+fu_engine_install_needs_replug (FuEngine *self, const gchar *device_id)
+{
+	g_autoptr(FuDevice) device = NULL;
+	g_autoptr(FuDevice) root = NULL;
 
-	/* notify the plugins about the composite action */
-	devices = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
-	for (guint i = 0; i < install_tasks->len; i++) {
-		FuInstallTask *task = g_ptr_array_index (install_tasks, i);
-		g_debug ("composite update %u: %s", i + 1,
-			 fu_device_get_id (fu_install_task_get_device (task)));
-		g_ptr_array_add (devices, g_object_ref (fu_install_task_get_device (task)));
-	}
-	if (!fu_engine_composite_prepare (self, devices, error)) {
-		g_prefix_error (error, "failed to prepare composite action: ");
+	device = fu_device_list_get_by_id (self->device_list, device_id, NULL);
+	if (device == NULL)
 		return FALSE;
-	}
+	root = fu_device_get_root (device);
+	return fu_device_has_flag (device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG) ||
+	       fu_device_has_flag (root, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG);
+}
 
-	/* all authenticated, so install all the things */
-	for (guint i = 0; i < install_tasks->len; i++) {
-		FuInstallTask *task = g_ptr_array_index (install_tasks, i);
-		if (!fu_engine_install (self, task, blob_cab, flags, error)) {
-			g_autoptr(GError) error_local = NULL;
-			if (!fu_engine_composite_cleanup (self, devices, &error_local)) {
-				g_warning ("failed to cleanup failed composite action: %s",
-					   error_local->message);
-			}
-			return FALSE;
+static void
+fu_engine_install_thread_cb (gpointer data, gpointer user_data)
+{
+	FuEngineInstallHelper *helper = (FuEngineInstallHelper *) data;
+	const gchar *device_id = fu_device_get_id (helper->device);
+	g_autoptr(GSource) source = g_idle_source_new ();
+
+	/* only detach, write and attach are run from the worker thread, and
+	 * any steps left over are run when the task is finished */
+	for (; helper->step < FU_ENGINE_INSTALL_STEP_LAST; helper->step++) {
+		if (fu_engine_install_needs_replug (helper->self, device_id)) {
+			g_debug ("continuing update of %s from the main thread", device_id);
+			break;
 		}
+		if (!fu_engine_install_blob_step (helper->self,
+						  device_id,
+						  helper->blob_fw,
+						  helper->flags,
+						  helper->step,
+						  &helper->error))
+			break;
 	}
 
-	/* set all the device statuses back to unknown */
-	for (guint i = 0; i < install_tasks->len; i++) {
-		FuInstallTask *task = g_ptr_array_index (install_tasks, i);
-		FuDevice *device = fu_install_task_get_device (task);
-		fu_device_set_status (device, FWUPD_STATUS_UNKNOWN);
+	/* the helper is owned by the scheduler, just mark as done */
+	g_source_set_callback (source, fu_engine_install_done_cb, helper, NULL);
+	g_source_attach (source, helper->self->main_ctx);
+}
+
+/* the topmost device sharing prepare, cleanup or replug with @device */
+static FuDevice *
+fu_engine_device_get_root (FuDevice *device)
+{
+	while (TRUE) {
+		FuDevice *tmp = fu_device_get_parent (device);
+		if (tmp == NULL)
+			tmp = fu_device_get_proxy (device);
+		if (tmp == NULL || tmp == device)
+			return device;
+		device = tmp;
 	}
+}
 
-	/* get a new list of devices in case they replugged */
-	devices_new = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
-	for (guint i = 0; i < devices->len; i++) {
-		FuDevice *device;
-		g_autoptr(FuDevice) device_new = NULL;
-		g_autoptr(GError) error_local = NULL;
-		device = g_ptr_array_index (devices, i);
-		device_new = fu_device_list_get_by_id (self->device_list,
-						       fu_device_get_id (device),
-						       &error_local);
-		if (device_new == NULL) {
+/* tasks can only be run from a worker thread if the plugin opted in and the
+ * device shares no parent or proxy with any other device being updated;
+ * the device order is honoured by fu_engine_install_tasks_schedule() */
+static gboolean
+fu_engine_install_task_can_thread (FuEngine *self,
+				   FuInstallTask *task,
+				   GPtrArray *install_tasks,
+				   FwupdInstallFlags flags)
+{
+	FuDevice *device = fu_install_task_get_device (task);
+	FuDevice *root = fu_engine_device_get_root (device);
+	FuPlugin *plugin;
+
+	/* scheduling an offline update is quick */
+	if (flags & FWUPD_INSTALL_FLAG_OFFLINE)
+		return FALSE;
+
+	/* only one device can wait for replug at a time */
+	if (fu_device_has_flag (device, FWUPD_DEVICE_FLAG_WAIT_FOR_REPLUG))
+		return FALSE;
+
+	/* each release is written in order */
+	if (fu_device_has_flag (device, FWUPD_DEVICE_FLAG_INSTALL_ALL_RELEASES))
+		return FALSE;
+	plugin = fu_plugin_list_find_by_name (self->plugin_list,
+					      fu_device_get_plugin (device),
+					      NULL);
+	if (plugin == NULL)
+		return FALSE;
+	if (!fu_plugin_has_rule (plugin, FU_PLUGIN_RULE_THREAD_SAFE, "update"))
+		return FALSE;
+
+	/* the plugin coordinates the devices in the composite update */
+	if (fu_plugin_has_vfunc (plugin, FU_PLUGIN_VFUNC_COMPOSITE_PREPARE) ||
+	    fu_plugin_has_vfunc (plugin, FU_PLUGIN_VFUNC_COMPOSITE_CLEANUP))
+		return FALSE;
+	for (guint i = 0; i < install_tasks->len; i++) {
+		FuInstallTask *task_tmp = g_ptr_array_index (install_tasks, i);
+		FuDevice *device_tmp = fu_install_task_get_device (task_tmp);
+		if (task_tmp == task)
+			continue;
+		if (fu_engine_device_get_root (device_tmp) == root)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static GThreadPool *
+fu_engine_install_pool_new (FuEngine *self,
+			    GPtrArray *install_tasks,
+			    GPtrArray *can_thread,
+			    FwupdInstallFlags flags)
+{
+	guint cnt = 0;
+	g_autoptr(GError) error = NULL;
+	GThreadPool *pool;
+
+	for (guint i = 0; i < install_tasks->len; i++) {
+		FuInstallTask *task = g_ptr_array_index (install_tasks, i);
+		gboolean ret = fu_engine_install_task_can_thread (self, task, install_tasks, flags);
+		g_ptr_array_add (can_thread, GINT_TO_POINTER (ret));
+		if (ret)
+			cnt++;
+	}
+
+	/* only create threads if more than one device can be updated */
+	if (cnt < 2)
+		return NULL;
+	pool = g_thread_pool_new (fu_engine_install_thread_cb,
+				  self,
+				  MIN (cnt, self->install_threads_max),
+				  FALSE,
+				  &error);
+	if (pool == NULL)
+		g_warning ("failed to create install threads: %s", error->message);
+	return pool;
+}
+
+/* finishes the tasks the workers are done with from the main thread until no
+ * more than @max_pending are still running; only the first error is set */
+static gboolean
+fu_engine_install_wait_pending (FuEngine *self,
+				GPtrArray *helpers,
+				guint max_pending,
+				GError **error)
+{
+	gboolean ret = TRUE;
+
+	while (TRUE) {
+		for (guint i = 0; i < helpers->len; i++) {
+			FuEngineInstallHelper *helper = g_ptr_array_index (helpers, i);
+			if (!helper->done)
+				continue;
+			if (!fu_engine_install_task_finish (helper, ret ? error : NULL))
+				ret = FALSE;
+			g_ptr_array_remove_index (helpers, i--);
+		}
+		if (self->install_pending <= max_pending)
+			break;
+		g_main_context_iteration (self->main_ctx, TRUE);
+	}
+	return ret;
+}
+
+/* independent devices with the same order are updated at the same time where
+ * the plugin allows it, and everything else is updated in order from the main
+ * thread -- the tasks are already sorted by the device order */
+static gboolean
+fu_engine_install_tasks_schedule (FuEngine *self,
+				  GPtrArray *install_tasks,
+				  GBytes *blob_cab,
+				  FwupdInstallFlags flags,
+				  GError **error)
+{
+	GThreadPool *pool;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GPtrArray) can_thread = g_ptr_array_new ();
+	g_autoptr(GPtrArray) helpers = NULL;
+
+	helpers = g_ptr_array_new_with_free_func ((GDestroyNotify) fu_engine_install_helper_free);
+	pool = fu_engine_install_pool_new (self, install_tasks, can_thread, flags);
+	for (guint i = 0; i < install_tasks->len; i++) {
+		FuInstallTask *task = g_ptr_array_index (install_tasks, i);
+		FuDevice *device = fu_install_task_get_device (task);
+
+		if (pool != NULL && GPOINTER_TO_INT (g_ptr_array_index (can_thread, i))) {
+			FuEngineInstallHelper *helper;
+			guint max_pending = g_thread_pool_get_max_threads (pool) - 1;
+			g_autoptr(GError) error_pool = NULL;
+
+			/* devices with a lower order have to be finished first */
+			if (i > 0) {
+				FuInstallTask *task_prev = g_ptr_array_index (install_tasks, i - 1);
+				FuDevice *device_prev = fu_install_task_get_device (task_prev);
+				if (fu_device_get_order (device) != fu_device_get_order (device_prev))
+					max_pending = 0;
+			}
+
+			/* only start a task when a worker is free, so nothing
+			 * is left queued if another task fails */
+			if (!fu_engine_install_wait_pending (self,
+							     helpers,
+							     max_pending,
+							     &error_local))
+				break;
+			helper = fu_engine_install_task_start (self, task, flags, &error_local);
+			if (helper == NULL)
+				break;
+			g_ptr_array_add (helpers, helper);
+			if (g_thread_pool_push (pool, helper, &error_pool)) {
+				self->install_pending++;
+				continue;
+			}
+
+			/* the remaining steps are run when finishing the task */
+			g_warning ("failed to update %s in thread: %s",
+				   fu_device_get_id (device),
+				   error_pool->message);
+			helper->done = TRUE;
+			continue;
+		}
+
+		/* everything that was already started has to finish first */
+		if (!fu_engine_install_wait_pending (self, helpers, 0, &error_local))
+			break;
+		if (!fu_engine_install (self, task, blob_cab, flags, &error_local))
+			break;
+	}
+
+	/* tasks that were started are always finished */
+	fu_engine_install_wait_pending (self,
+					helpers,
+					0,
+					error_local == NULL ? &error_local : NULL);
+	if (pool != NULL)
+		g_thread_pool_free (pool, FALSE, TRUE);
+	if (error_local != NULL) {
+		g_propagate_error (error, g_steal_pointer (&error_local));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * fu_engine_install_tasks:
+ * @self: A #FuEngine
+ * @request: A #FuEngineRequest
+ * @install_tasks: (element-type FuInstallTask): A #FuDevice
+ * @blob_cab: The #GBytes of the .cab file
+ * @flags: The #FwupdInstallFlags, e.g. %FWUPD_DEVICE_FLAG_UPDATABLE
+ * @error: A #GError, or %NULL
+ *
+ * Installs a specific firmware file on one or more install tasks.
+ *
+ * By this point all the requirements and tests should have been done in
+ * fu_engine_check_requirements() so this should not fail before running
+ * the plugin loader.
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+fu_engine_install_tasks (FuEngine *self,
+			 FuEngineRequest *request,
+			 GPtrArray *install_tasks,
+			 GBytes *blob_cab,
+			 FwupdInstallFlags flags,
+			 GError **error)
+{
+	g_autoptr(FuIdleLocker) locker = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GPtrArray) devices_new = NULL;
+
+	/* an install authorized while another was running */
+	if (!fu_engine_check_not_installing (self, error))
+		return FALSE;
+
+	/* do not allow auto-shutdown during this time */
+	locker = fu_idle_locker_new (self->idle, "update");
+	g_assert (locker != NULL);
+
+	/* notify the plugins about the composite action */
+	devices = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	for (guint i = 0; i < install_tasks->len; i++) {
+		FuInstallTask *task = g_ptr_array_index (install_tasks, i);
+		g_debug ("composite update %u: %s", i + 1,
+			 fu_device_get_id (fu_install_task_get_device (task)));
+		g_ptr_array_add (devices, g_object_ref (fu_install_task_get_device (task)));
+	}
+	if (!fu_engine_composite_prepare (self, devices, error)) {
+		g_prefix_error (error, "failed to prepare composite action: ");
+		return FALSE;
+	}
+
+	/* all authenticated, so install all the things */
+	if (!fu_engine_install_tasks_schedule (self, install_tasks, blob_cab, flags, error)) {
+		g_autoptr(GError) error_local = NULL;
+		if (!fu_engine_composite_cleanup (self, devices, &error_local)) {
+			g_warning ("failed to cleanup failed composite action: %s",
+				   error_local->message);
+		}
+		return FALSE;
+	}
+
+	/* set all the device statuses back to unknown */
+	for (guint i = 0; i < install_tasks->len; i++) {
+		FuInstallTask *task = g_ptr_array_index (install_tasks, i);
+		FuDevice *device = fu_install_task_get_device (task);
+		fu_device_set_status (device, FWUPD_STATUS_UNKNOWN);
+	}
+
+	/* get a new list of devices in case they replugged */
+	devices_new = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	for (guint i = 0; i < devices->len; i++) {
+		FuDevice *device;
+		g_autoptr(FuDevice) device_new = NULL;
+		g_autoptr(GError) error_local = NULL;
+		device = g_ptr_array_index (devices, i);
+		device_new = fu_device_list_get_by_id (self->device_list,
+						       fu_device_get_id (device),
+						       &error_local);
+		if (device_new == NULL) {
 			g_debug ("failed to find new device: %s",
 				 error_local->message);
 			continue;
@@ -2058,83 +2751,33 @@ fu_engine_schedule_update (FuEngine *self,
 	return fu_engine_offline_setup (error);
 }
 
+/* runs the steps the worker thread did not, and updates the history database;
+ * must be called from the main thread */
 static gboolean
-fu_engine_install_release (FuEngine *self,
-			   FuDevice *device_orig,
-			   XbNode *component,
-			   XbNode *rel,
-			   FwupdInstallFlags flags,
-			   GError **error)
+fu_engine_install_release_finish (FuEngineInstallHelper *helper, GError **error)
 {
-	FuPlugin *plugin;
+	FuEngine *self = helper->self;
+	FwupdInstallFlags flags = helper->flags;
 	FwupdVersionFormat fmt;
-	GBytes *blob_fw;
-	const gchar *tmp;
-	g_autofree gchar *version_orig = NULL;
-	g_autofree gchar *version_rel = NULL;
+	g_autofree gchar *device_id = g_strdup (fu_device_get_id (helper->device));
 	g_autoptr(FuDevice) device_tmp = NULL;
-	g_autoptr(FuDevice) device = g_object_ref (device_orig);
-	g_autoptr(GBytes) blob_fw2 = NULL;
+	g_autoptr(FuDevice) device = g_object_ref (helper->device);
 	g_autoptr(GError) error_local = NULL;
 
-	/* get per-release firmware blob */
-	blob_fw = xb_node_get_data (rel, "fwupd::FirmwareBlob");
-	if (blob_fw == NULL) {
-		g_set_error_literal (error,
-				     FWUPD_ERROR,
-				     FWUPD_ERROR_INTERNAL,
-				     "Failed to get firmware blob from release");
-		return FALSE;
-	}
-
-	/* use a bubblewrap helper script to build the firmware */
-	tmp = g_object_get_data (G_OBJECT (component), "fwupd::BuilderScript");
-	if (tmp != NULL) {
-		const gchar *tmp2 = g_object_get_data (G_OBJECT (component), "fwupd::BuilderOutput");
-		if (tmp2 == NULL)
-			tmp2 = "firmware.bin";
-		blob_fw2 = fu_common_firmware_builder (blob_fw, tmp, tmp2, error);
-		if (blob_fw2 == NULL)
-			return FALSE;
-	} else {
-		blob_fw2 = g_bytes_ref (blob_fw);
-	}
-
-	/* get the plugin */
-	plugin = fu_plugin_list_find_by_name (self->plugin_list,
-					      fu_device_get_plugin (device),
-					      error);
-	if (plugin == NULL)
-		return FALSE;
-
-	/* schedule this for the next reboot if not in system-update.target,
-	 * but first check if allowed on battery power */
-	version_rel = fu_engine_get_release_version (self, device, rel, error);
-	if (version_rel == NULL) {
-		g_prefix_error (error, "failed to get release version: ");
-		return FALSE;
-	}
-
-	/* add device to database */
-	if ((flags & FWUPD_INSTALL_FLAG_NO_HISTORY) == 0) {
-		g_autoptr(FwupdRelease) release_tmp = NULL;
-		release_tmp = fu_engine_create_release_metadata (self, device, plugin, error);
-		if (release_tmp == NULL)
-			return FALSE;
-		tmp = xb_node_query_text (component,
-					  "releases/release/checksum[@target='container']",
-					  NULL);
-		if (tmp != NULL)
-			fwupd_release_add_checksum (release_tmp, tmp);
-		fwupd_release_set_version (release_tmp, version_rel);
-		fu_device_set_update_state (device, FWUPD_UPDATE_STATE_FAILED);
-		if (!fu_history_add_device (self->history, device, release_tmp, error))
-			return FALSE;
-	}
-
-	/* install firmware blob */
-	version_orig = g_strdup (fu_device_get_version (device));
-	if (!fu_engine_install_blob (self, device, blob_fw2, flags, &error_local)) {
+	/* continue from where the worker thread stopped */
+	if (helper->error != NULL) {
+		fu_engine_install_blob_failed (self, device_id, flags, helper->step);
+		error_local = g_steal_pointer (&helper->error);
+	} else if (fu_engine_install_blob_resume (self,
+						  device_id,
+						  helper->blob_fw,
+						  flags,
+						  helper->step,
+						  &error_local)) {
+		g_debug ("Updating %s took %f seconds", fu_device_get_name (device),
+			 g_timer_elapsed (helper->timer, NULL));
+	}
+	if (error_local != NULL) {
 		fu_device_set_status (device, FWUPD_STATUS_IDLE);
 		if (g_error_matches (error_local,
 				     FWUPD_ERROR,
@@ -2184,13 +2827,13 @@ fu_engine_install_release (FuEngine *self,
 
 	/* for online updates, verify the version changed if not a re-install */
 	fmt = fu_device_get_version_format (device);
-	if (version_rel != NULL &&
-	    fu_common_vercmp_full (version_orig, version_rel, fmt) != 0 &&
-	    fu_common_vercmp_full (version_orig, fu_device_get_version (device), fmt) == 0) {
+	if (helper->version_rel != NULL &&
+	    fu_common_vercmp_full (helper->version_orig, helper->version_rel, fmt) != 0 &&
+	    fu_common_vercmp_full (helper->version_orig, fu_device_get_version (device), fmt) == 0) {
 		g_autofree gchar *str = NULL;
 		fu_device_set_update_state (device, FWUPD_UPDATE_STATE_FAILED);
 		str = g_strdup_printf ("device version not updated on success, %s != %s",
-				       version_rel, fu_device_get_version (device));
+				       helper->version_rel, fu_device_get_version (device));
 		fu_device_set_update_error (device, str);
 	}
 
@@ -2205,6 +2848,107 @@ fu_engine_install_release (FuEngine *self,
 	return TRUE;
 }
 
+/* gets the firmware and adds the device to the history database, and must be
+ * called from the main thread */
+static FuEngineInstallHelper *
+fu_engine_install_release_start (FuEngine *self,
+				 FuDevice *device,
+				 XbNode *component,
+				 XbNode *rel,
+				 FwupdInstallFlags flags,
+				 GError **error)
+{
+	FuPlugin *plugin;
+	GBytes *blob_fw;
+	const gchar *tmp;
+	g_autoptr(FuEngineInstallHelper) helper = g_new0 (FuEngineInstallHelper, 1);
+
+	helper->self = self;
+	helper->device = g_object_ref (device);
+	helper->flags = flags;
+	helper->timer = g_timer_new ();
+
+	/* get per-release firmware blob */
+	blob_fw = xb_node_get_data (rel, "fwupd::FirmwareBlob");
+	if (blob_fw == NULL) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INTERNAL,
+				     "Failed to get firmware blob from release");
+		return NULL;
+	}
+
+	/* use a bubblewrap helper script to build the firmware */
+	tmp = g_object_get_data (G_OBJECT (component), "fwupd::BuilderScript");
+	if (tmp != NULL) {
+		const gchar *tmp2 = g_object_get_data (G_OBJECT (component), "fwupd::BuilderOutput");
+		if (tmp2 == NULL)
+			tmp2 = "firmware.bin";
+		helper->blob_fw = fu_common_firmware_builder (blob_fw, tmp, tmp2, error);
+		if (helper->blob_fw == NULL)
+			return NULL;
+	} else {
+		helper->blob_fw = g_bytes_ref (blob_fw);
+	}
+
+	/* get the plugin */
+	plugin = fu_plugin_list_find_by_name (self->plugin_list,
+					      fu_device_get_plugin (device),
+					      error);
+	if (plugin == NULL)
+		return NULL;
+
+	/* schedule this for the next reboot if not in system-update.target,
+	 * but first check if allowed on battery power */
+	helper->version_rel = fu_engine_get_release_version (self, device, rel, error);
+	if (helper->version_rel == NULL) {
+		g_prefix_error (error, "failed to get release version: ");
+		return NULL;
+	}
+
+	/* add device to database */
+	if ((flags & FWUPD_INSTALL_FLAG_NO_HISTORY) == 0) {
+		g_autoptr(FwupdRelease) release_tmp = NULL;
+		release_tmp = fu_engine_create_release_metadata (self, device, plugin, error);
+		if (release_tmp == NULL)
+			return NULL;
+		tmp = xb_node_query_text (component,
+					  "releases/release/checksum[@target='container']",
+					  NULL);
+		if (tmp != NULL)
+			fwupd_release_add_checksum (release_tmp, tmp);
+		fwupd_release_set_version (release_tmp, helper->version_rel);
+		fu_device_set_update_state (device, FWUPD_UPDATE_STATE_FAILED);
+		if (!fu_history_add_device (self->history, device, release_tmp, error))
+			return NULL;
+	}
+
+	/* install firmware blob */
+	helper->version_orig = g_strdup (fu_device_get_version (device));
+	helper->step = FU_ENGINE_INSTALL_STEP_PREPARE;
+	if (!fu_engine_install_blob_start (self, device, helper->blob_fw, &helper->error)) {
+		fu_engine_install_release_finish (helper, error);
+		return NULL;
+	}
+	return g_steal_pointer (&helper);
+}
+
+static gboolean
+fu_engine_install_release (FuEngine *self,
+			   FuDevice *device,
+			   XbNode *component,
+			   XbNode *rel,
+			   FwupdInstallFlags flags,
+			   GError **error)
+{
+	g_autoptr(FuEngineInstallHelper) helper = NULL;
+
+	helper = fu_engine_install_release_start (self, device, component, rel, flags, error);
+	if (helper == NULL)
+		return FALSE;
+	return fu_engine_install_release_finish (helper, error);
+}
+
 typedef struct {
 	gboolean	 ret;
 	GError		**error;
@@ -2252,6 +2996,38 @@ fu_engine_sort_releases (FuEngine *self, FuDevice *device, GPtrArray *rels, GErr
 	return helper.ret;
 }
 
+static gboolean
+fu_engine_install_check_bootloader (FuEngine *self,
+				    FuDevice *device,
+				    XbNode *component,
+				    GError **error)
+{
+	const gchar *caption = NULL;
+
+	if (!fu_device_has_flag (device, FWUPD_DEVICE_FLAG_NEEDS_BOOTLOADER))
+		return TRUE;
+	caption = xb_node_query_text (component,
+				      "screenshots/screenshot/caption",
+				      NULL);
+	if (caption != NULL) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NEEDS_USER_ACTION,
+			     "Device %s needs to manually be put in update mode: %s",
+			     fu_device_get_name (device), caption);
+	} else {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_NEEDS_USER_ACTION,
+			     "Device %s needs to manually be put in update mode",
+			     fu_device_get_name (device));
+	}
+	fu_device_set_update_state (device, FWUPD_UPDATE_STATE_FAILED_TRANSIENT);
+	if (error != NULL)
+		fu_device_set_update_error (device, (*error)->message);
+	return FALSE;
+}
+
 /**
  * fu_engine_install:
  * @self: A #FuEngine
@@ -2290,29 +3066,8 @@ fu_engine_install (FuEngine *self,
 
 	/* not in bootloader mode */
 	device = g_object_ref (fu_install_task_get_device (task));
-	if (fu_device_has_flag (device, FWUPD_DEVICE_FLAG_NEEDS_BOOTLOADER)) {
-		const gchar *caption = NULL;
-		caption = xb_node_query_text (component,
-					      "screenshots/screenshot/caption",
-					      NULL);
-		if (caption != NULL) {
-			g_set_error (error,
-				     FWUPD_ERROR,
-				     FWUPD_ERROR_NEEDS_USER_ACTION,
-				     "Device %s needs to manually be put in update mode: %s",
-				     fu_device_get_name (device), caption);
-		} else {
-			g_set_error (error,
-				     FWUPD_ERROR,
-				     FWUPD_ERROR_NEEDS_USER_ACTION,
-				     "Device %s needs to manually be put in update mode",
-				     fu_device_get_name (device));
-		}
-		fu_device_set_update_state (device, FWUPD_UPDATE_STATE_FAILED_TRANSIENT);
-		if (error != NULL)
-			fu_device_set_update_error (device, (*error)->message);
+	if (!fu_engine_install_check_bootloader (self, device, component, error))
 		return FALSE;
-	}
 
 	/* get the newest version */
 #if LIBXMLB_CHECK_VERSION(0,2,0)
@@ -2393,6 +3148,71 @@ fu_engine_install (FuEngine *self,
 	return TRUE;
 }
 
+/* does everything fu_engine_install() does before the device is detached, so
+ * that only detach, write and attach are left for the worker thread */
+static FuEngineInstallHelper *
+fu_engine_install_task_start (FuEngine *self,
+			      FuInstallTask *task,
+			      FwupdInstallFlags flags,
+			      GError **error)
+{
+	FuDevice *device = fu_install_task_get_device (task);
+	XbNode *component = fu_install_task_get_component (task);
+	g_autoptr(FuEngineInstallHelper) helper = NULL;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(XbNode) rel_newest = NULL;
+#if LIBXMLB_CHECK_VERSION(0,2,0)
+	g_autoptr(XbQuery) query = NULL;
+#endif
+
+	if (!fu_engine_install_check_bootloader (self, device, component, error))
+		return NULL;
+#if LIBXMLB_CHECK_VERSION(0,2,0)
+	query = xb_query_new_full (xb_node_get_silo (component),
+				   "releases/release",
+				   XB_QUERY_FLAG_FORCE_NODE_CACHE,
+				   error);
+	if (query == NULL)
+		return NULL;
+	rel_newest = xb_node_query_first_full (component, query, &error_local);
+#else
+	rel_newest = xb_node_query_first (component, "releases/release", &error_local);
+#endif
+	if (rel_newest == NULL) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "No releases in the firmware component: %s",
+			     error_local->message);
+		return NULL;
+	}
+	helper = fu_engine_install_release_start (self, device, component, rel_newest, flags, error);
+	if (helper == NULL)
+		return NULL;
+
+	/* all the plugins are told about the update from the main thread */
+	if (!fu_engine_install_blob_step (self,
+					  fu_device_get_id (device),
+					  helper->blob_fw,
+					  flags,
+					  FU_ENGINE_INSTALL_STEP_PREPARE,
+					  &helper->error)) {
+		fu_engine_install_release_finish (helper, error);
+		return NULL;
+	}
+	helper->step = FU_ENGINE_INSTALL_STEP_DETACH;
+	return g_steal_pointer (&helper);
+}
+
+static gboolean
+fu_engine_install_task_finish (FuEngineInstallHelper *helper, GError **error)
+{
+	if (!fu_engine_install_release_finish (helper, error))
+		return FALSE;
+	fu_device_set_update_state (helper->device, FWUPD_UPDATE_STATE_SUCCESS);
+	return TRUE;
+}
+
 /**
  * fu_engine_get_plugins:
  * @self: A #FuPluginList
@@ -2694,11 +3514,6 @@ fu_engine_update (FuEngine *self,
 	FuPlugin *plugin;
 	g_autofree gchar *str = NULL;
 	g_autoptr(FuDevice) device = NULL;
-	g_autoptr(FuDevice) device_pending = NULL;
-
-	/* cancel the pending action */
-	if (!fu_engine_offline_invalidate (error))
-		return FALSE;
 
 	/* the device and plugin both may have changed */
 	device = fu_engine_get_device (self, device_id, error);
@@ -2706,7 +3521,6 @@ fu_engine_update (FuEngine *self,
 		g_prefix_error (error, "failed to get device after detach: ");
 		return FALSE;
 	}
-	device_pending = fu_history_get_device_by_id (self->history, device_id, NULL);
 	str = fu_device_to_string (device);
 	g_debug ("update -> %s", str);
 	plugin = fu_plugin_list_find_by_name (self->plugin_list,
@@ -2716,47 +3530,52 @@ fu_engine_update (FuEngine *self,
 		return FALSE;
 	if (!fu_plugin_runner_update (plugin, device, blob_fw2, flags, error)) {
 		g_autoptr(GError) error_attach = NULL;
-		g_autoptr(GError) error_cleanup = NULL;
 
-		/* attack back into runtime then cleanup */
+		/* attack back into runtime, the cleanup is done by the caller */
 		if (!fu_plugin_runner_update_attach (plugin,
 						     device,
 						     &error_attach)) {
 			g_warning ("failed to attach device after failed update: %s",
 				   error_attach->message);
 		}
-		if (!fu_engine_update_cleanup (self, flags, device_id, &error_cleanup)) {
-			g_warning ("failed to update-cleanup after failed update: %s",
-				   error_cleanup->message);
-		}
 		return FALSE;
 	}
+	return TRUE;
+}
 
-	/* cleanup */
-	if (device_pending != NULL) {
-		const gchar *tmp;
-		FwupdRelease *release;
+static gboolean
+fu_engine_update_history (FuEngine *self, FuDevice *device, GError **error)
+{
+	const gchar *tmp;
+	FwupdRelease *release;
+	g_autoptr(FuDevice) device_pending = NULL;
 
-		/* update history database */
-		fu_device_set_update_state (device, FWUPD_UPDATE_STATE_SUCCESS);
-		if (!fu_history_modify_device (self->history, device, error))
-			return FALSE;
+	/* not in the history database */
+	device_pending = fu_history_get_device_by_id (self->history,
+						      fu_device_get_id (device),
+						      NULL);
+	if (device_pending == NULL)
+		return TRUE;
 
-		/* delete cab file */
-		release = fu_device_get_release_default (device_pending);
-		tmp = fwupd_release_get_filename (release);
-		if (tmp != NULL && g_str_has_prefix (tmp, FWUPD_LIBEXECDIR)) {
-			g_autoptr(GError) error_delete = NULL;
-			g_autoptr(GFile) file = NULL;
-			file = g_file_new_for_path (tmp);
-			if (!g_file_delete (file, NULL, &error_delete)) {
-				g_set_error (error,
-					     FWUPD_ERROR,
-					     FWUPD_ERROR_INVALID_FILE,
-					     "Failed to delete %s: %s",
-					     tmp, error_delete->message);
-				return FALSE;
-			}
+	/* update history database */
+	fu_device_set_update_state (device, FWUPD_UPDATE_STATE_SUCCESS);
+	if (!fu_history_modify_device (self->history, device, error))
+		return FALSE;
+
+	/* delete cab file */
+	release = fu_device_get_release_default (device_pending);
+	tmp = fwupd_release_get_filename (release);
+	if (tmp != NULL && g_str_has_prefix (tmp, FWUPD_LIBEXECDIR)) {
+		g_autoptr(GError) error_delete = NULL;
+		g_autoptr(GFile) file = NULL;
+		file = g_file_new_for_path (tmp);
+		if (!g_file_delete (file, NULL, &error_delete)) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "Failed to delete %s: %s",
+				     tmp, error_delete->message);
+			return FALSE;
 		}
 	}
 	return TRUE;
@@ -2770,26 +3589,64 @@ fu_engine_firmware_dump (FuEngine *self,
 {
 	g_autoptr(FuDeviceLocker) locker = NULL;
 
-	/* open, read, close */
-	locker = fu_device_locker_new (device, error);
-	if (locker == NULL) {
-		g_prefix_error (error, "failed to open device for firmware read: ");
-		return NULL;
+	/* open, read, close */
+	locker = fu_device_locker_new (device, error);
+	if (locker == NULL) {
+		g_prefix_error (error, "failed to open device for firmware read: ");
+		return NULL;
+	}
+	return fu_device_dump_firmware (device, error);
+}
+
+/* the steps are run in order, and only detach, update and attach can be run
+ * from a worker thread */
+static gboolean
+fu_engine_install_blob_step (FuEngine *self,
+			     const gchar *device_id,
+			     GBytes *blob_fw,
+			     FwupdInstallFlags flags,
+			     FuEngineInstallStep step,
+			     GError **error)
+{
+	/* signal to all the plugins the update is about to happen */
+	if (step == FU_ENGINE_INSTALL_STEP_PREPARE)
+		return fu_engine_update_prepare (self, flags, device_id, error);
+
+	/* detach to bootloader mode */
+	if (step == FU_ENGINE_INSTALL_STEP_DETACH)
+		return fu_engine_update_detach (self, device_id, error);
+
+	/* install */
+	if (step == FU_ENGINE_INSTALL_STEP_UPDATE)
+		return fu_engine_update (self, device_id, blob_fw, flags, error);
+
+	/* attach into runtime mode */
+	return fu_engine_update_attach (self, device_id, error);
+}
+
+/* the plugins still get the cleanup when the device failed to update */
+static void
+fu_engine_install_blob_failed (FuEngine *self,
+			       const gchar *device_id,
+			       FwupdInstallFlags flags,
+			       FuEngineInstallStep step)
+{
+	g_autoptr(GError) error_cleanup = NULL;
+
+	if (step != FU_ENGINE_INSTALL_STEP_UPDATE)
+		return;
+	if (!fu_engine_update_cleanup (self, flags, device_id, &error_cleanup)) {
+		g_warning ("failed to update-cleanup after failed update: %s",
+			   error_cleanup->message);
 	}
-	return fu_device_dump_firmware (device, error);
 }
 
-gboolean
-fu_engine_install_blob (FuEngine *self,
-			FuDevice *device,
-			GBytes *blob_fw,
-			FwupdInstallFlags flags,
-			GError **error)
+static gboolean
+fu_engine_install_blob_start (FuEngine *self,
+			      FuDevice *device,
+			      GBytes *blob_fw,
+			      GError **error)
 {
-	guint retries = 0;
-	g_autofree gchar *device_id = NULL;
-	g_autoptr(GTimer) timer = g_timer_new ();
-
 	/* test the firmware is not an empty blob */
 	if (g_bytes_get_size (blob_fw) == 0) {
 		g_set_error (error,
@@ -2802,12 +3659,25 @@ fu_engine_install_blob (FuEngine *self,
 	/* mark this as modified even if we actually fail to do the update */
 	fu_device_set_modified (device, (guint64) g_get_real_time () / G_USEC_PER_SEC);
 
+	/* cancel the pending action */
+	return fu_engine_offline_invalidate (error);
+}
+
+/* runs the steps from @step onwards from the main thread */
+static gboolean
+fu_engine_install_blob_resume (FuEngine *self,
+			       const gchar *device_id,
+			       GBytes *blob_fw,
+			       FwupdInstallFlags flags,
+			       FuEngineInstallStep step,
+			       GError **error)
+{
+	guint retries = 0;
+	g_autoptr(FuDevice) device_tmp = NULL;
+
 	/* plugins can set FWUPD_DEVICE_FLAG_ANOTHER_WRITE_REQUIRED to run again, but they
 	 * must return TRUE rather than an error */
-	device_id = g_strdup (fu_device_get_id (device));
 	do {
-		g_autoptr(FuDevice) device_tmp = NULL;
-
 		/* check for a loop */
 		if (++retries > 5) {
 			g_set_error_literal (error,
@@ -2817,30 +3687,25 @@ fu_engine_install_blob (FuEngine *self,
 			return FALSE;
 		}
 
-		/* signal to all the plugins the update is about to happen */
-		if (!fu_engine_update_prepare (self, flags, device_id, error))
-			return FALSE;
-
-		/* detach to bootloader mode */
-		if (!fu_engine_update_detach (self, device_id, error))
-			return FALSE;
-
-		/* install */
-		if (!fu_engine_update (self, device_id, blob_fw, flags, error))
-			return FALSE;
-
-		/* attach into runtime mode */
-		if (!fu_engine_update_attach (self, device_id, error))
-			return FALSE;
+		for (; step < FU_ENGINE_INSTALL_STEP_LAST; step++) {
+			if (!fu_engine_install_blob_step (self, device_id, blob_fw,
+							  flags, step, error)) {
+				fu_engine_install_blob_failed (self, device_id, flags, step);
+				return FALSE;
+			}
+		}
 
 		/* the device and plugin both may have changed */
+		g_clear_object (&device_tmp);
 		device_tmp = fu_engine_get_device (self, device_id, error);
 		if (device_tmp == NULL)
 			return FALSE;
-		if (!fu_device_has_flag (device_tmp, FWUPD_DEVICE_FLAG_ANOTHER_WRITE_REQUIRED))
-			break;
+		step = FU_ENGINE_INSTALL_STEP_PREPARE;
+	} while (fu_device_has_flag (device_tmp, FWUPD_DEVICE_FLAG_ANOTHER_WRITE_REQUIRED));
 
-	} while (TRUE);
+	/* update the history database for the device */
+	if (!fu_engine_update_history (self, device_tmp, error))
+		return FALSE;
 
 	/* get the new version number */
 	if (!fu_engine_update_reload (self, device_id, error))
@@ -2852,6 +3717,28 @@ fu_engine_install_blob (FuEngine *self,
 
 	/* make the UI update */
 	fu_engine_set_status (self, FWUPD_STATUS_IDLE);
+	return TRUE;
+}
+
+gboolean
+fu_engine_install_blob (FuEngine *self,
+			FuDevice *device,
+			GBytes *blob_fw,
+			FwupdInstallFlags flags,
+			GError **error)
+{
+	g_autofree gchar *device_id = g_strdup (fu_device_get_id (device));
+	g_autoptr(GTimer) timer = g_timer_new ();
+
+	if (!fu_engine_install_blob_start (self, device, blob_fw, error))
+		return FALSE;
+	if (!fu_engine_install_blob_resume (self,
+					    device_id,
+					    blob_fw,
+					    flags,
+					    FU_ENGINE_INSTALL_STEP_PREPARE,
+					    error))
+		return FALSE;
 	g_debug ("Updating %s took %f seconds", fu_device_get_name (device),
 		 g_timer_elapsed (timer, NULL));
 	return TRUE;
@@ -2918,7 +3805,20 @@ fu_engine_set_silo (FuEngine *self, XbSilo *silo)
 {
 	g_return_if_fail (FU_IS_ENGINE (self));
 	g_return_if_fail (XB_IS_SILO (silo));
-	g_set_object (&self->silo, silo);
+	fu_engine_component_index_invalidate (self);
+	g_hash_table_remove_all (self->silo_shards);
+	g_ptr_array_set_size (self->silos, 0);
+	g_ptr_array_add (self->silos, g_object_ref (silo));
+	fu_engine_releases_cache_invalidate (self);
+}
+
+/* for the self tests */
+void
+fu_engine_set_install_threads_max (FuEngine *self, guint install_threads_max)
+{
+	g_return_if_fail (FU_IS_ENGINE (self));
+	g_return_if_fail (install_threads_max > 0);
+	self->install_threads_max = install_threads_max;
 }
 
 static gboolean
@@ -3230,19 +4130,21 @@ fu_engine_md_refresh_devices (FuEngine *self)
 	}
 }
 
-static gboolean
-fu_engine_load_metadata_store (FuEngine *self, FuEngineLoadFlags flags, GError **error)
+static XbSilo *
+fu_engine_load_metadata_shard (FuEngine *self,
+			       FwupdRemote *remote,
+			       FuEngineLoadFlags flags,
+			       GError **error)
 {
-	GPtrArray *remotes;
+	const gchar *path = fwupd_remote_get_filename_cache (remote);
 	XbBuilderCompileFlags compile_flags = XB_BUILDER_COMPILE_FLAG_IGNORE_INVALID;
+	g_autofree gchar *basename = NULL;
 	g_autofree gchar *cachedirpkg = NULL;
 	g_autofree gchar *xmlbfn = NULL;
+	g_autoptr(GError) error_local = NULL;
 	g_autoptr(GFile) xmlb = NULL;
-	g_autoptr(GPtrArray) components = NULL;
 	g_autoptr(XbBuilder) builder = xb_builder_new ();
-
-	/* clear existing silo */
-	g_clear_object (&self->silo);
+	g_autoptr(XbSilo) silo = NULL;
 
 	/* verbose profiling */
 	if (g_getenv ("FWUPD_XMLB_VERBOSE") != NULL) {
@@ -3251,44 +4153,35 @@ fu_engine_load_metadata_store (FuEngine *self, FuEngineLoadFlags flags, GError *
 					      XB_SILO_PROFILE_FLAG_DEBUG);
 	}
 
-	/* load each enabled metadata file */
-	remotes = fu_remote_list_get_all (self->remote_list);
-	for (guint i = 0; i < remotes->len; i++) {
-		const gchar *path = NULL;
-		g_autoptr(GError) error_local = NULL;
-		g_autoptr(GFile) file = NULL;
+	/* generate all metadata on demand */
+	if (fwupd_remote_get_kind (remote) == FWUPD_REMOTE_KIND_DIRECTORY) {
+		g_debug ("building metadata for remote '%s'",
+			 fwupd_remote_get_id (remote));
+		if (!fu_engine_create_metadata (self, builder, remote, &error_local)) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "failed to generate remote %s: %s",
+				     fwupd_remote_get_id (remote),
+				     error_local->message);
+			return NULL;
+		}
+	} else {
+		g_autoptr(GFile) file = g_file_new_for_path (path);
 		g_autoptr(XbBuilderFixup) fixup = NULL;
 		g_autoptr(XbBuilderNode) custom = NULL;
 		g_autoptr(XbBuilderSource) source = xb_builder_source_new ();
 
-		FwupdRemote *remote = g_ptr_array_index (remotes, i);
-		if (!fwupd_remote_get_enabled (remote))
-			continue;
-		path = fwupd_remote_get_filename_cache (remote);
-		if (!g_file_test (path, G_FILE_TEST_EXISTS))
-			continue;
-
-		/* generate all metadata on demand */
-		if (fwupd_remote_get_kind (remote) == FWUPD_REMOTE_KIND_DIRECTORY) {
-			g_debug ("building metadata for remote '%s'",
-				 fwupd_remote_get_id (remote));
-			if (!fu_engine_create_metadata (self, builder, remote, &error_local)) {
-				g_warning ("failed to generate remote %s: %s",
-					   fwupd_remote_get_id (remote),
-					   error_local->message);
-			}
-			continue;
-		}
-
-		/* save the remote-id in the custom metadata space */
-		file = g_file_new_for_path (path);
 		if (!xb_builder_source_load_file (source, file,
 						  XB_BUILDER_SOURCE_FLAG_NONE,
 						  NULL, &error_local)) {
-			g_warning ("failed to load remote %s: %s",
-				   fwupd_remote_get_id (remote),
-				   error_local->message);
-			continue;
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "failed to load remote %s: %s",
+				     fwupd_remote_get_id (remote),
+				     error_local->message);
+			return NULL;
 		}
 
 		/* fix up any legacy installed files */
@@ -3298,7 +4191,7 @@ fu_engine_load_metadata_store (FuEngine *self, FuEngineLoadFlags flags, GError *
 		xb_builder_fixup_set_max_depth (fixup, 3);
 		xb_builder_source_add_fixup (source, fixup);
 
-		/* add metadata */
+		/* save the remote-id in the custom metadata space */
 		custom = xb_builder_node_new ("custom");
 		xb_builder_node_insert_text (custom,
 					     "value", path,
@@ -3309,8 +4202,6 @@ fu_engine_load_metadata_store (FuEngine *self, FuEngineLoadFlags flags, GError *
 					     "key", "fwupd::RemoteId",
 					     NULL);
 		xb_builder_source_set_info (source, custom);
-
-		/* we need to watch for changes? */
 		xb_builder_import_source (builder, source);
 	}
 
@@ -3318,28 +4209,138 @@ fu_engine_load_metadata_store (FuEngine *self, FuEngineLoadFlags flags, GError *
 	if (flags & FU_ENGINE_LOAD_FLAG_READONLY_FS)
 		compile_flags |= XB_BUILDER_COMPILE_FLAG_IGNORE_GUID;
 
-	/* ensure silo is up to date */
+	/* the shard is only recompiled if the remote metadata has changed */
 	cachedirpkg = fu_common_get_path (FU_PATH_KIND_CACHEDIR_PKG);
-	xmlbfn = g_build_filename (cachedirpkg, "metadata.xmlb", NULL);
+	basename = g_strdup_printf ("metadata-%s.xmlb", fwupd_remote_get_id (remote));
+	xmlbfn = g_build_filename (cachedirpkg, basename, NULL);
 	xmlb = g_file_new_for_path (xmlbfn);
-	self->silo = xb_builder_ensure (builder, xmlb, compile_flags, NULL, error);
-	if (self->silo == NULL)
-		return FALSE;
-
-	/* print what we've got */
-	components = xb_silo_query (self->silo, "components/component", 0, NULL);
-	if (components != NULL)
-		g_debug ("%u components now in silo", components->len);
+	silo = xb_builder_ensure (builder, xmlb, compile_flags, NULL, error);
+	if (silo == NULL)
+		return NULL;
 
 	/* build the index */
-	if (!xb_silo_query_build_index (self->silo,
+	if (!xb_silo_query_build_index (silo,
 					"components/component/provides/firmware",
 					"type", error))
-		return FALSE;
-	if (!xb_silo_query_build_index (self->silo,
+		return NULL;
+	if (!xb_silo_query_build_index (silo,
 					"components/component/provides/firmware",
 					NULL, error))
-		return FALSE;
+		return NULL;
+
+	/* success */
+	return g_steal_pointer (&silo);
+}
+
+/* the size and modification time of the metadata file, or of every file in
+ * the directory for directory remotes, so that new or changed archives are
+ * picked up without a refresh */
+static gchar *
+fu_engine_remote_get_shard_stamp (FwupdRemote *remote)
+{
+	const gchar *path = fwupd_remote_get_filename_cache (remote);
+	GString *str = g_string_new (NULL);
+	g_autoptr(GPtrArray) files = NULL;
+
+	if (fwupd_remote_get_kind (remote) == FWUPD_REMOTE_KIND_DIRECTORY) {
+		files = fu_common_get_files_recursive (path, NULL);
+	} else {
+		files = g_ptr_array_new_with_free_func (g_free);
+		g_ptr_array_add (files, g_strdup (path));
+	}
+	for (guint i = 0; files != NULL && i < files->len; i++) {
+		const gchar *fn = g_ptr_array_index (files, i);
+		GStatBuf statbuf = { 0 };
+		if (g_stat (fn, &statbuf) != 0)
+			continue;
+		g_string_append_printf (str, "%s:%" G_GINT64_FORMAT ":%" G_GINT64_FORMAT "\n",
+					fn,
+					(gint64) statbuf.st_size,
+					(gint64) statbuf.st_mtime);
+	}
+	return g_string_free (str, FALSE);
+}
+
+static gboolean
+fu_engine_load_metadata_store (FuEngine *self, FuEngineLoadFlags flags, GError **error)
+{
+	GPtrArray *remotes;
+	guint components_cnt = 0;
+	g_autoptr(GHashTable) silo_shards = NULL;
+	g_autoptr(GHashTable) silo_shard_stamps = NULL;
+
+	/* clear existing silos, but keep any shards still valid */
+	fu_engine_component_index_invalidate (self);
+	g_ptr_array_set_size (self->silos, 0);
+	fu_engine_releases_cache_invalidate (self);
+	silo_shards = g_hash_table_new_full (g_str_hash, g_str_equal,
+					     g_free, (GDestroyNotify) g_object_unref);
+	silo_shard_stamps = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+	/* load each enabled metadata file */
+	remotes = fu_remote_list_get_all (self->remote_list);
+	for (guint i = 0; i < remotes->len; i++) {
+		FwupdRemote *remote = g_ptr_array_index (remotes, i);
+		const gchar *remote_id = fwupd_remote_get_id (remote);
+		g_autofree gchar *stamp = NULL;
+		g_autoptr(GError) error_local = NULL;
+		g_autoptr(GPtrArray) components = NULL;
+		g_autoptr(XbSilo) silo = NULL;
+
+		if (!fwupd_remote_get_enabled (remote))
+			continue;
+		if (!g_file_test (fwupd_remote_get_filename_cache (remote),
+				  G_FILE_TEST_EXISTS))
+			continue;
+
+		/* reuse the shard if the remote has not been refreshed or
+		 * changed on disk */
+		stamp = fu_engine_remote_get_shard_stamp (remote);
+		silo = g_hash_table_lookup (self->silo_shards, remote_id);
+		if (silo != NULL &&
+		    g_strcmp0 (g_hash_table_lookup (self->silo_shard_stamps, remote_id), stamp) != 0) {
+			g_debug ("remote %s changed on disk", remote_id);
+			silo = NULL;
+		}
+		if (silo != NULL) {
+			g_object_ref (silo);
+		} else {
+			silo = fu_engine_load_metadata_shard (self, remote, flags, &error_local);
+			if (silo == NULL) {
+				if (g_error_matches (error_local,
+						     FWUPD_ERROR,
+						     FWUPD_ERROR_INVALID_FILE)) {
+					g_warning ("%s", error_local->message);
+					continue;
+				}
+				g_propagate_error (error, g_steal_pointer (&error_local));
+				return FALSE;
+			}
+		}
+
+		/* print what we've got */
+		components = xb_silo_query (silo, "components/component", 0, NULL);
+		if (components != NULL)
+			components_cnt += components->len;
+		g_ptr_array_add (self->silos, g_object_ref (silo));
+		g_hash_table_insert (silo_shards, g_strdup (remote_id), g_steal_pointer (&silo));
+		g_hash_table_insert (silo_shard_stamps, g_strdup (remote_id), g_steal_pointer (&stamp));
+	}
+	g_debug ("%u components now in %u silos", components_cnt, self->silos->len);
+
+	/* shards for disabled or removed remotes are dropped */
+	g_hash_table_unref (self->silo_shards);
+	self->silo_shards = g_steal_pointer (&silo_shards);
+	g_hash_table_unref (self->silo_shard_stamps);
+	self->silo_shard_stamps = g_steal_pointer (&silo_shard_stamps);
+
+	/* the combined metadata.xmlb has been split into shards */
+	if ((flags & FU_ENGINE_LOAD_FLAG_READONLY_FS) == 0) {
+		g_autofree gchar *cachedirpkg = fu_common_get_path (FU_PATH_KIND_CACHEDIR_PKG);
+		g_autofree gchar *xmlbfn = g_build_filename (cachedirpkg, "metadata.xmlb", NULL);
+		if (g_file_test (xmlbfn, G_FILE_TEST_EXISTS) && g_unlink (xmlbfn) != 0)
+			g_debug ("failed to delete %s", xmlbfn);
+	}
 
 	/* success */
 	return TRUE;
@@ -3349,12 +4350,16 @@ static void
 fu_engine_config_changed_cb (FuConfig *config, FuEngine *self)
 {
 	fu_idle_set_timeout (self->idle, fu_config_get_idle_timeout (config));
+	fu_engine_releases_cache_invalidate (self);
 }
 
 static void
 fu_engine_remote_list_changed_cb (FuRemoteList *remote_list, FuEngine *self)
 {
 	g_autoptr(GError) error_local = NULL;
+
+	/* the remote filenames or kinds may have changed */
+	g_hash_table_remove_all (self->silo_shards);
 	if (!fu_engine_load_metadata_store (self, FU_ENGINE_LOAD_FLAG_NONE,
 					    &error_local))
 		g_warning ("Failed to reload metadata store: %s",
@@ -3508,6 +4513,10 @@ fu_engine_update_metadata_bytes (FuEngine *self, const gchar *remote_id,
 	g_return_val_if_fail (bytes_sig != NULL, FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
+	/* the silo is in use by the install */
+	if (!fu_engine_check_not_installing (self, error))
+		return FALSE;
+
 	/* check remote is valid */
 	remote = fu_remote_list_get_by_id (self->remote_list, remote_id);
 	if (remote == NULL) {
@@ -3590,6 +4599,9 @@ fu_engine_update_metadata_bytes (FuEngine *self, const gchar *remote_id,
 						   bytes_sig, error))
 			return FALSE;
 	}
+
+	/* only the shard for this remote needs rebuilding */
+	g_hash_table_remove (self->silo_shards, remote_id);
 	if (!fu_engine_load_metadata_store (self, FU_ENGINE_LOAD_FLAG_NONE, error))
 		return FALSE;
 
@@ -3849,6 +4861,7 @@ fu_engine_get_details (FuEngine *self, FuEngineRequest *request, gint fd, GError
 	g_autoptr(GError) error_local = NULL;
 	g_autoptr(GPtrArray) components = NULL;
 	g_autoptr(GPtrArray) details = NULL;
+	g_autoptr(XbNode) csum_node = NULL;
 	g_autoptr(XbSilo) silo = NULL;
 
 	g_return_val_if_fail (FU_IS_ENGINE (self), NULL);
@@ -3882,8 +4895,16 @@ fu_engine_get_details (FuEngine *self, FuEngineRequest *request, gint fd, GError
 					NULL, error))
 		return NULL;
 
-	/* does this exist in any enabled remote */
-	csum = g_compute_checksum_for_bytes (G_CHECKSUM_SHA1, blob);
+	/* does this exist in any enabled remote, reusing the container
+	 * checksum that FuCabinet already computed */
+	csum_node = xb_silo_query_first (silo,
+					 "components/component/releases/release/"
+					 "checksum[@target='container']",
+					 NULL);
+	if (csum_node != NULL)
+		csum = g_strdup (xb_node_get_text (csum_node));
+	if (csum == NULL)
+		csum = g_compute_checksum_for_bytes (G_CHECKSUM_SHA1, blob);
 	remote_id = fu_engine_get_remote_id_for_checksum (self, csum);
 
 	/* create results with all the metadata in */
@@ -4366,20 +5387,17 @@ fu_engine_get_branch_fallback (const gchar *nullable_branch)
 	return nullable_branch;
 }
 
-GPtrArray *
-fu_engine_get_releases_for_device (FuEngine *self,
-				   FuEngineRequest *request,
-				   FuDevice *device,
-				   GError **error)
+static GPtrArray *
+fu_engine_get_releases_for_device_uncached (FuEngine *self,
+					    FuEngineRequest *request,
+					    FuDevice *device,
+					    GError **error)
 {
-	GPtrArray *device_guids;
 	GPtrArray *releases;
 	const gchar *version;
 	g_autoptr(GError) error_all = NULL;
-	g_autoptr(GError) error_local = NULL;
 	g_autoptr(GPtrArray) branches = NULL;
 	g_autoptr(GPtrArray) components = NULL;
-	g_autoptr(GString) xpath = g_string_new (NULL);
 
 	/* get device version */
 	version = fu_device_get_version (device);
@@ -4401,25 +5419,12 @@ fu_engine_get_releases_for_device (FuEngine *self,
 	}
 
 	/* get all the components that provide any of these GUIDs */
-	device_guids = fu_device_get_guids (device);
-	for (guint i = 0; i < device_guids->len; i++) {
-		const gchar *guid = g_ptr_array_index (device_guids, i);
-		xb_string_append_union (xpath,
-					"components/component/"
-					"provides/firmware[@type=$'flashed'][text()=$'%s']/"
-					"../..", guid);
-	}
-	components = xb_silo_query (self->silo, xpath->str, 0, &error_local);
-	if (components == NULL) {
-		if (g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) ||
-		    g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT)) {
-			g_set_error_literal (error,
-					     FWUPD_ERROR,
-					     FWUPD_ERROR_NOTHING_TO_DO,
-					     "No releases found");
-			return NULL;
-		}
-		g_propagate_error (error, g_steal_pointer (&error_local));
+	components = fu_engine_get_components_for_device (self, device);
+	if (components->len == 0) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_NOTHING_TO_DO,
+				     "No releases found");
 		return NULL;
 	}
 
@@ -4475,6 +5480,102 @@ fu_engine_get_releases_for_device (FuEngine *self,
 	return releases;
 }
 
+static void
+fu_engine_releases_cache_item_free (FuEngineReleasesCacheItem *item)
+{
+	g_free (item->version);
+	g_free (item->version_lowest);
+	g_free (item->branch);
+	if (item->releases != NULL)
+		g_ptr_array_unref (item->releases);
+	if (item->error != NULL)
+		g_error_free (item->error);
+	g_free (item);
+}
+
+/* the device may have changed since the releases were cached */
+static gboolean
+fu_engine_releases_cache_item_is_valid (FuEngineReleasesCacheItem *item,
+					FuDevice *device)
+{
+	if (item->device != device)
+		return FALSE;
+	if (item->flags != fu_device_get_flags (device))
+		return FALSE;
+	if (item->guids_len != fu_device_get_guids (device)->len)
+		return FALSE;
+	if (g_strcmp0 (item->version, fu_device_get_version (device)) != 0)
+		return FALSE;
+	if (g_strcmp0 (item->version_lowest, fu_device_get_version_lowest (device)) != 0)
+		return FALSE;
+	if (g_strcmp0 (item->branch, fu_device_get_branch (device)) != 0)
+		return FALSE;
+	return TRUE;
+}
+
+/* returns a new container, as callers are free to sort the array */
+static GPtrArray *
+fu_engine_releases_cache_item_get_releases (FuEngineReleasesCacheItem *item,
+					    GError **error)
+{
+	GPtrArray *releases;
+	if (item->error != NULL) {
+		if (error != NULL)
+			*error = g_error_copy (item->error);
+		return NULL;
+	}
+	releases = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	for (guint i = 0; i < item->releases->len; i++) {
+		FwupdRelease *rel = g_ptr_array_index (item->releases, i);
+		g_ptr_array_add (releases, g_object_ref (rel));
+	}
+	return releases;
+}
+
+GPtrArray *
+fu_engine_get_releases_for_device (FuEngine *self,
+				   FuEngineRequest *request,
+				   FuDevice *device,
+				   GError **error)
+{
+	FuEngineReleasesCacheItem *item;
+	g_autofree gchar *key = NULL;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GPtrArray) releases = NULL;
+
+	/* not added to the engine */
+	if (fu_device_get_id (device) == NULL)
+		return fu_engine_get_releases_for_device_uncached (self, request, device, error);
+
+	/* the release flags depend on what the client supports */
+	key = g_strdup_printf ("%s:%" G_GUINT64_FORMAT ":%" G_GUINT64_FORMAT,
+			       fu_device_get_id (device),
+			       (guint64) fu_engine_request_get_feature_flags (request),
+			       (guint64) fu_engine_request_get_device_flags (request));
+	item = g_hash_table_lookup (self->releases_cache, key);
+	if (item != NULL && fu_engine_releases_cache_item_is_valid (item, device))
+		return fu_engine_releases_cache_item_get_releases (item, error);
+
+	/* this may set HAS_MULTIPLE_BRANCHES, so snapshot the device after */
+	releases = fu_engine_get_releases_for_device_uncached (self,
+							       request,
+							       device,
+							       &error_local);
+	item = g_new0 (FuEngineReleasesCacheItem, 1);
+	item->device = device;
+	item->version = g_strdup (fu_device_get_version (device));
+	item->version_lowest = g_strdup (fu_device_get_version_lowest (device));
+	item->branch = g_strdup (fu_device_get_branch (device));
+	item->flags = fu_device_get_flags (device);
+	item->guids_len = fu_device_get_guids (device)->len;
+	if (releases != NULL)
+		item->releases = g_steal_pointer (&releases);
+	else
+		item->error = g_steal_pointer (&error_local);
+	g_hash_table_replace (self->releases_cache, g_steal_pointer (&key), item);
+	return fu_engine_releases_cache_item_get_releases (item, error);
+}
+
 /**
  * fu_engine_get_releases:
  * @self: A #FuEngine
@@ -4647,6 +5748,7 @@ fu_engine_add_approved_firmware (FuEngine *self, const gchar *checksum)
 								 NULL);
 	}
 	g_hash_table_add (self->approved_firmware, g_strdup (checksum));
+	fu_engine_releases_cache_invalidate (self);
 }
 
 GPtrArray *
@@ -4673,28 +5775,44 @@ fu_engine_add_blocked_firmware (FuEngine *self, const gchar *checksum)
 								NULL);
 	}
 	g_hash_table_add (self->blocked_firmware, g_strdup (checksum));
+	fu_engine_releases_cache_invalidate (self);
 }
 
 gboolean
 fu_engine_set_blocked_firmware (FuEngine *self, GPtrArray *checksums, GError **error)
 {
+	/* the history database is in use by the install */
+	if (!fu_engine_check_not_installing (self, error))
+		return FALSE;
+
 	/* update in-memory hash */
 	if (self->blocked_firmware != NULL) {
 		g_hash_table_unref (self->blocked_firmware);
 		self->blocked_firmware = NULL;
 	}
+	fu_engine_releases_cache_invalidate (self);
 	for (guint i = 0; i < checksums->len; i++) {
 		const gchar *csum = g_ptr_array_index (checksums, i);
 		fu_engine_add_blocked_firmware (self, csum);
 	}
 
 	/* save database */
-	if (!fu_history_clear_blocked_firmware (self->history, error))
+	if (!fu_history_start_transaction (self->history, error))
+		return FALSE;
+	if (!fu_history_clear_blocked_firmware (self->history, error)) {
+		fu_history_rollback_transaction (self->history);
 		return FALSE;
+	}
 	for (guint i = 0; i < checksums->len; i++) {
 		const gchar *csum = g_ptr_array_index (checksums, i);
-		if (!fu_history_add_blocked_firmware (self->history, csum, error))
+		if (!fu_history_add_blocked_firmware (self->history, csum, error)) {
+			fu_history_rollback_transaction (self->history);
 			return FALSE;
+		}
+	}
+	if (!fu_history_commit_transaction (self->history, error)) {
+		fu_history_rollback_transaction (self->history);
+		return FALSE;
 	}
 	return TRUE;
 }
@@ -4841,6 +5959,88 @@ fu_engine_get_upgrades (FuEngine *self,
 	return g_steal_pointer (&releases);
 }
 
+typedef GPtrArray	*(*FuEngineGetReleasesFunc)	(FuEngine	*self,
+							 FuEngineRequest *request,
+							 const gchar	*device_id,
+							 GError		**error);
+
+static GHashTable *
+fu_engine_get_releases_all_by_func (FuEngine *self,
+				    FuEngineRequest *request,
+				    FuEngineGetReleasesFunc func,
+				    GError **error)
+{
+	g_autoptr(GHashTable) results = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+
+	g_return_val_if_fail (FU_IS_ENGINE (self), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	devices = fu_engine_get_devices (self, error);
+	if (devices == NULL)
+		return NULL;
+	results = g_hash_table_new_full (g_str_hash, g_str_equal,
+					 g_free, (GDestroyNotify) g_ptr_array_unref);
+	for (guint i = 0; i < devices->len; i++) {
+		FuDevice *device = g_ptr_array_index (devices, i);
+		g_autoptr(GError) error_local = NULL;
+		g_autoptr(GPtrArray) releases = NULL;
+
+		/* not going to have results */
+		if (!fu_device_has_flag (device, FWUPD_DEVICE_FLAG_UPDATABLE))
+			continue;
+		releases = func (self, request, fu_device_get_id (device), &error_local);
+		if (releases == NULL) {
+			g_debug ("ignoring %s: %s",
+				 fu_device_get_id (device),
+				 error_local->message);
+			continue;
+		}
+		g_hash_table_insert (results,
+				     g_strdup (fu_device_get_id (device)),
+				     g_steal_pointer (&releases));
+	}
+	return g_steal_pointer (&results);
+}
+
+/**
+ * fu_engine_get_releases_all:
+ * @self: A #FuEngine
+ * @request: A #FuEngineRequest
+ * @error: A #GError, or %NULL
+ *
+ * Gets the releases available for all devices. Devices without any
+ * releases are not included.
+ *
+ * Returns: (transfer container) (element-type utf8 GPtrArray): device-id:releases
+ **/
+GHashTable *
+fu_engine_get_releases_all (FuEngine *self, FuEngineRequest *request, GError **error)
+{
+	return fu_engine_get_releases_all_by_func (self, request,
+						   fu_engine_get_releases,
+						   error);
+}
+
+/**
+ * fu_engine_get_upgrades_all:
+ * @self: A #FuEngine
+ * @request: A #FuEngineRequest
+ * @error: A #GError, or %NULL
+ *
+ * Gets the upgrades available for all devices. Devices without any
+ * upgrades are not included.
+ *
+ * Returns: (transfer container) (element-type utf8 GPtrArray): device-id:releases
+ **/
+GHashTable *
+fu_engine_get_upgrades_all (FuEngine *self, FuEngineRequest *request, GError **error)
+{
+	return fu_engine_get_releases_all_by_func (self, request,
+						   fu_engine_get_upgrades,
+						   error);
+}
+
 /**
  * fu_engine_clear_results:
  * @self: A #FuEngine
@@ -4947,10 +6147,97 @@ fu_engine_plugins_setup (FuEngine *self)
 	}
 }
 
+typedef struct {
+	FuEngine		*self;
+	FuPlugin		*plugin;
+	GError			*error;
+} FuEngineColdplugHelper;
+
+static void
+fu_engine_coldplug_helper_free (FuEngineColdplugHelper *helper)
+{
+	g_object_unref (helper->plugin);
+	if (helper->error != NULL)
+		g_error_free (helper->error);
+	g_free (helper);
+}
+
+static gboolean
+fu_engine_plugin_coldplug (FuPlugin *plugin, gboolean is_recoldplug, GError **error)
+{
+	if (is_recoldplug)
+		return fu_plugin_runner_recoldplug (plugin, error);
+	return fu_plugin_runner_coldplug (plugin, error);
+}
+
+static void
+fu_engine_plugin_coldplug_failed (FuPlugin *plugin, gboolean is_recoldplug, const GError *error)
+{
+	if (is_recoldplug) {
+		g_message ("failed recoldplug: %s", error->message);
+		return;
+	}
+	fu_plugin_add_flag (plugin, FWUPD_PLUGIN_FLAG_DISABLED);
+	g_message ("disabling plugin because: %s", error->message);
+}
+
+static gboolean
+fu_engine_plugins_coldplug_done_cb (gpointer user_data)
+{
+	FuEngineColdplugHelper *helper = (FuEngineColdplugHelper *) user_data;
+	if (helper->error != NULL)
+		fu_engine_plugin_coldplug_failed (helper->plugin, FALSE, helper->error);
+	helper->self->coldplug_pending--;
+	return G_SOURCE_REMOVE;
+}
+
+static void
+fu_engine_plugins_coldplug_thread_cb (gpointer data, gpointer user_data)
+{
+	FuEngineColdplugHelper *helper = (FuEngineColdplugHelper *) data;
+	g_autoptr(GSource) source = g_idle_source_new ();
+
+	/* any signals emitted by the plugin are proxied to the main thread */
+	fu_plugin_runner_coldplug (helper->plugin, &helper->error);
+
+	/* process the result in the main thread */
+	g_source_set_callback (source,
+			       fu_engine_plugins_coldplug_done_cb,
+			       helper,
+			       (GDestroyNotify) fu_engine_coldplug_helper_free);
+	g_source_attach (source, helper->self->main_ctx);
+}
+
+static GThreadPool *
+fu_engine_plugins_coldplug_pool_new (FuEngine *self, GPtrArray *plugins)
+{
+	g_autoptr(GError) error = NULL;
+	GThreadPool *pool;
+
+	/* only create threads if any plugin opted in */
+	for (guint i = 0; i < plugins->len; i++) {
+		FuPlugin *plugin = g_ptr_array_index (plugins, i);
+		if (!fu_plugin_has_rule (plugin, FU_PLUGIN_RULE_THREAD_SAFE, "coldplug"))
+			continue;
+		pool = g_thread_pool_new (fu_engine_plugins_coldplug_thread_cb,
+					  self,
+					  FU_ENGINE_COLDPLUG_THREADS_MAX,
+					  FALSE,
+					  &error);
+		if (pool == NULL) {
+			g_warning ("failed to create coldplug threads: %s",
+				   error->message);
+		}
+		return pool;
+	}
+	return NULL;
+}
+
 static void
 fu_engine_plugins_coldplug (FuEngine *self, gboolean is_recoldplug)
 {
 	GPtrArray *plugins;
+	GThreadPool *pool = NULL;
 	g_autoptr(GString) str = g_string_new (NULL);
 
 	/* don't allow coldplug to be scheduled when in coldplug */
@@ -4971,21 +6258,45 @@ fu_engine_plugins_coldplug (FuEngine *self, gboolean is_recoldplug)
 		g_usleep (self->coldplug_delay * 1000);
 	}
 
-	/* exec */
-	for (guint i = 0; i < plugins->len; i++) {
-		g_autoptr(GError) error = NULL;
-		FuPlugin *plugin = g_ptr_array_index (plugins, i);
-		if (is_recoldplug) {
-			if (!fu_plugin_runner_recoldplug (plugin, &error))
-				g_message ("failed recoldplug: %s", error->message);
-		} else {
-			if (!fu_plugin_runner_coldplug (plugin, &error)) {
-				fu_plugin_add_flag (plugin, FWUPD_PLUGIN_FLAG_DISABLED);
-				g_message ("disabling plugin because: %s",
+	/* exec, where plugins with the same depsolved order have no ordering
+	 * constraints between them and can be run at the same time if safe --
+	 * this is only done when loading, as the main context is iterated
+	 * while waiting and a recoldplug would otherwise handle requests and
+	 * uevents with only some of the plugins done */
+	if (!is_recoldplug)
+		pool = fu_engine_plugins_coldplug_pool_new (self, plugins);
+	for (guint i = 0; i < plugins->len;) {
+		guint order = fu_plugin_get_order (g_ptr_array_index (plugins, i));
+		for (; i < plugins->len; i++) {
+			FuPlugin *plugin = g_ptr_array_index (plugins, i);
+			g_autoptr(GError) error = NULL;
+			if (fu_plugin_get_order (plugin) != order)
+				break;
+			if (pool != NULL &&
+			    fu_plugin_has_rule (plugin, FU_PLUGIN_RULE_THREAD_SAFE, "coldplug")) {
+				FuEngineColdplugHelper *helper = g_new0 (FuEngineColdplugHelper, 1);
+				helper->self = self;
+				helper->plugin = g_object_ref (plugin);
+				if (g_thread_pool_push (pool, helper, &error)) {
+					self->coldplug_pending++;
+					continue;
+				}
+				g_warning ("failed to coldplug %s in thread: %s",
+					   fu_plugin_get_name (plugin),
 					   error->message);
+				g_clear_error (&error);
+				fu_engine_coldplug_helper_free (helper);
 			}
+			if (!fu_engine_plugin_coldplug (plugin, is_recoldplug, &error))
+				fu_engine_plugin_coldplug_failed (plugin, is_recoldplug, error);
 		}
+
+		/* wait for the threaded plugins before the next order */
+		while (self->coldplug_pending > 0)
+			g_main_context_iteration (self->main_ctx, TRUE);
 	}
+	if (pool != NULL)
+		g_thread_pool_free (pool, FALSE, TRUE);
 
 	/* cleanup */
 	for (guint i = 0; i < plugins->len; i++) {
@@ -5020,7 +6331,8 @@ fu_engine_plugin_device_register (FuEngine *self, FuDevice *device)
 			   fu_device_get_id (device));
 		return;
 	}
-	plugins = fu_plugin_list_get_all (self->plugin_list);
+	plugins = fu_plugin_list_get_all_by_vfunc (self->plugin_list,
+						   FU_PLUGIN_VFUNC_DEVICE_REGISTERED);
 	for (guint i = 0; i < plugins->len; i++) {
 		FuPlugin *plugin = g_ptr_array_index (plugins, i);
 		fu_plugin_runner_device_register (plugin, device);
@@ -5330,69 +6642,501 @@ fu_engine_plugin_rules_changed_cb (FuPlugin *plugin, gpointer user_data)
 }
 
 static void
-fu_engine_plugin_security_changed_cb (FuPlugin *plugin, gpointer user_data)
+fu_engine_plugin_security_changed_cb (FuPlugin *plugin, gpointer user_data)
+{
+	FuEngine *self = FU_ENGINE (user_data);
+
+	/* only this plugin needs to be queried again */
+	fu_engine_security_attrs_invalidate (self, fu_plugin_get_name (plugin));
+
+	/* make UI refresh */
+	fu_engine_emit_changed (self);
+}
+
+static void
+fu_engine_plugin_device_removed_cb (FuPlugin *plugin,
+				    FuDevice *device,
+				    gpointer user_data)
+{
+	FuEngine *self = (FuEngine *) user_data;
+	FuPlugin *plugin_old;
+	g_autoptr(FuDevice) device_tmp = NULL;
+	g_autoptr(GError) error = NULL;
+
+	device_tmp = fu_device_list_get_by_id (self->device_list,
+					       fu_device_get_id (device),
+					       &error);
+	if (device_tmp == NULL) {
+		g_debug ("failed to find device %s: %s",
+			 fu_device_get_id (device),
+			 error->message);
+		return;
+	}
+
+	/* get the plugin */
+	plugin_old = fu_plugin_list_find_by_name (self->plugin_list,
+						  fu_device_get_plugin (device),
+						  &error);
+	if (plugin_old == NULL) {
+		g_debug ("failed to find plugin %s: %s",
+			 fu_device_get_plugin (device),
+			 error->message);
+		return;
+	}
+
+	/* check this came from the same plugin */
+	if (g_strcmp0 (fu_plugin_get_name (plugin),
+		       fu_plugin_get_name (plugin_old)) != 0) {
+		g_debug ("ignoring duplicate removal from %s",
+			 fu_plugin_get_name (plugin));
+		return;
+	}
+
+	/* make the UI update */
+	fu_device_list_remove (self->device_list, device);
+	fu_engine_emit_changed (self);
+}
+
+static gboolean
+fu_engine_recoldplug_delay_cb (gpointer user_data)
+{
+	FuEngine *self = (FuEngine *) user_data;
+	g_debug ("recoldplugging");
+	fu_engine_plugins_coldplug (self, TRUE);
+	self->coldplug_id = 0;
+	return FALSE;
+}
+
+/**
+ * fu_engine_set_emulation:
+ * @self: A #FuEngine
+ * @emulation: A #FuDeviceEmulation, e.g. %FU_DEVICE_EMULATION_RECORD
+ * @emulation_latency: %TRUE to play back events with the recorded latency
+ *
+ * Sets if requests sent to USB and udev devices should be recorded, or played
+ * back from events loaded using fu_engine_emulation_load().
+ *
+ * This has to be called before fu_engine_load().
+ **/
+void
+fu_engine_set_emulation (FuEngine *self,
+			 FuDeviceEmulation emulation,
+			 gboolean emulation_latency)
+{
+	g_return_if_fail (FU_IS_ENGINE (self));
+	self->emulation = emulation;
+	self->emulation_latency = emulation_latency;
+}
+
+/* devices are re-created when replugged, so share the events using the
+ * backend ID that does not change */
+static void
+fu_engine_emulation_setup_device (FuEngine *self, FuDevice *device, const gchar *backend_id)
+{
+	GPtrArray *events;
+
+	if (self->emulation == FU_DEVICE_EMULATION_NONE || backend_id == NULL)
+		return;
+	events = g_hash_table_lookup (self->emulation_events, backend_id);
+	if (events == NULL) {
+		events = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+		g_hash_table_insert (self->emulation_events, g_strdup (backend_id), events);
+	}
+	fu_device_set_emulation (device, self->emulation);
+	fu_device_set_emulation_latency (device, self->emulation_latency);
+	fu_device_set_events (device, events);
+}
+
+/**
+ * fu_engine_emulation_load:
+ * @self: A #FuEngine
+ * @filename: A JSON file previously written using fu_engine_emulation_save()
+ * @error: A #GError, or %NULL
+ *
+ * Loads the events to play back when the devices are added.
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+fu_engine_emulation_load (FuEngine *self, const gchar *filename, GError **error)
+{
+	JsonArray *json_devices;
+	JsonNode *json_node;
+	JsonObject *json_root;
+	g_autoptr(JsonParser) json_parser = json_parser_new ();
+
+	g_return_val_if_fail (FU_IS_ENGINE (self), FALSE);
+	g_return_val_if_fail (filename != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	if (!json_parser_load_from_file (json_parser, filename, error))
+		return FALSE;
+	json_node = json_parser_get_root (json_parser);
+	if (json_node == NULL || !JSON_NODE_HOLDS_OBJECT (json_node)) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "no root object in %s",
+			     filename);
+		return FALSE;
+	}
+	json_root = json_node_get_object (json_node);
+	json_node = json_object_get_member (json_root, "Devices");
+	if (json_node == NULL || !JSON_NODE_HOLDS_ARRAY (json_node)) {
+		g_set_error (error,
+			     FWUPD_ERROR,
+			     FWUPD_ERROR_INVALID_FILE,
+			     "no Devices in %s",
+			     filename);
+		return FALSE;
+	}
+	json_devices = json_node_get_array (json_node);
+	for (guint i = 0; i < json_array_get_length (json_devices); i++) {
+		JsonObject *json_device;
+		JsonArray *json_events;
+		JsonNode *json_backend_id;
+		JsonNode *json_events_node;
+		const gchar *backend_id;
+		g_autoptr(GPtrArray) events = NULL;
+
+		json_node = json_array_get_element (json_devices, i);
+		if (!JSON_NODE_HOLDS_OBJECT (json_node)) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "device %u is not an object", i);
+			return FALSE;
+		}
+		json_device = json_node_get_object (json_node);
+		json_backend_id = json_object_get_member (json_device, "BackendId");
+		json_events_node = json_object_get_member (json_device, "Events");
+		if (json_backend_id == NULL ||
+		    !JSON_NODE_HOLDS_VALUE (json_backend_id) ||
+		    json_node_get_value_type (json_backend_id) != G_TYPE_STRING ||
+		    json_events_node == NULL ||
+		    !JSON_NODE_HOLDS_ARRAY (json_events_node)) {
+			g_set_error (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_FILE,
+				     "device %u has no BackendId or Events", i);
+			return FALSE;
+		}
+		backend_id = json_node_get_string (json_backend_id);
+		events = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+		json_events = json_node_get_array (json_events_node);
+		for (guint j = 0; j < json_array_get_length (json_events); j++) {
+			FuDeviceEvent *event;
+			json_node = json_array_get_element (json_events, j);
+			if (!JSON_NODE_HOLDS_OBJECT (json_node)) {
+				g_set_error (error,
+					     FWUPD_ERROR,
+					     FWUPD_ERROR_INVALID_FILE,
+					     "failed to load %s: event %u is not an object",
+					     backend_id, j);
+				return FALSE;
+			}
+			event = fu_device_event_new_from_json (json_node_get_object (json_node),
+							       error);
+			if (event == NULL) {
+				g_prefix_error (error, "failed to load %s: ", backend_id);
+				return FALSE;
+			}
+			g_ptr_array_add (events, event);
+		}
+		g_debug ("loaded %u events for %s", events->len, backend_id);
+		g_hash_table_insert (self->emulation_events,
+				     g_strdup (backend_id),
+				     g_steal_pointer (&events));
+	}
+	return TRUE;
+}
+
+/**
+ * fu_engine_emulation_save:
+ * @self: A #FuEngine
+ * @filename: A filename
+ * @error: A #GError, or %NULL
+ *
+ * Saves all the events recorded since the engine was loaded.
+ *
+ * Returns: %TRUE for success
+ **/
+gboolean
+fu_engine_emulation_save (FuEngine *self, const gchar *filename, GError **error)
+{
+	g_autofree gchar *data = NULL;
+	g_autoptr(GList) backend_ids = NULL;
+	g_autoptr(JsonBuilder) builder = json_builder_new ();
+	g_autoptr(JsonGenerator) json_generator = json_generator_new ();
+	g_autoptr(JsonNode) json_root = NULL;
+
+	g_return_val_if_fail (FU_IS_ENGINE (self), FALSE);
+	g_return_val_if_fail (filename != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* sort so that the output is stable */
+	backend_ids = g_hash_table_get_keys (self->emulation_events);
+	backend_ids = g_list_sort (backend_ids, (GCompareFunc) g_strcmp0);
+	json_builder_begin_object (builder);
+	json_builder_set_member_name (builder, "Devices");
+	json_builder_begin_array (builder);
+	for (GList *l = backend_ids; l != NULL; l = l->next) {
+		const gchar *backend_id = l->data;
+		GPtrArray *events = g_hash_table_lookup (self->emulation_events, backend_id);
+		if (events->len == 0)
+			continue;
+		json_builder_begin_object (builder);
+		json_builder_set_member_name (builder, "BackendId");
+		json_builder_add_string_value (builder, backend_id);
+		json_builder_set_member_name (builder, "Events");
+		json_builder_begin_array (builder);
+		for (guint i = 0; i < events->len; i++) {
+			FuDeviceEvent *event = g_ptr_array_index (events, i);
+			fu_device_event_to_json (event, builder);
+		}
+		json_builder_end_array (builder);
+		json_builder_end_object (builder);
+	}
+	json_builder_end_array (builder);
+	json_builder_end_object (builder);
+
+	/* export as a string */
+	json_root = json_builder_get_root (builder);
+	json_generator_set_pretty (json_generator, TRUE);
+	json_generator_set_root (json_generator, json_root);
+	data = json_generator_to_data (json_generator, NULL);
+	return g_file_set_contents (filename, data, -1, error);
+}
+
+typedef struct {
+	FuEngine		*self;
+	FuDevice		*device;	/* FuUsbDevice or FuUdevDevice */
+	gchar			*backend_id;
+	GPtrArray		*plugins;	/* of FuPlugin, to run from the main thread */
+	gboolean		 removed;
+} FuEngineProbeHelper;
+
+static void fu_engine_probe_helper_push (FuEngine *self, FuEngineProbeHelper *helper);
+
+static void
+fu_engine_probe_helper_free (FuEngineProbeHelper *helper)
+{
+	g_object_unref (helper->self);
+	g_object_unref (helper->device);
+	g_ptr_array_unref (helper->plugins);
+	g_free (helper->backend_id);
+	g_free (helper);
+}
+
+static void
+fu_engine_backend_device_added_plugin (FuEngine *self, FuPlugin *plugin, FuDevice *device)
+{
+	gboolean ret;
+	g_autoptr(GError) error = NULL;
+
+	if (FU_IS_USB_DEVICE (device))
+		ret = fu_plugin_runner_usb_device_added (plugin, FU_USB_DEVICE (device), &error);
+	else
+		ret = fu_plugin_runner_udev_device_added (plugin, FU_UDEV_DEVICE (device), &error);
+	if (!ret) {
+		if (g_error_matches (error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED)) {
+			if (g_getenv ("FWUPD_PROBE_VERBOSE") != NULL) {
+				g_debug ("%s ignoring: %s",
+					 fu_plugin_get_name (plugin),
+					 error->message);
+			}
+			return;
+		}
+		g_warning ("failed to add device %s: %s",
+			   fu_device_get_backend_id (device),
+			   error->message);
+	}
+}
+
+/* if @plugins_main is set then the first plugin that cannot be run from this
+ * thread and all the plugins after it are added to it rather than being run,
+ * so that the plugins are always run in the same order */
+static void
+fu_engine_backend_device_probe (FuEngine *self, FuDevice *device, GPtrArray *plugins_main)
+{
+	GPtrArray *possible_plugins;
+	const gchar *vfunc = FU_IS_USB_DEVICE (device) ? "usb_device_added" : "udev_device_added";
+	g_autoptr(GError) error_local = NULL;
+
+	if (!fu_device_probe (device, &error_local)) {
+		g_warning ("failed to probe device %s: %s",
+			   fu_device_get_backend_id (device),
+			   error_local->message);
+		return;
+	}
+
+	/* can be specified using a quirk */
+	possible_plugins = fu_device_get_possible_plugins (device);
+	for (guint i = 0; i < possible_plugins->len; i++) {
+		FuPlugin *plugin;
+		const gchar *plugin_name = g_ptr_array_index (possible_plugins, i);
+
+		plugin = fu_plugin_list_find_by_name (self->plugin_list, plugin_name, NULL);
+		if (plugin == NULL)
+			continue;
+		if (plugins_main != NULL &&
+		    (plugins_main->len > 0 ||
+		     !fu_plugin_has_rule (plugin, FU_PLUGIN_RULE_THREAD_SAFE, vfunc))) {
+			g_ptr_array_add (plugins_main, g_object_ref (plugin));
+			continue;
+		}
+		fu_engine_backend_device_added_plugin (self, plugin, device);
+	}
+}
+
+static void
+fu_engine_backend_device_remove_all (FuEngine *self, const gchar *backend_id)
+{
+	GPtrArray *devices = g_hash_table_lookup (self->backend_devices, backend_id);
+	g_autoptr(GPtrArray) devices_tmp = NULL;
+
+	if (devices == NULL)
+		return;
+
+	/* removing the device may also modify the index */
+	devices_tmp = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	for (guint i = 0; i < devices->len; i++)
+		g_ptr_array_add (devices_tmp, g_object_ref (g_ptr_array_index (devices, i)));
+	for (guint i = 0; i < devices_tmp->len; i++) {
+		FuDevice *device = g_ptr_array_index (devices_tmp, i);
+		g_debug ("auto-removing %s", backend_id);
+		fu_device_list_remove (self->device_list, device);
+	}
+}
+
+static gboolean
+fu_engine_probe_done_cb (gpointer user_data)
+{
+	FuEngineProbeHelper *helper = (FuEngineProbeHelper *) user_data;
+	FuEngine *self = helper->self;
+	const gchar *backend_id = helper->backend_id;
+	GQueue *queue = g_hash_table_lookup (self->probe_queues, backend_id);
+
+	/* unplugged while being set up, so there is nothing left to talk to */
+	if (helper->removed) {
+		fu_engine_backend_device_remove_all (self, backend_id);
+	} else {
+		/* plugins that are not thread safe */
+		for (guint i = 0; i < helper->plugins->len; i++) {
+			FuPlugin *plugin = g_ptr_array_index (helper->plugins, i);
+			fu_engine_backend_device_added_plugin (self, plugin, helper->device);
+		}
+	}
+
+	/* start the next event for the same device */
+	g_queue_pop_head (queue);
+	if (g_queue_is_empty (queue))
+		g_hash_table_remove (self->probe_queues, backend_id);
+	else
+		fu_engine_probe_helper_push (self, g_queue_peek_head (queue));
+	return G_SOURCE_REMOVE;
+}
+
+static void
+fu_engine_probe_thread_cb (gpointer data, gpointer user_data)
 {
-	FuEngine *self = FU_ENGINE (user_data);
+	FuEngineProbeHelper *helper = (FuEngineProbeHelper *) data;
+	g_autoptr(GSource) source = g_idle_source_new ();
 
-	/* invalidate host security attributes */
-	g_clear_pointer (&self->host_security_id, g_free);
+	/* any devices added by the plugin are proxied to the main thread */
+	fu_engine_backend_device_probe (helper->self, helper->device, helper->plugins);
 
-	/* make UI refresh */
-	fu_engine_emit_changed (self);
+	/* process the result in the main thread */
+	g_source_set_callback (source,
+			       fu_engine_probe_done_cb,
+			       helper,
+			       (GDestroyNotify) fu_engine_probe_helper_free);
+	g_source_attach (source, helper->self->main_ctx);
 }
 
 static void
-fu_engine_plugin_device_removed_cb (FuPlugin *plugin,
-				    FuDevice *device,
-				    gpointer user_data)
+fu_engine_probe_helper_push (FuEngine *self, FuEngineProbeHelper *helper)
 {
-	FuEngine *self = (FuEngine *) user_data;
-	FuPlugin *plugin_old;
-	g_autoptr(FuDevice) device_tmp = NULL;
 	g_autoptr(GError) error = NULL;
+	if (!g_thread_pool_push (self->probe_pool, helper, &error)) {
+		g_warning ("failed to probe %s in thread: %s",
+			   helper->backend_id,
+			   error->message);
+		fu_engine_probe_thread_cb (helper, self);
+	}
+}
 
-	device_tmp = fu_device_list_get_by_id (self->device_list,
-					       fu_device_get_id (device),
-					       &error);
-	if (device_tmp == NULL) {
-		g_debug ("failed to find device %s: %s",
-			 fu_device_get_id (device),
-			 error->message);
-		return;
+static GThreadPool *
+fu_engine_probe_pool_new (FuEngine *self)
+{
+	GPtrArray *plugins = fu_plugin_list_get_all (self->plugin_list);
+	g_autoptr(GError) error = NULL;
+	GThreadPool *pool;
+
+	/* only create threads if any plugin opted in */
+	for (guint i = 0; i < plugins->len; i++) {
+		FuPlugin *plugin = g_ptr_array_index (plugins, i);
+		if (!fu_plugin_has_rule (plugin, FU_PLUGIN_RULE_THREAD_SAFE, "usb_device_added") &&
+		    !fu_plugin_has_rule (plugin, FU_PLUGIN_RULE_THREAD_SAFE, "udev_device_added"))
+			continue;
+		pool = g_thread_pool_new (fu_engine_probe_thread_cb,
+					  self,
+					  FU_ENGINE_PROBE_THREADS_MAX,
+					  FALSE,
+					  &error);
+		if (pool == NULL)
+			g_warning ("failed to create probe threads: %s", error->message);
+		return pool;
 	}
+	return NULL;
+}
 
-	/* get the plugin */
-	plugin_old = fu_plugin_list_find_by_name (self->plugin_list,
-						  fu_device_get_plugin (device),
-						  &error);
-	if (plugin_old == NULL) {
-		g_debug ("failed to find plugin %s: %s",
-			 fu_device_get_plugin (device),
-			 error->message);
+/* hotplugged devices are probed and set up from a worker thread where the
+ * plugin allows it, and events for the same @backend_id are run in order */
+void
+fu_engine_backend_device_added (FuEngine *self, FuDevice *device, const gchar *backend_id)
+{
+	FuEngineProbeHelper *helper;
+	GQueue *queue;
+
+	/* coldplugged devices have to be added when fu_engine_load() returns */
+	if (!self->loaded || self->probe_pool == NULL || backend_id == NULL) {
+		fu_engine_backend_device_probe (self, device, NULL);
 		return;
 	}
 
-	/* check this came from the same plugin */
-	if (g_strcmp0 (fu_plugin_get_name (plugin),
-		       fu_plugin_get_name (plugin_old)) != 0) {
-		g_debug ("ignoring duplicate removal from %s",
-			 fu_plugin_get_name (plugin));
+	helper = g_new0 (FuEngineProbeHelper, 1);
+	helper->self = g_object_ref (self);
+	helper->device = g_object_ref (device);
+	helper->backend_id = g_strdup (backend_id);
+	helper->plugins = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	queue = g_hash_table_lookup (self->probe_queues, backend_id);
+	if (queue != NULL) {
+		g_debug ("%s is already being probed, deferring", backend_id);
+		g_queue_push_tail (queue, helper);
 		return;
 	}
-
-	/* make the UI update */
-	fu_device_list_remove (self->device_list, device);
-	fu_engine_emit_changed (self);
+	queue = g_queue_new ();
+	g_queue_push_tail (queue, helper);
+	g_hash_table_insert (self->probe_queues, g_strdup (backend_id), queue);
+	fu_engine_probe_helper_push (self, helper);
 }
 
-static gboolean
-fu_engine_recoldplug_delay_cb (gpointer user_data)
+void
+fu_engine_backend_device_removed (FuEngine *self, const gchar *backend_id)
 {
-	FuEngine *self = (FuEngine *) user_data;
-	g_debug ("recoldplugging");
-	fu_engine_plugins_coldplug (self, TRUE);
-	self->coldplug_id = 0;
-	return FALSE;
+	GQueue *queue = g_hash_table_lookup (self->probe_queues, backend_id);
+
+	/* anything waiting is now pointless, and the device being set up is
+	 * removed again when the worker thread has finished */
+	if (queue != NULL) {
+		FuEngineProbeHelper *helper;
+		while (g_queue_get_length (queue) > 1)
+			fu_engine_probe_helper_free (g_queue_pop_tail (queue));
+		helper = g_queue_peek_head (queue);
+		helper->removed = TRUE;
+	}
+	fu_engine_backend_device_remove_all (self, backend_id);
 }
 
 #ifdef HAVE_GUDEV
@@ -5400,8 +7144,6 @@ static void
 fu_engine_udev_device_add (FuEngine *self, GUdevDevice *udev_device)
 {
 	g_autoptr(FuUdevDevice) device = fu_udev_device_new (udev_device);
-	g_autoptr(GError) error_local = NULL;
-	g_autoptr(GPtrArray) possible_plugins = NULL;
 
 	/* debug */
 	if (g_getenv ("FWUPD_PROBE_VERBOSE") != NULL) {
@@ -5411,63 +7153,22 @@ fu_engine_udev_device_add (FuEngine *self, GUdevDevice *udev_device)
 
 	/* add any extra quirks */
 	fu_device_set_quirks (FU_DEVICE (device), self->quirks);
-	if (!fu_device_probe (FU_DEVICE (device), &error_local)) {
-		g_warning ("failed to probe device %s: %s",
-			   g_udev_device_get_sysfs_path (udev_device),
-			   error_local->message);
-		return;
-	}
-
-	/* can be specified using a quirk */
-	possible_plugins = fu_device_get_possible_plugins (FU_DEVICE (device));
-	for (guint i = 0; i < possible_plugins->len; i++) {
-		FuPlugin *plugin;
-		const gchar *plugin_name = g_ptr_array_index (possible_plugins, i);
-		g_autoptr(GError) error = NULL;
-
-		plugin = fu_plugin_list_find_by_name (self->plugin_list, plugin_name, NULL);
-		if (plugin == NULL)
-			continue;
-		if (!fu_plugin_runner_udev_device_added (plugin, device, &error)) {
-			if (g_error_matches (error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED)) {
-				if (g_getenv ("FWUPD_PROBE_VERBOSE") != NULL) {
-					g_debug ("%s ignoring: %s",
-						 fu_plugin_get_name (plugin),
-						 error->message);
-				}
-				continue;
-			}
-			g_warning ("failed to add udev device %s: %s",
-				   g_udev_device_get_sysfs_path (udev_device),
-				   error->message);
-			continue;
-		}
-	}
+	fu_engine_emulation_setup_device (self, FU_DEVICE (device),
+					  g_udev_device_get_sysfs_path (udev_device));
+	fu_engine_backend_device_added (self, FU_DEVICE (device),
+					g_udev_device_get_sysfs_path (udev_device));
 }
 
 static void
 fu_engine_udev_device_remove (FuEngine *self, GUdevDevice *udev_device)
 {
-	g_autoptr(GPtrArray) devices = NULL;
-
 	/* debug */
 	if (g_getenv ("FWUPD_PROBE_VERBOSE") != NULL) {
 		g_debug ("UDEV %s removed",
 			 g_udev_device_get_sysfs_path (udev_device));
 	}
 
-	/* go through each device and remove any that match */
-	devices = fu_device_list_get_all (self->device_list);
-	for (guint i = 0; i < devices->len; i++) {
-		FuDevice *device = g_ptr_array_index (devices, i);
-		if (!FU_IS_UDEV_DEVICE (device))
-			continue;
-		if (g_strcmp0 (fu_udev_device_get_sysfs_path (FU_UDEV_DEVICE (device)),
-			       g_udev_device_get_sysfs_path (udev_device)) == 0) {
-			g_debug ("auto-removing GUdevDevice");
-			fu_device_list_remove (self->device_list, device);
-		}
-	}
+	fu_engine_backend_device_removed (self, g_udev_device_get_sysfs_path (udev_device));
 }
 
 typedef struct {
@@ -5499,7 +7200,8 @@ static gboolean
 fu_engine_udev_changed_cb (gpointer user_data)
 {
 	FuEngineUdevChangedHelper *helper = (FuEngineUdevChangedHelper *) user_data;
-	GPtrArray *plugins = fu_plugin_list_get_all (helper->self->plugin_list);
+	GPtrArray *plugins = fu_plugin_list_get_all_by_vfunc (helper->self->plugin_list,
+							      FU_PLUGIN_VFUNC_UDEV_DEVICE_CHANGED);
 	g_autoptr(FuUdevDevice) device = fu_udev_device_new (helper->udev_device);
 
 	/* run all plugins */
@@ -5518,6 +7220,10 @@ fu_engine_udev_changed_cb (gpointer user_data)
 				   g_udev_device_get_sysfs_path (helper->udev_device),
 				   error->message);
 		}
+
+		/* plugins such as iommu have no devices of their own */
+		fu_engine_security_attrs_invalidate (helper->self,
+						     fu_plugin_get_name (plugin_tmp));
 	}
 
 	/* device done, so remove ref */
@@ -5531,19 +7237,14 @@ static void
 fu_engine_udev_device_changed (FuEngine *self, GUdevDevice *udev_device)
 {
 	const gchar *sysfs_path = g_udev_device_get_sysfs_path (udev_device);
-	g_autoptr(GPtrArray) devices = NULL;
+	GPtrArray *devices = g_hash_table_lookup (self->backend_devices, sysfs_path);
 	FuEngineUdevChangedHelper *helper;
 
 	/* emit changed on any that match */
-	devices = fu_device_list_get_all (self->device_list);
-	for (guint i = 0; i < devices->len; i++) {
+	for (guint i = 0; devices != NULL && i < devices->len; i++) {
 		FuDevice *device = g_ptr_array_index (devices, i);
-		if (!FU_IS_UDEV_DEVICE (device))
-			continue;
-		if (g_strcmp0 (fu_udev_device_get_sysfs_path (FU_UDEV_DEVICE (device)),
-			       sysfs_path) == 0) {
+		if (FU_IS_UDEV_DEVICE (device))
 			fu_udev_device_emit_changed (FU_UDEV_DEVICE (device));
-		}
 	}
 
 	/* run all plugins, with per-device rate limiting */
@@ -5669,17 +7370,10 @@ fu_engine_add_plugin_filter (FuEngine *self, const gchar *plugin_glob)
 static gboolean
 fu_engine_plugin_check_supported_cb (FuPlugin *plugin, const gchar *guid, FuEngine *self)
 {
-	g_autoptr(XbNode) n = NULL;
-	g_autofree gchar *xpath = NULL;
-
 	if (fu_config_get_enumerate_all_devices (self->config))
 		return TRUE;
-
-	xpath = g_strdup_printf ("components/component/"
-				 "provides/firmware[@type='flashed'][text()='%s']",
-				 guid);
-	n = xb_silo_query_first (self->silo, xpath, NULL);
-	return n != NULL;
+	fu_engine_ensure_component_index (self);
+	return g_hash_table_lookup (self->component_index, guid) != NULL;
 }
 
 gboolean
@@ -5782,26 +7476,143 @@ fu_engine_attrs_calculate_hsi_for_chassis (FuEngine *self)
 }
 
 
+static void
+fu_engine_security_attrs_item_free (FuEngineSecurityAttrsItem *item)
+{
+	g_object_unref (item->plugin);
+	g_object_unref (item->attrs);
+	g_free (item);
+}
+
+/* the HSI string is always recalculated, but the attributes from other plugins
+ * are re-used from the cache unless they have expired */
+static void
+fu_engine_security_attrs_invalidate (FuEngine *self, const gchar *plugin_name)
+{
+	g_clear_pointer (&self->host_security_id, g_free);
+	if (plugin_name != NULL)
+		g_hash_table_remove (self->security_attrs_cache, plugin_name);
+}
+
+static void
+fu_engine_security_attrs_thread_cb (gpointer data, gpointer user_data)
+{
+	FuEngineSecurityAttrsItem *item = (FuEngineSecurityAttrsItem *) data;
+	fu_plugin_runner_add_security_attrs (item->plugin, item->attrs);
+}
+
+/* plugins that never signal a change are re-queried after a while */
+static gboolean
+fu_engine_security_attrs_expired (FuEngine *self)
+{
+	GHashTableIter iter;
+	gpointer value;
+	gint64 now = g_get_monotonic_time ();
+
+	g_hash_table_iter_init (&iter, self->security_attrs_cache);
+	while (g_hash_table_iter_next (&iter, NULL, &value)) {
+		FuEngineSecurityAttrsItem *item = (FuEngineSecurityAttrsItem *) value;
+		if (now - item->ctime >= FU_ENGINE_SECURITY_ATTRS_MAX_AGE)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+/* query the plugins with no cached attributes, at the same time if safe */
+static void
+fu_engine_security_attrs_refresh (FuEngine *self)
+{
+	GPtrArray *plugins = fu_plugin_list_get_all_by_vfunc (self->plugin_list,
+							      FU_PLUGIN_VFUNC_ADD_SECURITY_ATTRS);
+	GThreadPool *pool = NULL;
+	gint64 now = g_get_monotonic_time ();
+
+	for (guint j = 0; j < plugins->len; j++) {
+		FuPlugin *plugin_tmp = g_ptr_array_index (plugins, j);
+		FuEngineSecurityAttrsItem *item;
+		g_autoptr(GError) error = NULL;
+
+		/* still valid */
+		item = g_hash_table_lookup (self->security_attrs_cache,
+					    fu_plugin_get_name (plugin_tmp));
+		if (item != NULL && now - item->ctime < FU_ENGINE_SECURITY_ATTRS_MAX_AGE)
+			continue;
+
+		/* owned by the cache, which is not modified until the threads
+		 * have all finished */
+		item = g_new0 (FuEngineSecurityAttrsItem, 1);
+		item->plugin = g_object_ref (plugin_tmp);
+		item->attrs = fu_security_attrs_new ();
+		item->ctime = now;
+		g_hash_table_insert (self->security_attrs_cache,
+				     g_strdup (fu_plugin_get_name (plugin_tmp)),
+				     item);
+		if (fu_plugin_has_rule (plugin_tmp, FU_PLUGIN_RULE_THREAD_SAFE,
+					"add_security_attrs")) {
+			if (pool == NULL) {
+				pool = g_thread_pool_new (fu_engine_security_attrs_thread_cb,
+							  self,
+							  FU_ENGINE_SECURITY_ATTRS_THREADS_MAX,
+							  FALSE,
+							  &error);
+				if (pool == NULL) {
+					g_warning ("failed to create security attr threads: %s",
+						   error->message);
+					g_clear_error (&error);
+				}
+			}
+			if (pool != NULL && g_thread_pool_push (pool, item, &error))
+				continue;
+			if (error != NULL) {
+				g_warning ("failed to query %s in thread: %s",
+					   fu_plugin_get_name (plugin_tmp),
+					   error->message);
+			}
+		}
+		fu_plugin_runner_add_security_attrs (plugin_tmp, item->attrs);
+	}
+
+	/* wait for all the threads to finish */
+	if (pool != NULL)
+		g_thread_pool_free (pool, FALSE, TRUE);
+}
+
 static void
 fu_engine_ensure_security_attrs (FuEngine *self)
 {
-	GPtrArray *plugins = fu_plugin_list_get_all (self->plugin_list);
+	GPtrArray *plugins = fu_plugin_list_get_all_by_vfunc (self->plugin_list,
+							      FU_PLUGIN_VFUNC_ADD_SECURITY_ATTRS);
 	g_autoptr(GPtrArray) items = NULL;
 
 	/* already valid */
-	if (self->host_security_id != NULL)
+	if (self->host_security_id != NULL &&
+	    !fu_engine_security_attrs_expired (self))
 		return;
 
+	/* query any plugins that are not cached */
+	fu_engine_security_attrs_refresh (self);
+
 	/* clear old values */
 	fu_security_attrs_remove_all (self->host_security_attrs);
 
 	/* built in */
 	fu_engine_ensure_security_attrs_tainted (self);
 
-	/* call into plugins */
+	/* add from each plugin, in the depsolved order */
 	for (guint j = 0; j < plugins->len; j++) {
 		FuPlugin *plugin_tmp = g_ptr_array_index (plugins, j);
-		fu_plugin_runner_add_security_attrs (plugin_tmp, self->host_security_attrs);
+		FuEngineSecurityAttrsItem *item;
+		g_autoptr(GPtrArray) attrs_tmp = NULL;
+
+		item = g_hash_table_lookup (self->security_attrs_cache,
+					    fu_plugin_get_name (plugin_tmp));
+		if (item == NULL)
+			continue;
+		attrs_tmp = fu_security_attrs_get_all (item->attrs);
+		for (guint i = 0; i < attrs_tmp->len; i++) {
+			FwupdSecurityAttr *attr = g_ptr_array_index (attrs_tmp, i);
+			fu_security_attrs_append (self->host_security_attrs, attr);
+		}
 	}
 
 	/* set the fallback names for clients without native translations */
@@ -5988,8 +7799,6 @@ fu_engine_usb_device_removed_cb (GUsbContext *ctx,
 				 GUsbDevice *usb_device,
 				 FuEngine *self)
 {
-	g_autoptr(GPtrArray) devices = NULL;
-
 	/* debug */
 	if (g_getenv ("FWUPD_PROBE_VERBOSE") != NULL) {
 		g_debug ("USB %04x:%04x removed",
@@ -5997,18 +7806,7 @@ fu_engine_usb_device_removed_cb (GUsbContext *ctx,
 			 g_usb_device_get_pid (usb_device));
 	}
 
-	/* go through each device and remove any that match */
-	devices = fu_device_list_get_all (self->device_list);
-	for (guint i = 0; i < devices->len; i++) {
-		FuDevice *device = g_ptr_array_index (devices, i);
-		if (!FU_IS_USB_DEVICE (device))
-			continue;
-		if (g_strcmp0 (fu_usb_device_get_platform_id (FU_USB_DEVICE (device)),
-			       g_usb_device_get_platform_id (usb_device)) == 0) {
-			g_debug ("auto-removing GUsbDevice");
-			fu_device_list_remove (self->device_list, device);
-		}
-	}
+	fu_engine_backend_device_removed (self, g_usb_device_get_platform_id (usb_device));
 }
 
 static void
@@ -6017,8 +7815,6 @@ fu_engine_usb_device_added_cb (GUsbContext *ctx,
 			       FuEngine *self)
 {
 	g_autoptr(FuUsbDevice) device = fu_usb_device_new (usb_device);
-	g_autoptr(GError) error_local = NULL;
-	g_autoptr(GPtrArray) possible_plugins = NULL;
 
 	/* debug */
 	if (g_getenv ("FWUPD_PROBE_VERBOSE") != NULL) {
@@ -6029,39 +7825,10 @@ fu_engine_usb_device_added_cb (GUsbContext *ctx,
 
 	/* add any extra quirks */
 	fu_device_set_quirks (FU_DEVICE (device), self->quirks);
-	if (!fu_device_probe (FU_DEVICE (device), &error_local)) {
-		g_warning ("failed to probe device %s: %s",
-			   fu_device_get_physical_id (FU_DEVICE (device)),
-			   error_local->message);
-		return;
-	}
-
-	/* can be specified using a quirk */
-	possible_plugins = fu_device_get_possible_plugins (FU_DEVICE (device));
-	for (guint i = 0; i < possible_plugins->len; i++) {
-		FuPlugin *plugin;
-		const gchar *plugin_name = g_ptr_array_index (possible_plugins, i);
-		g_autoptr(GError) error = NULL;
-
-		plugin = fu_plugin_list_find_by_name (self->plugin_list, plugin_name, NULL);
-		if (plugin == NULL)
-			continue;
-		if (!fu_plugin_runner_usb_device_added (plugin, device, &error)) {
-			if (g_error_matches (error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED)) {
-				if (g_getenv ("FWUPD_PROBE_VERBOSE") != NULL) {
-					g_debug ("%s ignoring: %s",
-						 fu_plugin_get_name (plugin),
-						 error->message);
-				}
-				continue;
-			}
-			g_warning ("failed to add USB device %04x:%04x: %s",
-				   g_usb_device_get_vid (usb_device),
-				   g_usb_device_get_pid (usb_device),
-				   error->message);
-			continue;
-		}
-	}
+	fu_engine_emulation_setup_device (self, FU_DEVICE (device),
+					  g_usb_device_get_platform_id (usb_device));
+	fu_engine_backend_device_added (self, FU_DEVICE (device),
+					g_usb_device_get_platform_id (usb_device));
 }
 
 static void
@@ -6088,8 +7855,14 @@ fu_engine_load_hwids (FuEngine *self)
 		g_warning ("Failed to load HWIDs: %s", error->message);
 }
 
+/* the changes are only made to @dev_history, and the devices that need to be
+ * written are added to @devices_metadata and @devices_modify */
 static gboolean
-fu_engine_update_history_device (FuEngine *self, FuDevice *dev_history, GError **error)
+fu_engine_update_history_device (FuEngine *self,
+				 FuDevice *dev_history,
+				 GPtrArray *devices_metadata,
+				 GPtrArray *devices_modify,
+				 GError **error)
 {
 	FuPlugin *plugin;
 	FwupdRelease *rel_history;
@@ -6128,13 +7901,7 @@ fu_engine_update_history_device (FuEngine *self, FuDevice *dev_history, GError *
 	metadata_device = fu_device_report_metadata_post (dev);
 	if (metadata_device != NULL && g_hash_table_size (metadata_device) > 0) {
 		fwupd_release_add_metadata (rel_history, metadata_device);
-		if (!fu_history_set_device_metadata (self->history,
-						     fu_device_get_id (dev_history),
-						     fwupd_release_get_metadata (rel_history),
-						     error)) {
-			g_prefix_error (error, "failed to set metadata: ");
-			return FALSE;
-		}
+		g_ptr_array_add (devices_metadata, g_object_ref (dev_history));
 	}
 
 	/* the system is running with the new firmware version */
@@ -6157,7 +7924,8 @@ fu_engine_update_history_device (FuEngine *self, FuDevice *dev_history, GError *
 		fu_device_remove_flag (dev_history, FWUPD_DEVICE_FLAG_NEEDS_ACTIVATION);
 		fu_device_set_update_state (dev_history, FWUPD_UPDATE_STATE_SUCCESS);
 		fu_device_set_update_error (dev_history, NULL);
-		return fu_history_modify_device (self->history, dev_history, error);
+		g_ptr_array_add (devices_modify, g_object_ref (dev_history));
+		return TRUE;
 	}
 
 	/* does the plugin know the update failure */
@@ -6181,18 +7949,23 @@ fu_engine_update_history_device (FuEngine *self, FuDevice *dev_history, GError *
 	}
 
 	/* update the state in the database */
-	return fu_history_modify_device (self->history, dev_history, error);
+	g_ptr_array_add (devices_modify, g_object_ref (dev_history));
+	return TRUE;
 }
 
 static gboolean
 fu_engine_update_history_database (FuEngine *self, GError **error)
 {
 	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GPtrArray) devices_metadata = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_autoptr(GPtrArray) devices_modify = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
 
 	/* get any devices */
 	devices = fu_history_get_devices (self->history, error);
 	if (devices == NULL)
 		return FALSE;
+
+	/* ask the plugins before the database is locked */
 	for (guint i = 0; i < devices->len; i++) {
 		FuDevice *dev = g_ptr_array_index (devices, i);
 		g_autoptr(GError) error_local = NULL;
@@ -6201,33 +7974,105 @@ fu_engine_update_history_database (FuEngine *self, GError **error)
 		if (fu_device_get_update_state (dev) != FWUPD_UPDATE_STATE_NEEDS_REBOOT)
 			continue;
 
-		/* try to save the new update-state, but ignoring any error */
-		if (!fu_engine_update_history_device (self, dev, &error_local)) {
+		/* try to get the new update-state, but ignoring any error */
+		if (!fu_engine_update_history_device (self, dev,
+						      devices_metadata,
+						      devices_modify,
+						      &error_local)) {
+			g_warning ("failed to update history database: %s",
+				   error_local->message);
+		}
+	}
+
+	/* nothing to do, so do not require the database to be writable */
+	if (devices_metadata->len == 0 && devices_modify->len == 0)
+		return TRUE;
+
+	/* write all the changes at once */
+	if (!fu_history_start_transaction (self->history, error))
+		return FALSE;
+	for (guint i = 0; i < devices_metadata->len; i++) {
+		FuDevice *dev = g_ptr_array_index (devices_metadata, i);
+		FwupdRelease *rel = fu_device_get_release_default (dev);
+		g_autoptr(GError) error_local = NULL;
+		if (!fu_history_set_device_metadata (self->history,
+						     fu_device_get_id (dev),
+						     fwupd_release_get_metadata (rel),
+						     &error_local)) {
+			g_warning ("failed to set metadata: %s", error_local->message);
+		}
+	}
+	for (guint i = 0; i < devices_modify->len; i++) {
+		FuDevice *dev = g_ptr_array_index (devices_modify, i);
+		g_autoptr(GError) error_local = NULL;
+		if (!fu_history_modify_device (self->history, dev, &error_local)) {
 			g_warning ("failed to update history database: %s",
 				   error_local->message);
 		}
 	}
+	if (!fu_history_commit_transaction (self->history, error)) {
+		fu_history_rollback_transaction (self->history);
+		return FALSE;
+	}
 	return TRUE;
 }
 
 #ifdef HAVE_GUDEV
+static void
+fu_engine_udev_uevent_batch_cb (FuUeventBatchAction action, GObject *device, gpointer user_data)
+{
+	FuEngine *self = FU_ENGINE (user_data);
+	GUdevDevice *udev_device = G_UDEV_DEVICE (device);
+
+	if (action == FU_UEVENT_BATCH_ACTION_ADD)
+		fu_engine_udev_device_add (self, udev_device);
+	else if (action == FU_UEVENT_BATCH_ACTION_REMOVE)
+		fu_engine_udev_device_remove (self, udev_device);
+	else if (action == FU_UEVENT_BATCH_ACTION_CHANGE)
+		fu_engine_udev_device_changed (self, udev_device);
+}
+
+static gboolean
+fu_engine_udev_uevents_cb (gpointer user_data)
+{
+	FuEngine *self = FU_ENGINE (user_data);
+	guint coalesced = fu_uevent_batch_get_coalesced (self->uevents);
+	guint processed;
+
+	self->uevents_id = 0;
+	processed = fu_uevent_batch_process (self->uevents,
+					     fu_engine_udev_uevent_batch_cb,
+					     self);
+	if (coalesced > 0) {
+		g_debug ("processed %u devices, %u uevents coalesced in total",
+			 processed, coalesced);
+	}
+	return G_SOURCE_REMOVE;
+}
+
 static void
 fu_engine_udev_uevent_cb (GUdevClient *gudev_client,
 			  const gchar *action,
 			  GUdevDevice *udev_device,
 			  FuEngine *self)
 {
+	FuUeventBatchAction action_tmp;
+
 	if (g_strcmp0 (action, "add") == 0) {
-		fu_engine_udev_device_add (self, udev_device);
-		return;
-	}
-	if (g_strcmp0 (action, "remove") == 0) {
-		fu_engine_udev_device_remove (self, udev_device);
+		action_tmp = FU_UEVENT_BATCH_ACTION_ADD;
+	} else if (g_strcmp0 (action, "remove") == 0) {
+		action_tmp = FU_UEVENT_BATCH_ACTION_REMOVE;
+	} else if (g_strcmp0 (action, "change") == 0) {
+		action_tmp = FU_UEVENT_BATCH_ACTION_CHANGE;
+	} else {
 		return;
 	}
-	if (g_strcmp0 (action, "change") == 0) {
-		fu_engine_udev_device_changed (self, udev_device);
-		return;
+	fu_uevent_batch_add (self->uevents, action_tmp,
+			     g_udev_device_get_sysfs_path (udev_device),
+			     G_OBJECT (udev_device));
+	if (self->uevents_id == 0) {
+		self->uevents_id = g_timeout_add (FU_ENGINE_UEVENT_COALESCE_DELAY,
+						  fu_engine_udev_uevents_cb, self);
 	}
 }
 #endif
@@ -6256,6 +8101,67 @@ fu_engine_ensure_client_certificate (FuEngine *self)
 	g_debug ("client certificate exists and working");
 }
 
+static void
+fu_engine_profile_item_free (FuEngineProfileItem *item)
+{
+	g_free (item->id);
+	g_free (item);
+}
+
+/* record the time since @start, and then reset @start for the next phase */
+static void
+fu_engine_profile_add (FuEngine *self, const gchar *id, gint64 *start)
+{
+	FuEngineProfileItem *item = g_new0 (FuEngineProfileItem, 1);
+	gint64 now = g_get_monotonic_time ();
+	item->id = g_strdup (id);
+	item->duration = now - *start;
+	g_ptr_array_add (self->startup_profile, item);
+	*start = now;
+}
+
+/**
+ * fu_engine_get_startup_profile:
+ * @self: A #FuEngine
+ *
+ * Gets how long each phase of fu_engine_load() took, followed by the time
+ * taken for each plugin vfunc run during startup.
+ *
+ * Returns: (transfer floating): a #GVariant of type `a(st)`, in microseconds
+ **/
+GVariant *
+fu_engine_get_startup_profile (FuEngine *self)
+{
+	GPtrArray *plugins;
+	GVariantBuilder builder;
+	const gchar *vfunc_names[] = { "startup",
+				       "coldplug_prepare",
+				       "coldplug",
+				       "coldplug_cleanup",
+				       NULL };
+
+	g_return_val_if_fail (FU_IS_ENGINE (self), NULL);
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(st)"));
+	for (guint i = 0; i < self->startup_profile->len; i++) {
+		FuEngineProfileItem *item = g_ptr_array_index (self->startup_profile, i);
+		g_variant_builder_add (&builder, "(st)", item->id, item->duration);
+	}
+	plugins = fu_plugin_list_get_all (self->plugin_list);
+	for (guint i = 0; i < plugins->len; i++) {
+		FuPlugin *plugin = g_ptr_array_index (plugins, i);
+		for (guint j = 0; vfunc_names[j] != NULL; j++) {
+			guint duration = fu_plugin_get_runner_duration (plugin, vfunc_names[j]);
+			g_autofree gchar *id = NULL;
+			if (duration == 0)
+				continue;
+			id = g_strdup_printf ("%s(%s)", vfunc_names[j], fu_plugin_get_name (plugin));
+			g_variant_builder_add (&builder, "(st)", id, (guint64) duration);
+		}
+	}
+	return g_variant_builder_end (&builder);
+}
+
 /**
  * fu_engine_load:
  * @self: A #FuEngine
@@ -6273,6 +8179,7 @@ fu_engine_load (FuEngine *self, FuEngineLoadFlags flags, GError **error)
 	FuQuirksLoadFlags quirks_flags = FU_QUIRKS_LOAD_FLAG_NONE;
 	g_autoptr(GPtrArray) checksums_approved = NULL;
 	g_autoptr(GPtrArray) checksums_blocked = NULL;
+	gint64 profile_start = g_get_monotonic_time ();
 #ifndef _WIN32
 	g_autoptr(GError) error_local = NULL;
 #endif
@@ -6296,6 +8203,7 @@ fu_engine_load (FuEngine *self, FuEngineLoadFlags flags, GError **error)
 		g_prefix_error (error, "Failed to load config: ");
 		return FALSE;
 	}
+	fu_engine_profile_add (self, "config", &profile_start);
 
 	/* read remotes */
 	if (flags & FU_ENGINE_LOAD_FLAG_READONLY_FS)
@@ -6304,6 +8212,7 @@ fu_engine_load (FuEngine *self, FuEngineLoadFlags flags, GError **error)
 		g_prefix_error (error, "Failed to load remotes: ");
 		return FALSE;
 	}
+	fu_engine_profile_add (self, "remotes", &profile_start);
 
 	/* create client certificate */
 	fu_engine_ensure_client_certificate (self);
@@ -6336,23 +8245,29 @@ fu_engine_load (FuEngine *self, FuEngineLoadFlags flags, GError **error)
 		fu_engine_add_blocked_firmware (self, csum);
 	}
 
+	fu_engine_profile_add (self, "history", &profile_start);
+
 	/* set up idle exit */
 	if ((self->app_flags & FU_APP_FLAGS_NO_IDLE_SOURCES) == 0)
 		fu_idle_set_timeout (self->idle, fu_config_get_idle_timeout (self->config));
 
 	/* load quirks, SMBIOS and the hwids */
 	fu_engine_load_smbios (self);
+	fu_engine_profile_add (self, "smbios", &profile_start);
 	fu_engine_load_hwids (self);
+	fu_engine_profile_add (self, "hwids", &profile_start);
 	/* on a read-only filesystem don't care about the cache GUID */
 	if (flags & FU_ENGINE_LOAD_FLAG_READONLY_FS)
 		quirks_flags |= FU_QUIRKS_LOAD_FLAG_READONLY_FS;
 	fu_engine_load_quirks (self, quirks_flags);
+	fu_engine_profile_add (self, "quirks", &profile_start);
 
 	/* load AppStream metadata */
 	if (!fu_engine_load_metadata_store (self, flags, error)) {
 		g_prefix_error (error, "Failed to load AppStream data: ");
 		return FALSE;
 	}
+	fu_engine_profile_add (self, "metadata", &profile_start);
 
 	/* add the "built-in" firmware types */
 	fu_engine_add_firmware_gtype (self, "raw", FU_TYPE_FIRMWARE);
@@ -6379,6 +8294,7 @@ fu_engine_load (FuEngine *self, FuEngineLoadFlags flags, GError **error)
 		g_prefix_error (error, "Failed to load plugins: ");
 		return FALSE;
 	}
+	fu_engine_profile_add (self, "plugins-load", &profile_start);
 
 	/* watch the device list for updates and proxy */
 	g_signal_connect (self->device_list, "added",
@@ -6390,6 +8306,9 @@ fu_engine_load (FuEngine *self, FuEngineLoadFlags flags, GError **error)
 	g_signal_connect (self->device_list, "changed",
 			  G_CALLBACK (fu_engine_device_changed_cb),
 			  self);
+	g_signal_connect (self->device_list, "replaced",
+			  G_CALLBACK (fu_engine_device_replaced_cb),
+			  self);
 
 #ifdef HAVE_GUDEV
 	/* udev watches can only be set up in _init() so set up client now */
@@ -6409,8 +8328,10 @@ fu_engine_load (FuEngine *self, FuEngineLoadFlags flags, GError **error)
 
 	/* add devices */
 	fu_engine_plugins_setup (self);
+	fu_engine_profile_add (self, "plugins-startup", &profile_start);
 	if ((flags & FU_ENGINE_LOAD_FLAG_NO_ENUMERATE) == 0)
 		fu_engine_plugins_coldplug (self, FALSE);
+	fu_engine_profile_add (self, "plugins-coldplug", &profile_start);
 
 	/* coldplug USB devices */
 	g_signal_connect (self->usb_ctx, "device-added",
@@ -6421,20 +8342,27 @@ fu_engine_load (FuEngine *self, FuEngineLoadFlags flags, GError **error)
 			  self);
 	if ((flags & FU_ENGINE_LOAD_FLAG_NO_ENUMERATE) == 0)
 		g_usb_context_enumerate (self->usb_ctx);
+	fu_engine_profile_add (self, "usb-enumerate", &profile_start);
 
 #ifdef HAVE_GUDEV
 	/* coldplug udev devices */
 	if ((flags & FU_ENGINE_LOAD_FLAG_NO_ENUMERATE) == 0)
 		fu_engine_enumerate_udev (self);
+	fu_engine_profile_add (self, "udev-enumerate", &profile_start);
 #endif
 
 	/* set device properties from the metadata */
 	fu_engine_md_refresh_devices (self);
+	fu_engine_profile_add (self, "md-refresh", &profile_start);
 
 	/* update the db for devices that were updated during the reboot */
 	if (!fu_engine_update_history_database (self, error))
 		return FALSE;
 
+	/* hotplugged devices can now be set up from a worker thread */
+	if (self->probe_pool == NULL)
+		self->probe_pool = fu_engine_probe_pool_new (self);
+
 	fu_engine_set_status (self, FWUPD_STATUS_IDLE);
 	self->loaded = TRUE;
 
@@ -6520,6 +8448,9 @@ fu_engine_init (FuEngine *self)
 	g_autofree gchar *sysconfdir = NULL;
 	self->percentage = 0;
 	self->status = FWUPD_STATUS_IDLE;
+	self->install_threads_max = FU_ENGINE_INSTALL_THREADS_MAX;
+	self->main_ctx = g_main_context_ref_thread_default ();
+	self->main_thread = g_thread_self ();
 	self->config = fu_config_new ();
 	self->remote_list = fu_remote_list_new ();
 	self->device_list = fu_device_list_new ();
@@ -6528,13 +8459,28 @@ fu_engine_init (FuEngine *self)
 	self->idle = fu_idle_new ();
 	self->quirks = fu_quirks_new ();
 	self->history = fu_history_new ();
+	self->startup_profile = g_ptr_array_new_with_free_func ((GDestroyNotify) fu_engine_profile_item_free);
+	self->silos = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	self->silo_shards = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_object_unref);
+	self->silo_shard_stamps = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	self->releases_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+						      (GDestroyNotify) fu_engine_releases_cache_item_free);
 	self->plugin_list = fu_plugin_list_new ();
 	self->plugin_filter = g_ptr_array_new_with_free_func (g_free);
 	self->host_security_attrs = fu_security_attrs_new ();
+	self->security_attrs_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+							    (GDestroyNotify) fu_engine_security_attrs_item_free);
 	self->udev_subsystems = g_ptr_array_new_with_free_func (g_free);
+	self->emulation_events = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+							(GDestroyNotify) g_ptr_array_unref);
+	self->probe_queues = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+						    (GDestroyNotify) g_queue_free);
+	self->backend_devices = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+						       (GDestroyNotify) g_ptr_array_unref);
 #ifdef HAVE_GUDEV
 	self->udev_changed_ids = g_hash_table_new_full (g_str_hash, g_str_equal,
 							g_free, (GDestroyNotify) fu_engine_udev_changed_helper_free);
+	self->uevents = fu_uevent_batch_new ();
 #endif
 	self->runtime_versions = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 	self->compile_versions = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
@@ -6595,13 +8541,15 @@ fu_engine_finalize (GObject *obj)
 {
 	FuEngine *self = FU_ENGINE (obj);
 
+	if (self->probe_pool != NULL)
+		g_thread_pool_free (self->probe_pool, TRUE, TRUE);
 	if (self->usb_ctx != NULL)
 		g_object_unref (self->usb_ctx);
-	if (self->silo != NULL)
-		g_object_unref (self->silo);
 #ifdef HAVE_GUDEV
 	if (self->gudev_client != NULL)
 		g_object_unref (self->gudev_client);
+	if (self->uevents_id != 0)
+		g_source_remove (self->uevents_id);
 #endif
 	if (self->coldplug_id != 0)
 		g_source_remove (self->coldplug_id);
@@ -6613,6 +8561,10 @@ fu_engine_finalize (GObject *obj)
 	g_free (self->host_machine_id);
 	g_free (self->host_security_id);
 	g_object_unref (self->host_security_attrs);
+	g_hash_table_unref (self->security_attrs_cache);
+	g_hash_table_unref (self->emulation_events);
+	g_hash_table_unref (self->probe_queues);
+	g_hash_table_unref (self->backend_devices);
 	g_object_unref (self->idle);
 	g_object_unref (self->config);
 	g_object_unref (self->remote_list);
@@ -6626,11 +8578,19 @@ fu_engine_finalize (GObject *obj)
 	g_ptr_array_unref (self->udev_subsystems);
 #ifdef HAVE_GUDEV
 	g_hash_table_unref (self->udev_changed_ids);
+	g_object_unref (self->uevents);
 #endif
 	g_hash_table_unref (self->runtime_versions);
 	g_hash_table_unref (self->compile_versions);
 	g_hash_table_unref (self->firmware_gtypes);
+	g_ptr_array_unref (self->startup_profile);
+	fu_engine_component_index_invalidate (self);
+	g_ptr_array_unref (self->silos);
+	g_hash_table_unref (self->silo_shards);
+	g_hash_table_unref (self->silo_shard_stamps);
+	g_hash_table_unref (self->releases_cache);
 	g_object_unref (self->plugin_list);
+	g_main_context_unref (self->main_ctx);
 
 	G_OBJECT_CLASS (fu_engine_parent_class)->finalize (obj);
 }
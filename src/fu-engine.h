@@ -14,6 +14,7 @@
 #include "fwupd-enums.h"
 
 #include "fu-common.h"
+#include "fu-device-private.h"
 #include "fu-engine-request.h"
 #include "fu-install-task.h"
 #include "fu-plugin.h"
@@ -58,6 +59,7 @@ XbSilo		*fu_engine_get_silo_from_blob		(FuEngine	*self,
 							 GError		**error);
 guint64		 fu_engine_get_archive_size_max		(FuEngine	*self);
 GPtrArray	*fu_engine_get_plugins			(FuEngine	*self);
+GVariant	*fu_engine_get_startup_profile		(FuEngine	*self);
 GPtrArray	*fu_engine_get_devices			(FuEngine	*self,
 							 GError		**error);
 FuDevice	*fu_engine_get_device			(FuEngine	*self,
@@ -85,6 +87,12 @@ GPtrArray	*fu_engine_get_upgrades			(FuEngine	*self,
 							 FuEngineRequest *request,
 							 const gchar	*device_id,
 							 GError		**error);
+GHashTable	*fu_engine_get_releases_all		(FuEngine	*self,
+							 FuEngineRequest *request,
+							 GError		**error);
+GHashTable	*fu_engine_get_upgrades_all		(FuEngine	*self,
+							 FuEngineRequest *request,
+							 GError		**error);
 FwupdDevice	*fu_engine_get_results			(FuEngine	*self,
 							 const gchar	*device_id,
 							 GError		**error);
@@ -143,6 +151,8 @@ gboolean	 fu_engine_install_blob			(FuEngine	*self,
 							 GBytes		*blob_fw,
 							 FwupdInstallFlags flags,
 							 GError		**error);
+gboolean	 fu_engine_check_not_installing		(FuEngine	*self,
+							 GError		**error);
 gboolean	 fu_engine_install_tasks		(FuEngine	*self,
 							 FuEngineRequest *request,
 							 GPtrArray	*install_tasks,
@@ -185,12 +195,26 @@ GPtrArray	*fu_engine_get_releases_for_device 	(FuEngine	*self,
 							 FuEngineRequest *request,
 							 FuDevice	*device,
 							 GError		**error);
+void		 fu_engine_set_emulation		(FuEngine	*self,
+							 FuDeviceEmulation emulation,
+							 gboolean	 emulation_latency);
+gboolean	 fu_engine_emulation_load		(FuEngine	*self,
+							 const gchar	*filename,
+							 GError		**error);
+gboolean	 fu_engine_emulation_save		(FuEngine	*self,
+							 const gchar	*filename,
+							 GError		**error);
 
 /* for the self tests */
 void		 fu_engine_add_device			(FuEngine	*self,
 							 FuDevice	*device);
 void		 fu_engine_add_plugin			(FuEngine	*self,
 							 FuPlugin	*plugin);
+void		 fu_engine_backend_device_added		(FuEngine	*self,
+							 FuDevice	*device,
+							 const gchar	*backend_id);
+void		 fu_engine_backend_device_removed	(FuEngine	*self,
+							 const gchar	*backend_id);
 void		 fu_engine_add_runtime_version		(FuEngine	*self,
 							 const gchar	*component_id,
 							 const gchar	*version);
@@ -203,6 +227,8 @@ gboolean	 fu_engine_check_requirements		(FuEngine	*self,
 							 GError		**error);
 void		 fu_engine_set_silo			(FuEngine	*self,
 							 XbSilo		*silo);
+void		 fu_engine_set_install_threads_max	(FuEngine	*self,
+							 guint		 install_threads_max);
 XbNode		*fu_engine_get_component_by_guids	(FuEngine	*self,
 							 FuDevice	*device);
 gboolean	 fu_engine_schedule_update		(FuEngine	*self,
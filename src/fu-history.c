@@ -24,20 +24,185 @@
 
 static void fu_history_finalize			 (GObject *object);
 
+typedef enum {
+	FU_HISTORY_STMT_MODIFY_DEVICE,
+	FU_HISTORY_STMT_SET_DEVICE_METADATA,
+	FU_HISTORY_STMT_ADD_DEVICE,
+	FU_HISTORY_STMT_REMOVE_ALL_WITH_STATE,
+	FU_HISTORY_STMT_REMOVE_ALL,
+	FU_HISTORY_STMT_REMOVE_DEVICE,
+	FU_HISTORY_STMT_GET_DEVICE_BY_ID,
+	FU_HISTORY_STMT_GET_DEVICES,
+	FU_HISTORY_STMT_GET_APPROVED_FIRMWARE,
+	FU_HISTORY_STMT_CLEAR_APPROVED_FIRMWARE,
+	FU_HISTORY_STMT_ADD_APPROVED_FIRMWARE,
+	FU_HISTORY_STMT_GET_BLOCKED_FIRMWARE,
+	FU_HISTORY_STMT_CLEAR_BLOCKED_FIRMWARE,
+	FU_HISTORY_STMT_ADD_BLOCKED_FIRMWARE,
+	FU_HISTORY_STMT_LAST
+} FuHistoryStmtKind;
+
+/* prepared once when the database is loaded */
+static const gchar *fu_history_stmt_sql[FU_HISTORY_STMT_LAST] = {
+	[FU_HISTORY_STMT_MODIFY_DEVICE] =
+		"UPDATE history SET "
+		"update_state = ?1, "
+		"update_error = ?2, "
+		"checksum_device = ?6, "
+		"device_modified = ?7, "
+		"flags = ?3 "
+		"WHERE device_id = ?4;",
+	[FU_HISTORY_STMT_SET_DEVICE_METADATA] =
+		"UPDATE history SET "
+		"metadata = ?1 "
+		"WHERE device_id = ?2;",
+	[FU_HISTORY_STMT_ADD_DEVICE] =
+		"INSERT INTO history (device_id,"
+				     "update_state,"
+				     "update_error,"
+				     "flags,"
+				     "filename,"
+				     "checksum,"
+				     "display_name,"
+				     "plugin,"
+				     "guid_default,"
+				     "metadata,"
+				     "device_created,"
+				     "device_modified,"
+				     "version_old,"
+				     "version_new,"
+				     "checksum_device,"
+				     "protocol) "
+		"VALUES (?1,?2,?3,?4,?5,?6,?7,?8,?9,?10,"
+			"?11,?12,?13,?14,?15,?16)",
+	[FU_HISTORY_STMT_REMOVE_ALL_WITH_STATE] =
+		"DELETE FROM history WHERE update_state = ?1",
+	[FU_HISTORY_STMT_REMOVE_ALL] =
+		"DELETE FROM history;",
+	[FU_HISTORY_STMT_REMOVE_DEVICE] =
+		"DELETE FROM history WHERE device_id = ?1;",
+	[FU_HISTORY_STMT_GET_DEVICE_BY_ID] =
+		"SELECT device_id, "
+		       "checksum, "
+		       "plugin, "
+		       "device_created, "
+		       "device_modified, "
+		       "display_name, "
+		       "filename, "
+		       "flags, "
+		       "metadata, "
+		       "guid_default, "
+		       "update_state, "
+		       "update_error, "
+		       "version_new, "
+		       "version_old, "
+		       "checksum_device, "
+		       "protocol FROM history WHERE "
+		"device_id = ?1 ORDER BY device_created DESC "
+		"LIMIT 1",
+	[FU_HISTORY_STMT_GET_DEVICES] =
+		"SELECT device_id, "
+		       "checksum, "
+		       "plugin, "
+		       "device_created, "
+		       "device_modified, "
+		       "display_name, "
+		       "filename, "
+		       "flags, "
+		       "metadata, "
+		       "guid_default, "
+		       "update_state, "
+		       "update_error, "
+		       "version_new, "
+		       "version_old, "
+		       "checksum_device, "
+		       "protocol FROM history "
+		"ORDER BY device_modified ASC;",
+	[FU_HISTORY_STMT_GET_APPROVED_FIRMWARE] =
+		"SELECT checksum FROM approved_firmware;",
+	[FU_HISTORY_STMT_CLEAR_APPROVED_FIRMWARE] =
+		"DELETE FROM approved_firmware;",
+	[FU_HISTORY_STMT_ADD_APPROVED_FIRMWARE] =
+		"INSERT INTO approved_firmware (checksum) "
+		"VALUES (?1)",
+	[FU_HISTORY_STMT_GET_BLOCKED_FIRMWARE] =
+		"SELECT checksum FROM blocked_firmware;",
+	[FU_HISTORY_STMT_CLEAR_BLOCKED_FIRMWARE] =
+		"DELETE FROM blocked_firmware;",
+	[FU_HISTORY_STMT_ADD_BLOCKED_FIRMWARE] =
+		"INSERT INTO blocked_firmware (checksum) "
+		"VALUES (?1)",
+};
+
 struct _FuHistory
 {
 	GObject			 parent_instance;
 	sqlite3			*db;
+	sqlite3_stmt		*stmts[FU_HISTORY_STMT_LAST];
 	GRWLock			 db_mutex;
 };
 
 G_DEFINE_TYPE (FuHistory, fu_history, G_TYPE_OBJECT)
 
+/* a persistent statement that is reset when going out of scope -- the
+ * statements are shared, so always hold the writer lock and declare this after
+ * the locker so it is reset before unlocking */
+typedef sqlite3_stmt FuHistoryStmt;
+
+static void
+fu_history_stmt_release (FuHistoryStmt *stmt)
+{
+	sqlite3_reset (stmt);
+	sqlite3_clear_bindings (stmt);
+}
+
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wunused-function"
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(sqlite3_stmt, sqlite3_finalize);
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(FuHistoryStmt, fu_history_stmt_release);
 #pragma clang diagnostic pop
 
+static FuHistoryStmt *
+fu_history_get_stmt (FuHistory *self, FuHistoryStmtKind kind, GError **error)
+{
+	if (self->stmts[kind] == NULL) {
+		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
+			     "no prepared SQL for %s", fu_history_stmt_sql[kind]);
+		return NULL;
+	}
+	return self->stmts[kind];
+}
+
+static void
+fu_history_finalize_stmts (FuHistory *self)
+{
+	for (guint i = 0; i < FU_HISTORY_STMT_LAST; i++) {
+		if (self->stmts[i] == NULL)
+			continue;
+		sqlite3_finalize (self->stmts[i]);
+		self->stmts[i] = NULL;
+	}
+}
+
+static gboolean
+fu_history_prepare_stmts (FuHistory *self, GError **error)
+{
+	for (guint i = 0; i < FU_HISTORY_STMT_LAST; i++) {
+		gint rc = sqlite3_prepare_v2 (self->db,
+					      fu_history_stmt_sql[i], -1,
+					      &self->stmts[i], NULL);
+		if (rc != SQLITE_OK) {
+			g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
+				     "Failed to prepare SQL '%s': %s",
+				     fu_history_stmt_sql[i],
+				     sqlite3_errmsg (self->db));
+			fu_history_finalize_stmts (self);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
 static FuDevice *
 fu_history_device_from_stmt (sqlite3_stmt *stmt)
 {
@@ -381,11 +546,24 @@ fu_history_open (FuHistory *self, const gchar *filename, GError **error)
 			     FWUPD_ERROR_READ,
 			     "Can't open %s: %s",
 			     filename, sqlite3_errmsg (self->db));
+		sqlite3_close (self->db);
+		self->db = NULL;
 		return FALSE;
 	}
 
 	/* turn off the lookaside cache */
 	sqlite3_db_config (self->db, SQLITE_DBCONFIG_LOOKASIDE, NULL, 0, 0);
+
+	/* readers do not block the writer, and commits only need to append to
+	 * the log -- keep FULL as the pending record has to survive a reboot */
+	rc = sqlite3_exec (self->db,
+			   "PRAGMA journal_mode = WAL;"
+			   "PRAGMA synchronous = FULL;",
+			   NULL, NULL, NULL);
+	if (rc != SQLITE_OK) {
+		g_debug ("failed to set journal mode for %s: %s",
+			 filename, sqlite3_errmsg (self->db));
+	}
 	return TRUE;
 }
 
@@ -434,6 +612,7 @@ fu_history_load (FuHistory *self, GError **error)
 	/* create initial up-to-date database, or migrate */
 	g_debug ("got schema version of %u", schema_ver);
 	if (schema_ver != FU_HISTORY_CURRENT_SCHEMA_VERSION) {
+		const gchar *suffixes[] = { "-wal", "-shm", NULL };
 		g_autoptr(GError) error_migrate = NULL;
 		if (!fu_history_create_or_migrate (self, schema_ver, &error_migrate)) {
 			/* this is fatal to the daemon, so delete the database
@@ -441,6 +620,7 @@ fu_history_load (FuHistory *self, GError **error)
 			g_warning ("failed to migrate %s database: %s",
 				   filename, error_migrate->message);
 			sqlite3_close (self->db);
+			self->db = NULL;
 			if (g_unlink (filename) != 0) {
 				g_set_error (error,
 					     FWUPD_ERROR,
@@ -448,16 +628,119 @@ fu_history_load (FuHistory *self, GError **error)
 					     "Can't delete %s", filename);
 				return FALSE;
 			}
+			for (guint i = 0; suffixes[i] != NULL; i++) {
+				g_autofree gchar *fn = g_strconcat (filename, suffixes[i], NULL);
+				g_unlink (fn);
+			}
 			if (!fu_history_open (self, filename, error))
 				return FALSE;
-			return fu_history_create_database (self, error);
+			if (!fu_history_create_database (self, error))
+				return FALSE;
 		}
 	}
 
-	/* success */
+	/* only prepare once, and reset for each use; if this fails then try
+	 * loading again the next time rather than using a half-set-up object */
+	if (!fu_history_prepare_stmts (self, error)) {
+		sqlite3_close (self->db);
+		self->db = NULL;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * fu_history_start_transaction:
+ * @self: A #FuHistory
+ * @error: A #GError or NULL
+ *
+ * Starts a transaction so that multiple changes to the history database are
+ * only written to disk once when calling fu_history_commit_transaction().
+ *
+ * Returns: @TRUE if successful, @FALSE for failure
+ *
+ * Since: 1.5.2
+ **/
+gboolean
+fu_history_start_transaction (FuHistory *self, GError **error)
+{
+	gint rc;
+	g_autoptr(GRWLockWriterLocker) locker = NULL;
+
+	g_return_val_if_fail (FU_IS_HISTORY (self), FALSE);
+
+	/* lazy load */
+	if (!fu_history_load (self, error))
+		return FALSE;
+
+	locker = g_rw_lock_writer_locker_new (&self->db_mutex);
+	g_return_val_if_fail (locker != NULL, FALSE);
+	rc = sqlite3_exec (self->db, "BEGIN IMMEDIATE TRANSACTION;", NULL, NULL, NULL);
+	if (rc != SQLITE_OK) {
+		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_WRITE,
+			     "Failed to start transaction: %s",
+			     sqlite3_errmsg (self->db));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * fu_history_commit_transaction:
+ * @self: A #FuHistory
+ * @error: A #GError or NULL
+ *
+ * Commits the transaction started with fu_history_start_transaction().
+ *
+ * Returns: @TRUE if successful, @FALSE for failure
+ *
+ * Since: 1.5.2
+ **/
+gboolean
+fu_history_commit_transaction (FuHistory *self, GError **error)
+{
+	gint rc;
+	g_autoptr(GRWLockWriterLocker) locker = NULL;
+
+	g_return_val_if_fail (FU_IS_HISTORY (self), FALSE);
+	g_return_val_if_fail (self->db != NULL, FALSE);
+
+	locker = g_rw_lock_writer_locker_new (&self->db_mutex);
+	g_return_val_if_fail (locker != NULL, FALSE);
+	rc = sqlite3_exec (self->db, "COMMIT;", NULL, NULL, NULL);
+	if (rc != SQLITE_OK) {
+		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_WRITE,
+			     "Failed to commit transaction: %s",
+			     sqlite3_errmsg (self->db));
+		return FALSE;
+	}
 	return TRUE;
 }
 
+/**
+ * fu_history_rollback_transaction:
+ * @self: A #FuHistory
+ *
+ * Abandons the transaction started with fu_history_start_transaction().
+ *
+ * Since: 1.5.2
+ **/
+void
+fu_history_rollback_transaction (FuHistory *self)
+{
+	gint rc;
+	g_autoptr(GRWLockWriterLocker) locker = NULL;
+
+	g_return_if_fail (FU_IS_HISTORY (self));
+	g_return_if_fail (self->db != NULL);
+
+	locker = g_rw_lock_writer_locker_new (&self->db_mutex);
+	g_return_if_fail (locker != NULL);
+	rc = sqlite3_exec (self->db, "ROLLBACK;", NULL, NULL, NULL);
+	if (rc != SQLITE_OK)
+		g_warning ("failed to rollback transaction: %s", sqlite3_errmsg (self->db));
+}
+
 static gchar *
 _convert_hash_to_string (GHashTable *hash)
 {
@@ -498,9 +781,8 @@ fu_history_get_device_flags_filtered (FuDevice *device)
 gboolean
 fu_history_modify_device (FuHistory *self, FuDevice *device, GError **error)
 {
-	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
 	g_autoptr(GRWLockWriterLocker) locker = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail (FU_IS_HISTORY (self), FALSE);
 	g_return_val_if_fail (FU_IS_DEVICE (device), FALSE);
@@ -515,21 +797,9 @@ fu_history_modify_device (FuHistory *self, FuDevice *device, GError **error)
 	g_debug ("modifying device %s [%s]",
 		 fu_device_get_name (device),
 		 fu_device_get_id (device));
-	rc = sqlite3_prepare_v2 (self->db,
-				 "UPDATE history SET "
-				 "update_state = ?1, "
-				 "update_error = ?2, "
-				 "checksum_device = ?6, "
-				 "device_modified = ?7, "
-				 "flags = ?3 "
-				 "WHERE device_id = ?4;",
-				 -1, &stmt, NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
-			     "Failed to prepare SQL to update history: %s",
-			     sqlite3_errmsg (self->db));
+	stmt = fu_history_get_stmt (self, FU_HISTORY_STMT_MODIFY_DEVICE, error);
+	if (stmt == NULL)
 		return FALSE;
-	}
 
 	sqlite3_bind_int (stmt, 1, fu_device_get_update_state (device));
 	sqlite3_bind_text (stmt, 2, fu_device_get_update_error (device), -1, SQLITE_STATIC);
@@ -562,10 +832,9 @@ fu_history_set_device_metadata (FuHistory *self,
 				GHashTable *metadata,
 				GError **error)
 {
-	gint rc;
 	g_autofree gchar *metadata_str = NULL;
 	g_autoptr(GRWLockWriterLocker) locker = NULL;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail (FU_IS_HISTORY (self), FALSE);
 	g_return_val_if_fail (device_id != NULL, FALSE);
@@ -578,17 +847,9 @@ fu_history_set_device_metadata (FuHistory *self,
 	locker = g_rw_lock_writer_locker_new (&self->db_mutex);
 	g_return_val_if_fail (locker != NULL, FALSE);
 	g_debug ("modifying %s", device_id);
-	rc = sqlite3_prepare_v2 (self->db,
-				 "UPDATE history SET "
-				 "metadata = ?1 "
-				 "WHERE device_id = ?2;",
-				 -1, &stmt, NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
-			     "failed to prepare SQL to update history: %s",
-			     sqlite3_errmsg (self->db));
+	stmt = fu_history_get_stmt (self, FU_HISTORY_STMT_SET_DEVICE_METADATA, error);
+	if (stmt == NULL)
 		return FALSE;
-	}
 
 
 	/* metadata is stored as a simple string */
@@ -617,10 +878,9 @@ fu_history_add_device (FuHistory *self, FuDevice *device, FwupdRelease *release,
 {
 	const gchar *checksum_device;
 	const gchar *checksum = NULL;
-	gint rc;
 	g_autofree gchar *metadata = NULL;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
 	g_autoptr(GRWLockWriterLocker) locker = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail (FU_IS_HISTORY (self), FALSE);
 	g_return_val_if_fail (FU_IS_DEVICE (device), FALSE);
@@ -649,31 +909,9 @@ fu_history_add_device (FuHistory *self, FuDevice *device, FwupdRelease *release,
 	/* add */
 	locker = g_rw_lock_writer_locker_new (&self->db_mutex);
 	g_return_val_if_fail (locker != NULL, FALSE);
-	rc = sqlite3_prepare_v2 (self->db,
-				 "INSERT INTO history (device_id,"
-						      "update_state,"
-						      "update_error,"
-						      "flags,"
-						      "filename,"
-						      "checksum,"
-						      "display_name,"
-						      "plugin,"
-						      "guid_default,"
-						      "metadata,"
-						      "device_created,"
-						      "device_modified,"
-						      "version_old,"
-						      "version_new,"
-						      "checksum_device,"
-						      "protocol) "
-				 "VALUES (?1,?2,?3,?4,?5,?6,?7,?8,?9,?10,"
-					 "?11,?12,?13,?14,?15,?16)", -1, &stmt, NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
-			     "Failed to prepare SQL to insert history: %s",
-			     sqlite3_errmsg (self->db));
+	stmt = fu_history_get_stmt (self, FU_HISTORY_STMT_ADD_DEVICE, error);
+	if (stmt == NULL)
 		return FALSE;
-	}
 	sqlite3_bind_text (stmt, 1, fu_device_get_id (device), -1, SQLITE_STATIC);
 	sqlite3_bind_int (stmt, 2, fu_device_get_update_state (device));
 	sqlite3_bind_text (stmt, 3, fu_device_get_update_error (device), -1, SQLITE_STATIC);
@@ -711,9 +949,8 @@ fu_history_remove_all_with_state (FuHistory *self,
 				  FwupdUpdateState update_state,
 				  GError **error)
 {
-	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
 	g_autoptr(GRWLockWriterLocker) locker = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail (FU_IS_HISTORY (self), FALSE);
 
@@ -726,15 +963,9 @@ fu_history_remove_all_with_state (FuHistory *self,
 	g_return_val_if_fail (locker != NULL, FALSE);
 	g_debug ("removing all devices with update_state %s",
 		 fwupd_update_state_to_string (update_state));
-	rc = sqlite3_prepare_v2 (self->db,
-				 "DELETE FROM history WHERE update_state = ?1",
-				 -1, &stmt, NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
-			     "Failed to prepare SQL to delete history: %s",
-			     sqlite3_errmsg (self->db));
+	stmt = fu_history_get_stmt (self, FU_HISTORY_STMT_REMOVE_ALL_WITH_STATE, error);
+	if (stmt == NULL)
 		return FALSE;
-	}
 	sqlite3_bind_int (stmt, 1, update_state);
 	return fu_history_stmt_exec (self, stmt, NULL, error);
 }
@@ -753,9 +984,8 @@ fu_history_remove_all_with_state (FuHistory *self,
 gboolean
 fu_history_remove_all (FuHistory *self, GError **error)
 {
-	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
 	g_autoptr(GRWLockWriterLocker) locker = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail (FU_IS_HISTORY (self), FALSE);
 
@@ -767,13 +997,9 @@ fu_history_remove_all (FuHistory *self, GError **error)
 	locker = g_rw_lock_writer_locker_new (&self->db_mutex);
 	g_return_val_if_fail (locker != NULL, FALSE);
 	g_debug ("removing all devices");
-	rc = sqlite3_prepare_v2 (self->db, "DELETE FROM history;", -1, &stmt, NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
-			     "Failed to prepare SQL to delete history: %s",
-			     sqlite3_errmsg (self->db));
+	stmt = fu_history_get_stmt (self, FU_HISTORY_STMT_REMOVE_ALL, error);
+	if (stmt == NULL)
 		return FALSE;
-	}
 	return fu_history_stmt_exec (self, stmt, NULL, error);
 }
 
@@ -792,9 +1018,8 @@ fu_history_remove_all (FuHistory *self, GError **error)
 gboolean
 fu_history_remove_device (FuHistory *self,  FuDevice *device, GError **error)
 {
-	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
 	g_autoptr(GRWLockWriterLocker) locker = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail (FU_IS_HISTORY (self), FALSE);
 	g_return_val_if_fail (FU_IS_DEVICE (device), FALSE);
@@ -808,15 +1033,9 @@ fu_history_remove_device (FuHistory *self,  FuDevice *device, GError **error)
 	g_debug ("remove device %s [%s]",
 		 fu_device_get_name (device),
 		 fu_device_get_id (device));
-	rc = sqlite3_prepare_v2 (self->db,
-				 "DELETE FROM history WHERE device_id = ?1;",
-				 -1, &stmt, NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
-			     "Failed to prepare SQL to delete history: %s",
-			     sqlite3_errmsg (self->db));
+	stmt = fu_history_get_stmt (self, FU_HISTORY_STMT_REMOVE_DEVICE, error);
+	if (stmt == NULL)
 		return FALSE;
-	}
 	sqlite3_bind_text (stmt, 1, fu_device_get_id (device), -1, SQLITE_STATIC);
 	return fu_history_stmt_exec (self, stmt, NULL, error);
 }
@@ -837,10 +1056,9 @@ fu_history_remove_device (FuHistory *self,  FuDevice *device, GError **error)
 FuDevice *
 fu_history_get_device_by_id (FuHistory *self, const gchar *device_id, GError **error)
 {
-	gint rc;
 	g_autoptr(GPtrArray) array_tmp = NULL;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
-	g_autoptr(GRWLockReaderLocker) locker = NULL;
+	g_autoptr(GRWLockWriterLocker) locker = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail (FU_IS_HISTORY (self), NULL);
 	g_return_val_if_fail (device_id != NULL, NULL);
@@ -850,33 +1068,11 @@ fu_history_get_device_by_id (FuHistory *self, const gchar *device_id, GError **e
 		return NULL;
 
 	/* get all the devices */
-	locker = g_rw_lock_reader_locker_new (&self->db_mutex);
+	locker = g_rw_lock_writer_locker_new (&self->db_mutex);
 	g_return_val_if_fail (locker != NULL, NULL);
-	rc = sqlite3_prepare_v2 (self->db,
-				 "SELECT device_id, "
-					"checksum, "
-					"plugin, "
-					"device_created, "
-					"device_modified, "
-					"display_name, "
-					"filename, "
-					"flags, "
-					"metadata, "
-					"guid_default, "
-					"update_state, "
-					"update_error, "
-					"version_new, "
-					"version_old, "
-					"checksum_device, "
-					"protocol FROM history WHERE "
-				 "device_id = ?1 ORDER BY device_created DESC "
-				 "LIMIT 1", -1, &stmt, NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
-			     "Failed to prepare SQL to get history: %s",
-			     sqlite3_errmsg (self->db));
+	stmt = fu_history_get_stmt (self, FU_HISTORY_STMT_GET_DEVICE_BY_ID, error);
+	if (stmt == NULL)
 		return NULL;
-	}
 	sqlite3_bind_text (stmt, 1, device_id, -1, SQLITE_STATIC);
 	array_tmp = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
 	if (!fu_history_stmt_exec (self, stmt, array_tmp, error))
@@ -905,10 +1101,9 @@ GPtrArray *
 fu_history_get_devices (FuHistory *self, GError **error)
 {
 	GPtrArray *array = NULL;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
-	gint rc;
 	g_autoptr(GPtrArray) array_tmp = NULL;
-	g_autoptr(GRWLockReaderLocker) locker = NULL;
+	g_autoptr(GRWLockWriterLocker) locker = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail (FU_IS_HISTORY (self), NULL);
 
@@ -919,33 +1114,11 @@ fu_history_get_devices (FuHistory *self, GError **error)
 	}
 
 	/* get all the devices */
-	locker = g_rw_lock_reader_locker_new (&self->db_mutex);
+	locker = g_rw_lock_writer_locker_new (&self->db_mutex);
 	g_return_val_if_fail (locker != NULL, NULL);
-	rc = sqlite3_prepare_v2 (self->db,
-				 "SELECT device_id, "
-					"checksum, "
-					"plugin, "
-					"device_created, "
-					"device_modified, "
-					"display_name, "
-					"filename, "
-					"flags, "
-					"metadata, "
-					"guid_default, "
-					"update_state, "
-					"update_error, "
-					"version_new, "
-					"version_old, "
-					"checksum_device, "
-					"protocol FROM history "
-					"ORDER BY device_modified ASC;",
-					-1, &stmt, NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
-			     "Failed to prepare SQL to get history: %s",
-			     sqlite3_errmsg (self->db));
+	stmt = fu_history_get_stmt (self, FU_HISTORY_STMT_GET_DEVICES, error);
+	if (stmt == NULL)
 		return NULL;
-	}
 	array_tmp = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
 	if (!fu_history_stmt_exec (self, stmt, array_tmp, error))
 		return NULL;
@@ -968,9 +1141,9 @@ GPtrArray *
 fu_history_get_approved_firmware (FuHistory *self, GError **error)
 {
 	gint rc;
-	g_autoptr(GRWLockReaderLocker) locker = NULL;
+	g_autoptr(GRWLockWriterLocker) locker = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 	g_autoptr(GPtrArray) array = NULL;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
 
 	g_return_val_if_fail (FU_IS_HISTORY (self), NULL);
 
@@ -981,17 +1154,11 @@ fu_history_get_approved_firmware (FuHistory *self, GError **error)
 	}
 
 	/* get all the approved firmware */
-	locker = g_rw_lock_reader_locker_new (&self->db_mutex);
+	locker = g_rw_lock_writer_locker_new (&self->db_mutex);
 	g_return_val_if_fail (locker != NULL, NULL);
-	rc = sqlite3_prepare_v2 (self->db,
-				 "SELECT checksum FROM approved_firmware;",
-				 -1, &stmt, NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
-			     "Failed to prepare SQL to get checksum: %s",
-			     sqlite3_errmsg (self->db));
+	stmt = fu_history_get_stmt (self, FU_HISTORY_STMT_GET_APPROVED_FIRMWARE, error);
+	if (stmt == NULL)
 		return NULL;
-	}
 	array = g_ptr_array_new_with_free_func (g_free);
 	while ((rc = sqlite3_step (stmt)) == SQLITE_ROW) {
 		const gchar *tmp = (const gchar *) sqlite3_column_text (stmt, 0);
@@ -1020,9 +1187,8 @@ fu_history_get_approved_firmware (FuHistory *self, GError **error)
 gboolean
 fu_history_clear_approved_firmware (FuHistory *self, GError **error)
 {
-	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
 	g_autoptr(GRWLockWriterLocker) locker = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail (FU_IS_HISTORY (self), FALSE);
 
@@ -1033,15 +1199,9 @@ fu_history_clear_approved_firmware (FuHistory *self, GError **error)
 	/* remove entries */
 	locker = g_rw_lock_writer_locker_new (&self->db_mutex);
 	g_return_val_if_fail (locker != NULL, FALSE);
-	rc = sqlite3_prepare_v2 (self->db,
-				 "DELETE FROM approved_firmware;",
-				 -1, &stmt, NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
-			     "Failed to prepare SQL to delete approved firmware: %s",
-			     sqlite3_errmsg (self->db));
+	stmt = fu_history_get_stmt (self, FU_HISTORY_STMT_CLEAR_APPROVED_FIRMWARE, error);
+	if (stmt == NULL)
 		return FALSE;
-	}
 	return fu_history_stmt_exec (self, stmt, NULL, error);
 }
 
@@ -1062,9 +1222,8 @@ fu_history_add_approved_firmware (FuHistory *self,
 				  const gchar *checksum,
 				  GError **error)
 {
-	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
 	g_autoptr(GRWLockWriterLocker) locker = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail (FU_IS_HISTORY (self), FALSE);
 	g_return_val_if_fail (checksum != NULL, FALSE);
@@ -1076,15 +1235,9 @@ fu_history_add_approved_firmware (FuHistory *self,
 	/* add */
 	locker = g_rw_lock_writer_locker_new (&self->db_mutex);
 	g_return_val_if_fail (locker != NULL, FALSE);
-	rc = sqlite3_prepare_v2 (self->db,
-				 "INSERT INTO approved_firmware (checksum) "
-				 "VALUES (?1)", -1, &stmt, NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
-			     "Failed to prepare SQL to insert checksum: %s",
-			     sqlite3_errmsg (self->db));
+	stmt = fu_history_get_stmt (self, FU_HISTORY_STMT_ADD_APPROVED_FIRMWARE, error);
+	if (stmt == NULL)
 		return FALSE;
-	}
 	sqlite3_bind_text (stmt, 1, checksum, -1, SQLITE_STATIC);
 	return fu_history_stmt_exec (self, stmt, NULL, error);
 }
@@ -1103,9 +1256,9 @@ GPtrArray *
 fu_history_get_blocked_firmware (FuHistory *self, GError **error)
 {
 	gint rc;
-	g_autoptr(GRWLockReaderLocker) locker = NULL;
+	g_autoptr(GRWLockWriterLocker) locker = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 	g_autoptr(GPtrArray) array = NULL;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
 
 	g_return_val_if_fail (FU_IS_HISTORY (self), NULL);
 
@@ -1116,17 +1269,11 @@ fu_history_get_blocked_firmware (FuHistory *self, GError **error)
 	}
 
 	/* get all the blocked firmware */
-	locker = g_rw_lock_reader_locker_new (&self->db_mutex);
+	locker = g_rw_lock_writer_locker_new (&self->db_mutex);
 	g_return_val_if_fail (locker != NULL, NULL);
-	rc = sqlite3_prepare_v2 (self->db,
-				 "SELECT checksum FROM blocked_firmware;",
-				 -1, &stmt, NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
-			     "Failed to prepare SQL to get checksum: %s",
-			     sqlite3_errmsg (self->db));
+	stmt = fu_history_get_stmt (self, FU_HISTORY_STMT_GET_BLOCKED_FIRMWARE, error);
+	if (stmt == NULL)
 		return NULL;
-	}
 	array = g_ptr_array_new_with_free_func (g_free);
 	while ((rc = sqlite3_step (stmt)) == SQLITE_ROW) {
 		const gchar *tmp = (const gchar *) sqlite3_column_text (stmt, 0);
@@ -1155,9 +1302,8 @@ fu_history_get_blocked_firmware (FuHistory *self, GError **error)
 gboolean
 fu_history_clear_blocked_firmware (FuHistory *self, GError **error)
 {
-	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
 	g_autoptr(GRWLockWriterLocker) locker = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail (FU_IS_HISTORY (self), FALSE);
 
@@ -1168,15 +1314,9 @@ fu_history_clear_blocked_firmware (FuHistory *self, GError **error)
 	/* remove entries */
 	locker = g_rw_lock_writer_locker_new (&self->db_mutex);
 	g_return_val_if_fail (locker != NULL, FALSE);
-	rc = sqlite3_prepare_v2 (self->db,
-				 "DELETE FROM blocked_firmware;",
-				 -1, &stmt, NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
-			     "Failed to prepare SQL to delete blocked firmware: %s",
-			     sqlite3_errmsg (self->db));
+	stmt = fu_history_get_stmt (self, FU_HISTORY_STMT_CLEAR_BLOCKED_FIRMWARE, error);
+	if (stmt == NULL)
 		return FALSE;
-	}
 	return fu_history_stmt_exec (self, stmt, NULL, error);
 }
 
@@ -1195,9 +1335,8 @@ fu_history_clear_blocked_firmware (FuHistory *self, GError **error)
 gboolean
 fu_history_add_blocked_firmware (FuHistory *self, const gchar *checksum, GError **error)
 {
-	gint rc;
-	g_autoptr(sqlite3_stmt) stmt = NULL;
 	g_autoptr(GRWLockWriterLocker) locker = NULL;
+	g_autoptr(FuHistoryStmt) stmt = NULL;
 
 	g_return_val_if_fail (FU_IS_HISTORY (self), FALSE);
 	g_return_val_if_fail (checksum != NULL, FALSE);
@@ -1209,15 +1348,9 @@ fu_history_add_blocked_firmware (FuHistory *self, const gchar *checksum, GError
 	/* add */
 	locker = g_rw_lock_writer_locker_new (&self->db_mutex);
 	g_return_val_if_fail (locker != NULL, FALSE);
-	rc = sqlite3_prepare_v2 (self->db,
-				 "INSERT INTO blocked_firmware (checksum) "
-				 "VALUES (?1)", -1, &stmt, NULL);
-	if (rc != SQLITE_OK) {
-		g_set_error (error, FWUPD_ERROR, FWUPD_ERROR_INTERNAL,
-			     "Failed to prepare SQL to insert checksum: %s",
-			     sqlite3_errmsg (self->db));
+	stmt = fu_history_get_stmt (self, FU_HISTORY_STMT_ADD_BLOCKED_FIRMWARE, error);
+	if (stmt == NULL)
 		return FALSE;
-	}
 	sqlite3_bind_text (stmt, 1, checksum, -1, SQLITE_STATIC);
 	return fu_history_stmt_exec (self, stmt, NULL, error);
 }
@@ -1242,6 +1375,7 @@ fu_history_finalize (GObject *object)
 
 	g_rw_lock_clear (&self->db_mutex);
 
+	fu_history_finalize_stmts (self);
 	if (self->db != NULL)
 		sqlite3_close (self->db);
 
@@ -39,6 +39,11 @@ FuDevice	*fu_history_get_device_by_id		(FuHistory	*self,
 							 GError		**error);
 GPtrArray	*fu_history_get_devices			(FuHistory	*self,
 							 GError		**error);
+gboolean	 fu_history_start_transaction		(FuHistory	*self,
+							 GError		**error);
+gboolean	 fu_history_commit_transaction		(FuHistory	*self,
+							 GError		**error);
+void		 fu_history_rollback_transaction	(FuHistory	*self);
 
 gboolean	 fu_history_clear_approved_firmware	(FuHistory	*self,
 							 GError		**error);
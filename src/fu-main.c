@@ -272,8 +272,9 @@ fu_main_device_array_to_variant (FuMainPrivate *priv, FuEngineRequest *request,
 
 	for (guint i = 0; i < devices->len; i++) {
 		FuDevice *device = g_ptr_array_index (devices, i);
-		GVariant *tmp = fwupd_device_to_variant_full (FWUPD_DEVICE (device),
-							      fu_engine_request_get_device_flags (request));
+		g_autoptr(GVariant) tmp = NULL;
+		tmp = fwupd_device_to_variant_cached (FWUPD_DEVICE (device),
+						      fu_engine_request_get_device_flags (request));
 		g_variant_builder_add_value (&builder, tmp);
 	}
 	return g_variant_new ("(aa{sv})", &builder);
@@ -309,6 +310,31 @@ fu_main_release_array_to_variant (GPtrArray *results)
 	return g_variant_new ("(aa{sv})", &builder);
 }
 
+static GVariant *
+fu_main_release_map_to_variant (GHashTable *results)
+{
+	GHashTableIter iter;
+	GVariantBuilder builder;
+	const gchar *device_id;
+	GPtrArray *releases;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{saa{sv}}"));
+	g_hash_table_iter_init (&iter, results);
+	while (g_hash_table_iter_next (&iter,
+				       (gpointer *) &device_id,
+				       (gpointer *) &releases)) {
+		GVariantBuilder builder_rels;
+		g_variant_builder_init (&builder_rels, G_VARIANT_TYPE ("aa{sv}"));
+		for (guint i = 0; i < releases->len; i++) {
+			FwupdRelease *rel = g_ptr_array_index (releases, i);
+			g_variant_builder_add_value (&builder_rels,
+						     fwupd_release_to_variant (rel));
+		}
+		g_variant_builder_add (&builder, "{saa{sv}}", device_id, &builder_rels);
+	}
+	return g_variant_new ("(a{saa{sv}})", &builder);
+}
+
 static GVariant *
 fu_main_remote_array_to_variant (GPtrArray *remotes)
 {
@@ -992,6 +1018,13 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 		g_dbus_method_invocation_return_value (invocation, val);
 		return;
 	}
+	if (g_strcmp0 (method_name, "GetStartupProfile") == 0) {
+		g_debug ("Called %s()", method_name);
+		val = fu_engine_get_startup_profile (priv->engine);
+		g_dbus_method_invocation_return_value (invocation,
+						       g_variant_new_tuple (&val, 1));
+		return;
+	}
 	if (g_strcmp0 (method_name, "GetReleases") == 0) {
 		const gchar *device_id;
 		g_autoptr(GPtrArray) releases = NULL;
@@ -1212,6 +1245,30 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 		g_dbus_method_invocation_return_value (invocation, val);
 		return;
 	}
+	if (g_strcmp0 (method_name, "GetReleasesAll") == 0) {
+		g_autoptr(GHashTable) results = NULL;
+		g_debug ("Called %s()", method_name);
+		results = fu_engine_get_releases_all (priv->engine, request, &error);
+		if (results == NULL) {
+			g_dbus_method_invocation_return_gerror (invocation, error);
+			return;
+		}
+		val = fu_main_release_map_to_variant (results);
+		g_dbus_method_invocation_return_value (invocation, val);
+		return;
+	}
+	if (g_strcmp0 (method_name, "GetUpgradesAll") == 0) {
+		g_autoptr(GHashTable) results = NULL;
+		g_debug ("Called %s()", method_name);
+		results = fu_engine_get_upgrades_all (priv->engine, request, &error);
+		if (results == NULL) {
+			g_dbus_method_invocation_return_gerror (invocation, error);
+			return;
+		}
+		val = fu_main_release_map_to_variant (results);
+		g_dbus_method_invocation_return_value (invocation, val);
+		return;
+	}
 	if (g_strcmp0 (method_name, "GetRemotes") == 0) {
 		g_autoptr(GPtrArray) remotes = NULL;
 		g_debug ("Called %s()", method_name);
@@ -1563,6 +1620,12 @@ fu_main_daemon_method_call (GDBusConnection *connection, const gchar *sender,
 			return;
 		}
 
+		/* the main loop is running while devices are updated */
+		if (!fu_engine_check_not_installing (priv->engine, &error)) {
+			g_dbus_method_invocation_return_gerror (invocation, error);
+			return;
+		}
+
 		/* create helper object */
 		helper = g_new0 (FuMainAuthHelper, 1);
 		helper->request = g_steal_pointer (&request);
@@ -33,6 +33,7 @@ struct _FuPluginList
 	GObject			 parent_instance;
 	GPtrArray		*plugins;		/* of FuPlugin */
 	GHashTable		*plugins_hash;		/* of name : FuPlugin */
+	GPtrArray		*plugins_vfunc[FU_PLUGIN_VFUNC_LAST]; /* (nullable): of FuPlugin */
 };
 
 G_DEFINE_TYPE (FuPluginList, fu_plugin_list, G_TYPE_OBJECT)
@@ -54,6 +55,45 @@ fu_plugin_list_get_all (FuPluginList *self)
 	return self->plugins;
 }
 
+static void
+fu_plugin_list_invalidate_vfuncs (FuPluginList *self)
+{
+	for (guint i = 0; i < FU_PLUGIN_VFUNC_LAST; i++)
+		g_clear_pointer (&self->plugins_vfunc[i], g_ptr_array_unref);
+}
+
+/**
+ * fu_plugin_list_get_all_by_vfunc:
+ * @self: A #FuPluginList
+ * @vfunc: A #FuPluginVfunc, e.g. %FU_PLUGIN_VFUNC_DEVICE_REGISTERED
+ *
+ * Gets all the plugins that implement a specific vfunc, in the same order as
+ * fu_plugin_list_get_all(). This allows the caller to skip plugins that would
+ * do nothing when the runner is called.
+ *
+ * Returns: (transfer none) (element-type FuPlugin): the plugins
+ *
+ * Since: 1.5.2
+ **/
+GPtrArray *
+fu_plugin_list_get_all_by_vfunc (FuPluginList *self, FuPluginVfunc vfunc)
+{
+	g_return_val_if_fail (FU_IS_PLUGIN_LIST (self), NULL);
+	g_return_val_if_fail (vfunc < FU_PLUGIN_VFUNC_LAST, NULL);
+
+	/* build on demand, and invalidated when the list changes */
+	if (self->plugins_vfunc[vfunc] == NULL) {
+		GPtrArray *plugins = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+		for (guint i = 0; i < self->plugins->len; i++) {
+			FuPlugin *plugin = g_ptr_array_index (self->plugins, i);
+			if (fu_plugin_has_vfunc (plugin, vfunc))
+				g_ptr_array_add (plugins, g_object_ref (plugin));
+		}
+		self->plugins_vfunc[vfunc] = plugins;
+	}
+	return self->plugins_vfunc[vfunc];
+}
+
 /**
  * fu_plugin_list_add:
  * @self: A #FuPluginList
@@ -74,6 +114,7 @@ fu_plugin_list_add (FuPluginList *self, FuPlugin *plugin)
 	g_hash_table_insert (self->plugins_hash,
 			     g_strdup (fu_plugin_get_name (plugin)),
 			     g_object_ref (plugin));
+	fu_plugin_list_invalidate_vfuncs (self);
 }
 
 /**
@@ -269,6 +310,7 @@ fu_plugin_list_depsolve (FuPluginList *self, GError **error)
 
 	/* sort by order */
 	g_ptr_array_sort (self->plugins, fu_plugin_list_sort_cb);
+	fu_plugin_list_invalidate_vfuncs (self);
 	return TRUE;
 }
 
@@ -292,6 +334,7 @@ fu_plugin_list_finalize (GObject *obj)
 {
 	FuPluginList *self = FU_PLUGIN_LIST (obj);
 
+	fu_plugin_list_invalidate_vfuncs (self);
 	g_ptr_array_unref (self->plugins);
 	g_hash_table_unref (self->plugins_hash);
 
@@ -8,7 +8,7 @@
 
 #include <glib-object.h>
 
-#include "fu-plugin.h"
+#include "fu-plugin-private.h"
 
 #define FU_TYPE_PLUGIN_LIST (fu_plugin_list_get_type ())
 G_DECLARE_FINAL_TYPE (FuPluginList, fu_plugin_list, FU, PLUGIN_LIST, GObject)
@@ -17,6 +17,8 @@ FuPluginList	*fu_plugin_list_new			(void);
 void		 fu_plugin_list_add			(FuPluginList	*self,
 							 FuPlugin	*plugin);
 GPtrArray	*fu_plugin_list_get_all			(FuPluginList	*self);
+GPtrArray	*fu_plugin_list_get_all_by_vfunc	(FuPluginList	*self,
+							 FuPluginVfunc	 vfunc);
 FuPlugin	*fu_plugin_list_find_by_name		(FuPluginList	*self,
 							 const gchar	*name,
 							 GError		**error);
@@ -28,6 +28,7 @@
 #include "fu-security-attr.h"
 #include "fu-security-attrs.h"
 #include "fu-smbios-private.h"
+#include "fu-uevent-batch.h"
 
 typedef struct {
 	FuPlugin	*plugin;
@@ -1272,15 +1273,18 @@ static void
 fu_engine_downgrade_func (gconstpointer user_data)
 {
 	FwupdRelease *rel;
+	GPtrArray *releases_tmp;
 	gboolean ret;
 	g_autoptr(FuDevice) device = fu_device_new ();
 	g_autoptr(FuEngine) engine = fu_engine_new (FU_APP_FLAGS_NONE);
 	g_autoptr(FuEngineRequest) request = fu_engine_request_new ();
 	g_autoptr(GError) error = NULL;
+	g_autoptr(GHashTable) upgrades_all = NULL;
 	g_autoptr(GPtrArray) devices = NULL;
 	g_autoptr(GPtrArray) devices_pre = NULL;
 	g_autoptr(GPtrArray) releases_dg = NULL;
 	g_autoptr(GPtrArray) releases = NULL;
+	g_autoptr(GPtrArray) releases_cached = NULL;
 	g_autoptr(GPtrArray) releases_up = NULL;
 	g_autoptr(GPtrArray) remotes = NULL;
 	g_autoptr(XbSilo) silo_empty = xb_silo_new ();
@@ -1407,6 +1411,17 @@ fu_engine_downgrade_func (gconstpointer user_data)
 	g_assert (releases != NULL);
 	g_assert_cmpint (releases->len, ==, 4);
 
+	/* the second lookup is served from the cache */
+	releases_cached = fu_engine_get_releases (engine,
+						  request,
+						  fu_device_get_id (device),
+						  &error);
+	g_assert_no_error (error);
+	g_assert (releases_cached != NULL);
+	g_assert (releases_cached != releases);
+	g_assert_cmpint (releases_cached->len, ==, 4);
+	g_assert (g_ptr_array_index (releases_cached, 0) == g_ptr_array_index (releases, 0));
+
 	/* no upgrades, as no firmware is approved */
 	releases_up = fu_engine_get_upgrades (engine,
 					      request,
@@ -1435,6 +1450,15 @@ fu_engine_downgrade_func (gconstpointer user_data)
 	rel = FWUPD_RELEASE (g_ptr_array_index (releases_up, 1));
 	g_assert_cmpstr (fwupd_release_get_version (rel), ==, "1.2.4");
 
+	/* upgrades for all devices at once */
+	upgrades_all = fu_engine_get_upgrades_all (engine, request, &error);
+	g_assert_no_error (error);
+	g_assert (upgrades_all != NULL);
+	g_assert_cmpint (g_hash_table_size (upgrades_all), ==, 1);
+	releases_tmp = g_hash_table_lookup (upgrades_all, fu_device_get_id (device));
+	g_assert (releases_tmp != NULL);
+	g_assert_cmpint (releases_tmp->len, ==, 2);
+
 	/* downgrades */
 	releases_dg = fu_engine_get_downgrades (engine,
 						request,
@@ -1523,6 +1547,439 @@ fu_engine_install_duration_func (gconstpointer user_data)
 	g_assert_cmpint (fwupd_release_get_install_duration (rel), ==, 120);
 }
 
+static void
+fu_engine_startup_profile_func (gconstpointer user_data)
+{
+	gboolean ret;
+	guint duration;
+	guint64 duration_tmp;
+	const gchar *id_tmp;
+	gboolean found_phase = FALSE;
+	gboolean found_plugin = FALSE;
+	GVariantIter iter;
+	g_autofree gchar *pluginfn = NULL;
+	g_autoptr(FuEngine) engine = fu_engine_new (FU_APP_FLAGS_NONE);
+	g_autoptr(FuPlugin) plugin = fu_plugin_new ();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GVariant) profile = NULL;
+	g_autoptr(XbSilo) silo_empty = xb_silo_new ();
+
+	/* ensure empty tree */
+	fu_self_test_mkroot ();
+
+	/* use a new plugin so that no other test has run the vfuncs */
+	pluginfn = g_build_filename (PLUGINBUILDDIR,
+				     "libfu_plugin_test." G_MODULE_SUFFIX,
+				     NULL);
+	ret = fu_plugin_open (plugin, pluginfn, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (fu_plugin_get_runner_duration (plugin, "coldplug"), ==, 0);
+
+	/* no metadata in daemon */
+	fu_engine_set_silo (engine, silo_empty);
+	fu_engine_add_plugin (engine, plugin);
+	g_setenv ("CONFIGURATION_DIRECTORY", TESTDATADIR_SRC, TRUE);
+	ret = fu_engine_load (engine, FU_ENGINE_LOAD_FLAG_NO_ENUMERATE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+
+	/* loading without enumerating does not coldplug the plugins */
+	g_assert_cmpint (fu_plugin_get_runner_duration (plugin, "coldplug"), ==, 0);
+	ret = fu_plugin_runner_coldplug (plugin, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+
+	/* both the engine phases and the plugin vfuncs are listed */
+	duration = fu_plugin_get_runner_duration (plugin, "coldplug");
+	g_assert_cmpint (duration, >, 0);
+	profile = g_variant_ref_sink (fu_engine_get_startup_profile (engine));
+	g_variant_iter_init (&iter, profile);
+	while (g_variant_iter_next (&iter, "(&st)", &id_tmp, &duration_tmp)) {
+		if (g_strcmp0 (id_tmp, "plugins-coldplug") == 0)
+			found_phase = TRUE;
+		if (g_strcmp0 (id_tmp, "coldplug(test)") == 0) {
+			g_assert_cmpint (duration_tmp, ==, duration);
+			found_plugin = TRUE;
+		}
+	}
+	g_assert_true (found_phase);
+	g_assert_true (found_plugin);
+
+	/* running coldplug again does not replace the startup value */
+	ret = fu_plugin_runner_coldplug (plugin, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpint (fu_plugin_get_runner_duration (plugin, "coldplug"), ==, duration);
+}
+
+static const gchar *
+fu_engine_security_attrs_get_test_queries (FuEngine *engine)
+{
+	g_autoptr(FuSecurityAttrs) attrs = fu_engine_get_host_security_attrs (engine);
+	g_autoptr(GPtrArray) items = fu_security_attrs_get_all (attrs);
+	for (guint i = 0; i < items->len; i++) {
+		FwupdSecurityAttr *attr = g_ptr_array_index (items, i);
+		if (g_strcmp0 (fwupd_security_attr_get_appstream_id (attr), "org.fwupd.hsi.Test") == 0)
+			return fwupd_security_attr_get_metadata (attr, "nr-queries");
+	}
+	return NULL;
+}
+
+static void
+fu_engine_security_attrs_cache_func (gconstpointer user_data)
+{
+	gboolean ret;
+	g_autofree gchar *pluginfn = NULL;
+	g_autoptr(FuDevice) device1 = fu_device_new ();
+	g_autoptr(FuDevice) device2 = fu_device_new ();
+	g_autoptr(FuEngine) engine = fu_engine_new (FU_APP_FLAGS_NONE);
+	g_autoptr(FuPlugin) plugin = fu_plugin_new ();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(XbSilo) silo_empty = xb_silo_new ();
+
+	/* ensure empty tree */
+	fu_self_test_mkroot ();
+
+	/* use a new plugin so that the number of queries starts at zero */
+	pluginfn = g_build_filename (PLUGINBUILDDIR,
+				     "libfu_plugin_test." G_MODULE_SUFFIX,
+				     NULL);
+	ret = fu_plugin_open (plugin, pluginfn, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+
+	/* no metadata in daemon */
+	fu_engine_set_silo (engine, silo_empty);
+	fu_engine_add_plugin (engine, plugin);
+	g_setenv ("CONFIGURATION_DIRECTORY", TESTDATADIR_SRC, TRUE);
+	ret = fu_engine_load (engine, FU_ENGINE_LOAD_FLAG_NO_ENUMERATE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+
+	fu_device_set_id (device1, "other_device");
+	fu_device_set_plugin (device1, "other");
+	fu_device_add_guid (device1, "12345678-1234-1234-1234-123456789012");
+	fu_engine_add_device (engine, device1);
+	fu_device_set_id (device2, "test_device");
+	fu_device_set_plugin (device2, "test");
+	fu_device_add_guid (device2, "b585990a-003e-5270-89d5-3705a17f9a43");
+	fu_engine_add_device (engine, device2);
+
+	/* queried the first time */
+	g_setenv ("FWUPD_PLUGIN_TEST", "security-attrs", TRUE);
+	g_assert_cmpstr (fu_engine_security_attrs_get_test_queries (engine), ==, "1");
+
+	/* a device from another plugin changing does not query the plugin again */
+	fu_device_set_status (device1, FWUPD_STATUS_DEVICE_BUSY);
+	g_assert_cmpstr (fu_engine_security_attrs_get_test_queries (engine), ==, "1");
+
+	/* a device from the plugin changing does */
+	fu_device_set_status (device2, FWUPD_STATUS_DEVICE_BUSY);
+	g_assert_cmpstr (fu_engine_security_attrs_get_test_queries (engine), ==, "2");
+	g_unsetenv ("FWUPD_PLUGIN_TEST");
+}
+
+/* the plugins that are not thread safe are run from the main context once the
+ * worker thread has finished */
+static void
+fu_engine_probe_thread_wait (FuDevice *device, const gchar *key, guint value)
+{
+	for (guint i = 0; i < 5000; i++) {
+		if (fu_device_get_metadata_integer (device, key) == value)
+			return;
+		g_main_context_iteration (NULL, FALSE);
+		g_usleep (1000);
+	}
+}
+
+static void
+fu_engine_probe_thread_func (gconstpointer user_data)
+{
+	gboolean ret;
+	g_autofree gchar *pluginfn = NULL;
+	g_autoptr(FuEngine) engine = fu_engine_new (FU_APP_FLAGS_NONE);
+	g_autoptr(FuPlugin) plugin1 = fu_plugin_new ();
+	g_autoptr(FuPlugin) plugin2 = fu_plugin_new ();
+	g_autoptr(FuUdevDevice) device1 = fu_udev_device_new (NULL);
+	g_autoptr(FuUdevDevice) device2 = fu_udev_device_new (NULL);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(XbSilo) silo_empty = xb_silo_new ();
+
+	/* ensure empty tree */
+	fu_self_test_mkroot ();
+
+	/* one plugin that can be run from a worker thread and one that cannot */
+	pluginfn = g_build_filename (PLUGINBUILDDIR,
+				     "libfu_plugin_test." G_MODULE_SUFFIX,
+				     NULL);
+	ret = fu_plugin_open (plugin1, pluginfn, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	fu_plugin_add_rule (plugin1, FU_PLUGIN_RULE_THREAD_SAFE, "udev_device_added");
+	fu_plugin_set_name (plugin2, "test2");
+	ret = fu_plugin_open (plugin2, pluginfn, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+
+	/* no metadata in daemon */
+	fu_engine_set_silo (engine, silo_empty);
+	fu_engine_add_plugin (engine, plugin1);
+	fu_engine_add_plugin (engine, plugin2);
+	g_setenv ("CONFIGURATION_DIRECTORY", TESTDATADIR_SRC, TRUE);
+	ret = fu_engine_load (engine, FU_ENGINE_LOAD_FLAG_NO_ENUMERATE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_setenv ("FWUPD_PLUGIN_TEST", "probe-thread", TRUE);
+
+	/* events for the same device are processed in order, one at a time */
+	fu_device_add_possible_plugin (FU_DEVICE (device1), "test");
+	fu_device_add_possible_plugin (FU_DEVICE (device1), "test2");
+	fu_device_set_metadata_integer (FU_DEVICE (device1), "nr-added-test", 0);
+	fu_device_set_metadata_integer (FU_DEVICE (device1), "nr-added-test2", 0);
+	for (guint i = 0; i < 3; i++)
+		fu_engine_backend_device_added (engine, FU_DEVICE (device1), "/sys/devices/fake1");
+	fu_engine_probe_thread_wait (FU_DEVICE (device1), "nr-added-test2", 3);
+	g_assert_cmpint (fu_device_get_metadata_integer (FU_DEVICE (device1), "nr-added-test2"), ==, 3);
+	g_assert_cmpint (fu_device_get_metadata_integer (FU_DEVICE (device1), "nr-added-test"), ==, 3);
+	g_assert_false (fu_device_get_metadata_boolean (FU_DEVICE (device1), "ProbeOverlap"));
+
+	/* removing the device while it is being set up drops the waiting
+	 * events, and the plugins that are not thread safe are not run */
+	fu_device_add_possible_plugin (FU_DEVICE (device2), "test");
+	fu_device_add_possible_plugin (FU_DEVICE (device2), "test2");
+	fu_device_set_metadata_integer (FU_DEVICE (device2), "nr-added-test", 0);
+	fu_device_set_metadata_integer (FU_DEVICE (device2), "nr-added-test2", 0);
+	for (guint i = 0; i < 3; i++)
+		fu_engine_backend_device_added (engine, FU_DEVICE (device2), "/sys/devices/fake2");
+	fu_engine_backend_device_removed (engine, "/sys/devices/fake2");
+
+	/* replugged, which is only processed once the first event is done */
+	fu_engine_backend_device_added (engine, FU_DEVICE (device2), "/sys/devices/fake2");
+	fu_engine_probe_thread_wait (FU_DEVICE (device2), "nr-added-test2", 1);
+	g_assert_cmpint (fu_device_get_metadata_integer (FU_DEVICE (device2), "nr-added-test2"), ==, 1);
+	g_assert_cmpint (fu_device_get_metadata_integer (FU_DEVICE (device2), "nr-added-test"), ==, 2);
+	g_assert_false (fu_device_get_metadata_boolean (FU_DEVICE (device2), "ProbeOverlap"));
+	g_unsetenv ("FWUPD_PLUGIN_TEST");
+}
+
+static void
+fu_engine_emulation_func (gconstpointer user_data)
+{
+	gboolean ret;
+	const gchar *json =
+		"{\"Devices\":[{\"BackendId\":\"/sys/devices/foo\",\"Events\":["
+		"{\"Id\":\"Pread:Port=0x0,Length=0x2\",\"Duration\":10,\"Data\":\"EjQ=\"},"
+		"{\"Id\":\"Write:Data=AA==\",\"ErrorDomain\":\"g-io-error-quark\","
+		"\"ErrorCode\":\"24\",\"Error\":\"timeout\"}]}]}";
+	const gchar *json_invalid[] = {
+		"",
+		"[]",
+		"{\"Devices\":{}}",
+		"{\"Devices\":[1]}",
+		"{\"Devices\":[{\"BackendId\":1,\"Events\":[]}]}",
+		"{\"Devices\":[{\"BackendId\":\"foo\",\"Events\":[1]}]}",
+		"{\"Devices\":[{\"BackendId\":\"foo\",\"Events\":[{\"Id\":1}]}]}",
+		"{\"Devices\":[{\"BackendId\":\"foo\",\"Events\":[{\"Id\":\"Foo\",\"Data\":[]}]}]}",
+		NULL };
+	g_autofree gchar *data1 = NULL;
+	g_autofree gchar *data2 = NULL;
+	g_autoptr(FuEngine) engine1 = fu_engine_new (FU_APP_FLAGS_NONE);
+	g_autoptr(FuEngine) engine2 = fu_engine_new (FU_APP_FLAGS_NONE);
+	g_autoptr(GError) error = NULL;
+
+	/* load, save and load again */
+	ret = g_file_set_contents ("/tmp/fwupd-self-test/emulation.json", json, -1, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = fu_engine_emulation_load (engine1, "/tmp/fwupd-self-test/emulation.json", &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = fu_engine_emulation_save (engine1, "/tmp/fwupd-self-test/emulation1.json", &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = fu_engine_emulation_load (engine2, "/tmp/fwupd-self-test/emulation1.json", &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = fu_engine_emulation_save (engine2, "/tmp/fwupd-self-test/emulation2.json", &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+
+	/* nothing was lost */
+	ret = g_file_get_contents ("/tmp/fwupd-self-test/emulation1.json", &data1, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	ret = g_file_get_contents ("/tmp/fwupd-self-test/emulation2.json", &data2, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	g_assert_cmpstr (data1, ==, data2);
+	g_assert_nonnull (g_strstr_len (data1, -1, "/sys/devices/foo"));
+	g_assert_nonnull (g_strstr_len (data1, -1, "EjQ="));
+	g_assert_nonnull (g_strstr_len (data1, -1, "timeout"));
+
+	/* invalid files are rejected with an error */
+	for (guint i = 0; json_invalid[i] != NULL; i++) {
+		g_autoptr(FuEngine) engine = fu_engine_new (FU_APP_FLAGS_NONE);
+		g_autoptr(GError) error_local = NULL;
+		ret = g_file_set_contents ("/tmp/fwupd-self-test/emulation.json",
+					   json_invalid[i], -1, &error);
+		g_assert_no_error (error);
+		g_assert_true (ret);
+		ret = fu_engine_emulation_load (engine, "/tmp/fwupd-self-test/emulation.json",
+						&error_local);
+		g_assert_false (ret);
+		g_assert_nonnull (error_local);
+		g_assert_nonnull (error_local->message);
+		g_debug ("%s: %s", json_invalid[i], error_local->message);
+	}
+}
+
+static void
+fu_engine_backend_replace_func (gconstpointer user_data)
+{
+	gboolean ret;
+	g_autofree gchar *pluginfn = NULL;
+	g_autoptr(FuDevice) device = NULL;
+	g_autoptr(FuDevice) device1 = fu_device_new ();
+	g_autoptr(FuDevice) device2 = fu_device_new ();
+	g_autoptr(FuEngine) engine = fu_engine_new (FU_APP_FLAGS_NONE);
+	g_autoptr(FuPlugin) plugin = fu_plugin_new ();
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(XbSilo) silo_empty = xb_silo_new ();
+
+	/* ensure empty tree */
+	fu_self_test_mkroot ();
+
+	pluginfn = g_build_filename (PLUGINBUILDDIR,
+				     "libfu_plugin_test." G_MODULE_SUFFIX,
+				     NULL);
+	ret = fu_plugin_open (plugin, pluginfn, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+
+	/* no metadata in daemon */
+	fu_engine_set_silo (engine, silo_empty);
+	fu_engine_add_plugin (engine, plugin);
+	g_setenv ("CONFIGURATION_DIRECTORY", TESTDATADIR_SRC, TRUE);
+	ret = fu_engine_load (engine, FU_ENGINE_LOAD_FLAG_NO_ENUMERATE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+
+	/* the device is replugged and now uses a different backend device */
+	fu_device_set_id (device1, "backend-replace");
+	fu_device_set_backend_id (device1, "/sys/devices/fake1");
+	fu_device_add_guid (device1, "2d47f29b-83a2-4f31-a2e8-63474f4d4c2e");
+	fu_engine_add_device (engine, device1);
+	fu_device_set_id (device2, "backend-replace");
+	fu_device_set_backend_id (device2, "/sys/devices/fake2");
+	fu_device_add_guid (device2, "2d47f29b-83a2-4f31-a2e8-63474f4d4c2e");
+	fu_engine_add_device (engine, device2);
+	devices = fu_engine_get_devices (engine, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (devices);
+	g_assert_cmpint (devices->len, ==, 1);
+
+	/* the old backend device going away does not remove the new device */
+	fu_engine_backend_device_removed (engine, "/sys/devices/fake1");
+	device = fu_engine_get_device (engine, fu_device_get_id (device2), &error);
+	g_assert_no_error (error);
+	g_assert_true (device == device2);
+	g_clear_object (&device);
+
+	/* but the new one does */
+	fu_engine_backend_device_removed (engine, "/sys/devices/fake2");
+	device = fu_engine_get_device (engine, fu_device_get_id (device2), &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert_null (device);
+}
+
+static void
+fu_engine_install_threaded_func (gconstpointer user_data)
+{
+	gboolean ret;
+	const gchar *logical_ids[] = { "fail", "pass1", "pass2", NULL };
+	g_autofree gchar *filename = NULL;
+	g_autofree gchar *pluginfn = NULL;
+	g_autoptr(FuEngine) engine = fu_engine_new (FU_APP_FLAGS_NONE);
+	g_autoptr(FuEngineRequest) request = fu_engine_request_new ();
+	g_autoptr(FuPlugin) plugin = fu_plugin_new ();
+	g_autoptr(GBytes) blob_cab = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) devices = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_autoptr(GPtrArray) install_tasks = NULL;
+	g_autoptr(XbNode) component = NULL;
+	g_autoptr(XbSilo) silo_empty = xb_silo_new ();
+	g_autoptr(XbSilo) silo = NULL;
+
+	/* ensure empty tree */
+	fu_self_test_mkroot ();
+
+	/* use a new plugin so the rule does not affect any other test */
+	pluginfn = g_build_filename (PLUGINBUILDDIR,
+				     "libfu_plugin_test." G_MODULE_SUFFIX,
+				     NULL);
+	ret = fu_plugin_open (plugin, pluginfn, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+	fu_plugin_add_rule (plugin, FU_PLUGIN_RULE_THREAD_SAFE, "update");
+
+	/* no metadata in daemon, and only one device updated at a time */
+	fu_engine_set_silo (engine, silo_empty);
+	fu_engine_set_install_threads_max (engine, 1);
+	fu_engine_add_plugin (engine, plugin);
+	g_setenv ("CONFIGURATION_DIRECTORY", TESTDATADIR_SRC, TRUE);
+	ret = fu_engine_load (engine, FU_ENGINE_LOAD_FLAG_NO_ENUMERATE, &error);
+	g_assert_no_error (error);
+	g_assert_true (ret);
+
+	/* three independent devices, the first of which fails to update */
+	for (guint i = 0; logical_ids[i] != NULL; i++) {
+		g_autofree gchar *id = g_strdup_printf ("test_device%u", i + 1);
+		g_autoptr(FuDevice) device = fu_device_new ();
+		fu_device_set_id (device, id);
+		fu_device_set_logical_id (device, logical_ids[i]);
+		fu_device_set_version_format (device, FWUPD_VERSION_FORMAT_TRIPLET);
+		fu_device_set_version (device, "1.2.2");
+		fu_device_set_vendor_id (device, "USB:FFFF");
+		fu_device_set_protocol (device, "com.acme");
+		fu_device_set_plugin (device, "test");
+		fu_device_add_guid (device, "12345678-1234-1234-1234-123456789012");
+		fu_device_add_flag (device, FWUPD_DEVICE_FLAG_UPDATABLE);
+		fu_device_set_metadata_integer (device, "nr-update", 0);
+		fu_engine_add_device (engine, device);
+		g_ptr_array_add (devices, g_steal_pointer (&device));
+	}
+
+	filename = g_build_filename (TESTDATADIR_DST, "missing-hwid", "noreqs-1.2.3.cab", NULL);
+	blob_cab = fu_common_get_contents_bytes (filename, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (blob_cab);
+	silo = fu_engine_get_silo_from_blob (engine, blob_cab, &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (silo);
+	component = xb_silo_query_first (silo, "components/component/id[text()='com.hughski.test.firmware']/..", &error);
+	g_assert_no_error (error);
+	g_assert_nonnull (component);
+
+	/* the failure is reported and the queued devices are never updated */
+	install_tasks = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	for (guint i = 0; i < devices->len; i++) {
+		FuDevice *device = g_ptr_array_index (devices, i);
+		g_ptr_array_add (install_tasks, fu_install_task_new (device, component));
+	}
+	g_setenv ("FWUPD_PLUGIN_TEST", "fail-logical-id", TRUE);
+	ret = fu_engine_install_tasks (engine, request, install_tasks, blob_cab,
+				       FWUPD_INSTALL_FLAG_NONE, &error);
+	g_unsetenv ("FWUPD_PLUGIN_TEST");
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_SUPPORTED);
+	g_assert_false (ret);
+	for (guint i = 0; i < devices->len; i++) {
+		FuDevice *device = g_ptr_array_index (devices, i);
+		g_assert_cmpint (fu_device_get_metadata_integer (device, "nr-update"), ==, 0);
+	}
+}
+
 static void
 fu_engine_history_func (gconstpointer user_data)
 {
@@ -2266,6 +2723,63 @@ fu_device_list_remove_chain_func (gconstpointer user_data)
 	g_assert_cmpint (changed_cnt, ==, 0);
 }
 
+static void
+fu_uevent_batch_cb (FuUeventBatchAction action, GObject *device, gpointer user_data)
+{
+	GString *str = (GString *) user_data;
+	const gchar *id = g_object_get_data (device, "id");
+	if (action == FU_UEVENT_BATCH_ACTION_ADD)
+		g_string_append_printf (str, "add:%s,", id);
+	else if (action == FU_UEVENT_BATCH_ACTION_REMOVE)
+		g_string_append_printf (str, "remove:%s,", id);
+	else if (action == FU_UEVENT_BATCH_ACTION_CHANGE)
+		g_string_append_printf (str, "change:%s,", id);
+}
+
+static void
+fu_uevent_batch_func (gconstpointer user_data)
+{
+	guint processed;
+	const gchar *ids[] = { "A", "B", "C", "D", "E", NULL };
+	g_autoptr(FuUeventBatch) batch = fu_uevent_batch_new ();
+	g_autoptr(GPtrArray) devices = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_autoptr(GString) str = g_string_new (NULL);
+
+	for (guint i = 0; ids[i] != NULL; i++) {
+		GObject *device = g_object_new (G_TYPE_OBJECT, NULL);
+		g_object_set_data (device, "id", (gpointer) ids[i]);
+		g_ptr_array_add (devices, device);
+	}
+
+	fu_uevent_batch_add (batch, FU_UEVENT_BATCH_ACTION_ADD, "A", g_ptr_array_index (devices, 0));
+	fu_uevent_batch_add (batch, FU_UEVENT_BATCH_ACTION_REMOVE, "B", g_ptr_array_index (devices, 1));
+	fu_uevent_batch_add (batch, FU_UEVENT_BATCH_ACTION_ADD, "B", g_ptr_array_index (devices, 1));
+	fu_uevent_batch_add (batch, FU_UEVENT_BATCH_ACTION_CHANGE, "C", g_ptr_array_index (devices, 2));
+	fu_uevent_batch_add (batch, FU_UEVENT_BATCH_ACTION_REMOVE, "D", g_ptr_array_index (devices, 3));
+	fu_uevent_batch_add (batch, FU_UEVENT_BATCH_ACTION_ADD, "E", g_ptr_array_index (devices, 4));
+
+	/* replugged, so added after everything else */
+	fu_uevent_batch_add (batch, FU_UEVENT_BATCH_ACTION_ADD, "A", g_ptr_array_index (devices, 0));
+
+	/* covered by the pending change */
+	fu_uevent_batch_add (batch, FU_UEVENT_BATCH_ACTION_CHANGE, "C", g_ptr_array_index (devices, 2));
+
+	/* removed before it was ever added */
+	fu_uevent_batch_add (batch, FU_UEVENT_BATCH_ACTION_REMOVE, "E", g_ptr_array_index (devices, 4));
+	g_assert_cmpint (fu_uevent_batch_get_coalesced (batch), ==, 4);
+
+	/* all the removes are run before the adds */
+	processed = fu_uevent_batch_process (batch, fu_uevent_batch_cb, str);
+	g_assert_cmpint (processed, ==, 5);
+	g_assert_cmpstr (str->str, ==, "remove:B,remove:D,remove:E,add:B,change:C,add:A,");
+
+	/* the batch is now empty */
+	g_string_truncate (str, 0);
+	processed = fu_uevent_batch_process (batch, fu_uevent_batch_cb, str);
+	g_assert_cmpint (processed, ==, 0);
+	g_assert_cmpstr (str->str, ==, "");
+}
+
 static void
 fu_device_list_func (gconstpointer user_data)
 {
@@ -2348,9 +2862,73 @@ fu_device_list_func (gconstpointer user_data)
 			 "1a8d0d9a96ad3e67ba76cf3033623625dc6d6882");
 }
 
+static void
+fu_device_list_index_func (gconstpointer user_data)
+{
+	g_autoptr(FuDeviceList) device_list = fu_device_list_new ();
+	g_autoptr(FuDevice) device1 = fu_device_new ();
+	g_autoptr(FuDevice) device2 = fu_device_new ();
+	g_autoptr(GError) error = NULL;
+	FuDevice *device;
+
+	fu_device_set_id (device1, "device1");
+	fu_device_add_instance_id (device1, "foobar");
+	fu_device_convert_instance_ids (device1);
+	fu_device_list_add (device_list, device1);
+	fu_device_set_id (device2, "device2");
+	fu_device_add_instance_id (device2, "baz");
+	fu_device_convert_instance_ids (device2);
+	fu_device_list_add (device_list, device2);
+
+	/* instance IDs are converted to GUIDs for the lookup */
+	device = fu_device_list_get_by_guid (device_list, "foobar", &error);
+	g_assert_no_error (error);
+	g_assert (device == device1);
+	g_clear_object (&device);
+
+	/* GUID added after the device was added to the list */
+	fu_device_add_guid (device2, "2d47f29b-83a2-4f31-a2e8-63474f4d4c2e");
+	device = fu_device_list_get_by_guid (device_list,
+					     "2d47f29b-83a2-4f31-a2e8-63474f4d4c2e",
+					     &error);
+	g_assert_no_error (error);
+	g_assert (device == device2);
+	g_clear_object (&device);
+
+	/* ID changed after the device was added to the list */
+	fu_device_set_id (device1, "device1-new");
+	device = fu_device_list_get_by_id (device_list,
+					   "99249eb1bd9ef0b6e192b271a8cb6a3090cfec7a",
+					   &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert (device == NULL);
+	g_clear_error (&error);
+	device = fu_device_list_get_by_id (device_list,
+					   fu_device_get_id (device1),
+					   &error);
+	g_assert_no_error (error);
+	g_assert (device == device1);
+	g_clear_object (&device);
+
+	/* abbreviated hashes do not use the index */
+	device = fu_device_list_get_by_id (device_list, "1a8d0d", &error);
+	g_assert_no_error (error);
+	g_assert (device == device2);
+	g_clear_object (&device);
+
+	/* removed devices are dropped from the index */
+	fu_device_list_remove (device_list, device2);
+	device = fu_device_list_get_by_guid (device_list,
+					     "2d47f29b-83a2-4f31-a2e8-63474f4d4c2e",
+					     &error);
+	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
+	g_assert (device == NULL);
+}
+
 static void
 fu_plugin_list_func (gconstpointer user_data)
 {
+	FuTest *self = (FuTest *) user_data;
 	GPtrArray *plugins;
 	FuPlugin *plugin;
 	g_autoptr(FuPluginList) plugin_list = fu_plugin_list_new ();
@@ -2377,6 +2955,18 @@ fu_plugin_list_func (gconstpointer user_data)
 	plugin = fu_plugin_list_find_by_name (plugin_list, "nope", &error);
 	g_assert_error (error, FWUPD_ERROR, FWUPD_ERROR_NOT_FOUND);
 	g_assert (plugin == NULL);
+
+	/* only plugins implementing the vfunc are returned */
+	plugins = fu_plugin_list_get_all_by_vfunc (plugin_list, FU_PLUGIN_VFUNC_DEVICE_REGISTERED);
+	g_assert_cmpint (plugins->len, ==, 0);
+	g_assert_true (fu_plugin_has_vfunc (self->plugin, FU_PLUGIN_VFUNC_DEVICE_REGISTERED));
+	g_assert_false (fu_plugin_has_vfunc (self->plugin, FU_PLUGIN_VFUNC_UDEV_DEVICE_CHANGED));
+	fu_plugin_list_add (plugin_list, self->plugin);
+	plugins = fu_plugin_list_get_all_by_vfunc (plugin_list, FU_PLUGIN_VFUNC_DEVICE_REGISTERED);
+	g_assert_cmpint (plugins->len, ==, 1);
+	g_assert_true (g_ptr_array_index (plugins, 0) == self->plugin);
+	plugins = fu_plugin_list_get_all_by_vfunc (plugin_list, FU_PLUGIN_VFUNC_UDEV_DEVICE_CHANGED);
+	g_assert_cmpint (plugins->len, ==, 0);
 }
 
 static void
@@ -2628,6 +3218,7 @@ fu_history_func (gconstpointer user_data)
 	g_autoptr(GPtrArray) approved_firmware = NULL;
 	g_autofree gchar *dirname = NULL;
 	g_autofree gchar *filename = NULL;
+	g_autofree gchar *filename_wal = NULL;
 
 	/* create */
 	history = fu_history_new ();
@@ -2639,6 +3230,8 @@ fu_history_func (gconstpointer user_data)
 		return;
 	filename = g_build_filename (dirname, "pending.db", NULL);
 	g_unlink (filename);
+	filename_wal = g_build_filename (dirname, "pending.db-wal", NULL);
+	g_unlink (filename_wal);
 
 	/* add a device */
 	device = fu_device_new ();
@@ -2717,7 +3310,10 @@ fu_history_func (gconstpointer user_data)
 	g_assert (device_found == NULL);
 	g_clear_error (&error);
 
-	/* approved firmware */
+	/* approved firmware, written in one transaction */
+	ret = fu_history_start_transaction (history, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
 	ret = fu_history_clear_approved_firmware (history, &error);
 	g_assert_no_error (error);
 	g_assert (ret);
@@ -2727,6 +3323,9 @@ fu_history_func (gconstpointer user_data)
 	ret = fu_history_add_approved_firmware (history, "bar", &error);
 	g_assert_no_error (error);
 	g_assert (ret);
+	ret = fu_history_commit_transaction (history, &error);
+	g_assert_no_error (error);
+	g_assert (ret);
 	approved_firmware = fu_history_get_approved_firmware (history, &error);
 	g_assert_no_error (error);
 	g_assert_nonnull (approved_firmware);
@@ -3155,12 +3754,16 @@ main (int argc, char **argv)
 			      fu_security_attr_func);
 	g_test_add_data_func ("/fwupd/device-list", self,
 			      fu_device_list_func);
+	g_test_add_data_func ("/fwupd/device-list{index}", self,
+			      fu_device_list_index_func);
 	g_test_add_data_func ("/fwupd/device-list{delay}", self,
 			      fu_device_list_delay_func);
 	g_test_add_data_func ("/fwupd/device-list{compatible}", self,
 			      fu_device_list_compatible_func);
 	g_test_add_data_func ("/fwupd/device-list{remove-chain}", self,
 			      fu_device_list_remove_chain_func);
+	g_test_add_data_func ("/fwupd/uevent-batch", self,
+			      fu_uevent_batch_func);
 	g_test_add_data_func ("/fwupd/install-task{compare}", self,
 			      fu_install_task_compare_func);
 	g_test_add_data_func ("/fwupd/engine{device-unlock}", self,
@@ -3219,6 +3822,18 @@ main (int argc, char **argv)
 			      fu_engine_device_priority_func);
 	g_test_add_data_func ("/fwupd/engine{install-duration}", self,
 			      fu_engine_install_duration_func);
+	g_test_add_data_func ("/fwupd/engine{startup-profile}", self,
+			      fu_engine_startup_profile_func);
+	g_test_add_data_func ("/fwupd/engine{install-threaded}", self,
+			      fu_engine_install_threaded_func);
+	g_test_add_data_func ("/fwupd/engine{security-attrs-cache}", self,
+			      fu_engine_security_attrs_cache_func);
+	g_test_add_data_func ("/fwupd/engine{probe-thread}", self,
+			      fu_engine_probe_thread_func);
+	g_test_add_data_func ("/fwupd/engine{emulation}", self,
+			      fu_engine_emulation_func);
+	g_test_add_data_func ("/fwupd/engine{backend-replace}", self,
+			      fu_engine_backend_replace_func);
 	g_test_add_data_func ("/fwupd/engine{generate-md}", self,
 			      fu_engine_generate_md_func);
 	g_test_add_data_func ("/fwupd/engine{requirements-other-device}", self,
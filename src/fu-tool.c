@@ -63,6 +63,7 @@ struct FuUtilPrivate {
 	FwupdInstallFlags	 flags;
 	gboolean		 show_all;
 	gboolean		 disable_ssl_strict;
+	gboolean		 emulation_latency;
 	/* only valid in update and downgrade */
 	FuUtilOperation		 current_operation;
 	FwupdDevice		*current_device;
@@ -342,6 +343,26 @@ fu_util_get_plugins (FuUtilPrivate *priv, gchar **values, GError **error)
 	return TRUE;
 }
 
+static gboolean
+fu_util_get_startup_profile (FuUtilPrivate *priv, gchar **values, GError **error)
+{
+	GVariantIter iter;
+	const gchar *id;
+	guint64 duration;
+	g_autoptr(GVariant) profile = NULL;
+
+	/* load engine */
+	if (!fu_util_start_engine (priv, FU_ENGINE_LOAD_FLAG_NONE, error))
+		return FALSE;
+
+	/* print */
+	profile = g_variant_ref_sink (fu_engine_get_startup_profile (priv->engine));
+	g_variant_iter_init (&iter, profile);
+	while (g_variant_iter_next (&iter, "(&st)", &id, &duration))
+		g_print ("%-40s %8.2fms\n", id, (gdouble) duration / 1000.f);
+	return TRUE;
+}
+
 static gboolean
 fu_util_filter_device (FuUtilPrivate *priv, FwupdDevice *dev)
 {
@@ -2578,6 +2599,53 @@ fu_util_switch_branch (FuUtilPrivate *priv, gchar **values, GError **error)
 	return fu_util_prompt_complete (priv->completion_flags, TRUE, error);
 }
 
+static gboolean
+fu_util_emulate_record (FuUtilPrivate *priv, gchar **values, GError **error)
+{
+	/* invalid args, the device ID is only used when installing firmware */
+	if (g_strv_length (values) == 0 || g_strv_length (values) > 3) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_ARGS,
+				     "Invalid arguments");
+		return FALSE;
+	}
+
+	/* record the probe and setup, and optionally the update */
+	fu_engine_set_emulation (priv->engine, FU_DEVICE_EMULATION_RECORD, FALSE);
+	if (g_strv_length (values) >= 2) {
+		if (!fu_util_install_blob (priv, values + 1, error))
+			return FALSE;
+	} else {
+		if (!fu_util_get_devices (priv, values + 1, error))
+			return FALSE;
+	}
+	return fu_engine_emulation_save (priv->engine, values[0], error);
+}
+
+static gboolean
+fu_util_emulate_load (FuUtilPrivate *priv, gchar **values, GError **error)
+{
+	/* invalid args, the device ID is only used when installing firmware */
+	if (g_strv_length (values) == 0 || g_strv_length (values) > 3) {
+		g_set_error_literal (error,
+				     FWUPD_ERROR,
+				     FWUPD_ERROR_INVALID_ARGS,
+				     "Invalid arguments");
+		return FALSE;
+	}
+
+	/* play back the probe and setup, and optionally the update */
+	fu_engine_set_emulation (priv->engine,
+				 FU_DEVICE_EMULATION_REPLAY,
+				 priv->emulation_latency);
+	if (!fu_engine_emulation_load (priv->engine, values[0], error))
+		return FALSE;
+	if (g_strv_length (values) >= 2)
+		return fu_util_install_blob (priv, values + 1, error);
+	return fu_util_get_devices (priv, values + 1, error);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -2652,6 +2720,9 @@ main (int argc, char *argv[])
 		{ "disable-ssl-strict", '\0', 0, G_OPTION_ARG_NONE, &priv->disable_ssl_strict,
 			/* TRANSLATORS: command line option */
 			_("Ignore SSL strict checks when downloading files"), NULL },
+		{ "emulation-latency", '\0', 0, G_OPTION_ARG_NONE, &priv->emulation_latency,
+			/* TRANSLATORS: command line option */
+			_("Play back emulated devices with the recorded latency"), NULL },
 		{ "filter", '\0', 0, G_OPTION_ARG_STRING, &filter,
 			/* TRANSLATORS: command line option */
 			_("Filter with a set of device flags using a ~ prefix to "
@@ -2701,6 +2772,12 @@ main (int argc, char *argv[])
 		     /* TRANSLATORS: command description */
 		     _("Get all enabled plugins registered with the system"),
 		     fu_util_get_plugins);
+	fu_util_cmd_array_add (cmd_array,
+		     "get-startup-profile",
+		     NULL,
+		     /* TRANSLATORS: command description */
+		     _("Show how long each part of startup took"),
+		     fu_util_get_startup_profile);
 	fu_util_cmd_array_add (cmd_array,
 		     "get-details",
 		     NULL,
@@ -2894,6 +2971,18 @@ main (int argc, char *argv[])
 		     /* TRANSLATORS: command description */
 		     _("Switch the firmware branch on the device"),
 		     fu_util_switch_branch);
+	fu_util_cmd_array_add (cmd_array,
+		     "emulate-record",
+		     "FILENAME [FILENAME-FW [DEVICE-ID]]",
+		     /* TRANSLATORS: command description */
+		     _("Record the requests sent to devices, optionally when installing firmware"),
+		     fu_util_emulate_record);
+	fu_util_cmd_array_add (cmd_array,
+		     "emulate-load",
+		     "FILENAME [FILENAME-FW [DEVICE-ID]]",
+		     /* TRANSLATORS: command description */
+		     _("Play back recorded requests rather than using the hardware"),
+		     fu_util_emulate_load);
 
 	/* do stuff on ctrl+c */
 	priv->cancellable = g_cancellable_new ();
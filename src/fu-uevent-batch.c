@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#define G_LOG_DOMAIN				"FuUeventBatch"
+
+#include "config.h"
+
+#include "fu-uevent-batch.h"
+
+static void fu_uevent_batch_finalize	 (GObject *obj);
+
+struct _FuUeventBatch
+{
+	GObject			 parent_instance;
+	GPtrArray		*items;		/* of FuUeventBatchItem */
+	GHashTable		*items_idx;	/* id:FuUeventBatchItem, no ref */
+	guint			 coalesced;
+};
+
+typedef struct {
+	GObject			*device;
+	FuUeventBatchAction	 action;
+	gboolean		 removed;	/* removed before the last add */
+} FuUeventBatchItem;
+
+G_DEFINE_TYPE (FuUeventBatch, fu_uevent_batch, G_TYPE_OBJECT)
+
+static void
+fu_uevent_batch_item_free (FuUeventBatchItem *item)
+{
+	g_object_unref (item->device);
+	g_free (item);
+}
+
+static FuUeventBatchItem *
+fu_uevent_batch_item_new (GObject *device, FuUeventBatchAction action)
+{
+	FuUeventBatchItem *item = g_new0 (FuUeventBatchItem, 1);
+	item->device = g_object_ref (device);
+	item->action = action;
+	return item;
+}
+
+/**
+ * fu_uevent_batch_add:
+ * @self: A #FuUeventBatch
+ * @action: A #FuUeventBatchAction, e.g. %FU_UEVENT_BATCH_ACTION_ADD
+ * @id: A device ID, typically the sysfs path
+ * @device: A #GObject, typically a #GUdevDevice
+ *
+ * Adds an event to the batch, merging it with any event already pending for
+ * the same device so that a storm of events only probes or removes each
+ * device once. A device that is added again is moved to the end of the batch
+ * so that devices are added in the order they last arrived.
+ **/
+void
+fu_uevent_batch_add (FuUeventBatch *self,
+		     FuUeventBatchAction action,
+		     const gchar *id,
+		     GObject *device)
+{
+	FuUeventBatchItem *item;
+
+	g_return_if_fail (FU_IS_UEVENT_BATCH (self));
+	g_return_if_fail (id != NULL);
+	g_return_if_fail (G_IS_OBJECT (device));
+
+	item = g_hash_table_lookup (self->items_idx, id);
+	if (item == NULL) {
+		item = fu_uevent_batch_item_new (device, action);
+		g_ptr_array_add (self->items, item);
+		g_hash_table_insert (self->items_idx, g_strdup (id), item);
+		return;
+	}
+
+	self->coalesced++;
+	if (action == FU_UEVENT_BATCH_ACTION_ADD) {
+		FuUeventBatchItem *item_new = fu_uevent_batch_item_new (device, action);
+		item_new->removed = item->removed ||
+				    item->action == FU_UEVENT_BATCH_ACTION_REMOVE;
+		g_ptr_array_add (self->items, item_new);
+		g_hash_table_insert (self->items_idx, g_strdup (id), item_new);
+		g_ptr_array_remove (self->items, item);
+		return;
+	}
+	g_set_object (&item->device, device);
+	if (action == FU_UEVENT_BATCH_ACTION_REMOVE)
+		item->action = action;
+
+	/* a pending add or remove already covers a change */
+}
+
+/**
+ * fu_uevent_batch_get_coalesced:
+ * @self: A #FuUeventBatch
+ *
+ * Gets the number of events that have been merged into an existing event
+ * since the batch was created.
+ *
+ * Returns: integer
+ **/
+guint
+fu_uevent_batch_get_coalesced (FuUeventBatch *self)
+{
+	g_return_val_if_fail (FU_IS_UEVENT_BATCH (self), 0);
+	return self->coalesced;
+}
+
+/**
+ * fu_uevent_batch_process:
+ * @self: A #FuUeventBatch
+ * @func: A #FuUeventBatchFunc
+ * @user_data: user data to pass to @func
+ *
+ * Runs @func for every pending event and then empties the batch. All the
+ * removals are run first so that a device that was replugged is not matched
+ * against the instance it is replacing, and then the additions and changes
+ * are run in the order they were received.
+ *
+ * Any events added from @func are kept for the next batch.
+ *
+ * Returns: the number of devices processed
+ **/
+guint
+fu_uevent_batch_process (FuUeventBatch *self, FuUeventBatchFunc func, gpointer user_data)
+{
+	g_autoptr(GPtrArray) items = NULL;
+
+	g_return_val_if_fail (FU_IS_UEVENT_BATCH (self), 0);
+	g_return_val_if_fail (func != NULL, 0);
+
+	/* any events received while processing start a new batch */
+	items = self->items;
+	self->items = g_ptr_array_new_with_free_func ((GDestroyNotify) fu_uevent_batch_item_free);
+	g_hash_table_remove_all (self->items_idx);
+
+	for (guint i = 0; i < items->len; i++) {
+		FuUeventBatchItem *item = g_ptr_array_index (items, i);
+		if (item->removed || item->action == FU_UEVENT_BATCH_ACTION_REMOVE)
+			func (FU_UEVENT_BATCH_ACTION_REMOVE, item->device, user_data);
+	}
+	for (guint i = 0; i < items->len; i++) {
+		FuUeventBatchItem *item = g_ptr_array_index (items, i);
+		if (item->action == FU_UEVENT_BATCH_ACTION_REMOVE)
+			continue;
+		func (item->action, item->device, user_data);
+	}
+	return items->len;
+}
+
+static void
+fu_uevent_batch_class_init (FuUeventBatchClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+	object_class->finalize = fu_uevent_batch_finalize;
+}
+
+static void
+fu_uevent_batch_init (FuUeventBatch *self)
+{
+	self->items = g_ptr_array_new_with_free_func ((GDestroyNotify) fu_uevent_batch_item_free);
+	self->items_idx = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+}
+
+static void
+fu_uevent_batch_finalize (GObject *obj)
+{
+	FuUeventBatch *self = FU_UEVENT_BATCH (obj);
+
+	g_ptr_array_unref (self->items);
+	g_hash_table_unref (self->items_idx);
+
+	G_OBJECT_CLASS (fu_uevent_batch_parent_class)->finalize (obj);
+}
+
+FuUeventBatch *
+fu_uevent_batch_new (void)
+{
+	FuUeventBatch *self;
+	self = g_object_new (FU_TYPE_UEVENT_BATCH, NULL);
+	return FU_UEVENT_BATCH (self);
+}
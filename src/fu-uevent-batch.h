@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2020 Richard Hughes <richard@hughsie.com>
+ *
+ * SPDX-License-Identifier: LGPL-2.1+
+ */
+
+#pragma once
+
+#include <glib-object.h>
+
+#define FU_TYPE_UEVENT_BATCH (fu_uevent_batch_get_type ())
+G_DECLARE_FINAL_TYPE (FuUeventBatch, fu_uevent_batch, FU, UEVENT_BATCH, GObject)
+
+typedef enum {
+	FU_UEVENT_BATCH_ACTION_ADD,
+	FU_UEVENT_BATCH_ACTION_REMOVE,
+	FU_UEVENT_BATCH_ACTION_CHANGE,
+	FU_UEVENT_BATCH_ACTION_LAST
+} FuUeventBatchAction;
+
+typedef void	 (*FuUeventBatchFunc)		(FuUeventBatchAction action,
+						 GObject	*device,
+						 gpointer	 user_data);
+
+FuUeventBatch	*fu_uevent_batch_new		(void);
+void		 fu_uevent_batch_add		(FuUeventBatch	*self,
+						 FuUeventBatchAction action,
+						 const gchar	*id,
+						 GObject	*device);
+guint		 fu_uevent_batch_get_coalesced	(FuUeventBatch	*self);
+guint		 fu_uevent_batch_process	(FuUeventBatch	*self,
+						 FuUeventBatchFunc func,
+						 gpointer	 user_data);
@@ -1392,6 +1392,8 @@ static gboolean
 fu_util_get_updates (FuUtilPrivate *priv, gchar **values, GError **error)
 {
 	g_autoptr(GPtrArray) devices = NULL;
+	g_autoptr(GHashTable) upgrades = NULL;
+	g_autoptr(GError) error_all = NULL;
 	gboolean supported = FALSE;
 	g_autoptr(GNode) root = g_node_new (NULL);
 	g_autofree gchar *title = fu_util_get_tree_title (priv);
@@ -1421,6 +1423,13 @@ fu_util_get_updates (FuUtilPrivate *priv, gchar **values, GError **error)
 		return FALSE;
 	}
 	g_ptr_array_sort (devices, fu_util_sort_devices_by_flags_cb);
+
+	/* get the upgrades for every device in one D-Bus round-trip */
+	if (devices->len > 1) {
+		upgrades = fwupd_client_get_upgrades_all (priv->client, NULL, &error_all);
+		if (upgrades == NULL)
+			g_debug ("falling back to GetUpgrades: %s", error_all->message);
+	}
 	for (guint i = 0; i < devices->len; i++) {
 		FwupdDevice *dev = g_ptr_array_index (devices, i);
 		g_autoptr(GPtrArray) rels = NULL;
@@ -1444,9 +1453,22 @@ fu_util_get_updates (FuUtilPrivate *priv, gchar **values, GError **error)
 		supported = TRUE;
 
 		/* get the releases for this device and filter for validity */
-		rels = fwupd_client_get_upgrades (priv->client,
-						  fwupd_device_get_id (dev),
-						  NULL, &error_local);
+		if (upgrades != NULL) {
+			GPtrArray *rels_tmp = g_hash_table_lookup (upgrades,
+								   fwupd_device_get_id (dev));
+			if (rels_tmp != NULL) {
+				rels = g_ptr_array_ref (rels_tmp);
+			} else {
+				g_set_error_literal (&error_local,
+						     FWUPD_ERROR,
+						     FWUPD_ERROR_NOTHING_TO_DO,
+						     "No upgrades for device");
+			}
+		} else {
+			rels = fwupd_client_get_upgrades (priv->client,
+							  fwupd_device_get_id (dev),
+							  NULL, &error_local);
+		}
 		if (rels == NULL) {
 			if (!latest_header) {
 				/* TRANSLATORS: message letting the user know no device upgrade available */